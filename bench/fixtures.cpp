@@ -0,0 +1,126 @@
+#include "fixtures.h"
+
+#include <charconv>
+#include <fstream>
+#include <string_view>
+
+namespace memc::bench {
+
+namespace {
+
+/// First address handed out to generated VMAs.
+constexpr uint64_t kBaseAddress = 0x400000;
+
+/// Unmapped gap left between two generated VMAs.
+constexpr uint64_t kGap = 0x1000;
+
+/**
+ * @brief Parses the "start-end" range at the front of an smaps header line.
+ *
+ * @return size_t Length of the range text, or 0 if @p line is no header.
+ */
+size_t parse_range(std::string_view line, uint64_t& start, uint64_t& end) {
+    size_t dash = line.find('-');
+    size_t space = line.find(' ');
+    if (dash == std::string_view::npos || space == std::string_view::npos || dash > space)
+        return 0;
+    auto a = std::from_chars(line.data(), line.data() + dash, start, 16);
+    auto b = std::from_chars(line.data() + dash + 1, line.data() + space, end, 16);
+    if (a.ptr != line.data() + dash || b.ptr != line.data() + space || end < start)
+        return 0;
+    return space;
+}
+
+/**
+ * @brief Appends the "start-end" range of a VMA in maps format.
+ */
+void append_range(std::string& out, uint64_t start, uint64_t end) {
+    char buf[48];
+    char* p = std::to_chars(buf, buf + 20, start, 16).ptr;
+    *p++ = '-';
+    p = std::to_chars(p, buf + sizeof(buf), end, 16).ptr;
+    out.append(buf, p);
+}
+
+} // namespace
+
+/**
+ * @brief Splits a recorded /proc/<pid>/smaps file into its VMAs.
+ *
+ * A header line is one starting with a hex "start-end" range; every other
+ * line belongs to the body of the VMA above it.
+ *
+ * @param path The recorded smaps file.
+ * @param regions Output, in file order. Cleared first.
+ * @return true on success, false if unreadable or empty.
+ */
+bool load_recording(const std::string& path, std::vector<RecordedRegion>& regions) {
+    regions.clear();
+    std::ifstream in(path);
+    if (!in)
+        return false;
+
+    std::string line;
+    while (std::getline(in, line)) {
+        uint64_t start = 0;
+        uint64_t end = 0;
+        size_t range = parse_range(line, start, end);
+        if (range > 0) {
+            RecordedRegion& r = regions.emplace_back();
+            r.size = end - start;
+            r.header_tail.assign(line, range);
+            r.header_tail += '\n';
+        } else if (!regions.empty()) {
+            regions.back().body += line;
+            regions.back().body += '\n';
+        }
+    }
+    return !regions.empty();
+}
+
+/**
+ * @brief Builds a fixture of @p count VMAs from a recording.
+ *
+ * @param recording A recording from load_recording().
+ * @param count Number of VMAs to generate.
+ * @return Fixture The generated maps and smaps contents.
+ */
+Fixture make_fixture(const std::vector<RecordedRegion>& recording, size_t count) {
+    std::vector<const RecordedRegion*> repeatable;
+    for (const auto& r : recording) {
+        if (r.header_tail.find(" [") == std::string::npos)
+            repeatable.push_back(&r);
+    }
+
+    Fixture f;
+    f.regions = count;
+    uint64_t next = kBaseAddress;
+    for (size_t i = 0; i < count; ++i) {
+        const RecordedRegion* r = nullptr;
+        if (i < recording.size()) {
+            r = &recording[i];
+        } else if (!repeatable.empty()) {
+            r = repeatable[(i - recording.size()) % repeatable.size()];
+        } else {
+            r = &recording[i % recording.size()];
+        }
+
+        uint64_t start = next;
+        uint64_t end = start + r->size;
+        next = end + kGap;
+
+        append_range(f.maps, start, end);
+        f.maps += r->header_tail;
+        append_range(f.smaps, start, end);
+        f.smaps += r->header_tail;
+        f.smaps += r->body;
+    }
+
+    for (char c : f.maps)
+        f.maps_lines += c == '\n';
+    for (char c : f.smaps)
+        f.smaps_lines += c == '\n';
+    return f;
+}
+
+} // namespace memc::bench
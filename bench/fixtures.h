@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace memc::bench {
+
+/**
+ * @brief One VMA of a recorded smaps file.
+ *
+ * Fields:
+ * - size: end - start of the recorded mapping, in bytes.
+ * - header_tail: The header line after the address range (" r-xp ...\n").
+ * - body: The field lines that follow the header ("Size: ...\n" ...).
+ */
+struct RecordedRegion {
+    uint64_t size = 0;
+    std::string header_tail;
+    std::string body;
+};
+
+/**
+ * @brief Generated maps and smaps contents with the same regions.
+ *
+ * Fields:
+ * - regions: Number of VMAs.
+ * - maps, smaps: File contents.
+ * - maps_lines, smaps_lines: Line counts of each.
+ */
+struct Fixture {
+    size_t regions = 0;
+    std::string maps;
+    std::string smaps;
+    size_t maps_lines = 0;
+    size_t smaps_lines = 0;
+};
+
+/**
+ * @brief Splits a recorded /proc/<pid>/smaps file into its VMAs.
+ *
+ * @param path The recorded smaps file.
+ * @param regions Output, in file order. Cleared first.
+ * @return true on success, false if the file could not be read or holds
+ * no VMA.
+ */
+bool load_recording(const std::string& path, std::vector<RecordedRegion>& regions);
+
+/**
+ * @brief Builds a fixture of @p count VMAs from a recording.
+ *
+ * The first VMAs are the recording itself, in order. Larger fixtures
+ * repeat its file-backed and anonymous VMAs (not the "[heap]"-style
+ * pseudo-paths) until @p count is reached. Addresses are reassigned to
+ * ascending, non-overlapping ranges that keep each VMA's recorded size.
+ *
+ * @param recording A recording from load_recording().
+ * @param count Number of VMAs to generate.
+ * @return Fixture The generated maps and smaps contents.
+ */
+Fixture make_fixture(const std::vector<RecordedRegion>& recording, size_t count);
+
+} // namespace memc::bench
@@ -0,0 +1,448 @@
+/**
+ * memc_bench — parser and serializer microbenchmarks
+ *
+ * Times the maps/smaps parsers and the JSON serializers on fixtures generated
+ * from a recorded smaps file (50 to 100k VMAs), plus end-to-end sweeps of the
+ * live /proc. See `memc_bench --help` for usage details.
+ */
+
+#include "fixtures.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memc/growth_tracker.h>
+#include <memc/json_writer.h>
+#include <memc/maps_parser.h>
+#include <memc/process_utils.h>
+#include <memc/region.h>
+#include <memc/self_stats.h>
+#include <memc/shared_files.h>
+#include <memc/smaps_parser.h>
+#include <memc/system_scanner.h>
+#include <memc/version.h>
+#include <string>
+#include <third_party/nlohmann/json.hpp>
+#include <vector>
+
+#ifndef MEMC_BENCH_FIXTURE_DIR
+#define MEMC_BENCH_FIXTURE_DIR "bench/fixtures"
+#endif
+
+// ── Allocation counting ──────────────────────────────────────────────
+
+MEMC_COUNT_ALLOCATIONS()
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/// Fixture sizes, in VMAs.
+constexpr size_t kFixtureSizes[] = {50, 1000, 10000, 100000};
+
+/**
+ * @brief Command-line options of memc_bench.
+ *
+ * Fields:
+ * - fixtures: Directory holding the recorded smaps file.
+ * - filter: Only run benchmarks whose name contains this substring.
+ * - min_time_ms: Minimum measured time per benchmark.
+ * - json: Print results as JSON instead of a table.
+ * - baseline: Results file (from --json) to compare against.
+ * - threshold_pct: Slowdown in ns/region that counts as a regression.
+ * - write_fixtures: Directory to write the generated fixtures to, then exit.
+ * - live: Include the live /proc sweeps.
+ */
+struct BenchOptions {
+    std::string fixtures = MEMC_BENCH_FIXTURE_DIR;
+    std::string filter;
+    int min_time_ms = 200;
+    bool json = false;
+    std::string baseline;
+    double threshold_pct = 10.0;
+    std::string write_fixtures;
+    bool live = true;
+};
+
+/**
+ * @brief Measurements of one benchmark.
+ *
+ * Fields:
+ * - name: Benchmark name ("smaps.parse_from_view").
+ * - fixture: Input name ("vma_1000", "live").
+ * - regions, lines, bytes: Work done per iteration (0 if not applicable).
+ * - iterations: Timed iterations.
+ * - ns_per_iter: Mean wall time per iteration.
+ * - allocs_per_iter: Mean operator new calls per iteration.
+ */
+struct BenchResult {
+    std::string name;
+    std::string fixture;
+    size_t regions = 0;
+    size_t lines = 0;
+    size_t bytes = 0;
+    uint64_t iterations = 0;
+    double ns_per_iter = 0;
+    double allocs_per_iter = 0;
+
+    [[nodiscard]] double ns_per_region() const {
+        return regions ? ns_per_iter / static_cast<double>(regions) : 0.0;
+    }
+    [[nodiscard]] double per_sec(size_t n) const {
+        return ns_per_iter > 0 ? static_cast<double>(n) * 1e9 / ns_per_iter : 0.0;
+    }
+};
+
+/**
+ * @brief Runs @p body once untimed, then repeatedly for at least min_time_ms.
+ *
+ * @param body Callable performing one iteration.
+ * @return BenchResult Timing and allocation counts; the caller fills in the
+ * name and work sizes.
+ */
+template <typename Body>
+BenchResult measure(const BenchOptions& opts, Body&& body) {
+    body();
+
+    const auto min_time = std::chrono::milliseconds(opts.min_time_ms);
+    uint64_t iterations = 0;
+    uint64_t allocs_before = memc::self_stats().allocations;
+    auto start = Clock::now();
+    auto elapsed = Clock::duration::zero();
+    do {
+        body();
+        ++iterations;
+        elapsed = Clock::now() - start;
+    } while (elapsed < min_time);
+    uint64_t allocs = memc::self_stats().allocations - allocs_before;
+
+    BenchResult r;
+    r.iterations = iterations;
+    r.ns_per_iter = static_cast<double>(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) /
+                    static_cast<double>(iterations);
+    r.allocs_per_iter = static_cast<double>(allocs) / static_cast<double>(iterations);
+    return r;
+}
+
+/**
+ * @brief Collects results, skipping benchmarks excluded by --filter.
+ */
+class BenchRunner {
+public:
+    explicit BenchRunner(const BenchOptions& opts)
+        : opts_(opts) {}
+
+    /**
+     * @brief Runs one benchmark and records its result.
+     *
+     * @param name Benchmark name.
+     * @param fixture Input name.
+     * @param regions Regions processed per iteration.
+     * @param lines Input lines per iteration.
+     * @param bytes Input bytes per iteration.
+     * @param body Callable performing one iteration.
+     */
+    template <typename Body>
+    void run(const std::string& name, const std::string& fixture, size_t regions, size_t lines,
+             size_t bytes, Body&& body) {
+        if (!opts_.filter.empty() && name.find(opts_.filter) == std::string::npos)
+            return;
+        BenchResult r = measure(opts_, body);
+        r.name = name;
+        r.fixture = fixture;
+        r.regions = regions;
+        r.lines = lines;
+        r.bytes = bytes;
+        if (!opts_.json)
+            print_row(r);
+        results_.push_back(std::move(r));
+    }
+
+    [[nodiscard]] const std::vector<BenchResult>& results() const {
+        return results_;
+    }
+
+    /**
+     * @brief Prints the table header (table output only).
+     */
+    void print_header() const {
+        if (opts_.json)
+            return;
+        std::printf("%-26s %-11s %8s %12s %12s %14s %10s %12s\n", "benchmark", "fixture",
+                    "regions", "ns/iter", "ns/region", "lines/s", "MB/s", "allocs/iter");
+    }
+
+private:
+    static void print_row(const BenchResult& r) {
+        std::printf("%-26s %-11s %8zu %12.0f %12.1f %14.0f %10.1f %12.1f\n", r.name.c_str(),
+                    r.fixture.c_str(), r.regions, r.ns_per_iter, r.ns_per_region(),
+                    r.per_sec(r.lines), r.per_sec(r.bytes) / 1e6, r.allocs_per_iter);
+        std::fflush(stdout);
+    }
+
+    const BenchOptions& opts_;
+    std::vector<BenchResult> results_;
+};
+
+/**
+ * @brief Benchmarks parsing and serialization of one fixture.
+ */
+void bench_fixture(BenchRunner& runner, const memc::bench::Fixture& f) {
+    using namespace memc;
+    const std::string name = "vma_" + std::to_string(f.regions);
+    std::vector<MemoryRegion> regions;
+
+    runner.run("maps.parse_from_view", name, f.regions, f.maps_lines, f.maps.size(), [&] {
+        regions.clear();
+        MapsParser::parse_from_view(f.maps, regions);
+    });
+    runner.run("maps.parse_from_string", name, f.regions, f.maps_lines, f.maps.size(), [&] {
+        auto parsed = MapsParser::parse_from_string(f.maps);
+        regions.swap(parsed);
+    });
+    runner.run("smaps.parse_from_view", name, f.regions, f.smaps_lines, f.smaps.size(), [&] {
+        regions.clear();
+        SmapsParser::parse_from_view(f.smaps, regions);
+    });
+    runner.run("smaps.parse_from_view.rss", name, f.regions, f.smaps_lines, f.smaps.size(), [&] {
+        regions.clear();
+        SmapsParser::parse_from_view(f.smaps, regions, SmapsFields::kRss);
+    });
+    runner.run("smaps.parse_from_string", name, f.regions, f.smaps_lines, f.smaps.size(), [&] {
+        auto parsed = SmapsParser::parse_from_string(f.smaps);
+        regions.swap(parsed);
+    });
+
+    ProcessSnapshot snapshot;
+    snapshot.pid = 1;
+    SmapsParser::parse_from_view(f.smaps, snapshot.regions);
+
+    JsonWriter writer(true);
+    writer.write(snapshot);
+    size_t json_bytes = writer.view().size();
+    runner.run("json.write", name, f.regions, 0, json_bytes, [&] {
+        writer.clear();
+        writer.write(snapshot);
+    });
+    runner.run("json.to_json", name, f.regions, 0, json_bytes, [&] {
+        nlohmann::ordered_json j;
+        to_json(j, snapshot);
+        std::string out = j.dump(2);
+    });
+
+    GrowthTracker tracker({.rules = {*GrowthRule::parse("heap_growth>10MB/min")}});
+    std::vector<GrowthAlert> alerts;
+    runner.run("growth.update", name, f.regions, 0, 0, [&] {
+        snapshot.timestamp_ms += 1000;
+        alerts.clear();
+        tracker.update(snapshot, alerts);
+    });
+
+    SharedFileTable files;
+    runner.run("shared_files.add", name, f.regions, 0, 0, [&] {
+        snapshot.pid++;
+        files.add(snapshot);
+    });
+}
+
+/**
+ * @brief Benchmarks a full SystemScanner sweep of the live /proc.
+ */
+void bench_sweep(BenchRunner& runner, bool use_smaps) {
+    using namespace memc;
+    SystemScanner scanner({.collector = {.use_smaps = use_smaps}});
+    std::vector<pid_t> pids = enumerate_pids();
+    size_t regions = 0;
+    auto sweep = [&] {
+        regions = 0;
+        scanner.scan(pids, [&](ProcessEntry& e) {
+            if (e.snapshot)
+                regions += e.snapshot->regions.size();
+            return true;
+        });
+    };
+    sweep();
+    runner.run(use_smaps ? "sweep.smaps" : "sweep.maps", "live", regions, 0, 0, sweep);
+}
+
+/**
+ * @brief Serializes @p results as a JSON document.
+ */
+nlohmann::ordered_json results_to_json(const std::vector<BenchResult>& results) {
+    nlohmann::ordered_json doc;
+    doc["memc_version"] = MEMC_VERSION_STRING;
+    doc["results"] = nlohmann::ordered_json::array();
+    for (const auto& r : results) {
+        nlohmann::ordered_json j;
+        j["name"] = r.name;
+        j["fixture"] = r.fixture;
+        j["regions"] = r.regions;
+        j["lines"] = r.lines;
+        j["bytes"] = r.bytes;
+        j["iterations"] = r.iterations;
+        j["ns_per_iter"] = r.ns_per_iter;
+        j["ns_per_region"] = r.ns_per_region();
+        j["lines_per_sec"] = r.per_sec(r.lines);
+        j["bytes_per_sec"] = r.per_sec(r.bytes);
+        j["allocs_per_iter"] = r.allocs_per_iter;
+        doc["results"].push_back(std::move(j));
+    }
+    return doc;
+}
+
+/**
+ * @brief Compares @p results with a baseline file and reports regressions.
+ *
+ * A benchmark regresses when its ns/iter grew by more than threshold_pct.
+ * Live sweeps are skipped: they depend on what the machine is running.
+ *
+ * @return int Number of regressions, or -1 if the baseline is unreadable.
+ */
+int compare_baseline(const BenchOptions& opts, const std::vector<BenchResult>& results) {
+    std::ifstream in(opts.baseline);
+    if (!in) {
+        std::cerr << "Error: cannot read baseline " << opts.baseline << "\n";
+        return -1;
+    }
+    nlohmann::json base = nlohmann::json::parse(in, nullptr, false);
+    if (base.is_discarded() || !base.contains("results")) {
+        std::cerr << "Error: " << opts.baseline << " is not a memc_bench --json file\n";
+        return -1;
+    }
+
+    std::map<std::pair<std::string, std::string>, double> before;
+    for (const auto& j : base["results"]) {
+        before[{j.value("name", ""), j.value("fixture", "")}] = j.value("ns_per_iter", 0.0);
+    }
+
+    int regressions = 0;
+    for (const auto& r : results) {
+        auto it = before.find({r.name, r.fixture});
+        if (r.fixture == "live" || it == before.end() || it->second <= 0)
+            continue;
+        double change = (r.ns_per_iter / it->second - 1.0) * 100.0;
+        if (change > opts.threshold_pct) {
+            std::cerr << "Regression: " << r.name << " " << r.fixture << " " << it->second
+                      << " -> " << r.ns_per_iter << " ns/iter (+" << change << "%)\n";
+            ++regressions;
+        }
+    }
+    return regressions;
+}
+
+void print_usage(const char* prog) {
+    std::cerr << "Usage: " << prog << " [options]\n"
+              << "\n"
+              << "Benchmarks the memc parsers and serializers.\n"
+              << "\n"
+              << "Options:\n"
+              << "  --fixtures <dir>        Directory with the recorded smaps file\n"
+              << "                          (default: " MEMC_BENCH_FIXTURE_DIR ")\n"
+              << "  --filter <text>         Only run benchmarks whose name contains <text>\n"
+              << "  --min-time <ms>         Minimum measured time per benchmark (default: 200)\n"
+              << "  --json                  Print results as JSON\n"
+              << "  --baseline <file>       Compare with a previous --json run; exit 1 on\n"
+              << "                          regressions\n"
+              << "  --threshold <percent>   Slowdown counted as a regression (default: 10)\n"
+              << "  --no-live               Skip the live /proc sweeps\n"
+              << "  --write-fixtures <dir>  Write the generated maps/smaps fixtures and exit\n"
+              << "  -h, --help              Show this help message\n";
+}
+
+/**
+ * @brief Parses the command line into @p opts.
+ *
+ * @return int -1 to continue, otherwise the exit code to return.
+ */
+int parse_args(int argc, char* argv[], BenchOptions& opts) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto need_value = [&]() -> const char* {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: " << arg << " requires a value\n";
+                return nullptr;
+            }
+            return argv[++i];
+        };
+
+        if (arg == "-h" || arg == "--help") {
+            print_usage(argv[0]);
+            return 0;
+        } else if (arg == "--json") {
+            opts.json = true;
+        } else if (arg == "--no-live") {
+            opts.live = false;
+        } else if (arg == "--fixtures" || arg == "--filter" || arg == "--baseline" ||
+                   arg == "--write-fixtures" || arg == "--min-time" || arg == "--threshold") {
+            const char* v = need_value();
+            if (!v)
+                return 1;
+            if (arg == "--fixtures")
+                opts.fixtures = v;
+            else if (arg == "--filter")
+                opts.filter = v;
+            else if (arg == "--baseline")
+                opts.baseline = v;
+            else if (arg == "--write-fixtures")
+                opts.write_fixtures = v;
+            else if (arg == "--min-time")
+                opts.min_time_ms = std::max(1, std::atoi(v));
+            else
+                opts.threshold_pct = std::atof(v);
+        } else {
+            std::cerr << "Error: unknown option " << arg << "\n";
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    return -1;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    BenchOptions opts;
+    if (int rc = parse_args(argc, argv, opts); rc >= 0)
+        return rc;
+
+    std::vector<memc::bench::RecordedRegion> recording;
+    std::string recording_path = opts.fixtures + "/python3.smaps";
+    if (!memc::bench::load_recording(recording_path, recording)) {
+        std::cerr << "Error: cannot load fixture " << recording_path << "\n";
+        return 1;
+    }
+
+    if (!opts.write_fixtures.empty()) {
+        for (size_t n : kFixtureSizes) {
+            memc::bench::Fixture f = memc::bench::make_fixture(recording, n);
+            std::string base = opts.write_fixtures + "/vma_" + std::to_string(n);
+            std::ofstream(base + ".maps") << f.maps;
+            std::ofstream(base + ".smaps") << f.smaps;
+        }
+        return 0;
+    }
+
+    BenchRunner runner(opts);
+    runner.print_header();
+    for (size_t n : kFixtureSizes) {
+        bench_fixture(runner, memc::bench::make_fixture(recording, n));
+    }
+    if (opts.live) {
+        bench_sweep(runner, false);
+        bench_sweep(runner, true);
+    }
+
+    if (opts.json) {
+        std::cout << results_to_json(runner.results()).dump(2) << "\n";
+    }
+    if (!opts.baseline.empty()) {
+        int regressions = compare_baseline(opts, runner.results());
+        if (regressions != 0)
+            return 1;
+    }
+    return 0;
+}
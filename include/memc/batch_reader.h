@@ -0,0 +1,106 @@
+#pragma once
+
+#include <memory>
+#include <span>
+#include <string>
+#include <sys/types.h>
+
+namespace memc {
+
+/**
+ * @brief One file of a BatchReader::read() batch.
+ *
+ * Fields:
+ * - pid, name: The file to read, /proc/<pid>/<name>.
+ * - buffer: Receives the contents; its capacity is reused as with
+ *   read_proc_file().
+ * - ok: Set by read(): true if the file was read to the end.
+ */
+struct BatchRead {
+    pid_t pid = 0;
+    const char* name = nullptr;
+    std::string* buffer = nullptr;
+    bool ok = false;
+};
+
+/**
+ * Reads many small /proc files with few system calls, using io_uring.
+ *
+ * A batch is processed in rounds: one io_uring_enter(2) submits the openat
+ * of every file and waits for them, then each round submits the next read
+ * of every file not yet at end-of-file, and a last round closes them all.
+ * A batch of N files therefore costs a handful of system calls instead of
+ * 4N, and the kernel works on the files concurrently.
+ *
+ * The ring is set up with raw system calls (no liburing). On kernels
+ * without io_uring or without its openat, read and close operations
+ * (Linux < 5.6), when it is disabled by sysctl or seccomp, or when the
+ * ring fails mid-batch, read() falls back to one read_proc_file() per
+ * file; the results are the same either way.
+ *
+ * Not thread-safe; use one reader per thread.
+ *
+ * Usage:
+ *   BatchReader reader;
+ *   reader.open();
+ *   std::vector<BatchRead> batch = {{pid, "maps", &buffer}, ...};
+ *   reader.read(batch);
+ */
+class BatchReader {
+public:
+    /// Ring entries, and thus files in flight, per round.
+    static constexpr unsigned kDefaultDepth = 64;
+
+    BatchReader();
+    ~BatchReader();
+
+    BatchReader(const BatchReader&) = delete;
+    BatchReader& operator=(const BatchReader&) = delete;
+
+    /**
+     * @brief Returns true if this kernel lets the process use io_uring with
+     * the operations BatchReader needs.
+     */
+    [[nodiscard]] static bool io_uring_supported();
+
+    /**
+     * @brief Sets up the io_uring instance.
+     *
+     * @param depth Ring entries (files in flight per round).
+     * @return true if io_uring is in use, false if read() will fall back to
+     * plain system calls.
+     */
+    bool open(unsigned depth = kDefaultDepth);
+
+    /**
+     * @brief Tears down the ring; later reads use plain system calls.
+     */
+    void close();
+
+    /**
+     * @brief Returns true if reads go through io_uring.
+     */
+    [[nodiscard]] bool uses_io_uring() const {
+        return ring_ != nullptr;
+    }
+
+    /**
+     * @brief Reads every file of @p reads and sets its BatchRead::ok.
+     *
+     * Files that fail are left with an empty buffer. The whole batch is
+     * timed as one StatPhase::READ call.
+     *
+     * @param reads The files to read.
+     */
+    void read(std::span<BatchRead> reads);
+
+private:
+    struct Ring;
+
+    void read_sync(std::span<BatchRead> reads);
+    bool read_chunk(std::span<BatchRead> reads);
+
+    std::unique_ptr<Ring> ring_;
+};
+
+} // namespace memc
@@ -0,0 +1,430 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memc/delta.h>
+#include <memc/region.h>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace memc {
+
+/**
+ * Versioned binary on-disk format for sequences of ProcessSnapshot.
+ *
+ * Layout (host byte order, every chunk 8-byte aligned):
+ *
+ *   BinaryFileHeader
+ *   chunk*            ChunkHeader + payload, padded to 8 bytes
+ *   BinaryFileTrailer (only present once the writer was closed)
+ *
+ * Chunk types:
+ * - STRINGS: newly interned strings. IDs are assigned sequentially across
+ *   the whole file, starting at 1; ID 0 is the empty string. A STRINGS chunk
+ *   always precedes the first snapshot that references its strings.
+ * - SNAPSHOT: a BinarySnapshotHeader followed by region_count fixed-width
+ *   RegionRecord entries (stride = header.region_record_size).
+ * - DELTA (version 2): a BinaryDeltaHeader, then added_count + changed_count
+ *   RegionRecord entries (added first), then removed_count uint64_t start
+ *   addresses. It applies to the closest earlier frame of the same pid.
+ * - INDEX: written on close; locates every frame (snapshot or delta) and
+ *   STRINGS chunk so a reader can open the file without walking it.
+ *
+ * A file whose writer never closed (e.g. the capture was killed) has no
+ * trailer; readers recover it by walking the chunk headers.
+ */
+inline constexpr char kBinaryMagic[8] = {'M', 'E', 'M', 'C', 'S', 'N', 'P', '\0'};
+inline constexpr char kBinaryTrailerMagic[8] = {'M', 'E', 'M', 'C', 'I', 'D', 'X', '\0'};
+inline constexpr uint32_t kBinaryVersion = 2;
+inline constexpr uint32_t kBinaryByteOrderMark = 0x01020304;
+
+/// Chunk type tags.
+enum class ChunkType : uint32_t { STRINGS = 1, SNAPSHOT = 2, INDEX = 3, DELTA = 4 };
+
+struct BinaryFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order_mark;
+    uint32_t header_size;
+    uint32_t region_record_size;
+    uint64_t reserved;
+};
+
+struct ChunkHeader {
+    uint32_t type;
+    uint32_t reserved;
+    uint64_t size; ///< Payload size in bytes, excluding padding.
+};
+
+struct BinarySnapshotHeader {
+    int32_t pid;
+    uint32_t region_count;
+    uint64_t timestamp_ms;
+};
+
+struct BinaryDeltaHeader {
+    int32_t pid;
+    uint32_t added_count;
+    uint32_t changed_count;
+    uint32_t removed_count;
+    uint64_t timestamp_ms;
+    uint64_t base_timestamp_ms;
+    uint64_t region_count;
+    uint64_t total_rss_kb;
+    uint64_t total_vsize_kb;
+};
+
+/**
+ * @brief Fixed-width on-disk form of a MemoryRegion.
+ *
+ * String fields are IDs into the file's string table. The record only ever
+ * grows at the end: readers step by the header's region_record_size and
+ * leave fields beyond a shorter record at zero, so captures written before
+ * the THP and locking fields existed stay readable. NUMA data is not
+ * recorded.
+ */
+struct RegionRecord {
+    uint64_t start_addr;
+    uint64_t end_addr;
+    uint64_t offset;
+    uint64_t inode;
+    uint64_t size_kb;
+    uint64_t rss_kb;
+    uint64_t pss_kb;
+    uint64_t shared_clean_kb;
+    uint64_t shared_dirty_kb;
+    uint64_t private_clean_kb;
+    uint64_t private_dirty_kb;
+    uint64_t swap_kb;
+    uint32_t permissions_id;
+    uint32_t device_id;
+    uint32_t pathname_id;
+    uint8_t type;
+    uint8_t flags; ///< Bit 0: has_smaps_data. Bit 1: thp_eligible.
+    uint16_t reserved;
+    uint64_t swap_pss_kb;
+    uint64_t locked_kb;
+    uint64_t anon_huge_kb;
+    uint64_t shmem_pmd_kb;
+    uint64_t file_pmd_kb;
+};
+
+/// Size of the original RegionRecord, the smallest a reader accepts.
+inline constexpr size_t kRegionRecordBaseSize = offsetof(RegionRecord, swap_pss_kb);
+
+struct BinaryIndexEntry {
+    uint64_t offset; ///< File offset of the frame's ChunkHeader.
+    uint64_t timestamp_ms;
+    int32_t pid;
+    uint32_t region_count;
+};
+
+struct BinaryFileTrailer {
+    uint64_t index_offset; ///< File offset of the INDEX ChunkHeader.
+    char magic[8];
+};
+
+/**
+ * Appends ProcessSnapshots to a binary capture file.
+ *
+ * Strings are interned for the lifetime of the writer, so each distinct
+ * pathname, device and permission string is stored once per file.
+ *
+ * Usage:
+ *   BinaryWriter writer;
+ *   if (!writer.open("capture.bin")) { ... }
+ *   writer.write(snapshot);   // repeatedly
+ *   writer.close();           // writes the index and trailer
+ */
+class BinaryWriter {
+public:
+    BinaryWriter() = default;
+    ~BinaryWriter();
+
+    BinaryWriter(const BinaryWriter&) = delete;
+    BinaryWriter& operator=(const BinaryWriter&) = delete;
+
+    /**
+     * @brief Creates (or truncates) the file and writes the header.
+     *
+     * @param path The output path.
+     * @return true on success, false if the file could not be opened.
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief Appends a snapshot, preceded by any strings it introduces.
+     *
+     * @param snapshot The snapshot to write.
+     * @return true on success, false on a write error.
+     */
+    bool write(const ProcessSnapshot& snapshot);
+
+    /**
+     * @brief Appends a delta against the previously written frame of the
+     * same process, preceded by any strings it introduces.
+     *
+     * @param delta The delta to write.
+     * @return true on success, false on a write error.
+     */
+    bool write(const SnapshotDelta& delta);
+
+    /**
+     * @brief Writes the index and trailer and closes the file.
+     *
+     * Called automatically by the destructor. Does nothing if not open.
+     *
+     * @return true on success, false on a write error.
+     */
+    bool close();
+
+    /**
+     * @brief Returns true while the file is open.
+     */
+    [[nodiscard]] bool is_open() const {
+        return out_.is_open();
+    }
+
+private:
+    uint32_t intern(std::string_view s);
+    uint32_t intern(InternedString s);
+    uint32_t intern(Permissions p);
+    uint32_t intern(DeviceNumber d);
+    RegionRecord make_record(const MemoryRegion& r);
+    void flush_strings();
+    void write_chunk(ChunkType type, const void* data, size_t size);
+
+    std::ofstream out_;
+    uint64_t offset_ = 0;
+    std::unordered_map<std::string, uint32_t> string_ids_;
+    std::vector<uint32_t> pool_ids_;
+    std::array<uint32_t, 16> permission_ids_{};
+    std::unordered_map<uint32_t, uint32_t> device_ids_;
+    std::vector<std::string_view> pending_strings_;
+    std::vector<BinaryIndexEntry> index_;
+    std::vector<uint64_t> string_chunks_;
+    std::vector<char> scratch_;
+};
+
+/**
+ * @brief Zero-copy view of one snapshot inside a memory-mapped capture.
+ *
+ * Valid for as long as the BinaryReader that produced it.
+ */
+class BinarySnapshotView {
+public:
+    [[nodiscard]] pid_t pid() const {
+        return header_->pid;
+    }
+    [[nodiscard]] uint64_t timestamp_ms() const {
+        return header_->timestamp_ms;
+    }
+    [[nodiscard]] size_t region_count() const {
+        return header_->region_count;
+    }
+
+    /**
+     * @brief Returns the i-th region record, in place in the mapping.
+     */
+    [[nodiscard]] const RegionRecord& region(size_t i) const {
+        return *reinterpret_cast<const RegionRecord*>(records_ + i * stride_);
+    }
+
+    /**
+     * @brief Resolves a string ID from a region record.
+     */
+    [[nodiscard]] std::string_view string(uint32_t id) const {
+        return id < strings_->size() ? (*strings_)[id] : std::string_view{};
+    }
+
+    /**
+     * @brief Materializes the view as an owning ProcessSnapshot.
+     */
+    [[nodiscard]] ProcessSnapshot to_snapshot() const;
+
+private:
+    friend class BinaryReader;
+
+    BinarySnapshotView(const BinarySnapshotHeader* header, const char* records, size_t stride,
+                       const std::vector<std::string_view>* strings)
+        : header_(header)
+        , records_(records)
+        , stride_(stride)
+        , strings_(strings) {}
+
+    const BinarySnapshotHeader* header_;
+    const char* records_;
+    size_t stride_;
+    const std::vector<std::string_view>* strings_;
+};
+
+/**
+ * @brief Zero-copy view of one delta frame inside a memory-mapped capture.
+ *
+ * Valid for as long as the BinaryReader that produced it.
+ */
+class BinaryDeltaView {
+public:
+    [[nodiscard]] pid_t pid() const {
+        return header_->pid;
+    }
+    [[nodiscard]] uint64_t timestamp_ms() const {
+        return header_->timestamp_ms;
+    }
+    [[nodiscard]] uint64_t base_timestamp_ms() const {
+        return header_->base_timestamp_ms;
+    }
+    [[nodiscard]] size_t added_count() const {
+        return header_->added_count;
+    }
+    [[nodiscard]] size_t changed_count() const {
+        return header_->changed_count;
+    }
+    [[nodiscard]] size_t removed_count() const {
+        return header_->removed_count;
+    }
+
+    /**
+     * @brief Returns the i-th added region record, in place in the mapping.
+     */
+    [[nodiscard]] const RegionRecord& added(size_t i) const {
+        return *reinterpret_cast<const RegionRecord*>(records_ + i * stride_);
+    }
+
+    /**
+     * @brief Returns the i-th changed region record, in place in the mapping.
+     */
+    [[nodiscard]] const RegionRecord& changed(size_t i) const {
+        return added(added_count() + i);
+    }
+
+    /**
+     * @brief Returns the start address of the i-th removed region.
+     */
+    [[nodiscard]] uint64_t removed(size_t i) const {
+        const char* removed = records_ + (added_count() + changed_count()) * stride_;
+        return reinterpret_cast<const uint64_t*>(removed)[i];
+    }
+
+    /**
+     * @brief Resolves a string ID from a region record.
+     */
+    [[nodiscard]] std::string_view string(uint32_t id) const {
+        return id < strings_->size() ? (*strings_)[id] : std::string_view{};
+    }
+
+    /**
+     * @brief Materializes the view as an owning SnapshotDelta.
+     */
+    [[nodiscard]] SnapshotDelta to_delta() const;
+
+private:
+    friend class BinaryReader;
+
+    BinaryDeltaView(const BinaryDeltaHeader* header, const char* records, size_t stride,
+                    const std::vector<std::string_view>* strings)
+        : header_(header)
+        , records_(records)
+        , stride_(stride)
+        , strings_(strings) {}
+
+    const BinaryDeltaHeader* header_;
+    const char* records_;
+    size_t stride_;
+    const std::vector<std::string_view>* strings_;
+};
+
+/**
+ * Memory-maps a binary capture and iterates its frames without copying.
+ *
+ * A frame is either a full snapshot or a delta against the previous frame
+ * of the same process.
+ *
+ * Usage:
+ *   auto reader = BinaryReader::open("capture.bin");
+ *   if (!reader) { ... }
+ *   for (size_t i = 0; i < reader->size(); ++i) {
+ *       if (reader->is_delta(i)) {
+ *           auto delta = reader->delta(i);     // delta.added(j), ...
+ *       } else {
+ *           auto snap = reader->snapshot(i);   // snap.region(j), ...
+ *       }
+ *       auto full = reader->reconstruct(i);    // either way
+ *   }
+ */
+class BinaryReader {
+public:
+    /**
+     * @brief Maps and validates a capture file.
+     *
+     * The INDEX chunk is used when the file was closed cleanly; otherwise the
+     * chunk headers are walked, stopping at the first truncated chunk.
+     *
+     * @param path The capture file path.
+     * @return std::optional<BinaryReader> The reader, or std::nullopt if the
+     * file is missing, unreadable, or not a compatible memc capture.
+     */
+    static std::optional<BinaryReader> open(const std::string& path);
+
+    BinaryReader(BinaryReader&& other) noexcept;
+    BinaryReader& operator=(BinaryReader&& other) noexcept;
+    BinaryReader(const BinaryReader&) = delete;
+    BinaryReader& operator=(const BinaryReader&) = delete;
+    ~BinaryReader();
+
+    /**
+     * @brief Returns the number of frames (snapshots and deltas) in the file.
+     */
+    [[nodiscard]] size_t size() const {
+        return frames_.size();
+    }
+
+    /**
+     * @brief Returns true if the i-th frame is a delta.
+     */
+    [[nodiscard]] bool is_delta(size_t i) const;
+
+    /**
+     * @brief Returns a view of the i-th frame, which must be a snapshot.
+     */
+    [[nodiscard]] BinarySnapshotView snapshot(size_t i) const;
+
+    /**
+     * @brief Returns a view of the i-th frame, which must be a delta.
+     */
+    [[nodiscard]] BinaryDeltaView delta(size_t i) const;
+
+    /**
+     * @brief Rebuilds the full snapshot at the i-th frame.
+     *
+     * Starts from the closest snapshot frame of the same process at or
+     * before @p i and applies the deltas that follow it.
+     *
+     * @param i The frame index.
+     * @return std::optional<ProcessSnapshot> The snapshot, or std::nullopt if
+     * the chain of deltas is broken.
+     */
+    [[nodiscard]] std::optional<ProcessSnapshot> reconstruct(size_t i) const;
+
+private:
+    BinaryReader() = default;
+
+    bool load_index(uint64_t index_offset);
+    bool walk_chunks();
+    bool add_strings(uint64_t chunk_offset);
+    bool valid_frame(const ChunkHeader* chunk) const;
+    const ChunkHeader* chunk_at(uint64_t offset) const;
+
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    size_t stride_ = 0;
+    std::vector<uint64_t> frames_;
+    std::vector<std::string_view> strings_;
+};
+
+} // namespace memc
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <optional>
+#include <utility>
+
+namespace memc {
+
+/**
+ * Bounded lock-free multi-producer/multi-consumer FIFO queue.
+ *
+ * A fixed array of cells, each tagged with a sequence number that tells
+ * producers and consumers whose turn the cell is (D. Vyukov's bounded MPMC
+ * design). try_push() and try_pop() claim a position with one CAS and
+ * never block; callers that want to wait build that on top, e.g. with
+ * std::atomic::wait on their own counter.
+ *
+ * The capacity is rounded up to a power of two.
+ *
+ * Usage:
+ *   BoundedQueue<int> queue(64);
+ *   queue.try_push(1);
+ *   if (auto v = queue.try_pop()) { ... }
+ */
+template <typename T>
+class BoundedQueue {
+public:
+    /**
+     * @brief Creates an empty queue.
+     *
+     * @param capacity Minimum number of elements the queue can hold (at
+     * least 2).
+     */
+    explicit BoundedQueue(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        mask_ = size - 1;
+        cells_ = std::make_unique<Cell[]>(size);
+        for (size_t i = 0; i < size; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    /**
+     * @brief Appends @p value if there is room.
+     *
+     * @param value The element; left untouched if the queue is full.
+     * @return true if the element was queued, false if the queue was full.
+     */
+    bool try_push(T& value) {
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[pos & mask_];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = std::move(value);
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Removes and returns the oldest element, if any.
+     *
+     * @return std::optional<T> The element, or std::nullopt if empty.
+     */
+    std::optional<T> try_pop() {
+        size_t pos = head_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[pos & mask_];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    std::optional<T> value(std::move(cell.value));
+                    cell.value = T{};
+                    cell.sequence.store(pos + mask_ + 1, std::memory_order_release);
+                    return value;
+                }
+            } else if (diff < 0) {
+                return std::nullopt;
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Returns the number of elements the queue can hold.
+     */
+    [[nodiscard]] size_t capacity() const {
+        return mask_ + 1;
+    }
+
+    /**
+     * @brief Returns an approximate element count; exact when quiescent.
+     */
+    [[nodiscard]] size_t size_approx() const {
+        size_t tail = tail_.load(std::memory_order_acquire);
+        size_t head = head_.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence{0};
+        T value{};
+    };
+
+    static constexpr size_t kCacheLine = 64;
+
+    std::unique_ptr<Cell[]> cells_;
+    size_t mask_ = 0;
+    alignas(kCacheLine) std::atomic<size_t> tail_{0};
+    alignas(kCacheLine) std::atomic<size_t> head_{0};
+};
+
+} // namespace memc
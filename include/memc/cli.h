@@ -1,11 +1,16 @@
 #pragma once
 
 #include <memc/collector.h>
+#include <memc/growth_tracker.h>
+#include <memc/process_selector.h>
 #include <string>
 #include <sys/types.h>
 
 namespace memc {
 
+/// Output encoding selected with --format.
+enum class OutputFormat { JSON, BINARY };
+
 /**
  * @brief Holds all parsed command-line options for the memc CLI.
  *
@@ -14,8 +19,25 @@ namespace memc {
  * - all_mode: If true, snapshot all processes on the system.
  * - skip_kernel: If true, skip kernel threads with no user-space memory.
  * - count: Number of samples to take (1 = single, 0 = continuous).
+ * - jobs: Worker threads for --all mode (0 = one per CPU).
+ * - io_uring: If true, --all mode batches its /proc reads through io_uring.
  * - output_file: Path to write JSON output (empty = stdout).
+ * - format: Output encoding (JSON, or the binary capture format).
+ * - convert_input: Binary capture to convert back to JSON ("convert" mode).
+ * - serve: If true, run as a Prometheus exporter ("serve" mode).
+ * - listen: Address the exporter listens on, "[host]:port".
+ * - pagemap: If true, report page-level residency from /proc/<pid>/pagemap.
+ * - track_idle: If true, also report hot/cold pages (implies pagemap).
+ * - self_stats: If true, print memc's own SelfStats to stderr on exit.
+ * - fields: If true, --fields narrowed collector_config.fields.
+ * - growth: Growth tracking for --alert; its rules are the --alert rules.
+ * - shared_files: If true, --all also reports memory per mapped file,
+ *   summed over all processes (SharedFileTable).
+ * - file_pages: If true, that report also counts distinct resident pages
+ *   from pagemap (implies shared_files).
  * - collector_config: Configuration forwarded to DataCollector.
+ * - selector_config: --all filters (--name, --uid, --cgroup, --min-rss, and
+ *   --skip-kernel), forwarded to ProcessSelector.
  * - show_help: If true, print usage and exit.
  * - show_version: If true, print version and exit.
  * - parse_error: If true, an error was encountered during parsing.
@@ -26,8 +48,22 @@ struct CLIOptions {
     bool all_mode = false;
     bool skip_kernel = false;
     int count = 1;
+    size_t jobs = 0;
+    bool io_uring = false;
     std::string output_file;
+    OutputFormat format = OutputFormat::JSON;
+    std::string convert_input;
+    bool serve = false;
+    std::string listen;
+    bool pagemap = false;
+    bool track_idle = false;
+    bool self_stats = false;
+    bool fields = false;
+    GrowthConfig growth;
+    bool shared_files = false;
+    bool file_pages = false;
     DataCollector::Config collector_config;
+    ProcessSelector::Config selector_config;
 
     bool show_help = false;
     bool show_version = false;
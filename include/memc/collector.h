@@ -1,7 +1,11 @@
 #pragma once
 
+#include <memc/delta.h>
+#include <memc/proc_handle.h>
 #include <memc/region.h>
 #include <memc/sampler.h>
+#include <memc/self_stats.h>
+#include <memc/smaps_parser.h>
 #include <memory>
 #include <optional>
 #include <string>
@@ -14,16 +18,32 @@ namespace memc {
  * Fields:
  * - use_smaps: If true, detailed smaps data will be collected (requires more
  * overhead).
+ * - numa: If true, per-node residency is joined onto every region from
+ * /proc/<pid>/numa_maps (see NumaMapsParser).
+ * - fields: The smaps detail fields to parse and serialize (see
+ * SmapsFields); the others read as zero and are left out of the JSON. Only
+ * used with use_smaps.
  * - interval_ms: Sampling interval in milliseconds.
  * - max_snapshots: Maximum number of snapshots to keep in history (0 =
  * unlimited).
  * - pretty_json: If true, JSON output will be indented and human-readable.
+ * - summary_only: If true, collect per-process totals from smaps_rollup
+ * instead of per-region data (see DataCollector::collect_summary).
+ * - delta: If true, sampling history is stored as deltas between
+ * consecutive snapshots (see SamplerConfig::delta).
+ * - dispatch: How sampling callbacks are delivered (see
+ * SamplerConfig::dispatch).
  */
 struct CollectorConfig {
     bool use_smaps = false;
+    bool numa = false;
+    SmapsFields fields{};
     uint32_t interval_ms = 1000;
     size_t max_snapshots = 0;
     bool pretty_json = true;
+    bool summary_only = false;
+    bool delta = false;
+    DispatchConfig dispatch{};
 };
 
 /**
@@ -63,6 +83,56 @@ public:
      */
     [[nodiscard]] std::optional<ProcessSnapshot> collect_once();
 
+    /**
+     * @brief Takes a snapshot into caller-owned storage.
+     *
+     * Like collect_once(), but refills @p snapshot in place. Its region
+     * vector keeps its capacity and is reserved for the previous
+     * collection's region count, so reusing one snapshot across samples (or
+     * taking it from a SnapshotPool) avoids reallocating it every time.
+     *
+     * @param snapshot The snapshot to overwrite.
+     * @return true on success, false if the process could not be accessed or
+     * parsed (the regions are then left empty).
+     */
+    bool collect_into(ProcessSnapshot& snapshot);
+
+    /**
+     * @brief Collects per-process memory totals without any per-region data.
+     *
+     * Reads /proc/<pid>/smaps_rollup, which the kernel aggregates itself. On
+     * kernels without smaps_rollup the totals are summed from a full smaps
+     * parse instead.
+     *
+     * @return std::optional<ProcessSummary> The totals if successful, or
+     * std::nullopt if the process could not be accessed.
+     */
+    [[nodiscard]] std::optional<ProcessSummary> collect_summary();
+
+    /**
+     * @brief Takes a snapshot and returns its delta against the previous one.
+     *
+     * The collector keeps the snapshot taken by the previous collect_delta()
+     * call as the base. The first call has no base, so its delta lists every
+     * region as added and has a base_timestamp_ms of 0.
+     *
+     * @return std::optional<SnapshotDelta> The delta if successful, or
+     * std::nullopt if the process could not be accessed (the base is kept).
+     */
+    [[nodiscard]] std::optional<SnapshotDelta> collect_delta();
+
+    /**
+     * @brief Returns the snapshot the last collect_delta() call produced.
+     *
+     * This is the reconstruction of every delta returned so far.
+     *
+     * @return const ProcessSnapshot* The current snapshot, or nullptr before
+     * the first successful collect_delta().
+     */
+    [[nodiscard]] const ProcessSnapshot* current_snapshot() const {
+        return previous_ ? &*previous_ : nullptr;
+    }
+
     /**
      * @brief Serializes a process snapshot to a JSON string.
      *
@@ -71,6 +141,22 @@ public:
      */
     virtual std::string to_json(const ProcessSnapshot& snapshot) const;
 
+    /**
+     * @brief Serializes a process summary to a JSON string.
+     *
+     * @param summary The summary object to serialize.
+     * @return std::string A JSON string representation of the summary.
+     */
+    virtual std::string to_json(const ProcessSummary& summary) const;
+
+    /**
+     * @brief Serializes a snapshot delta to a JSON string.
+     *
+     * @param delta The delta object to serialize.
+     * @return std::string A JSON string representation of the delta.
+     */
+    virtual std::string to_json(const SnapshotDelta& delta) const;
+
     /**
      * @brief Starts periodic background sampling of the process memory.
      *
@@ -110,6 +196,68 @@ public:
      */
     [[nodiscard]] std::optional<ProcessSnapshot> get_latest_snapshot() const;
 
+    /**
+     * @brief Retrieves a shared handle to the most recently collected snapshot.
+     *
+     * Unlike get_latest_snapshot() no region data is copied, which makes it
+     * the cheap choice for polling.
+     *
+     * @return SnapshotHandle The latest snapshot, or nullptr if no sampler is
+     * active or no snapshots have been collected yet.
+     */
+    [[nodiscard]] SnapshotHandle get_latest_handle() const;
+
+    /**
+     * @brief Retrieves shared handles to every retained snapshot, oldest first.
+     *
+     * @return std::vector<SnapshotHandle> The handles, or an empty vector if no
+     * sampler is active.
+     */
+    [[nodiscard]] std::vector<SnapshotHandle> get_snapshot_handles() const;
+
+    /**
+     * @brief Rebuilds a snapshot from the sampling history.
+     *
+     * @param index Position in the history, 0 being the oldest retained.
+     * @return std::optional<ProcessSnapshot> The snapshot, or std::nullopt if
+     * no sampler is active or @p index is out of range.
+     */
+    [[nodiscard]] std::optional<ProcessSnapshot> reconstruct(size_t index) const;
+
+    /**
+     * @brief Retrieves the stored deltas of a delta-mode sampling session.
+     *
+     * @return std::vector<SnapshotDelta> The deltas, oldest first.
+     */
+    [[nodiscard]] std::vector<SnapshotDelta> get_all_deltas() const;
+
+    /**
+     * @brief Retrieves the sampling clock's jitter and missed-deadline counts.
+     *
+     * @return TimerStats The statistics of the current (or last) sampling
+     * session, or all zeros if sampling was never started.
+     */
+    [[nodiscard]] TimerStats get_timer_stats() const;
+
+    /**
+     * @brief Retrieves memc's own per-phase latencies and work counters.
+     *
+     * The statistics are process-wide (see memc::self_stats()): every
+     * collector, sampler and scanner of the process contributes to them.
+     *
+     * @return SelfStats The statistics since process start or the last
+     * reset_self_stats().
+     */
+    [[nodiscard]] static SelfStats get_self_stats();
+
+    /**
+     * @brief Retrieves the callback delivery counters of the sampler.
+     *
+     * @return DispatchStats The counters, or all zeros if sampling was never
+     * started.
+     */
+    [[nodiscard]] DispatchStats get_dispatch_stats() const;
+
     /**
      * @brief Registers a callback function to be invoked on each new snapshot.
      *
@@ -118,6 +266,14 @@ public:
      */
     void on_snapshot(SnapshotCallback cb);
 
+    /**
+     * @brief Registers a callback function to be invoked on each new delta.
+     *
+     * @param cb The callback function to register. Only called when sampling
+     * in delta mode.
+     */
+    void on_delta(DeltaCallback cb);
+
     /**
      * @brief Gets the process ID being monitored.
      *
@@ -128,9 +284,17 @@ public:
     }
 
 private:
+    ProcHandle& proc();
+
     pid_t pid_;
     Config config_;
     std::unique_ptr<Sampler> sampler_;
+    ProcHandle proc_;
+    std::string read_buffer_;
+    std::vector<MemoryRegion> scratch_regions_;
+    std::optional<ProcessSnapshot> previous_;
+    ProcessSnapshot next_{};
+    size_t region_hint_ = 0;
 };
 
 } // namespace memc
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstdint>
+#include <memc/region.h>
+#include <third_party/nlohmann/json.hpp>
+#include <vector>
+
+namespace memc {
+
+/**
+ * @brief The difference between two consecutive snapshots of one process.
+ *
+ * Regions are keyed by start address. A region whose start address exists
+ * in both snapshots but whose mapping or smaps counters differ is recorded
+ * in full under `changed`; unchanged regions are not recorded at all.
+ *
+ * The totals describe the snapshot the delta produces, so a consumer can
+ * follow a process's RSS and VSZ without reconstructing every sample.
+ *
+ * Fields:
+ * - pid: Process ID.
+ * - timestamp_ms: UNIX epoch milliseconds of the newer snapshot.
+ * - base_timestamp_ms: Timestamp of the snapshot the delta applies to
+ *   (0 for a delta against an empty process).
+ * - region_count: Region count of the newer snapshot.
+ * - total_rss_kb: Total RSS of the newer snapshot in KB.
+ * - total_vsize_kb: Total virtual size of the newer snapshot in KB.
+ * - added: Regions present only in the newer snapshot.
+ * - changed: New contents of regions present in both but different.
+ * - removed: Start addresses of regions present only in the base.
+ *
+ * All three lists are ordered by start address.
+ */
+struct SnapshotDelta {
+    pid_t pid = 0;
+    uint64_t timestamp_ms = 0;
+    uint64_t base_timestamp_ms = 0;
+    uint64_t region_count = 0;
+    uint64_t total_rss_kb = 0;
+    uint64_t total_vsize_kb = 0;
+
+    std::vector<MemoryRegion> added;
+    std::vector<MemoryRegion> changed;
+    std::vector<uint64_t> removed;
+
+    /**
+     * @brief Returns true if no region was added, changed or removed.
+     */
+    [[nodiscard]] bool empty() const {
+        return added.empty() && changed.empty() && removed.empty();
+    }
+};
+
+/**
+ * @brief Computes the delta that turns @p base into @p next.
+ *
+ * Both snapshots must list their regions in ascending start-address order,
+ * as /proc/<pid>/maps and smaps do; the comparison is a single linear merge.
+ *
+ * @param base The older snapshot.
+ * @param next The newer snapshot.
+ * @return SnapshotDelta The difference between the two.
+ */
+[[nodiscard]] SnapshotDelta compute_delta(const ProcessSnapshot& base,
+                                          const ProcessSnapshot& next);
+
+/**
+ * @brief Applies @p delta to @p snapshot in place.
+ *
+ * @param snapshot The base snapshot; on success it becomes the newer one.
+ * @param delta A delta computed against @p snapshot.
+ * @return true on success, false if the delta does not belong to this
+ * snapshot (timestamp mismatch, or a removed/changed region is missing).
+ * On failure @p snapshot is left untouched.
+ */
+bool apply_delta(ProcessSnapshot& snapshot, const SnapshotDelta& delta);
+
+/**
+ * @brief Serializes a SnapshotDelta object to an ordered JSON object.
+ *
+ * Removed regions are written as hex start addresses.
+ *
+ * @param j The JSON object to populate.
+ * @param d The SnapshotDelta object to serialize.
+ */
+inline void to_json(nlohmann::ordered_json& j, const SnapshotDelta& d) {
+    j = nlohmann::ordered_json{};
+    j["pid"] = d.pid;
+    j["timestamp_ms"] = d.timestamp_ms;
+    j["base_timestamp_ms"] = d.base_timestamp_ms;
+    j["total_rss_kb"] = d.total_rss_kb;
+    j["total_vsize_kb"] = d.total_vsize_kb;
+    j["region_count"] = d.region_count;
+
+    j["added"] = nlohmann::ordered_json::array();
+    for (const auto& r : d.added) {
+        nlohmann::ordered_json rj;
+        to_json(rj, r);
+        j["added"].push_back(std::move(rj));
+    }
+    j["changed"] = nlohmann::ordered_json::array();
+    for (const auto& r : d.changed) {
+        nlohmann::ordered_json rj;
+        to_json(rj, r);
+        j["changed"].push_back(std::move(rj));
+    }
+    j["removed"] = nlohmann::ordered_json::array();
+    for (uint64_t start : d.removed) {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "0x%lx", start);
+        j["removed"].push_back(buf);
+    }
+}
+
+} // namespace memc
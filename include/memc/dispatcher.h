@@ -0,0 +1,166 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memc/bounded_queue.h>
+#include <memc/delta.h>
+#include <memc/growth_tracker.h>
+#include <memc/region.h>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace memc {
+
+/**
+ * @brief What a SampleDispatcher does when a sample arrives and its queue
+ * is full.
+ *
+ * - DROP_OLDEST: Discard the oldest queued sample to make room.
+ * - BLOCK: Wait until a dispatcher thread frees a slot. Slow consumers then
+ *   hold up sampling again, but nothing is lost.
+ * - COALESCE: Like DROP_OLDEST, and in addition a dispatcher thread that
+ *   has fallen behind delivers only the newest queued sample of each PID
+ *   (and every sample that raised an alert).
+ */
+enum class OverflowPolicy : uint8_t { DROP_OLDEST, BLOCK, COALESCE };
+
+/**
+ * @brief Configuration for callback dispatch.
+ *
+ * Fields:
+ * - threads: Dispatcher threads. 0 runs callbacks synchronously on the
+ *   sampling thread. With more than one, callbacks run concurrently and
+ *   samples may be delivered out of order.
+ * - capacity: Queue size in samples (rounded up to a power of two).
+ * - policy: Behaviour when the queue is full.
+ */
+struct DispatchConfig {
+    size_t threads = 1;
+    size_t capacity = 64;
+    OverflowPolicy policy = OverflowPolicy::DROP_OLDEST;
+};
+
+/**
+ * @brief Delivery counters of a SampleDispatcher.
+ *
+ * Fields:
+ * - posted: Samples handed to the dispatcher.
+ * - delivered: Samples passed to the handler.
+ * - dropped: Samples discarded from a full queue.
+ * - coalesced: Samples skipped because a newer one for the same PID was
+ *   already queued.
+ * - blocked: Posts that had to wait for room (BLOCK policy).
+ */
+struct DispatchStats {
+    uint64_t posted = 0;
+    uint64_t delivered = 0;
+    uint64_t dropped = 0;
+    uint64_t coalesced = 0;
+    uint64_t blocked = 0;
+};
+
+/**
+ * @brief One unit of work for a SampleDispatcher.
+ *
+ * Fields:
+ * - pid: The process the event is about.
+ * - snapshot: The new snapshot; nullptr means the process exited.
+ * - delta: The snapshot's delta against the previous sample, if any. A
+ *   dropped or coalesced sample leaves a gap in the delta chain, visible as
+ *   a base_timestamp_ms that does not match the last delivered delta.
+ * - alerts: Growth alerts raised by this sample, if any. COALESCE never
+ *   skips an event that carries alerts; DROP_OLDEST may drop it like any
+ *   other, so use BLOCK where no alert may be lost.
+ */
+struct SampleEvent {
+    pid_t pid = 0;
+    SnapshotHandle snapshot;
+    std::shared_ptr<const SnapshotDelta> delta;
+    std::shared_ptr<const std::vector<GrowthAlert>> alerts;
+};
+
+/**
+ * Delivers SampleEvents to a handler on dedicated threads.
+ *
+ * The sampling thread posts into a bounded lock-free queue and returns at
+ * once, so its cadence no longer depends on how long consumers take. Idle
+ * dispatcher threads sleep on a futex (std::atomic::wait) and wake only
+ * when something is posted.
+ *
+ * Usage:
+ *   SampleDispatcher dispatcher({.threads = 1}, [](const SampleEvent& e) { ... });
+ *   dispatcher.start();
+ *   dispatcher.post({pid, snapshot, nullptr, nullptr});
+ *   dispatcher.stop(); // delivers what is still queued, then joins
+ */
+class SampleDispatcher {
+public:
+    using Handler = std::function<void(const SampleEvent&)>;
+
+    /**
+     * @brief Creates a stopped dispatcher.
+     *
+     * @param config Thread count, queue size and overflow policy.
+     * @param handler Invoked once per delivered event.
+     */
+    SampleDispatcher(DispatchConfig config, Handler handler);
+    ~SampleDispatcher();
+
+    SampleDispatcher(const SampleDispatcher&) = delete;
+    SampleDispatcher& operator=(const SampleDispatcher&) = delete;
+
+    /**
+     * @brief Starts the dispatcher threads. Does nothing if already running.
+     */
+    void start();
+
+    /**
+     * @brief Delivers every queued event, then joins the dispatcher threads.
+     *
+     * No post() may run concurrently with or after stop().
+     */
+    void stop();
+
+    /**
+     * @brief Queues an event for delivery.
+     *
+     * Runs the handler inline when the dispatcher is synchronous
+     * (threads == 0) or not started.
+     *
+     * @param event The event.
+     */
+    void post(SampleEvent event);
+
+    /**
+     * @brief Returns the delivery counters since construction.
+     *
+     * Safe to call from any thread.
+     */
+    [[nodiscard]] DispatchStats stats() const;
+
+private:
+    void run();
+    void deliver_coalesced(std::vector<SampleEvent>& batch);
+    void deliver(const SampleEvent& event);
+    void discard_oldest();
+
+    DispatchConfig config_;
+    Handler handler_;
+    BoundedQueue<SampleEvent> queue_;
+    std::vector<std::thread> threads_;
+    std::atomic<bool> running_{false};
+
+    // Futex words: bumped after every push and every pop respectively.
+    std::atomic<uint32_t> pushes_{0};
+    std::atomic<uint32_t> pops_{0};
+
+    std::atomic<uint64_t> posted_{0};
+    std::atomic<uint64_t> delivered_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> coalesced_{0};
+    std::atomic<uint64_t> blocked_{0};
+};
+
+} // namespace memc
@@ -0,0 +1,221 @@
+#pragma once
+
+#include <cstdint>
+#include <memc/region.h>
+#include <memc/ring_buffer.h>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <sys/types.h>
+#include <unordered_map>
+#include <vector>
+
+namespace memc {
+
+/// Counter a growth series follows.
+enum class GrowthMetric : uint8_t { RSS, PSS };
+
+/**
+ * @brief A threshold on the smoothed growth rate of one series.
+ *
+ * Fields:
+ * - name: Label reported with the rule's alerts; parse() sets it to the
+ *   rule text.
+ * - subject: "total", a region type name as printed by
+ *   region_type_to_string() ("heap", "anonymous", ...), or a mapping
+ *   pathname ("/dev/shm/cache", "[stack]").
+ * - metric: Whether RSS or PSS is followed.
+ * - above: If true the rule holds while the rate is above the threshold,
+ *   otherwise while it is below.
+ * - threshold_kb_per_min: The threshold, in KB per minute. Negative values
+ *   describe shrinking.
+ */
+struct GrowthRule {
+    std::string name;
+    std::string subject = "total";
+    GrowthMetric metric = GrowthMetric::RSS;
+    bool above = true;
+    double threshold_kb_per_min = 0;
+
+    /**
+     * @brief Parses a rule such as "heap_growth>10MB/min".
+     *
+     * The form is <subject>_growth or <subject>_pss_growth, then '>' or
+     * '<', then a number with a B, KB, MB or GB suffix, then /s, /min or
+     * /h. Sizes are binary (1 MB = 1024 KB), like the kB of /proc.
+     *
+     * @param text The rule.
+     * @return std::optional<GrowthRule> The rule, or std::nullopt if @p text
+     * is malformed.
+     */
+    static std::optional<GrowthRule> parse(std::string_view text);
+};
+
+/**
+ * @brief A GrowthRule starting or ceasing to hold.
+ *
+ * Fields:
+ * - pid: The process.
+ * - timestamp_ms: Timestamp of the sample that changed the state.
+ * - rule: Index of the rule in GrowthConfig::rules.
+ * - firing: true when the rule starts to hold, false when it stops.
+ * - rate_kb_per_min: The smoothed rate at that sample.
+ * - value_kb: The series' value at that sample.
+ */
+struct GrowthAlert {
+    pid_t pid = 0;
+    uint64_t timestamp_ms = 0;
+    size_t rule = 0;
+    bool firing = false;
+    double rate_kb_per_min = 0;
+    uint64_t value_kb = 0;
+};
+
+/**
+ * @brief Growth statistics of one series.
+ *
+ * Fields:
+ * - subject: "total", a region type name or a pathname (see GrowthRule).
+ * - metric: The counter followed.
+ * - value_kb: The latest value.
+ * - rate_kb_per_min: Exponentially weighted moving average of the
+ *   sample-to-sample growth rate.
+ * - window_kb_per_min: Growth between the oldest and newest sample kept.
+ * - samples: Samples seen since the series appeared.
+ */
+struct GrowthRate {
+    std::string subject;
+    GrowthMetric metric = GrowthMetric::RSS;
+    uint64_t value_kb = 0;
+    double rate_kb_per_min = 0;
+    double window_kb_per_min = 0;
+    size_t samples = 0;
+};
+
+/**
+ * @brief Configuration for a GrowthTracker.
+ *
+ * Fields:
+ * - window: Samples kept per series. The moving average uses the matching
+ *   span (weight 2 / (window + 1) for the newest rate), and a pathname
+ *   that stays unmapped for this many samples is forgotten.
+ * - min_samples: Samples a series needs before rules on it are evaluated.
+ * - track_paths: If true, every mapped pathname gets its own series, in
+ *   addition to the totals and the per-RegionType series.
+ * - rules: Thresholds to watch.
+ */
+struct GrowthConfig {
+    size_t window = 10;
+    size_t min_samples = 3;
+    bool track_paths = true;
+    std::vector<GrowthRule> rules;
+};
+
+/**
+ * Follows how fast the memory of one process grows, sample by sample.
+ *
+ * Each update() sums RSS and PSS per RegionType, per mapping pathname and
+ * overall, appends the sums to a fixed-size window per series and folds the
+ * growth since the previous sample into a moving average. The work per
+ * sample is one pass over the regions plus a constant amount per series;
+ * nothing is recomputed from history. Rates are in KB per minute of
+ * sample time, so a late sample does not show up as a spike.
+ *
+ * Rules are evaluated after every update, and an alert is raised only when
+ * a rule starts or stops holding, so a consumer that only wants to hear
+ * about leaks does not have to look at every snapshot.
+ *
+ * RSS and PSS need snapshots taken with smaps; with maps alone every
+ * series stays at zero.
+ *
+ * Usage:
+ *   GrowthTracker tracker({.rules = {*GrowthRule::parse("heap_growth>10MB/min")}});
+ *   std::vector<GrowthAlert> alerts;
+ *   tracker.update(snapshot, alerts);   // per sample
+ *   for (const auto& a : alerts) { ... a.firing ... }
+ */
+class GrowthTracker {
+public:
+    using Config = GrowthConfig;
+
+    explicit GrowthTracker(Config config = {});
+
+    /**
+     * @brief Adds a sample and evaluates the rules.
+     *
+     * Samples must come from one process, in time order.
+     *
+     * @param snapshot The sample.
+     * @param alerts Receives an alert for every rule whose state changed.
+     * @return size_t The number of alerts appended.
+     */
+    size_t update(const ProcessSnapshot& snapshot, std::vector<GrowthAlert>& alerts);
+
+    /**
+     * @brief Returns the statistics of one series.
+     *
+     * @param subject "total", a region type name or a pathname.
+     * @param metric The counter.
+     * @return std::optional<GrowthRate> The statistics, or std::nullopt if
+     * no such series is tracked.
+     */
+    [[nodiscard]] std::optional<GrowthRate> rate(std::string_view subject,
+                                                 GrowthMetric metric = GrowthMetric::RSS) const;
+
+    /**
+     * @brief Returns the statistics of every series that has a sample.
+     *
+     * The total comes first, then the region types in enum order, then the
+     * pathnames in no particular order; each with RSS before PSS.
+     */
+    [[nodiscard]] std::vector<GrowthRate> rates() const;
+
+    /**
+     * @brief Returns the configuration, including the rules.
+     */
+    [[nodiscard]] const Config& config() const {
+        return config_;
+    }
+
+private:
+    static constexpr size_t kTypeCount = static_cast<size_t>(RegionType::UNKNOWN) + 1;
+    /// Index of the overall series, after the per-type ones.
+    static constexpr size_t kTotal = kTypeCount;
+
+    struct Point {
+        uint64_t timestamp_ms = 0;
+        uint64_t kb[2] = {0, 0};
+    };
+
+    struct Series {
+        explicit Series(size_t window)
+            : points(window) {}
+
+        RingBuffer<Point> points;
+        double rate[2] = {0, 0};
+        size_t samples = 0;
+        size_t idle = 0;
+        bool pinned = false;
+        uint64_t sum[2] = {0, 0};
+    };
+
+    /// Where a rule's series lives: a fixed slot, or a pathname's.
+    struct Binding {
+        size_t slot = kTotal;
+        uint32_t path = 0;
+    };
+
+    void push(Series& series, uint64_t timestamp_ms);
+    [[nodiscard]] const Series* find(const Binding& binding) const;
+    [[nodiscard]] GrowthRate describe(std::string_view subject, const Series& series,
+                                      GrowthMetric metric) const;
+
+    Config config_;
+    double alpha_;
+    std::vector<Series> fixed_;
+    std::unordered_map<uint32_t, Series> paths_;
+    std::vector<Binding> bindings_;
+    std::vector<bool> firing_;
+};
+
+} // namespace memc
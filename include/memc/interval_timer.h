@@ -0,0 +1,127 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace memc {
+
+/**
+ * @brief Timing statistics of an IntervalTimer.
+ *
+ * Fields:
+ * - ticks: Deadlines that were honored (wait() returned true).
+ * - missed: Deadlines skipped entirely because the caller was still busy
+ *   past the following deadline.
+ * - last_jitter_ns: Lateness of the most recent wakeup.
+ * - max_jitter_ns: Largest lateness seen.
+ * - mean_jitter_ns: Mean lateness over all ticks.
+ */
+struct TimerStats {
+    uint64_t ticks = 0;
+    uint64_t missed = 0;
+    int64_t last_jitter_ns = 0;
+    int64_t max_jitter_ns = 0;
+    double mean_jitter_ns = 0.0;
+};
+
+/**
+ * Absolute-deadline periodic timer.
+ *
+ * The k-th tick is due at start + k * interval on CLOCK_MONOTONIC, so the
+ * time the caller spends between waits never accumulates as drift. When
+ * the caller overruns, the latest passed deadline fires immediately (its
+ * lateness shows up as jitter) and any deadlines before it are counted as
+ * missed rather than fired back to back.
+ *
+ * The wait blocks on a timerfd armed with TFD_TIMER_ABSTIME and an eventfd
+ * for stop(), so a sleeping thread wakes exactly once per interval and
+ * immediately on stop. stop() is async-signal-safe. If either descriptor
+ * cannot be created the timer falls back to clock_nanosleep(TIMER_ABSTIME)
+ * in short slices.
+ *
+ * Usage:
+ *   IntervalTimer timer(std::chrono::milliseconds(10));
+ *   timer.start();
+ *   while (timer.wait()) {
+ *       // ... sample ...
+ *   }
+ *   // another thread or a signal handler calls timer.stop()
+ */
+class IntervalTimer {
+public:
+    /**
+     * @brief Creates a stopped timer.
+     *
+     * @param interval Time between deadlines. Zero makes wait() return
+     * immediately until stopped.
+     */
+    explicit IntervalTimer(std::chrono::nanoseconds interval);
+    ~IntervalTimer();
+
+    IntervalTimer(const IntervalTimer&) = delete;
+    IntervalTimer& operator=(const IntervalTimer&) = delete;
+
+    /**
+     * @brief Resets the schedule and statistics; the first deadline is now.
+     *
+     * Must not be called while another thread is inside wait().
+     */
+    void start();
+
+    /**
+     * @brief Blocks until the next deadline.
+     *
+     * The first call after start() returns immediately.
+     *
+     * @return true on a deadline, false once stop() has been called.
+     */
+    bool wait();
+
+    /**
+     * @brief Wakes any waiter and makes every later wait() return false.
+     *
+     * Async-signal-safe.
+     */
+    void stop() noexcept;
+
+    /**
+     * @brief Returns true if stop() has been called since the last start().
+     */
+    [[nodiscard]] bool stopped() const noexcept {
+        return stopped_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Returns the configured interval.
+     */
+    [[nodiscard]] std::chrono::nanoseconds interval() const noexcept {
+        return std::chrono::nanoseconds(interval_ns_);
+    }
+
+    /**
+     * @brief Returns the statistics gathered since the last start().
+     *
+     * Safe to call from any thread.
+     */
+    [[nodiscard]] TimerStats stats() const noexcept;
+
+private:
+    bool sleep_until(int64_t deadline_ns);
+    bool sleep_sliced(int64_t deadline_ns);
+    void record(int64_t jitter_ns);
+
+    int64_t interval_ns_;
+    int64_t next_ns_ = 0;
+    int timer_fd_ = -1;
+    int stop_fd_ = -1;
+    std::atomic<bool> stopped_{true};
+
+    std::atomic<uint64_t> ticks_{0};
+    std::atomic<uint64_t> missed_{0};
+    std::atomic<int64_t> last_jitter_ns_{0};
+    std::atomic<int64_t> max_jitter_ns_{0};
+    std::atomic<int64_t> total_jitter_ns_{0};
+};
+
+} // namespace memc
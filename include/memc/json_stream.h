@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cstdint>
+#include <memc/json_writer.h>
+#include <memc/system_scanner.h>
+#include <ostream>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+namespace memc {
+
+/**
+ * Streams the system-wide (--all) JSON document to an output sink.
+ *
+ * Each process entry is serialized and written as soon as it is handed
+ * over, so peak memory is bounded by a single process instead of the whole
+ * system. The counts and the (small) list of skipped processes are only
+ * known at the end and are written last:
+ *
+ *   {
+ *     "timestamp_ms": ...,
+ *     "processes": [ ... ],
+ *     "process_count": N,
+ *     "skipped_count": M,
+ *     "skipped_processes": [ ... ]
+ *   }
+ *
+ * Entries are written with JsonWriter into a reused buffer, and pretty
+ * output matches nlohmann::ordered_json::dump(2) of the same document byte
+ * for byte.
+ *
+ * An incremental writer (one document per sweep of an incremental
+ * SystemScanner) lists only the processes that changed, and adds
+ * "unchanged_count" and "exited_pids" after "skipped_processes". A
+ * SharedFileTable handed to finish() is written last, as "shared_files".
+ *
+ * Usage:
+ *   SystemJsonWriter writer(std::cout, true);
+ *   writer.begin(timestamp_ms);
+ *   writer.write_process(entry);      // per collected process
+ *   writer.add_skipped(pid, name);    // per unreadable process
+ *   writer.finish();
+ */
+class SystemJsonWriter {
+public:
+    /**
+     * @brief Constructs a writer over an output stream.
+     *
+     * @param out The stream to write to. It must outlive the writer.
+     * @param pretty If true, indent with two spaces like dump(2).
+     * @param incremental If true, write the unchanged and exited fields.
+     * @param fields The smaps fields to write for each region.
+     */
+    SystemJsonWriter(std::ostream& out, bool pretty, bool incremental = false,
+                     SmapsFields fields = {});
+
+    /**
+     * @brief Writes the document header and opens the "processes" array.
+     *
+     * @param timestamp_ms The scan timestamp in UNIX epoch milliseconds.
+     */
+    void begin(uint64_t timestamp_ms);
+
+    /**
+     * @brief Serializes one process entry into the "processes" array.
+     *
+     * @param entry The collected process.
+     */
+    void write_process(const ProcessEntry& entry);
+
+    /**
+     * @brief Records a process that could not be read.
+     *
+     * Skipped processes are buffered (PID and name only) and written by
+     * finish().
+     *
+     * @param pid The process ID.
+     * @param name The process name.
+     */
+    void add_skipped(pid_t pid, std::string name);
+
+    /**
+     * @brief Counts a process that did not change since the previous sweep.
+     */
+    void add_unchanged() {
+        unchanged_count_++;
+    }
+
+    /**
+     * @brief Records a process that exited since the previous sweep.
+     *
+     * @param pid The process ID.
+     */
+    void add_exited(pid_t pid) {
+        exited_.push_back(pid);
+    }
+
+    /**
+     * @brief Closes the "processes" array and writes the trailing fields.
+     *
+     * @param files If not null, written as the "shared_files" array.
+     */
+    void finish(const SharedFileTable* files = nullptr);
+
+    /**
+     * @brief Returns the number of process entries written so far.
+     */
+    [[nodiscard]] size_t process_count() const {
+        return process_count_;
+    }
+
+    /**
+     * @brief Returns the number of skipped processes recorded so far.
+     */
+    [[nodiscard]] size_t skipped_count() const {
+        return skipped_total_;
+    }
+
+    /**
+     * @brief Returns the number of unchanged processes counted so far.
+     */
+    [[nodiscard]] size_t unchanged_count() const {
+        return unchanged_count_;
+    }
+
+    /**
+     * @brief Returns the number of exited processes recorded so far.
+     */
+    [[nodiscard]] size_t exited_count() const {
+        return exited_.size();
+    }
+
+private:
+    std::ostream& out_;
+    bool pretty_;
+    bool incremental_;
+    JsonWriter entry_writer_;
+    size_t process_count_ = 0;
+    size_t skipped_total_ = 0;
+    size_t unchanged_count_ = 0;
+    std::vector<std::pair<pid_t, std::string>> skipped_;
+    std::vector<pid_t> exited_;
+};
+
+} // namespace memc
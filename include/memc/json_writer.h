@@ -0,0 +1,140 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memc/delta.h>
+#include <memc/pagemap.h>
+#include <memc/region.h>
+#include <memc/shared_files.h>
+#include <memc/smaps_parser.h>
+#include <string>
+#include <string_view>
+
+namespace memc {
+
+/**
+ * Direct, DOM-free JSON serializer writing into a growable char buffer.
+ *
+ * Values are appended to an internal std::string as they are written:
+ * integers go through std::to_chars, addresses through a lookup-table hex
+ * formatter, and no intermediate JSON tree is ever built. Both layouts
+ * reproduce nlohmann::ordered_json::dump() exactly: pretty output matches
+ * dump(2) and compact output matches dump().
+ *
+ * A base depth lets the writer emit a fragment that will be embedded into a
+ * larger document at a given nesting level (as the --all writer does).
+ *
+ * A partial SmapsFields set leaves the unselected smaps counters out of
+ * every region, and the THP and locked totals out of every snapshot unless
+ * all of the fields they sum are selected.
+ *
+ * Usage:
+ *   JsonWriter w(true);
+ *   w.write(snapshot);
+ *   std::cout << w.view() << '\n';
+ *   w.clear();   // reuse the buffer for the next snapshot
+ */
+class JsonWriter {
+public:
+    /**
+     * @brief Constructs a writer.
+     *
+     * @param pretty If true, indent with two spaces like dump(2).
+     * @param base_depth Nesting depth the output will be embedded at.
+     * @param fields The smaps fields to write for each region.
+     */
+    explicit JsonWriter(bool pretty = true, unsigned base_depth = 0, SmapsFields fields = {});
+
+    /**
+     * @brief Serializes a memory region as a JSON object.
+     *
+     * @param r The region to write.
+     */
+    void write(const MemoryRegion& r);
+
+    /**
+     * @brief Serializes a process snapshot, including all its regions.
+     *
+     * @param s The snapshot to write.
+     */
+    void write(const ProcessSnapshot& s);
+
+    /**
+     * @brief Serializes a process summary as a JSON object.
+     *
+     * @param s The summary to write.
+     */
+    void write(const ProcessSummary& s);
+
+    /**
+     * @brief Serializes a snapshot delta, including its changed regions.
+     *
+     * @param d The delta to write.
+     */
+    void write(const SnapshotDelta& d);
+
+    /**
+     * @brief Serializes a page report, one object per scanned region.
+     *
+     * @param p The report to write.
+     */
+    void write(const PageReport& p);
+
+    /**
+     * @brief Serializes a shared file table as an array, one object per
+     * file, highest PSS first.
+     *
+     * @param t The table to write.
+     */
+    void write(const SharedFileTable& t);
+
+    /// @name Low-level primitives
+    /// Structural calls must be balanced; keys are only valid inside objects.
+    /// @{
+    void begin_object();
+    void end_object();
+    void begin_array();
+    void end_array();
+    void key(std::string_view k);
+    void value(uint64_t v);
+    void value(int64_t v);
+    void value(std::string_view v);
+    void value_hex(uint64_t v);
+    /// @}
+
+    /**
+     * @brief Returns a view over the serialized bytes.
+     */
+    [[nodiscard]] std::string_view view() const {
+        return buf_;
+    }
+
+    /**
+     * @brief Returns the underlying buffer.
+     */
+    [[nodiscard]] std::string& buffer() {
+        return buf_;
+    }
+
+    /**
+     * @brief Discards the output but keeps the buffer's capacity.
+     */
+    void clear();
+
+private:
+    static constexpr unsigned kMaxDepth = 32;
+
+    void before_value();
+    void newline_indent(unsigned depth);
+    void write_escaped(std::string_view s);
+
+    std::string buf_;
+    bool pretty_;
+    unsigned base_depth_;
+    SmapsFields fields_;
+    unsigned depth_ = 0;
+    bool after_key_ = false;
+    std::array<bool, kMaxDepth> first_{};
+};
+
+} // namespace memc
@@ -3,10 +3,13 @@
 #include <memc/region.h>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace memc {
 
+class ProcHandle;
+
 /**
  * Parses /proc/<pid>/maps to extract memory region mappings.
  *
@@ -26,6 +29,33 @@ public:
      */
     static std::optional<std::vector<MemoryRegion>> parse(pid_t pid);
 
+    /**
+     * @brief Parses /proc/<pid>/maps using caller-owned storage.
+     *
+     * The file is read with pread(2) into @p buffer and scanned in place, so
+     * repeated calls with the same buffer and output vector reuse their
+     * capacity instead of allocating.
+     *
+     * @param pid The process ID to parse.
+     * @param buffer Scratch buffer receiving the raw file contents.
+     * @param regions Output vector. It is cleared before parsing.
+     * @return true on success, false if the file could not be read.
+     */
+    static bool parse(pid_t pid, std::string& buffer, std::vector<MemoryRegion>& regions);
+
+    /**
+     * @brief Parses the maps file of an open ProcHandle.
+     *
+     * Same as parse(pid, buffer, regions), but re-reads the descriptor the
+     * handle keeps open instead of opening the file again.
+     *
+     * @param proc The process to read.
+     * @param buffer Scratch buffer receiving the raw file contents.
+     * @param regions Output vector. It is cleared before parsing.
+     * @return true on success, false if the file could not be read.
+     */
+    static bool parse(ProcHandle& proc, std::string& buffer, std::vector<MemoryRegion>& regions);
+
     /**
      * @brief Parses memory regions from a raw string.
      *
@@ -36,24 +66,27 @@ public:
      */
     static std::vector<MemoryRegion> parse_from_string(const std::string& content);
 
-private:
     /**
-     * @brief Parses a single line from a maps file into a MemoryRegion.
+     * @brief Parses memory regions from a view over raw maps content.
+     *
+     * Parsed regions are appended to @p regions; the content is never copied.
      *
-     * @param line The line to parse.
-     * @return std::optional<MemoryRegion> The parsed MemoryRegion, or
-     * std::nullopt if parsing failed.
+     * @param content The raw content of a maps file.
+     * @param regions Output vector the parsed regions are appended to.
      */
-    static std::optional<MemoryRegion> parse_line(const std::string& line);
+    static void parse_from_view(std::string_view content, std::vector<MemoryRegion>& regions);
+
+private:
+    friend class SmapsParser;
 
     /**
-     * @brief Classifies a memory region based on its pathname and permissions.
+     * @brief Parses a single line from a maps file into a MemoryRegion.
      *
-     * @param pathname The pathname associated with the region.
-     * @param permissions The permissions string (e.g., "rw-p").
-     * @return RegionType The classified region type.
+     * @param line The line to parse, without its trailing newline.
+     * @param region The MemoryRegion to populate.
+     * @return true if the line was well-formed, false otherwise.
      */
-    static RegionType classify_region(const std::string& pathname, const std::string& permissions);
+    static bool parse_line(std::string_view line, MemoryRegion& region);
 };
 
 } // namespace memc
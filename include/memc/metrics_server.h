@@ -0,0 +1,143 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace memc {
+
+/**
+ * @brief Configuration for a MetricsServer.
+ *
+ * Fields:
+ * - listen: Address to listen on, "[host]:port". An empty host listens on
+ *   every interface; IPv6 hosts go in brackets ("[::1]:9464"). Port 0
+ *   picks a free port (see MetricsServer::port()).
+ * - max_clients: Connections served at once; further ones are closed as
+ *   soon as they are accepted.
+ * - client_timeout: Idle time after which a connection is closed.
+ */
+struct MetricsServerConfig {
+    std::string listen = ":9464";
+    size_t max_clients = 64;
+    std::chrono::milliseconds client_timeout{10000};
+};
+
+/**
+ * @brief Request counters of a MetricsServer.
+ *
+ * Fields:
+ * - connections: Connections accepted.
+ * - scrapes: GET or HEAD requests for /metrics answered.
+ * - errors: Requests answered with an error status (bad request, unknown
+ *   path or method, or no report published yet).
+ * - bytes_sent: Response bytes written to clients.
+ */
+struct MetricsServerStats {
+    uint64_t connections = 0;
+    uint64_t scrapes = 0;
+    uint64_t errors = 0;
+    uint64_t bytes_sent = 0;
+};
+
+/**
+ * Serves a pre-rendered metrics report over HTTP for Prometheus scrapers.
+ *
+ * publish() renders the complete HTTP response (status line, headers and
+ * body) once; every later scrape of /metrics is answered by writing those
+ * bytes to the socket, without touching /proc or formatting anything. How
+ * often a report is collected and published is therefore independent of how
+ * often, or by how many scrapers, it is read. A response in progress keeps
+ * the report it started with, so publishing never tears a scrape.
+ *
+ * run() serves on the calling thread with a single poll(2) loop, so any
+ * number of scrapers cost one thread. Connections are kept alive between
+ * requests (HTTP/1.1) unless the client asks otherwise.
+ *
+ * Usage:
+ *   MetricsServer server({.listen = ":9464"});
+ *   if (!server.listen()) { ... errno says why ... }
+ *   server.publish(writer.render());   // from the collection thread
+ *   server.run();                      // until server.stop()
+ */
+class MetricsServer {
+public:
+    using Config = MetricsServerConfig;
+
+    explicit MetricsServer(Config config = {});
+    ~MetricsServer();
+
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+
+    /**
+     * @brief Binds and listens on the configured address.
+     *
+     * @return true on success; false if the address is malformed or cannot
+     * be bound, with errno set.
+     */
+    bool listen();
+
+    /**
+     * @brief Returns the bound port, or 0 before a successful listen().
+     */
+    [[nodiscard]] uint16_t port() const {
+        return port_;
+    }
+
+    /**
+     * @brief Replaces the report served at /metrics.
+     *
+     * Thread-safe; may be called from any thread while run() serves. The
+     * report is swapped in with one atomic store, so publishing never
+     * waits for a scrape in progress, nor a scrape for a publish.
+     *
+     * @param body Exposition text (see MetricsWriter).
+     */
+    void publish(std::string_view body);
+
+    /**
+     * @brief Serves connections on the calling thread until stop().
+     *
+     * Returns at once if listen() did not succeed.
+     */
+    void run();
+
+    /**
+     * @brief Makes run() return.
+     *
+     * Only an atomic store and a write(2), both async-signal-safe, so it
+     * may be called from a signal handler.
+     */
+    void stop() noexcept;
+
+    /**
+     * @brief Returns the request counters since construction.
+     */
+    [[nodiscard]] MetricsServerStats stats() const;
+
+private:
+    struct Response;
+    struct Client;
+
+    bool handle_request(Client& client);
+    bool flush(Client& client);
+
+    Config config_;
+    int listen_fd_ = -1;
+    int stop_fd_ = -1;
+    uint16_t port_ = 0;
+    std::atomic<bool> stopped_{false};
+
+    std::atomic<std::shared_ptr<const Response>> report_;
+
+    std::atomic<uint64_t> connections_{0};
+    std::atomic<uint64_t> scrapes_{0};
+    std::atomic<uint64_t> errors_{0};
+    std::atomic<uint64_t> bytes_sent_{0};
+};
+
+} // namespace memc
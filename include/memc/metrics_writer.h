@@ -0,0 +1,97 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memc/region.h>
+#include <string>
+#include <string_view>
+#include <sys/types.h>
+#include <vector>
+
+namespace memc {
+
+/**
+ * Renders process snapshots in the Prometheus text exposition format
+ * (version 0.0.4), which OpenMetrics scrapers also accept.
+ *
+ * Every value is a gauge in bytes, labelled with pid and comm:
+ * - memc_process_{rss,pss,swap,vsize}_bytes: Per-process totals.
+ * - memc_region_{rss,pss,swap,vsize}_bytes: The same split by RegionType,
+ *   with a type label; types a process does not map are left out.
+ * - memc_process_regions: Number of mapped regions.
+ * - memc_processes: Number of processes in the report.
+ *
+ * RSS, PSS and swap need snapshots taken with smaps; with maps alone they
+ * are zero. Processes are added first and the families are written by
+ * render(), since the format wants every sample of a metric next to its
+ * HELP and TYPE lines. The buffers are reused, so rendering the same set of
+ * processes again does not allocate.
+ *
+ * Usage:
+ *   MetricsWriter w;
+ *   for (const auto& snapshot : snapshots) w.add(*snapshot, name_of(snapshot->pid));
+ *   std::string_view text = w.render();
+ *   w.clear();   // reuse the buffers for the next round
+ */
+class MetricsWriter {
+public:
+    /**
+     * @brief Adds one process to the report.
+     *
+     * The snapshot is summed immediately and not referenced afterwards.
+     *
+     * @param snapshot The process's snapshot.
+     * @param comm The process name for the comm label.
+     */
+    void add(const ProcessSnapshot& snapshot, std::string_view comm);
+
+    /**
+     * @brief Writes every metric family for the processes added so far.
+     *
+     * @return std::string_view The exposition text, valid until the next
+     * call on this writer.
+     */
+    std::string_view render();
+
+    /**
+     * @brief Forgets the processes and the rendered text, keeping the
+     * buffers' capacity.
+     */
+    void clear();
+
+    /**
+     * @brief Returns the number of processes added since the last clear().
+     */
+    [[nodiscard]] size_t size() const {
+        return count_;
+    }
+
+private:
+    static constexpr size_t kTypeCount = static_cast<size_t>(RegionType::UNKNOWN) + 1;
+
+    /// Byte totals of one process, overall and per region type.
+    struct Totals {
+        uint64_t rss = 0;
+        uint64_t pss = 0;
+        uint64_t swap = 0;
+        uint64_t vsize = 0;
+    };
+
+    struct Process {
+        pid_t pid = 0;
+        std::string comm;
+        uint64_t regions = 0;
+        Totals total;
+        std::array<Totals, kTypeCount> by_type{};
+    };
+
+    void family(std::string_view name, std::string_view help, std::string_view detail);
+    void labels(const Process& process);
+    void value(uint64_t v);
+
+    std::vector<Process> processes_;
+    size_t count_ = 0;
+    std::string buffer_;
+};
+
+} // namespace memc
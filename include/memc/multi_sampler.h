@@ -0,0 +1,228 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memc/dispatcher.h>
+#include <memc/interval_timer.h>
+#include <memc/process_selector.h>
+#include <memc/region.h>
+#include <memc/sampler.h>
+#include <memc/system_scanner.h>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+namespace memc {
+
+/**
+ * @brief Configuration for the MultiSampler.
+ *
+ * Fields:
+ * - interval: The time between the starts of consecutive sampling rounds.
+ * - use_smaps: If true, detailed memory statistics are read from smaps.
+ * - numa: If true, per-node residency is joined from numa_maps.
+ * - fields: The smaps detail fields to parse (see SmapsFields). Only used
+ *   with use_smaps.
+ * - jobs: Worker threads shared by every monitored process. 0 selects one
+ *   per hardware thread.
+ * - selector: If set, every process matching it is monitored in addition to
+ *   the PIDs added explicitly. Matches are re-evaluated each round.
+ * - dispatch: How callbacks are delivered (see SamplerConfig::dispatch). The
+ *   queue should hold at least one round of snapshots.
+ */
+struct MultiSamplerConfig {
+    std::chrono::milliseconds interval{1000};
+    bool use_smaps{false};
+    bool numa{false};
+    SmapsFields fields{};
+    size_t jobs{0};
+    std::optional<ProcessSelector> selector;
+    DispatchConfig dispatch{.threads = 1, .capacity = 1024};
+};
+
+/// Callback type invoked when a monitored process exits or becomes unreadable.
+using ExitCallback = std::function<void(pid_t)>;
+
+/// Callback type invoked after each round with every latest snapshot, in PID order.
+using RoundCallback = std::function<void(const std::vector<SnapshotHandle>&)>;
+
+/**
+ * Periodically samples a dynamic set of processes from a single timer
+ * thread.
+ *
+ * Each round collects every monitored process on a shared SystemScanner
+ * pool and delivers the snapshots, in PID order, to the registered
+ * SnapshotCallbacks. The thread count is 1 + jobs regardless of how many
+ * processes are watched, and the timer thread wakes once per round on an
+ * IntervalTimer deadline (or when stopped) instead of polling.
+ *
+ * Only the latest snapshot of each process is kept; use a callback to build
+ * a history.
+ *
+ * Usage:
+ *   MultiSampler sampler({.interval = std::chrono::milliseconds(500)});
+ *   sampler.add_pid(1234);
+ *   sampler.add_pid(5678);
+ *   sampler.on_snapshot([](const ProcessSnapshot& snap) { ... });
+ *   sampler.start();
+ */
+class MultiSampler {
+public:
+    explicit MultiSampler(MultiSamplerConfig config = {});
+    ~MultiSampler();
+
+    // Non-copyable, non-movable (owns a thread)
+    MultiSampler(const MultiSampler&) = delete;
+    MultiSampler& operator=(const MultiSampler&) = delete;
+
+    /**
+     * @brief Adds a process to the monitored set.
+     *
+     * Takes effect from the next round. Adding a PID twice has no effect.
+     *
+     * @param pid The process ID.
+     */
+    void add_pid(pid_t pid);
+
+    /**
+     * @brief Removes a process from the monitored set.
+     *
+     * Its latest snapshot is discarded. A process that is also matched by
+     * the selector keeps being sampled.
+     *
+     * @param pid The process ID.
+     */
+    void remove_pid(pid_t pid);
+
+    /**
+     * @brief Returns the explicitly added PIDs, in ascending order.
+     *
+     * @return std::vector<pid_t> The PIDs.
+     */
+    [[nodiscard]] std::vector<pid_t> pids() const;
+
+    /**
+     * @brief Starts the timer thread.
+     *
+     * If the sampler is already running, this method does nothing.
+     */
+    void start();
+
+    /**
+     * @brief Stops the timer thread.
+     *
+     * Wakes the thread immediately and blocks until it has joined and every
+     * queued callback has been delivered. A round in progress is finished
+     * first.
+     */
+    void stop();
+
+    /**
+     * @brief Checks if the sampler is currently running.
+     *
+     * @return true if running, false otherwise.
+     */
+    [[nodiscard]] bool is_running() const;
+
+    /**
+     * @brief Registers a callback to be invoked with each new snapshot.
+     *
+     * Callbacks run on the dispatcher threads, once per process per round.
+     *
+     * @param cb The callback function.
+     */
+    void on_snapshot(SnapshotCallback cb);
+
+    /**
+     * @brief Registers a callback to be invoked when a monitored process
+     * disappears.
+     *
+     * Explicitly added PIDs that can no longer be read are removed from the
+     * set before the callback runs.
+     *
+     * @param cb The callback function.
+     */
+    void on_exit(ExitCallback cb);
+
+    /**
+     * @brief Registers a callback to be invoked after each complete round.
+     *
+     * The callback receives the latest snapshot of every monitored process,
+     * in PID order, once the round's exits have been processed. It runs on
+     * the timer thread, so its time counts against the interval; use it for
+     * work over the whole set, such as rendering a report, and keep it
+     * short. Rounds cut short by stop() are not reported.
+     *
+     * @param cb The callback function.
+     */
+    void on_round(RoundCallback cb);
+
+    /**
+     * @brief Returns the latest snapshot of a process.
+     *
+     * @param pid The process ID.
+     * @return SnapshotHandle The snapshot, or nullptr if the process is not
+     * monitored or has not been sampled yet.
+     */
+    [[nodiscard]] SnapshotHandle get_latest(pid_t pid) const;
+
+    /**
+     * @brief Returns the number of worker threads.
+     *
+     * @return size_t The worker count.
+     */
+    [[nodiscard]] size_t jobs() const {
+        return scanner_.jobs();
+    }
+
+    /**
+     * @brief Returns the round clock's jitter and missed-deadline counts for
+     * the current (or last) run.
+     *
+     * @return TimerStats The timing statistics.
+     */
+    [[nodiscard]] TimerStats timer_stats() const {
+        return timer_.stats();
+    }
+
+    /**
+     * @brief Returns the callback delivery counters, including drops.
+     *
+     * @return DispatchStats The dispatch statistics.
+     */
+    [[nodiscard]] DispatchStats dispatch_stats() const {
+        return dispatcher_.stats();
+    }
+
+private:
+    void sample_loop();
+    void sample_round();
+    std::vector<pid_t> targets(std::vector<pid_t>& selected) const;
+    void deliver(const SampleEvent& event);
+    void finish_round();
+
+    MultiSamplerConfig config_;
+    SystemScanner scanner_;
+
+    std::atomic<bool> running_{false};
+    IntervalTimer timer_;
+    std::thread thread_;
+
+    // Monitored set and latest snapshots, guarded by mutex_.
+    mutable std::mutex mutex_;
+    std::set<pid_t> pids_;
+    std::map<pid_t, SnapshotHandle> latest_;
+
+    std::shared_mutex callbacks_mutex_;
+    std::vector<SnapshotCallback> callbacks_;
+    std::vector<ExitCallback> exit_callbacks_;
+    std::vector<RoundCallback> round_callbacks_;
+    SampleDispatcher dispatcher_;
+};
+
+} // namespace memc
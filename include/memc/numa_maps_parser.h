@@ -0,0 +1,60 @@
+#pragma once
+
+#include <memc/region.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace memc {
+
+class ProcHandle;
+
+/**
+ * Joins /proc/<pid>/numa_maps per-node page counts onto MemoryRegions.
+ *
+ * Each line of /proc/<pid>/numa_maps describes one VMA by its start
+ * address, followed by space-separated key=value tokens:
+ *   7f2c5c000000 default anon=3 dirty=3 N0=2 N1=1 kernelpagesize_kB=4
+ *
+ * The N<node>=<pages> tokens are converted to KB with the line's
+ * kernelpagesize_kB (hugetlb mappings use larger pages) and stored in
+ * MemoryRegion::numa_kb.
+ */
+class NumaMapsParser {
+public:
+    /**
+     * @brief Reads /proc/<pid>/numa_maps and joins it onto @p regions.
+     *
+     * @param pid The process ID to read.
+     * @param buffer Scratch buffer receiving the raw file contents.
+     * @param regions The regions to enrich, ascending by start address.
+     * @return true on success, false if the file could not be read (no NUMA
+     * support, or permission denied). @p regions is left untouched then.
+     */
+    static bool enrich(pid_t pid, std::string& buffer, std::vector<MemoryRegion>& regions);
+
+    /**
+     * @brief Reads the numa_maps file of an open ProcHandle and joins it onto
+     * @p regions.
+     *
+     * @param proc The process to read.
+     * @param buffer Scratch buffer receiving the raw file contents.
+     * @param regions The regions to enrich, ascending by start address.
+     * @return true on success, false if the file could not be read.
+     */
+    static bool enrich(ProcHandle& proc, std::string& buffer, std::vector<MemoryRegion>& regions);
+
+    /**
+     * @brief Joins raw numa_maps content onto @p regions by start address.
+     *
+     * Both lists are in address order, so the join is a single merge pass.
+     * Regions without a numa_maps line, or without resident pages, keep an
+     * empty numa_kb.
+     *
+     * @param content The raw numa_maps content.
+     * @param regions The regions to enrich, ascending by start address.
+     */
+    static void enrich_from_view(std::string_view content, std::vector<MemoryRegion>& regions);
+};
+
+} // namespace memc
@@ -0,0 +1,212 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memc/region.h>
+#include <sys/types.h>
+#include <unordered_map>
+#include <vector>
+
+namespace memc {
+
+/// Number of cold-page age buckets in a PageStats histogram.
+inline constexpr size_t kIdleAgeBuckets = 4;
+
+/**
+ * @brief Page-level residency of one memory region, from /proc/<pid>/pagemap.
+ *
+ * Counts are in pages of the system page size. A present page that is not
+ * exclusively mapped is shared with at least one other mapping.
+ *
+ * Fields:
+ * - start_addr, end_addr, type, pathname: Copied from the MemoryRegion.
+ * - pages: Virtual pages spanned by the region.
+ * - present: Pages resident in RAM.
+ * - swapped: Pages in swap.
+ * - exclusive: Present pages mapped exactly once.
+ * - shared: Present pages mapped more than once.
+ * - file_backed: Present pages that are file pages or shared anonymous.
+ * - soft_dirty: Pages written since the soft-dirty bits were last cleared.
+ *
+ * Idle Tracking Fields (only meaningful when PageReport::idle_tracked):
+ * - hot: Present pages accessed since the previous scan.
+ * - cold: Present pages left untouched, by the number of consecutive scans
+ *   they stayed idle: 1, 2-3, 4-7 and 8 or more.
+ */
+struct PageStats {
+    uint64_t start_addr = 0;
+    uint64_t end_addr = 0;
+    InternedString pathname;
+    RegionType type = RegionType::UNKNOWN;
+
+    uint64_t pages = 0;
+    uint64_t present = 0;
+    uint64_t swapped = 0;
+    uint64_t exclusive = 0;
+    uint64_t shared = 0;
+    uint64_t file_backed = 0;
+    uint64_t soft_dirty = 0;
+
+    uint64_t hot = 0;
+    std::array<uint64_t, kIdleAgeBuckets> cold{};
+
+    /**
+     * @brief Returns the total number of cold pages across all age buckets.
+     */
+    [[nodiscard]] uint64_t cold_total() const {
+        uint64_t total = 0;
+        for (uint64_t c : cold)
+            total += c;
+        return total;
+    }
+};
+
+/**
+ * @brief The page-level view of one process at a point in time.
+ *
+ * Fields:
+ * - pid: Process ID.
+ * - timestamp_ms: UNIX epoch milliseconds.
+ * - page_size: System page size in bytes.
+ * - idle_tracked: True if the hot/cold fields hold data. That needs
+ *   /sys/kernel/mm/page_idle/bitmap, physical frame numbers in pagemap
+ *   (CAP_SYS_ADMIN) and a previous scan to have marked the pages idle.
+ * - regions: One entry per scanned region, in address order.
+ */
+struct PageReport {
+    pid_t pid = 0;
+    uint64_t timestamp_ms = 0;
+    uint64_t page_size = 0;
+    bool idle_tracked = false;
+    std::vector<PageStats> regions;
+};
+
+/**
+ * @brief Configuration for a PagemapScanner.
+ *
+ * Fields:
+ * - all_regions: If true, scan every region; otherwise only HEAP and
+ *   ANONYMOUS regions.
+ * - track_idle: If true, mark scanned pages idle after each scan and
+ *   report on the next scan which of them were touched in between.
+ * - batch_pages: Pagemap entries read per pread(2) call.
+ */
+struct PagemapConfig {
+    bool all_regions = false;
+    bool track_idle = false;
+    size_t batch_pages = 8192;
+};
+
+/**
+ * Page-level residency and hotness scanner for one process.
+ *
+ * Runs over a region list already collected from maps or smaps and reads
+ * the matching slices of /proc/<pid>/pagemap in large batched preads. The
+ * 64-bit entries are decoded by branch-free loops over each batch, which
+ * the compiler vectorizes.
+ *
+ * With idle tracking, the physical frame of every present page is looked up
+ * in /sys/kernel/mm/page_idle/bitmap: a page that is still idle has not been
+ * accessed since the previous scan marked it. Each region keeps a per-page
+ * age (consecutive scans spent idle) across scans, which yields the cold
+ * page histogram. The first scan only marks pages, so its report has
+ * idle_tracked false.
+ *
+ * Not thread-safe; use one scanner per thread.
+ *
+ * Usage:
+ *   PagemapScanner pages(pid, {.track_idle = true});
+ *   PageReport report;
+ *   pages.scan(snapshot->regions, report);   // marks pages idle
+ *   // ... wait ...
+ *   pages.scan(snapshot->regions, report);   // report.idle_tracked
+ */
+class PagemapScanner {
+public:
+    /**
+     * @brief Creates a scanner; files are opened on the first scan.
+     *
+     * @param pid The process ID.
+     * @param config Which regions to scan and whether to track idle pages.
+     */
+    explicit PagemapScanner(pid_t pid, PagemapConfig config = {});
+    ~PagemapScanner();
+
+    PagemapScanner(const PagemapScanner&) = delete;
+    PagemapScanner& operator=(const PagemapScanner&) = delete;
+
+    /**
+     * @brief Returns true if this kernel exposes the page idle bitmap.
+     */
+    [[nodiscard]] static bool idle_tracking_supported();
+
+    /**
+     * @brief Decodes the pagemap entries of @p regions into @p report.
+     *
+     * @param regions The process's regions, ascending by start address.
+     * @param report Output report. Its region list is cleared first.
+     * @return true on success, false if pagemap could not be opened or read.
+     */
+    bool scan(const std::vector<MemoryRegion>& regions, PageReport& report);
+
+    /**
+     * @brief Reads which pages of one region are resident file pages.
+     *
+     * A file page here is a page of the page cache or of shared memory, as
+     * the pagemap file bit has it; copy-on-write copies of a private file
+     * mapping are anonymous and not included. Works without CAP_SYS_ADMIN.
+     *
+     * @param region The region, one of the process's mappings.
+     * @param bits Receives one bit per page of the region, bit i of word
+     * i / 64 for page i; cleared first.
+     * @return true on success, false if pagemap could not be opened or read.
+     */
+    bool file_pages(const MemoryRegion& region, std::vector<uint64_t>& bits);
+
+    /**
+     * @brief Returns the process ID being scanned.
+     */
+    [[nodiscard]] pid_t pid() const {
+        return pid_;
+    }
+
+    /**
+     * @brief Returns the system page size in bytes.
+     */
+    [[nodiscard]] uint64_t page_size() const {
+        return page_size_;
+    }
+
+private:
+    /// Page ages of one region, kept between scans while its size holds.
+    struct RegionAges {
+        std::vector<uint8_t> age;
+        uint32_t generation = 0;
+    };
+
+    bool open_files();
+    bool scan_region(const MemoryRegion& region, PageStats& stats, RegionAges* ages,
+                     bool report_idle);
+    bool read_idle_words();
+    void mark_idle_words();
+
+    pid_t pid_;
+    PagemapConfig config_;
+    uint64_t page_size_;
+    uint32_t generation_ = 0;
+    int pagemap_fd_ = -1;
+    int bitmap_fd_ = -1;
+    bool idle_primed_ = false;
+    bool frames_hidden_ = false;
+
+    // Per-batch scratch, kept to avoid reallocating on every scan.
+    std::vector<uint64_t> entries_;
+    std::vector<uint64_t> frames_;
+    std::vector<uint32_t> frame_pages_;
+    std::vector<uint64_t> words_;
+    std::vector<uint64_t> word_bits_;
+    std::vector<uint64_t> io_;
+    std::unordered_map<uint64_t, RegionAges> ages_;
+};
+
+} // namespace memc
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <sys/types.h>
+
+namespace memc {
+
+/**
+ * Long-lived handle on the /proc directory of one process.
+ *
+ * The first read of a file opens it relative to a descriptor of
+ * /proc/<pid> and keeps it open; later reads pread(2) it again from offset
+ * 0, which makes the kernel regenerate the contents. A sample therefore
+ * costs the reads only, instead of an open, a path walk and a close per
+ * file.
+ *
+ * The directory descriptor pins the process it was opened for: once that
+ * process exits, every read fails, even if the PID is reused. If the
+ * process execs, the files opened before refer to the old address space
+ * and read back empty; they are reopened once, transparently.
+ *
+ * Not thread-safe; use one handle per thread.
+ *
+ * Usage:
+ *   ProcHandle proc(pid);
+ *   std::string buffer;
+ *   while (proc.read("smaps", buffer)) {
+ *       // ... parse buffer ...
+ *   }
+ */
+class ProcHandle {
+public:
+    /// Maximum number of distinct files kept open per handle.
+    static constexpr size_t kMaxFiles = 8;
+
+    /**
+     * @brief Creates a closed handle.
+     */
+    ProcHandle() = default;
+
+    /**
+     * @brief Opens /proc/<pid>; check is_open() for the result.
+     *
+     * @param pid The process ID.
+     */
+    explicit ProcHandle(pid_t pid);
+    ~ProcHandle();
+
+    ProcHandle(const ProcHandle&) = delete;
+    ProcHandle& operator=(const ProcHandle&) = delete;
+    ProcHandle(ProcHandle&& other) noexcept;
+    ProcHandle& operator=(ProcHandle&& other) noexcept;
+
+    /**
+     * @brief Opens /proc/<pid>, closing any previously open process first.
+     *
+     * @param pid The process ID.
+     * @return true on success, false if the process does not exist or its
+     * /proc directory cannot be opened.
+     */
+    bool open(pid_t pid);
+
+    /**
+     * @brief Closes the directory and every cached file.
+     */
+    void close();
+
+    /**
+     * @brief Returns true if the handle refers to a process.
+     */
+    [[nodiscard]] bool is_open() const {
+        return dir_fd_ >= 0;
+    }
+
+    /**
+     * @brief Returns the process ID, or 0 for a closed handle.
+     */
+    [[nodiscard]] pid_t pid() const {
+        return pid_;
+    }
+
+    /**
+     * @brief Reads an entire /proc/<pid>/<name> file into a caller-owned
+     * buffer.
+     *
+     * Same contract as read_proc_file(). @p name must point to storage that
+     * outlives the handle (a string literal); it is kept as the cache key.
+     * Beyond kMaxFiles distinct names, files are opened and closed per read.
+     *
+     * @param name The file name below /proc/<pid>/ (e.g., "smaps").
+     * @param buffer The buffer to fill. Its previous contents are discarded.
+     * @return true on success, false if the handle is closed or the file
+     * could not be opened or read.
+     */
+    bool read(const char* name, std::string& buffer);
+
+private:
+    /// One cached file, keyed by the name it was opened with.
+    struct File {
+        const char* name = nullptr;
+        int fd = -1;
+    };
+
+    File* find_slot(const char* name);
+    int open_file(const char* name);
+    void close_files();
+
+    pid_t pid_ = 0;
+    int dir_fd_ = -1;
+    std::array<File, kMaxFiles> files_{};
+};
+
+} // namespace memc
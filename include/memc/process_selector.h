@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <sys/types.h>
+#include <vector>
+
+namespace memc {
+
+/**
+ * @brief Criteria for a ProcessSelector.
+ *
+ * Fields:
+ * - name_pattern: Regex for the process name, or empty for any name.
+ * - cgroup_prefix: Cgroup path, or empty for any cgroup. Matches that cgroup
+ *   and everything below it, by whole path components.
+ * - uid: Effective user ID the process must run as, if set.
+ * - min_rss_kb: Minimum resident set size in KB; 0 for any size.
+ * - skip_kernel: If true, kernel threads never match.
+ */
+struct SelectorConfig {
+    std::string name_pattern;
+    std::string cgroup_prefix;
+    std::optional<uid_t> uid;
+    uint64_t min_rss_kb = 0;
+    bool skip_kernel = false;
+};
+
+/**
+ * Matches processes by name, user, control group, size and kind.
+ *
+ * - Name: an ECMAScript regular expression searched in the process name.
+ * - User: the effective UID, from the Uid line of /proc/<pid>/status.
+ * - Cgroup: a path prefix matched against every hierarchy listed in
+ *   /proc/<pid>/cgroup (e.g. "/system.slice/nginx.service"), so it works on
+ *   both cgroup v1 and the v2 unified hierarchy.
+ * - Size: the resident set size from /proc/<pid>/statm.
+ * - Kind: kernel threads are recognized by PF_KTHREAD in the flags field of
+ *   /proc/<pid>/stat, without reading their (empty) maps.
+ *
+ * Each criterion costs one small /proc read, from cheapest to dearest
+ * (stat for name and kind, then status, statm and cgroup), and a process is
+ * rejected by the first one it fails. Run before a scan, this keeps the
+ * expensive maps or smaps parse to the processes that survive.
+ *
+ * A process must satisfy every criterion that is set; a selector with no
+ * criteria matches everything.
+ *
+ * Usage:
+ *   auto selector = ProcessSelector::create({.name_pattern = "^worker-",
+ *                                            .min_rss_kb = 1024,
+ *                                            .skip_kernel = true});
+ *   if (!selector) { ... invalid regex ... }
+ *   auto pids = selector->select(enumerate_pids());
+ */
+class ProcessSelector {
+public:
+    using Config = SelectorConfig;
+
+    /**
+     * @brief Builds a selector from a full set of criteria.
+     *
+     * @param config The criteria.
+     * @return std::optional<ProcessSelector> The selector, or std::nullopt if
+     * the name pattern is not a valid regular expression.
+     */
+    static std::optional<ProcessSelector> create(const Config& config);
+
+    /**
+     * @brief Builds a selector by name and cgroup.
+     *
+     * Both arguments are required so that a braced Config argument is never
+     * ambiguous with this overload.
+     *
+     * @param name_pattern Regex for the process name, or empty for any name.
+     * @param cgroup_prefix Cgroup path (matching it and its descendants), or
+     *   empty for any cgroup.
+     * @return std::optional<ProcessSelector> The selector, or std::nullopt if
+     * @p name_pattern is not a valid regular expression.
+     */
+    static std::optional<ProcessSelector> create(const std::string& name_pattern,
+                                                 const std::string& cgroup_prefix);
+
+    /**
+     * @brief Returns true if no criteria are set.
+     */
+    [[nodiscard]] bool empty() const {
+        return !name_regex_ && cgroup_prefix_.empty() && !uid_ && min_rss_kb_ == 0 &&
+               !skip_kernel_;
+    }
+
+    /**
+     * @brief Checks one process against every criterion.
+     *
+     * @param pid The process ID.
+     * @param buffer Scratch buffer for reading /proc files.
+     * @return true if the process matches; false if it does not or its
+     * /proc entries could not be read.
+     */
+    bool matches(pid_t pid, std::string& buffer) const;
+
+    /**
+     * @brief Filters a PID list, keeping its order.
+     *
+     * @param pids Candidate processes.
+     * @return std::vector<pid_t> The matching subset.
+     */
+    [[nodiscard]] std::vector<pid_t> select(const std::vector<pid_t>& pids) const;
+
+private:
+    ProcessSelector() = default;
+
+    bool stat_matches(std::string_view content) const;
+    bool cgroup_matches(std::string_view content) const;
+
+    std::optional<std::regex> name_regex_;
+    std::string cgroup_prefix_;
+    std::optional<uid_t> uid_;
+    uint64_t min_rss_kb_ = 0;
+    uint64_t page_kb_ = 4;
+    bool skip_kernel_ = false;
+};
+
+} // namespace memc
@@ -1,11 +1,14 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <sys/types.h>
 #include <vector>
 
 namespace memc {
 
+class ProcHandle;
+
 /**
  * @brief Enumerates all numeric PIDs from /proc.
  *
@@ -24,4 +27,60 @@ std::vector<pid_t> enumerate_pids();
  */
 std::string get_process_name(pid_t pid);
 
+/**
+ * @brief Reads /proc/<pid>/comm through a caller-owned read buffer.
+ *
+ * Same result as get_process_name(pid), but reuses @p buffer for the read
+ * so that scanning many processes does not open an ifstream per PID.
+ *
+ * @param pid The process ID.
+ * @param buffer Scratch buffer for the raw file contents.
+ * @return std::string The process name, or "unknown" if not found.
+ */
+std::string get_process_name(pid_t pid, std::string& buffer);
+
+/**
+ * @brief Reads the process name through an open ProcHandle.
+ *
+ * Same result as get_process_name(pid), but comm is read relative to the
+ * handle's /proc/<pid> directory, with no path to build, and stays open in
+ * the handle for the next call. Samplers that already hold a handle for the
+ * process can refresh its name for one pread.
+ *
+ * @param proc An open handle for the process.
+ * @param buffer Scratch buffer for the raw file contents.
+ * @return std::string The process name, or "unknown" if not found.
+ */
+std::string get_process_name(ProcHandle& proc, std::string& buffer);
+
+/**
+ * @brief Reads the start time of a process from /proc/<pid>/stat.
+ *
+ * A PID can be reused once its process exits, but (pid, start time) names
+ * one process for the lifetime of the system, so it is the key to cache
+ * per-process data such as names under.
+ *
+ * @param pid The process ID.
+ * @param buffer Scratch buffer for the raw file contents.
+ * @param start_time Receives the starttime field, in clock ticks since boot.
+ * @return true on success, false if the process is gone or stat is
+ * malformed.
+ */
+bool get_process_start_time(pid_t pid, std::string& buffer, uint64_t& start_time);
+
+/**
+ * @brief Reads an entire /proc/<pid>/<name> file into a caller-owned buffer.
+ *
+ * The file is read with pread(2) calls straight into the buffer's
+ * storage. The buffer is resized to the number of bytes read, but its
+ * capacity is kept, so reusing the same buffer across calls avoids any
+ * further allocation once it has grown to fit the largest file seen.
+ *
+ * @param pid The process ID.
+ * @param name The file name below /proc/<pid>/ (e.g., "maps").
+ * @param buffer The buffer to fill. Its previous contents are discarded.
+ * @return true on success, false if the file could not be opened or read.
+ */
+bool read_proc_file(pid_t pid, const char* name, std::string& buffer);
+
 } // namespace memc
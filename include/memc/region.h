@@ -1,8 +1,12 @@
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
 #include <cstdio>
+#include <memory>
+#include <memc/string_pool.h>
 #include <string>
+#include <string_view>
 #include <third_party/nlohmann/json.hpp>
 #include <vector>
 
@@ -12,7 +16,7 @@ namespace memc {
  * Classification of memory region types derived from the mapping path and
  * flags.
  */
-enum class RegionType {
+enum class RegionType : uint8_t {
     HEAP,
     STACK,
     CODE,
@@ -58,6 +62,248 @@ inline const char* region_type_to_string(RegionType t) {
     return "unknown";
 }
 
+/**
+ * @brief Mapping permissions packed into a single byte.
+ *
+ * Holds the four flags of the maps permission column ("rwxp" / "rw-s").
+ * The text form is served from a static table, so converting back to a
+ * string view never allocates. A default-constructed value has no
+ * permissions recorded and reads as the empty string.
+ */
+class Permissions {
+public:
+    static constexpr uint8_t kRead = 1;
+    static constexpr uint8_t kWrite = 2;
+    static constexpr uint8_t kExec = 4;
+    static constexpr uint8_t kShared = 8;
+
+    constexpr Permissions() = default;
+    constexpr Permissions(std::string_view s) {
+        assign(s);
+    }
+    constexpr Permissions(const char* s)
+        : Permissions(std::string_view(s)) {}
+    Permissions(const std::string& s)
+        : Permissions(std::string_view(s)) {}
+
+    /**
+     * @brief Parses a maps permission column such as "r-xp".
+     *
+     * Only the flags are kept: a position holding anything but its letter
+     * reads as '-', and an empty string clears the value.
+     */
+    constexpr Permissions& assign(std::string_view s) {
+        bits_ = 0;
+        if (s.empty()) {
+            return *this;
+        }
+        bits_ = kValid;
+        if (s.size() > 0 && s[0] == 'r')
+            bits_ |= kRead;
+        if (s.size() > 1 && s[1] == 'w')
+            bits_ |= kWrite;
+        if (s.size() > 2 && s[2] == 'x')
+            bits_ |= kExec;
+        if (s.size() > 3 && s[3] == 's')
+            bits_ |= kShared;
+        return *this;
+    }
+    constexpr Permissions& operator=(std::string_view s) {
+        return assign(s);
+    }
+    constexpr Permissions& operator=(const char* s) {
+        return assign(s);
+    }
+    Permissions& operator=(const std::string& s) {
+        return assign(s);
+    }
+
+    [[nodiscard]] constexpr bool readable() const {
+        return bits_ & kRead;
+    }
+    [[nodiscard]] constexpr bool writable() const {
+        return bits_ & kWrite;
+    }
+    [[nodiscard]] constexpr bool executable() const {
+        return bits_ & kExec;
+    }
+    [[nodiscard]] constexpr bool shared() const {
+        return bits_ & kShared;
+    }
+
+    /**
+     * @brief Returns the flags as a bitmask of kRead/kWrite/kExec/kShared.
+     */
+    [[nodiscard]] constexpr uint8_t bits() const {
+        return bits_ & 0x0f;
+    }
+
+    [[nodiscard]] constexpr std::string_view view() const {
+        if (!(bits_ & kValid))
+            return {};
+        return {kText[bits_ & 0x0f], 4};
+    }
+    constexpr operator std::string_view() const {
+        return view();
+    }
+    [[nodiscard]] std::string str() const {
+        return std::string(view());
+    }
+    [[nodiscard]] constexpr const char* c_str() const {
+        return (bits_ & kValid) ? kText[bits_ & 0x0f] : "";
+    }
+    [[nodiscard]] constexpr bool empty() const {
+        return !(bits_ & kValid);
+    }
+    [[nodiscard]] constexpr size_t size() const {
+        return view().size();
+    }
+    [[nodiscard]] constexpr char operator[](size_t i) const {
+        return view()[i];
+    }
+
+    friend constexpr bool operator==(Permissions a, Permissions b) {
+        return a.bits_ == b.bits_;
+    }
+    friend constexpr bool operator==(Permissions a, std::string_view b) {
+        return a.view() == b;
+    }
+    friend constexpr bool operator==(Permissions a, const char* b) {
+        return a.view() == std::string_view(b);
+    }
+    friend bool operator==(Permissions a, const std::string& b) {
+        return a.view() == b;
+    }
+
+private:
+    static constexpr uint8_t kValid = 16;
+    static constexpr char kText[16][5] = {
+        "---p", "r--p", "-w-p", "rw-p", "--xp", "r-xp", "-wxp", "rwxp",
+        "---s", "r--s", "-w-s", "rw-s", "--xs", "r-xs", "-wxs", "rwxs",
+    };
+
+    uint8_t bits_ = 0;
+};
+
+/**
+ * @brief A device number packed the way the kernel does internally.
+ *
+ * The maps device column ("fd:01") is major:minor in hex. Both halves fit
+ * in 32 bits (12-bit major, 20-bit minor). Text conversions format on
+ * demand; a default-constructed value reads as "00:00", like an anonymous
+ * mapping.
+ */
+class DeviceNumber {
+public:
+    constexpr DeviceNumber() = default;
+    constexpr DeviceNumber(uint32_t major, uint32_t minor)
+        : dev_(((major & 0xfff) << 20) | (minor & 0xfffff)) {}
+    DeviceNumber(std::string_view s) {
+        assign(s);
+    }
+    DeviceNumber(const char* s)
+        : DeviceNumber(std::string_view(s)) {}
+    DeviceNumber(const std::string& s)
+        : DeviceNumber(std::string_view(s)) {}
+
+    /**
+     * @brief Parses a "major:minor" hex pair; anything else reads as 00:00.
+     */
+    DeviceNumber& assign(std::string_view s) {
+        dev_ = 0;
+        size_t colon = s.find(':');
+        uint32_t major = 0;
+        uint32_t minor = 0;
+        if (colon == std::string_view::npos || !parse_hex(s.substr(0, colon), major) ||
+            !parse_hex(s.substr(colon + 1), minor)) {
+            return *this;
+        }
+        *this = DeviceNumber(major, minor);
+        return *this;
+    }
+    DeviceNumber& operator=(std::string_view s) {
+        return assign(s);
+    }
+    DeviceNumber& operator=(const char* s) {
+        return assign(s);
+    }
+    DeviceNumber& operator=(const std::string& s) {
+        return assign(s);
+    }
+
+    [[nodiscard]] constexpr uint32_t major() const {
+        return dev_ >> 20;
+    }
+    [[nodiscard]] constexpr uint32_t minor() const {
+        return dev_ & 0xfffff;
+    }
+
+    /**
+     * @brief Returns the packed (major << 20 | minor) value.
+     */
+    [[nodiscard]] constexpr uint32_t packed() const {
+        return dev_;
+    }
+    static constexpr DeviceNumber from_packed(uint32_t packed) {
+        DeviceNumber d;
+        d.dev_ = packed;
+        return d;
+    }
+
+    /**
+     * @brief Formats as in /proc/<pid>/maps ("%02x:%02x") into @p buf.
+     *
+     * @return std::string_view The text, backed by @p buf.
+     */
+    std::string_view format(char (&buf)[16]) const {
+        int n = std::snprintf(buf, sizeof(buf), "%02x:%02x", major(), minor());
+        return {buf, static_cast<size_t>(n)};
+    }
+
+    [[nodiscard]] std::string str() const {
+        char buf[16];
+        return std::string(format(buf));
+    }
+    operator std::string() const {
+        return str();
+    }
+
+    friend constexpr bool operator==(DeviceNumber a, DeviceNumber b) {
+        return a.dev_ == b.dev_;
+    }
+    friend bool operator==(DeviceNumber a, std::string_view b) {
+        return a == DeviceNumber(b);
+    }
+    friend bool operator==(DeviceNumber a, const char* b) {
+        return a == DeviceNumber(b);
+    }
+    friend bool operator==(DeviceNumber a, const std::string& b) {
+        return a == DeviceNumber(b);
+    }
+
+private:
+    static constexpr bool parse_hex(std::string_view s, uint32_t& out) {
+        if (s.empty() || s.size() > 8)
+            return false;
+        out = 0;
+        for (char c : s) {
+            uint32_t digit;
+            if (c >= '0' && c <= '9')
+                digit = c - '0';
+            else if (c >= 'a' && c <= 'f')
+                digit = c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F')
+                digit = c - 'A' + 10;
+            else
+                return false;
+            out = (out << 4) | digit;
+        }
+        return true;
+    }
+
+    uint32_t dev_ = 0;
+};
+
 /**
  * @brief A single memory region parsed from /proc/<pid>/maps (and optionally
  * smaps).
@@ -67,11 +313,12 @@ inline const char* region_type_to_string(RegionType t) {
  * Fields:
  * - start_addr: Start address of the mapping.
  * - end_addr: End address of the mapping.
- * - permissions: Permission string (e.g., "rw-p").
+ * - permissions: Permission flags (text form e.g., "rw-p").
  * - offset: File offset.
  * - device: Device ID (major:minor).
  * - inode: Inode number.
- * - pathname: Mapped file path or label (e.g., "[heap]").
+ * - pathname: Mapped file path or label (e.g., "[heap]"), interned in the
+ *   global StringPool.
  * - type: Calssified region type.
  *
  * Extended Smaps Fields:
@@ -83,18 +330,31 @@ inline const char* region_type_to_string(RegionType t) {
  * - private_clean_kb: Private clean pages in KB.
  * - private_dirty_kb: Private dirty pages in KB.
  * - swap_kb: Swap usage in KB.
+ * - swap_pss_kb: Proportional swap usage in KB.
+ * - locked_kb: Pages locked in memory (mlock) in KB.
+ * - anon_huge_kb: Anonymous memory backed by transparent huge pages in KB.
+ * - shmem_pmd_kb: Shared memory mapped with huge pages in KB.
+ * - file_pmd_kb: File pages mapped with huge pages in KB.
+ * - thp_eligible: True if the kernel may back the mapping with THP.
  * - has_smaps_data: True if smaps fields are populated.
+ *
+ * NUMA Fields:
+ * - numa_kb: Resident KB per NUMA node (index = node ID), joined from
+ *   /proc/<pid>/numa_maps. Empty unless NUMA data was collected.
  */
 struct MemoryRegion {
     uint64_t start_addr = 0;
     uint64_t end_addr = 0;
-    std::string permissions;
     uint64_t offset = 0;
-    std::string device;
     uint64_t inode = 0;
-    std::string pathname;
 
+    // Packed fields grouped together so the struct has no interior padding.
+    DeviceNumber device;
+    InternedString pathname;
+    Permissions permissions;
     RegionType type = RegionType::UNKNOWN;
+    bool has_smaps_data = false;
+    bool thp_eligible = false;
 
     uint64_t size_kb = 0;
     uint64_t rss_kb = 0;
@@ -104,8 +364,20 @@ struct MemoryRegion {
     uint64_t private_clean_kb = 0;
     uint64_t private_dirty_kb = 0;
     uint64_t swap_kb = 0;
+    uint64_t swap_pss_kb = 0;
+    uint64_t locked_kb = 0;
+    uint64_t anon_huge_kb = 0;
+    uint64_t shmem_pmd_kb = 0;
+    uint64_t file_pmd_kb = 0;
 
-    bool has_smaps_data = false;
+    std::vector<uint64_t> numa_kb;
+
+    /**
+     * @brief Returns the KB of this region mapped with transparent huge pages.
+     */
+    [[nodiscard]] uint64_t thp_kb() const {
+        return anon_huge_kb + shmem_pmd_kb + file_pmd_kb;
+    }
 
     /**
      * @brief Calculates the total size of this memory region in bytes.
@@ -115,6 +387,11 @@ struct MemoryRegion {
     [[nodiscard]] uint64_t size_bytes() const {
         return end_addr - start_addr;
     }
+
+    /**
+     * @brief Compares every mapping and smaps field.
+     */
+    bool operator==(const MemoryRegion&) const = default;
 };
 
 /**
@@ -136,7 +413,7 @@ inline void to_json(nlohmann::ordered_json& j, const MemoryRegion& r) {
     j["start"] = start_buf;
     j["end"] = end_buf;
     j["type"] = region_type_to_string(r.type);
-    j["perm"] = r.permissions;
+    j["perm"] = r.permissions.str();
     j["size_kb"] = r.size_bytes() / 1024;
 
     if (!r.pathname.empty()) {
@@ -151,6 +428,16 @@ inline void to_json(nlohmann::ordered_json& j, const MemoryRegion& r) {
         j["private_clean_kb"] = r.private_clean_kb;
         j["private_dirty_kb"] = r.private_dirty_kb;
         j["swap_kb"] = r.swap_kb;
+        j["swap_pss_kb"] = r.swap_pss_kb;
+        j["locked_kb"] = r.locked_kb;
+        j["anon_huge_kb"] = r.anon_huge_kb;
+        j["shmem_pmd_kb"] = r.shmem_pmd_kb;
+        j["file_pmd_kb"] = r.file_pmd_kb;
+        j["thp_eligible"] = r.thp_eligible ? 1 : 0;
+    }
+
+    if (!r.numa_kb.empty()) {
+        j["numa_kb"] = r.numa_kb;
     }
 }
 
@@ -193,8 +480,185 @@ struct ProcessSnapshot {
             total += r.size_bytes();
         return total / 1024;
     }
+
+    /**
+     * @brief Calculates the total KB mapped with transparent huge pages.
+     *
+     * Only meaningful if smaps data is present in the regions.
+     *
+     * @return uint64_t AnonHugePages + ShmemPmdMapped + FilePmdMapped, in KB.
+     */
+    [[nodiscard]] uint64_t total_thp_kb() const {
+        uint64_t total = 0;
+        for (const auto& r : regions)
+            total += r.thp_kb();
+        return total;
+    }
+
+    /**
+     * @brief Calculates the total KB locked in memory across all regions.
+     */
+    [[nodiscard]] uint64_t total_locked_kb() const {
+        uint64_t total = 0;
+        for (const auto& r : regions)
+            total += r.locked_kb;
+        return total;
+    }
+
+    /**
+     * @brief Returns the share of resident memory backed by huge pages.
+     *
+     * @return double total_thp_kb() / total_rss_kb(), or 0 without RSS.
+     */
+    [[nodiscard]] double thp_coverage() const {
+        uint64_t rss = total_rss_kb();
+        return rss ? static_cast<double>(total_thp_kb()) / static_cast<double>(rss) : 0.0;
+    }
+
+    /**
+     * @brief Returns true if the regions carry smaps data.
+     *
+     * A snapshot comes either entirely from smaps or entirely from maps.
+     */
+    [[nodiscard]] bool has_smaps_data() const {
+        return !regions.empty() && regions.front().has_smaps_data;
+    }
+
+    /**
+     * @brief Returns true if any region carries NUMA data.
+     */
+    [[nodiscard]] bool has_numa_data() const {
+        for (const auto& r : regions)
+            if (!r.numa_kb.empty())
+                return true;
+        return false;
+    }
+
+    /**
+     * @brief Sums the per-node resident KB of every region.
+     *
+     * @return std::vector<uint64_t> KB per NUMA node (index = node ID); empty
+     * without NUMA data.
+     */
+    [[nodiscard]] std::vector<uint64_t> numa_node_kb() const {
+        std::vector<uint64_t> totals;
+        for (const auto& r : regions) {
+            if (r.numa_kb.size() > totals.size())
+                totals.resize(r.numa_kb.size());
+            for (size_t node = 0; node < r.numa_kb.size(); ++node)
+                totals[node] += r.numa_kb[node];
+        }
+        return totals;
+    }
+
+    /**
+     * @brief Returns the KB resident outside the process's home node.
+     *
+     * The home node is the one holding the most of the process's memory.
+     */
+    [[nodiscard]] uint64_t numa_remote_kb() const {
+        uint64_t total = 0;
+        uint64_t home = 0;
+        for (uint64_t kb : numa_node_kb()) {
+            total += kb;
+            home = std::max(home, kb);
+        }
+        return total - home;
+    }
+
+    /**
+     * @brief Returns the share of NUMA-tracked memory outside the home node.
+     *
+     * @return double numa_remote_kb() over the total, or 0 without NUMA data.
+     */
+    [[nodiscard]] double numa_remote_ratio() const {
+        uint64_t total = 0;
+        for (uint64_t kb : numa_node_kb())
+            total += kb;
+        return total ? static_cast<double>(numa_remote_kb()) / static_cast<double>(total) : 0.0;
+    }
 };
 
+/// Shared, immutable handle to a snapshot.
+using SnapshotHandle = std::shared_ptr<const ProcessSnapshot>;
+
+/**
+ * @brief Per-process memory totals read from /proc/<pid>/smaps_rollup.
+ *
+ * The kernel aggregates every VMA into a single record, so collecting a
+ * summary costs one small read regardless of how many mappings the process
+ * has. No per-region data is kept.
+ *
+ * Fields:
+ * - pid: Process ID.
+ * - timestamp_ms: UNIX epoch milliseconds.
+ * - rss_kb: Resident Set Size in KB.
+ * - pss_kb: Proportional Set Size in KB.
+ * - pss_anon_kb: PSS of anonymous pages in KB.
+ * - pss_file_kb: PSS of file-backed pages in KB.
+ * - pss_shmem_kb: PSS of shared memory pages in KB.
+ * - shared_clean_kb: Shared clean pages in KB.
+ * - shared_dirty_kb: Shared dirty pages in KB.
+ * - private_clean_kb: Private clean pages in KB.
+ * - private_dirty_kb: Private dirty pages in KB.
+ * - anonymous_kb: Anonymous memory in KB.
+ * - swap_kb: Swap usage in KB.
+ * - swap_pss_kb: Proportional swap usage in KB.
+ * - locked_kb: Pages locked in memory (mlock) in KB.
+ * - anon_huge_kb: Anonymous memory backed by transparent huge pages in KB.
+ * - shmem_pmd_kb: Shared memory mapped with huge pages in KB.
+ * - file_pmd_kb: File pages mapped with huge pages in KB.
+ */
+struct ProcessSummary {
+    pid_t pid = 0;
+    uint64_t timestamp_ms = 0;
+
+    uint64_t rss_kb = 0;
+    uint64_t pss_kb = 0;
+    uint64_t pss_anon_kb = 0;
+    uint64_t pss_file_kb = 0;
+    uint64_t pss_shmem_kb = 0;
+    uint64_t shared_clean_kb = 0;
+    uint64_t shared_dirty_kb = 0;
+    uint64_t private_clean_kb = 0;
+    uint64_t private_dirty_kb = 0;
+    uint64_t anonymous_kb = 0;
+    uint64_t swap_kb = 0;
+    uint64_t swap_pss_kb = 0;
+    uint64_t locked_kb = 0;
+    uint64_t anon_huge_kb = 0;
+    uint64_t shmem_pmd_kb = 0;
+    uint64_t file_pmd_kb = 0;
+};
+
+/**
+ * @brief Serializes a ProcessSummary object to an ordered JSON object.
+ *
+ * @param j The JSON object to populate.
+ * @param s The ProcessSummary object to serialize.
+ */
+inline void to_json(nlohmann::ordered_json& j, const ProcessSummary& s) {
+    j = nlohmann::ordered_json{};
+    j["pid"] = s.pid;
+    j["timestamp_ms"] = s.timestamp_ms;
+    j["rss_kb"] = s.rss_kb;
+    j["pss_kb"] = s.pss_kb;
+    j["pss_anon_kb"] = s.pss_anon_kb;
+    j["pss_file_kb"] = s.pss_file_kb;
+    j["pss_shmem_kb"] = s.pss_shmem_kb;
+    j["shared_clean_kb"] = s.shared_clean_kb;
+    j["shared_dirty_kb"] = s.shared_dirty_kb;
+    j["private_clean_kb"] = s.private_clean_kb;
+    j["private_dirty_kb"] = s.private_dirty_kb;
+    j["anonymous_kb"] = s.anonymous_kb;
+    j["swap_kb"] = s.swap_kb;
+    j["swap_pss_kb"] = s.swap_pss_kb;
+    j["locked_kb"] = s.locked_kb;
+    j["anon_huge_kb"] = s.anon_huge_kb;
+    j["shmem_pmd_kb"] = s.shmem_pmd_kb;
+    j["file_pmd_kb"] = s.file_pmd_kb;
+}
+
 /**
  * @brief Serializes a ProcessSnapshot object to an ordered JSON object.
  *
@@ -211,6 +675,14 @@ inline void to_json(nlohmann::ordered_json& j, const ProcessSnapshot& s) {
     j["timestamp_ms"] = s.timestamp_ms;
     j["total_rss_kb"] = s.total_rss_kb();
     j["total_vsize_kb"] = s.total_vsize_kb();
+    if (s.has_smaps_data()) {
+        j["total_thp_kb"] = s.total_thp_kb();
+        j["total_locked_kb"] = s.total_locked_kb();
+    }
+    if (s.has_numa_data()) {
+        j["numa_node_kb"] = s.numa_node_kb();
+        j["numa_remote_kb"] = s.numa_remote_kb();
+    }
     j["region_count"] = s.regions.size();
 
     j["regions"] = nlohmann::ordered_json::array();
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <memc/region.h>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace memc {
+
+namespace detail {
+
+/// Longest ".so" version suffix (".6", ".6.0.30") the backward scan accepts.
+inline constexpr size_t kMaxSoVersionLength = 32;
+
+/**
+ * @brief Returns true if @p s is exactly the literal @p lit.
+ *
+ * The length is a compile-time constant, so the comparison folds into one
+ * or two integer compares.
+ */
+template <size_t N>
+constexpr bool equals(std::string_view s, const char (&lit)[N]) {
+    return s.size() == N - 1 && std::char_traits<char>::compare(s.data(), lit, N - 1) == 0;
+}
+
+/**
+ * @brief Returns true if @p s starts with the literal @p lit.
+ */
+template <size_t N>
+constexpr bool has_prefix(std::string_view s, const char (&lit)[N]) {
+    return s.size() >= N - 1 && std::char_traits<char>::compare(s.data(), lit, N - 1) == 0;
+}
+
+/**
+ * @brief Returns true if @p s ends with the literal @p lit.
+ */
+template <size_t N>
+constexpr bool has_suffix(std::string_view s, const char (&lit)[N]) {
+    return s.size() >= N - 1 &&
+           std::char_traits<char>::compare(s.data() + s.size() - (N - 1), lit, N - 1) == 0;
+}
+
+/**
+ * @brief Returns true if @p path names a shared object.
+ *
+ * Matches a ".so" suffix optionally followed by a version ("libc.so.6",
+ * "libstdc++.so.6.0.30") and the kernel's " (deleted)" marker. The scan
+ * walks back over at most kMaxSoVersionLength version characters instead
+ * of searching the whole path.
+ */
+constexpr bool is_shared_object(std::string_view path) {
+    if (has_suffix(path, " (deleted)"))
+        path.remove_suffix(sizeof(" (deleted)") - 1);
+
+    size_t end = path.size();
+    const size_t stop = end > kMaxSoVersionLength ? end - kMaxSoVersionLength : 0;
+    while (end > stop) {
+        char c = path[end - 1];
+        if ((c < '0' || c > '9') && c != '.')
+            break;
+        --end;
+    }
+    return has_suffix(path.substr(0, end), ".so");
+}
+
+/**
+ * @brief The built-in classification rules.
+ *
+ * Dispatches on the first byte of the pathname: pseudo-paths ("[heap]",
+ * "[stack]", ...) are told apart by length and a fixed-size compare, file
+ * paths by the shared-object suffix and the exec bit.
+ */
+constexpr RegionType classify_builtin(std::string_view pathname, Permissions perms) {
+    if (pathname.empty())
+        return perms.executable() ? RegionType::CODE : RegionType::ANONYMOUS;
+
+    switch (pathname[0]) {
+    case '/':
+        if (is_shared_object(pathname))
+            return RegionType::SHARED_LIB;
+        return perms.executable() ? RegionType::CODE : RegionType::MAPPED_FILE;
+    case '[':
+        switch (pathname.size()) {
+        case 6:
+            if (equals(pathname, "[heap]"))
+                return RegionType::HEAP;
+            if (equals(pathname, "[vdso]"))
+                return RegionType::VDSO;
+            if (equals(pathname, "[vvar]"))
+                return RegionType::VVAR;
+            break;
+        case 10:
+            if (equals(pathname, "[vsyscall]"))
+                return RegionType::VSYSCALL;
+            break;
+        }
+        // "[stack]", or "[stack:<tid>]" on kernels before 4.5.
+        if (has_prefix(pathname, "[stack"))
+            return RegionType::STACK;
+        break;
+    }
+    return RegionType::UNKNOWN;
+}
+
+} // namespace detail
+
+/**
+ * @brief A compile-time classification rule for RegionClassifier.
+ *
+ * A rule is a type with a static, ideally constexpr, member
+ *   std::optional<RegionType> match(std::string_view pathname, Permissions perms)
+ * returning the region's type, or std::nullopt to leave it to the next rule.
+ */
+template <typename R>
+concept RegionRule = requires(std::string_view pathname, Permissions perms) {
+    { R::match(pathname, perms) } -> std::same_as<std::optional<RegionType>>;
+};
+
+/**
+ * Region classifier assembled at compile time from a list of rules.
+ *
+ * The rules in @p Rules are tried in order, and the first match wins.
+ * Unmatched regions fall through to the built-in rules, which MapsParser
+ * uses on its own (DefaultRegionClassifier). Rules are static functions
+ * expanded in a fold expression, so a classifier is inlined into its
+ * caller as straight-line code, with no virtual calls or tables of
+ * function pointers.
+ *
+ * Usage:
+ *   struct JitCacheRule {
+ *       static constexpr std::optional<RegionType> match(std::string_view p, Permissions) {
+ *           if (p.starts_with("[anon:v8")) return RegionType::CODE;
+ *           return std::nullopt;
+ *       }
+ *   };
+ *   using MyClassifier = RegionClassifier<JitCacheRule, NamedAnonymousRule, MemfdRule>;
+ *   reclassify<MyClassifier>(snapshot.regions);
+ */
+template <RegionRule... Rules>
+struct RegionClassifier {
+    /**
+     * @brief Classifies a region by its pathname and permissions.
+     *
+     * @param pathname The region's pathname (empty for anonymous memory).
+     * @param perms The region's permissions.
+     * @return RegionType The type of the first matching rule, else the
+     * built-in classification.
+     */
+    static constexpr RegionType classify(std::string_view pathname, Permissions perms) {
+        std::optional<RegionType> type;
+        (void)((type = Rules::match(pathname, perms)) || ...);
+        if (type)
+            return *type;
+        return detail::classify_builtin(pathname, perms);
+    }
+};
+
+/// The classifier MapsParser and SmapsParser apply while parsing.
+using DefaultRegionClassifier = RegionClassifier<>;
+
+/**
+ * @brief Rule classifying named anonymous memory ("[anon:<name>]", set with
+ * prctl(PR_SET_VMA_ANON_NAME)) as ANONYMOUS, or CODE if executable.
+ */
+struct NamedAnonymousRule {
+    static constexpr std::optional<RegionType> match(std::string_view pathname,
+                                                     Permissions perms) {
+        if (!detail::has_prefix(pathname, "[anon:"))
+            return std::nullopt;
+        return perms.executable() ? RegionType::CODE : RegionType::ANONYMOUS;
+    }
+};
+
+/**
+ * @brief Rule classifying memfd mappings ("/memfd:<name>", with or without
+ * " (deleted)") as ANONYMOUS, or CODE if executable, not as mapped files.
+ */
+struct MemfdRule {
+    static constexpr std::optional<RegionType> match(std::string_view pathname,
+                                                     Permissions perms) {
+        if (!detail::has_prefix(pathname, "/memfd:"))
+            return std::nullopt;
+        return perms.executable() ? RegionType::CODE : RegionType::ANONYMOUS;
+    }
+};
+
+/**
+ * @brief Re-runs @p Classifier over already parsed regions.
+ *
+ * The parsers are compiled into the library with DefaultRegionClassifier;
+ * this applies a custom rule set afterwards, one inlined classify() call
+ * per region.
+ *
+ * @param regions The regions to reclassify in place.
+ */
+template <typename Classifier>
+void reclassify(std::span<MemoryRegion> regions) {
+    for (MemoryRegion& r : regions)
+        r.type = Classifier::classify(r.pathname.view(), r.permissions);
+}
+
+} // namespace memc
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <memc/region.h>
+#include <span>
+#include <vector>
+
+namespace memc {
+
+/**
+ * Address lookup index over the regions of one snapshot.
+ *
+ * The start and end addresses are copied into two flat sorted arrays, so a
+ * lookup touches 16 bytes per probed region instead of whole MemoryRegions.
+ * Point lookups use a branchless binary search (the loop compiles to
+ * conditional moves, with no mispredicted branches). Batch lookups of an
+ * ascending address list run as a single merge pass over both lists.
+ *
+ * The regions must be ascending by start address and must not overlap, as
+ * /proc/<pid>/maps and smaps list them. The index points into the region
+ * list it was built from, which must outlive it and stay unmodified.
+ *
+ * Usage:
+ *   RegionIndex index(*snapshot);
+ *   if (const MemoryRegion* r = index.find_region(0x7f2c5c001000))
+ *       std::cout << r->pathname.view() << "\n";
+ *   for (const MemoryRegion& r : index.overlapping(lo, hi))
+ *       ...
+ */
+class RegionIndex {
+public:
+    RegionIndex() = default;
+
+    /**
+     * @brief Builds an index over the regions of @p snapshot.
+     */
+    explicit RegionIndex(const ProcessSnapshot& snapshot);
+
+    /**
+     * @brief Builds an index over @p regions.
+     */
+    explicit RegionIndex(std::span<const MemoryRegion> regions);
+
+    /**
+     * @brief Rebuilds the index over @p regions, keeping the capacity.
+     */
+    void assign(std::span<const MemoryRegion> regions);
+
+    /**
+     * @brief Returns the region containing @p addr.
+     *
+     * @param addr A virtual address.
+     * @return const MemoryRegion* The region with start <= addr < end, or
+     * nullptr if the address is unmapped.
+     */
+    [[nodiscard]] const MemoryRegion* find_region(uint64_t addr) const;
+
+    /**
+     * @brief Returns the regions overlapping the range [lo, hi).
+     *
+     * @param lo First address of the range.
+     * @param hi One past the last address of the range.
+     * @return std::span<const MemoryRegion> The overlapping regions, in
+     * address order; empty if none overlap or lo >= hi.
+     */
+    [[nodiscard]] std::span<const MemoryRegion> overlapping(uint64_t lo, uint64_t hi) const;
+
+    /**
+     * @brief Looks up every address of @p addrs in one merge pass.
+     *
+     * @param addrs Addresses to look up, in ascending order.
+     * @param out Output with one entry per address: the containing region,
+     * or nullptr if unmapped. Must be at least as long as @p addrs.
+     * @return size_t Number of addresses found in a region.
+     */
+    size_t find_regions(std::span<const uint64_t> addrs,
+                        std::span<const MemoryRegion*> out) const;
+
+    /**
+     * @brief Returns the number of indexed regions.
+     */
+    [[nodiscard]] size_t size() const {
+        return starts_.size();
+    }
+    [[nodiscard]] bool empty() const {
+        return starts_.empty();
+    }
+
+    /**
+     * @brief Returns the indexed regions.
+     */
+    [[nodiscard]] std::span<const MemoryRegion> regions() const {
+        return regions_;
+    }
+
+private:
+    std::span<const MemoryRegion> regions_;
+    std::vector<uint64_t> starts_;
+    std::vector<uint64_t> ends_;
+};
+
+} // namespace memc
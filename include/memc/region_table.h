@@ -0,0 +1,213 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memc/region.h>
+#include <span>
+#include <vector>
+
+namespace memc {
+
+/// Number of RegionType values.
+inline constexpr size_t kRegionTypeCount = static_cast<size_t>(RegionType::UNKNOWN) + 1;
+
+/// Number of permission classes (every combination of Permissions bits).
+inline constexpr size_t kPermissionClassCount = 16;
+
+/**
+ * @brief Summed counters of a group of regions.
+ *
+ * Fields:
+ * - regions: Number of regions in the group.
+ * - size_kb: Total virtual size in KB.
+ * - rss_kb, pss_kb, swap_kb: Summed smaps counters in KB.
+ * - shared_kb: Shared_Clean + Shared_Dirty in KB.
+ * - private_kb: Private_Clean + Private_Dirty in KB.
+ * - thp_kb: Memory mapped with transparent huge pages in KB.
+ */
+struct RegionTotals {
+    uint64_t regions = 0;
+    uint64_t size_kb = 0;
+    uint64_t rss_kb = 0;
+    uint64_t pss_kb = 0;
+    uint64_t swap_kb = 0;
+    uint64_t shared_kb = 0;
+    uint64_t private_kb = 0;
+    uint64_t thp_kb = 0;
+
+    bool operator==(const RegionTotals&) const = default;
+};
+
+/**
+ * @brief Totals of every region mapping one pathname.
+ */
+struct PathnameTotals {
+    InternedString pathname;
+    RegionTotals totals;
+};
+
+/**
+ * Columnar (structure-of-arrays) store of memory regions.
+ *
+ * Each counter lives in its own contiguous array, so a reduction over one
+ * field streams 8 bytes per region instead of a whole MemoryRegion. Plain
+ * totals are branch-free sums the compiler vectorizes. Grouped totals make
+ * one pass per column, adding each value into a small accumulator array
+ * indexed by the group key, so aggregating a large table stays bound by
+ * memory bandwidth instead of pointer chasing. Grouping by pathname
+ * indexes the accumulators by the dense StringPool ID and never hashes.
+ *
+ * A table can hold any number of snapshots, appended one after another.
+ * That way a whole sampling history aggregates in one pass, and
+ * snapshot_totals() still gives the totals of each snapshot.
+ *
+ * Not thread-safe.
+ *
+ * Usage:
+ *   RegionTable table;
+ *   for (const auto& handle : sampler.get_snapshot_handles())
+ *       table.append(*handle);
+ *   auto by_type = table.totals_by_type();
+ *   uint64_t heap_rss = by_type[size_t(RegionType::HEAP)].rss_kb;
+ */
+class RegionTable {
+public:
+    RegionTable() = default;
+
+    /**
+     * @brief Builds a table holding the regions of @p snapshot.
+     */
+    explicit RegionTable(const ProcessSnapshot& snapshot);
+
+    /**
+     * @brief Appends the regions of @p snapshot as one more snapshot.
+     */
+    void append(const ProcessSnapshot& snapshot);
+
+    /**
+     * @brief Replaces the contents with @p snapshot, keeping the capacity.
+     */
+    void assign(const ProcessSnapshot& snapshot);
+
+    /**
+     * @brief Reserves room for @p regions rows in every column.
+     */
+    void reserve(size_t regions);
+
+    /**
+     * @brief Removes every row, keeping the allocated columns.
+     */
+    void clear();
+
+    /**
+     * @brief Returns the number of rows (regions) in the table.
+     */
+    [[nodiscard]] size_t size() const {
+        return start_.size();
+    }
+    [[nodiscard]] bool empty() const {
+        return start_.empty();
+    }
+
+    /**
+     * @brief Returns the number of snapshots appended.
+     */
+    [[nodiscard]] size_t snapshot_count() const {
+        return offsets_.size();
+    }
+
+    /**
+     * @brief Returns the totals of every row.
+     */
+    [[nodiscard]] RegionTotals totals() const;
+
+    /**
+     * @brief Returns the totals of the @p i-th appended snapshot.
+     */
+    [[nodiscard]] RegionTotals snapshot_totals(size_t i) const;
+
+    /**
+     * @brief Returns the totals of every row grouped by RegionType.
+     *
+     * @return std::array<RegionTotals, kRegionTypeCount> Indexed by the
+     * RegionType value.
+     */
+    [[nodiscard]] std::array<RegionTotals, kRegionTypeCount> totals_by_type() const;
+
+    /**
+     * @brief Returns the totals of every row grouped by permission class.
+     *
+     * @return std::array<RegionTotals, kPermissionClassCount> Indexed by
+     * Permissions::bits() (kRead | kWrite | kExec | kShared).
+     */
+    [[nodiscard]] std::array<RegionTotals, kPermissionClassCount> totals_by_permissions() const;
+
+    /**
+     * @brief Returns the totals of every row grouped by pathname.
+     *
+     * Anonymous regions (empty pathname) form their own group.
+     *
+     * @return std::vector<PathnameTotals> One entry per pathname present,
+     * ascending by StringPool ID.
+     */
+    [[nodiscard]] std::vector<PathnameTotals> totals_by_pathname() const;
+
+    /// @name Columns
+    /// Row i of every column describes the same region.
+    /// @{
+    [[nodiscard]] std::span<const uint64_t> start_addr() const {
+        return start_;
+    }
+    [[nodiscard]] std::span<const uint64_t> end_addr() const {
+        return end_;
+    }
+    [[nodiscard]] std::span<const uint64_t> rss_kb() const {
+        return rss_;
+    }
+    [[nodiscard]] std::span<const uint64_t> pss_kb() const {
+        return pss_;
+    }
+    [[nodiscard]] std::span<const uint64_t> swap_kb() const {
+        return swap_;
+    }
+    [[nodiscard]] std::span<const uint64_t> shared_kb() const {
+        return shared_;
+    }
+    [[nodiscard]] std::span<const uint64_t> private_kb() const {
+        return private_;
+    }
+    [[nodiscard]] std::span<const uint64_t> thp_kb() const {
+        return thp_;
+    }
+    [[nodiscard]] std::span<const uint32_t> pathname_id() const {
+        return pathname_;
+    }
+    [[nodiscard]] std::span<const uint8_t> type() const {
+        return type_;
+    }
+    [[nodiscard]] std::span<const uint8_t> permissions() const {
+        return perms_;
+    }
+    /// @}
+
+private:
+    RegionTotals totals(size_t begin, size_t end) const;
+
+    template <typename Key>
+    void group_totals(std::span<const Key> keys, RegionTotals* groups, size_t group_count) const;
+
+    std::vector<uint64_t> start_;
+    std::vector<uint64_t> end_;
+    std::vector<uint64_t> rss_;
+    std::vector<uint64_t> pss_;
+    std::vector<uint64_t> swap_;
+    std::vector<uint64_t> shared_;
+    std::vector<uint64_t> private_;
+    std::vector<uint64_t> thp_;
+    std::vector<uint32_t> pathname_;
+    std::vector<uint8_t> type_;
+    std::vector<uint8_t> perms_;
+    std::vector<size_t> offsets_;
+};
+
+} // namespace memc
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace memc {
+
+/**
+ * Circular FIFO buffer with O(1) push and pop at either end of the window.
+ *
+ * A bounded buffer (capacity > 0) overwrites its oldest element once full
+ * and hands the overwritten element back to the caller, so expensive
+ * destructors can run outside whatever lock guards the buffer. An unbounded
+ * buffer (capacity 0) grows geometrically instead; growing moves every
+ * element once, like std::vector.
+ *
+ * Element 0 is the oldest. Not thread-safe.
+ *
+ * Usage:
+ *   RingBuffer<int> ring(3);
+ *   for (int i = 0; i < 5; ++i) ring.push_back(i);
+ *   // ring holds 2, 3, 4; ring[0] == 2, ring.back() == 4
+ */
+template <typename T>
+class RingBuffer {
+public:
+    /**
+     * @brief Creates an empty buffer.
+     *
+     * @param capacity Maximum number of elements, or 0 for no limit.
+     */
+    explicit RingBuffer(size_t capacity = 0)
+        : bounded_(capacity > 0) {
+        slots_.resize(capacity);
+    }
+
+    /**
+     * @brief Appends @p value as the newest element.
+     *
+     * @param value The element to append.
+     * @return std::optional<T> The element that was overwritten to make room,
+     * if the buffer was bounded and full.
+     */
+    std::optional<T> push_back(T value) {
+        if (size_ == slots_.size()) {
+            if (bounded_) {
+                std::optional<T> evicted(std::move(slots_[head_]));
+                slots_[head_] = std::move(value);
+                head_ = next(head_);
+                return evicted;
+            }
+            grow();
+        }
+        slots_[wrap(head_ + size_)] = std::move(value);
+        ++size_;
+        return std::nullopt;
+    }
+
+    /**
+     * @brief Removes and returns the oldest element. The buffer must not be
+     * empty.
+     */
+    T pop_front() {
+        T value = std::move(slots_[head_]);
+        slots_[head_] = T{};
+        head_ = next(head_);
+        --size_;
+        return value;
+    }
+
+    /**
+     * @brief Returns the i-th oldest element.
+     */
+    [[nodiscard]] T& operator[](size_t i) {
+        return slots_[wrap(head_ + i)];
+    }
+    [[nodiscard]] const T& operator[](size_t i) const {
+        return slots_[wrap(head_ + i)];
+    }
+
+    [[nodiscard]] T& front() {
+        return (*this)[0];
+    }
+    [[nodiscard]] const T& front() const {
+        return (*this)[0];
+    }
+    [[nodiscard]] T& back() {
+        return (*this)[size_ - 1];
+    }
+    [[nodiscard]] const T& back() const {
+        return (*this)[size_ - 1];
+    }
+
+    [[nodiscard]] size_t size() const {
+        return size_;
+    }
+    [[nodiscard]] bool empty() const {
+        return size_ == 0;
+    }
+
+    /**
+     * @brief Returns the configured capacity (0 for unbounded).
+     */
+    [[nodiscard]] size_t capacity() const {
+        return bounded_ ? slots_.size() : 0;
+    }
+
+    /**
+     * @brief Removes every element, keeping the allocated slots.
+     */
+    void clear() {
+        for (size_t i = 0; i < size_; ++i) {
+            (*this)[i] = T{};
+        }
+        head_ = 0;
+        size_ = 0;
+    }
+
+private:
+    [[nodiscard]] size_t wrap(size_t i) const {
+        return i < slots_.size() ? i : i - slots_.size();
+    }
+    [[nodiscard]] size_t next(size_t i) const {
+        return wrap(i + 1);
+    }
+
+    void grow() {
+        std::vector<T> bigger(slots_.empty() ? 16 : slots_.size() * 2);
+        for (size_t i = 0; i < size_; ++i) {
+            bigger[i] = std::move((*this)[i]);
+        }
+        slots_ = std::move(bigger);
+        head_ = 0;
+    }
+
+    std::vector<T> slots_;
+    size_t head_ = 0;
+    size_t size_ = 0;
+    bool bounded_;
+};
+
+} // namespace memc
@@ -3,9 +3,20 @@
 #include <atomic>
 #include <chrono>
 #include <functional>
+#include <memc/delta.h>
+#include <memc/dispatcher.h>
+#include <memc/growth_tracker.h>
+#include <memc/interval_timer.h>
+#include <memc/proc_handle.h>
 #include <memc/region.h>
+#include <memc/ring_buffer.h>
+#include <memc/smaps_parser.h>
+#include <memc/snapshot_pool.h>
+#include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <optional>
+#include <string>
 #include <thread>
 #include <vector>
 
@@ -19,21 +30,61 @@ namespace memc {
  * - pid: The process ID to monitor.
  * - interval: The time duration between snapshots.
  * - use_smaps: If true, detailed memory statistics are read from smaps.
+ * - numa: If true, per-node residency is joined from numa_maps.
+ * - fields: The smaps detail fields to parse (see SmapsFields); the others
+ *   read as zero. Only used with use_smaps.
  * - max_snapshots: Size of the history ring buffer. 0 implies no limit.
+ * - delta: If true, history keeps one full snapshot plus a SnapshotDelta per
+ *   later sample instead of a full snapshot per sample.
+ * - dispatch: How callbacks are delivered. By default they run on one
+ *   dispatcher thread fed by a 64-sample queue that drops the oldest sample
+ *   when full; threads = 0 runs them on the sampling thread.
+ * - growth: If set, every sample is also fed to a GrowthTracker with this
+ *   configuration, and its alerts go to the on_alert() callbacks.
  */
 struct SamplerConfig {
     pid_t pid;
     std::chrono::milliseconds interval{1000};
     bool use_smaps{false};
+    bool numa{false};
+    SmapsFields fields{};
     size_t max_snapshots{0};
+    bool delta{false};
+    DispatchConfig dispatch{};
+    std::optional<GrowthConfig> growth{};
 };
 
 /// Callback type invoked on each new snapshot.
 using SnapshotCallback = std::function<void(const ProcessSnapshot&)>;
 
+/// Callback type invoked with the delta of each new snapshot (delta mode only).
+using DeltaCallback = std::function<void(const SnapshotDelta&)>;
+
+/// Callback type invoked when a growth rule starts or stops holding.
+using AlertCallback = std::function<void(const GrowthAlert&, const GrowthRule&)>;
+
 /**
  * Periodically samples /proc/<pid>/maps (and optionally smaps)
  * and stores snapshots in a thread-safe ring buffer.
+ *
+ * History entries are immutable snapshots held by shared pointer: pushing
+ * and evicting are O(1) and readers can take SnapshotHandles without copying
+ * any region data. Snapshots come from a SnapshotPool, so with a bounded
+ * history each released snapshot is refilled by a later sample instead of
+ * being freed and reallocated. Callbacks are delivered through a SampleDispatcher on
+ * their own thread, so a slow callback neither delays the next sample nor
+ * blocks readers.
+ *
+ * Samples are taken on an IntervalTimer's absolute deadlines, so the
+ * collection time does not add drift and stop() wakes the thread at once.
+ *
+ * In delta mode only the oldest retained snapshot is stored in full; every
+ * later sample is stored as its SnapshotDelta against the one before it.
+ * Full snapshots are rebuilt on demand by get_snapshots() and reconstruct().
+ *
+ * With SamplerConfig::growth set, the sampling thread also folds each sample
+ * into a GrowthTracker before it is stored; the cost is one pass over the
+ * regions, and alerts are delivered with the sample that raised them.
  */
 class Sampler {
 public:
@@ -54,7 +105,8 @@ public:
     /**
      * @brief Stops the sampling thread.
      *
-     * This method blocks until the background thread has joined.
+     * Wakes the thread immediately and blocks until it has joined and every
+     * queued callback has been delivered.
      */
     void stop();
 
@@ -65,6 +117,26 @@ public:
      */
     void on_snapshot(SnapshotCallback cb);
 
+    /**
+     * @brief Registers a callback to be invoked with each new delta.
+     *
+     * Only called in delta mode, for every sample after the first.
+     *
+     * @param cb The callback function.
+     */
+    void on_delta(DeltaCallback cb);
+
+    /**
+     * @brief Registers a callback to be invoked when a growth rule starts
+     * or stops holding.
+     *
+     * Only called when SamplerConfig::growth is set. Alert callbacks run
+     * before the delta and snapshot callbacks of the same sample.
+     *
+     * @param cb The callback function.
+     */
+    void on_alert(AlertCallback cb);
+
     /**
      * @brief Checks if the sampler is currently running.
      *
@@ -82,7 +154,8 @@ public:
     /**
      * @brief returns all collected snapshots.
      *
-     * This operation is thread-safe and returns a copy of the internal buffer.
+     * This operation is thread-safe and returns a deep copy of the history;
+     * prefer get_snapshot_handles() when copies are not needed.
      *
      * @return std::vector<ProcessSnapshot> Copy of all snapshots.
      */
@@ -91,20 +164,119 @@ public:
     /**
      * @brief Returns the most recent snapshot.
      *
-     * @return std::optional<ProcessSnapshot> The latest snapshot, or std::nullopt
-     * if none exist.
+     * Takes the handle like get_latest_handle() and copies the snapshot
+     * without holding any lock.
+     *
+     * @return std::optional<ProcessSnapshot> A copy of the latest snapshot, or
+     * std::nullopt if none exist.
      */
     [[nodiscard]] std::optional<ProcessSnapshot> get_latest() const;
 
+    /**
+     * @brief Returns handles to every retained snapshot, oldest first.
+     *
+     * Only the pointers are copied. In delta mode all but the latest entry
+     * have to be rebuilt from the stored deltas.
+     *
+     * @return std::vector<SnapshotHandle> The snapshot handles.
+     */
+    [[nodiscard]] std::vector<SnapshotHandle> get_snapshot_handles() const;
+
+    /**
+     * @brief Returns a handle to the most recent snapshot.
+     *
+     * Costs one atomic load of the published pointer and a reference-count
+     * increment. It never takes the history lock, so polling it, even at a
+     * high rate, neither waits for nor delays the sampling thread.
+     *
+     * @return SnapshotHandle The latest snapshot, or nullptr if none exist.
+     */
+    [[nodiscard]] SnapshotHandle get_latest_handle() const;
+
+    /**
+     * @brief Rebuilds the snapshot at a position in the history.
+     *
+     * In delta mode this replays the stored deltas from the oldest retained
+     * snapshot up to @p index.
+     *
+     * @param index Position in the history, 0 being the oldest retained.
+     * @return std::optional<ProcessSnapshot> The snapshot, or std::nullopt if
+     * @p index is out of range.
+     */
+    [[nodiscard]] std::optional<ProcessSnapshot> reconstruct(size_t index) const;
+
+    /**
+     * @brief Returns the stored deltas, oldest first.
+     *
+     * Delta i turns history entry i into entry i + 1. Empty unless the
+     * sampler runs in delta mode.
+     *
+     * @return std::vector<SnapshotDelta> Copy of the stored deltas.
+     */
+    [[nodiscard]] std::vector<SnapshotDelta> get_deltas() const;
+
+    /**
+     * @brief Returns the growth statistics of every tracked series.
+     *
+     * Empty unless SamplerConfig::growth is set. See GrowthTracker::rates().
+     *
+     * @return std::vector<GrowthRate> The statistics.
+     */
+    [[nodiscard]] std::vector<GrowthRate> growth_rates() const;
+
+    /**
+     * @brief Returns the sampling clock's jitter and missed-deadline counts
+     * for the current (or last) run.
+     *
+     * @return TimerStats The timing statistics.
+     */
+    [[nodiscard]] TimerStats timer_stats() const {
+        return timer_.stats();
+    }
+
+    /**
+     * @brief Returns the callback delivery counters, including drops.
+     *
+     * @return DispatchStats The dispatch statistics.
+     */
+    [[nodiscard]] DispatchStats dispatch_stats() const {
+        return dispatcher_.stats();
+    }
+
 private:
     void sample_loop();
-    ProcessSnapshot take_snapshot();
+    void store_snapshot(SnapshotHandle snapshot, std::vector<GrowthAlert> alerts);
+    void store_delta(SnapshotHandle snapshot, std::vector<GrowthAlert> alerts);
+    void notify(SnapshotHandle snapshot, std::optional<SnapshotDelta> delta,
+                std::vector<GrowthAlert> alerts);
+    void deliver(const SampleEvent& event);
+    std::shared_ptr<ProcessSnapshot> take_snapshot();
     SamplerConfig config_;
     std::atomic<bool> running_{false};
+    IntervalTimer timer_;
     std::thread thread_;
+
+    // History, guarded by mutex_. latest_ is only written by the sampling
+    // thread, under mutex_ so that it stays consistent with the history, and
+    // read by get_latest_handle() without the lock.
     mutable std::mutex mutex_;
-    std::vector<ProcessSnapshot> snapshots_;
+    RingBuffer<SnapshotHandle> snapshots_;
+    std::atomic<SnapshotHandle> latest_;
+    std::optional<ProcessSnapshot> base_;
+    RingBuffer<SnapshotDelta> deltas_;
+
+    std::shared_mutex callbacks_mutex_;
     std::vector<SnapshotCallback> callbacks_;
+    std::vector<DeltaCallback> delta_callbacks_;
+    std::vector<AlertCallback> alert_callbacks_;
+
+    // Written by the sampling thread, read by growth_rates().
+    mutable std::mutex growth_mutex_;
+    std::optional<GrowthTracker> growth_;
+    SampleDispatcher dispatcher_;
+    ProcHandle proc_;
+    SnapshotPool pool_;
+    std::string read_buffer_;
 };
 
 } // namespace memc
@@ -0,0 +1,286 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <third_party/nlohmann/json.hpp>
+
+namespace memc {
+
+/**
+ * @brief The timed phases of collecting and emitting a snapshot.
+ *
+ * - READ: open + read + close of one /proc or /sys file, or one
+ *   BatchReader batch of them.
+ * - MAPS_PARSE: MapsParser over a maps file (region classification happens
+ *   while parsing and is included here and in SMAPS_PARSE).
+ * - SMAPS_PARSE: SmapsParser over a smaps or smaps_rollup file.
+ * - ENRICH: Joining a second file onto parsed regions (SmapsParser::enrich,
+ *   numa_maps).
+ * - SERIALIZE: Writing one snapshot, summary, delta or page report as JSON
+ *   or as a binary capture record.
+ */
+enum class StatPhase : uint8_t { READ, MAPS_PARSE, SMAPS_PARSE, ENRICH, SERIALIZE };
+
+/// Number of StatPhase values.
+inline constexpr size_t kStatPhaseCount = static_cast<size_t>(StatPhase::SERIALIZE) + 1;
+
+/**
+ * @brief Converts a StatPhase to its string representation.
+ */
+inline const char* stat_phase_to_string(StatPhase p) {
+    switch (p) {
+    case StatPhase::READ:
+        return "read";
+    case StatPhase::MAPS_PARSE:
+        return "maps_parse";
+    case StatPhase::SMAPS_PARSE:
+        return "smaps_parse";
+    case StatPhase::ENRICH:
+        return "enrich";
+    case StatPhase::SERIALIZE:
+        return "serialize";
+    }
+    return "unknown";
+}
+
+/**
+ * @brief Log2 latency histogram of one phase.
+ *
+ * Bucket b counts durations in [2^(b-1), 2^b) ns (bucket 0 holds 0 ns), so
+ * percentiles are exact to within a factor of two.
+ *
+ * Fields:
+ * - count: Timed calls.
+ * - total_ns: Summed duration of all calls.
+ * - buckets: Calls per power-of-two duration bucket.
+ */
+struct LatencyHistogram {
+    static constexpr size_t kBuckets = 40;
+
+    uint64_t count = 0;
+    uint64_t total_ns = 0;
+    std::array<uint64_t, kBuckets> buckets{};
+
+    [[nodiscard]] double mean_ns() const {
+        return count ? static_cast<double>(total_ns) / static_cast<double>(count) : 0.0;
+    }
+
+    /**
+     * @brief Returns the upper bound of the bucket holding the @p p-th
+     * percentile (0 < p <= 100), or 0 without samples.
+     */
+    [[nodiscard]] uint64_t percentile_ns(double p) const;
+};
+
+/**
+ * @brief memc's own cost: per-phase latencies and work counters.
+ *
+ * The counters are process-wide and cover every collector, sampler and
+ * scanner thread, including threads that have exited. They count from
+ * process start or the last reset_self_stats().
+ *
+ * Fields:
+ * - phases: Latency histogram per StatPhase.
+ * - snapshots: Region snapshots and summaries collected.
+ * - regions: Regions parsed into those snapshots.
+ * - files_read: /proc and /sys files read.
+ * - bytes_read: Bytes read from those files.
+ * - syscalls: open, read, pread, close and io_uring_enter calls made to
+ *   read them.
+ * - allocations: operator new calls; only counted in programs that expand
+ *   MEMC_COUNT_ALLOCATIONS() (the memc CLI does).
+ * - allocations_tracked: True if allocation counting is active.
+ * - interned_strings, interned_bytes: Size of the global StringPool now.
+ *   These are not reset by reset_self_stats().
+ * - interned_dropped: Strings the StringPool could not hold since startup
+ *   (they read back as empty; see StringPool::dropped()).
+ */
+struct SelfStats {
+    std::array<LatencyHistogram, kStatPhaseCount> phases{};
+    uint64_t snapshots = 0;
+    uint64_t regions = 0;
+    uint64_t files_read = 0;
+    uint64_t bytes_read = 0;
+    uint64_t syscalls = 0;
+    uint64_t allocations = 0;
+    bool allocations_tracked = false;
+    uint64_t interned_strings = 0;
+    uint64_t interned_bytes = 0;
+    uint64_t interned_dropped = 0;
+
+    [[nodiscard]] const LatencyHistogram& phase(StatPhase p) const {
+        return phases[static_cast<size_t>(p)];
+    }
+
+    /**
+     * @brief Returns @p total divided by the snapshot count (0 without any).
+     */
+    [[nodiscard]] double per_snapshot(uint64_t total) const {
+        return snapshots ? static_cast<double>(total) / static_cast<double>(snapshots) : 0.0;
+    }
+};
+
+/**
+ * @brief Returns the process-wide self statistics.
+ *
+ * Every thread records into its own counters with plain relaxed stores, so
+ * recording never contends or locks. This call sums the counters of all
+ * live threads and of exited ones; it takes a mutex that is otherwise only
+ * used when a thread first records or exits.
+ */
+[[nodiscard]] SelfStats self_stats();
+
+/**
+ * @brief Makes later self_stats() calls count from now.
+ */
+void reset_self_stats();
+
+namespace detail {
+
+/**
+ * @brief Counts one allocation on the calling thread.
+ */
+void count_allocation() noexcept;
+
+/**
+ * @brief Counts one allocation and allocates @p size bytes aligned to
+ * @p alignment (0 for the default alignment).
+ *
+ * Called by the operator new overloads defined by MEMC_COUNT_ALLOCATIONS().
+ * Defined out of line so the compiler never sees the malloc behind an
+ * operator new next to the free behind the matching operator delete.
+ *
+ * @return void* The memory, or nullptr if it could not be allocated.
+ */
+void* allocate_counted(std::size_t size, std::size_t alignment) noexcept;
+
+/**
+ * @brief Frees memory returned by allocate_counted().
+ */
+void deallocate_counted(void* p) noexcept;
+
+} // namespace detail
+
+/**
+ * @brief Serializes SelfStats as JSON.
+ *
+ * Each phase becomes {"count", "mean_ns", "p50_ns", "p99_ns"}, the string
+ * pool figures go under "interned", and the counters are followed by their
+ * per-snapshot averages.
+ */
+inline void to_json(nlohmann::ordered_json& j, const SelfStats& s) {
+    nlohmann::ordered_json phases = nlohmann::ordered_json::object();
+    for (size_t i = 0; i < kStatPhaseCount; ++i) {
+        const LatencyHistogram& h = s.phases[i];
+        phases[stat_phase_to_string(static_cast<StatPhase>(i))] = {
+            {"count", h.count},
+            {"mean_ns", static_cast<uint64_t>(h.mean_ns())},
+            {"p50_ns", h.percentile_ns(50)},
+            {"p99_ns", h.percentile_ns(99)},
+        };
+    }
+    j["phases"] = std::move(phases);
+    j["snapshots"] = s.snapshots;
+    j["regions"] = s.regions;
+    j["files_read"] = s.files_read;
+    j["bytes_read"] = s.bytes_read;
+    j["syscalls"] = s.syscalls;
+    if (s.allocations_tracked) {
+        j["allocations"] = s.allocations;
+    }
+    j["interned"] = {
+        {"strings", s.interned_strings},
+        {"bytes", s.interned_bytes},
+        {"dropped", s.interned_dropped},
+    };
+    j["per_snapshot"] = {
+        {"regions", s.per_snapshot(s.regions)},
+        {"bytes_read", s.per_snapshot(s.bytes_read)},
+        {"syscalls", s.per_snapshot(s.syscalls)},
+    };
+    if (s.allocations_tracked) {
+        j["per_snapshot"]["allocations"] = s.per_snapshot(s.allocations);
+    }
+}
+
+} // namespace memc
+
+/**
+ * @brief Replaces the global operator new/delete with versions that feed
+ * SelfStats::allocations.
+ *
+ * Covers every replaceable form: plain, array, std::align_val_t and
+ * std::nothrow_t, and the sized deletes. Expand once, at namespace scope, in
+ * one source file of the program (not of a library). Programs that do not
+ * expand it report no allocation counts.
+ */
+#define MEMC_COUNT_ALLOCATIONS()                                                                   \
+    void* operator new(std::size_t size) {                                                         \
+        if (void* p = ::memc::detail::allocate_counted(size, 0))                                   \
+            return p;                                                                              \
+        throw std::bad_alloc();                                                                    \
+    }                                                                                              \
+    void* operator new[](std::size_t size) {                                                       \
+        return ::operator new(size);                                                               \
+    }                                                                                              \
+    void* operator new(std::size_t size, std::align_val_t alignment) {                             \
+        if (void* p = ::memc::detail::allocate_counted(size, static_cast<std::size_t>(alignment))) \
+            return p;                                                                              \
+        throw std::bad_alloc();                                                                    \
+    }                                                                                              \
+    void* operator new[](std::size_t size, std::align_val_t alignment) {                           \
+        return ::operator new(size, alignment);                                                    \
+    }                                                                                              \
+    void* operator new(std::size_t size, const std::nothrow_t&) noexcept {                         \
+        return ::memc::detail::allocate_counted(size, 0);                                          \
+    }                                                                                              \
+    void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {                       \
+        return ::memc::detail::allocate_counted(size, 0);                                          \
+    }                                                                                              \
+    void* operator new(std::size_t size, std::align_val_t alignment,                               \
+                       const std::nothrow_t&) noexcept {                                           \
+        return ::memc::detail::allocate_counted(size, static_cast<std::size_t>(alignment));        \
+    }                                                                                              \
+    void* operator new[](std::size_t size, std::align_val_t alignment,                             \
+                         const std::nothrow_t&) noexcept {                                         \
+        return ::memc::detail::allocate_counted(size, static_cast<std::size_t>(alignment));        \
+    }                                                                                              \
+    void operator delete(void* p) noexcept {                                                       \
+        ::memc::detail::deallocate_counted(p);                                                     \
+    }                                                                                              \
+    void operator delete[](void* p) noexcept {                                                     \
+        ::memc::detail::deallocate_counted(p);                                                     \
+    }                                                                                              \
+    void operator delete(void* p, std::size_t) noexcept {                                          \
+        ::memc::detail::deallocate_counted(p);                                                     \
+    }                                                                                              \
+    void operator delete[](void* p, std::size_t) noexcept {                                        \
+        ::memc::detail::deallocate_counted(p);                                                     \
+    }                                                                                              \
+    void operator delete(void* p, std::align_val_t) noexcept {                                     \
+        ::memc::detail::deallocate_counted(p);                                                     \
+    }                                                                                              \
+    void operator delete[](void* p, std::align_val_t) noexcept {                                   \
+        ::memc::detail::deallocate_counted(p);                                                     \
+    }                                                                                              \
+    void operator delete(void* p, std::size_t, std::align_val_t) noexcept {                        \
+        ::memc::detail::deallocate_counted(p);                                                     \
+    }                                                                                              \
+    void operator delete[](void* p, std::size_t, std::align_val_t) noexcept {                      \
+        ::memc::detail::deallocate_counted(p);                                                     \
+    }                                                                                              \
+    void operator delete(void* p, const std::nothrow_t&) noexcept {                                \
+        ::memc::detail::deallocate_counted(p);                                                     \
+    }                                                                                              \
+    void operator delete[](void* p, const std::nothrow_t&) noexcept {                              \
+        ::memc::detail::deallocate_counted(p);                                                     \
+    }                                                                                              \
+    void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept {              \
+        ::memc::detail::deallocate_counted(p);                                                     \
+    }                                                                                              \
+    void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept {            \
+        ::memc::detail::deallocate_counted(p);                                                     \
+    }
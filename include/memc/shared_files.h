@@ -0,0 +1,157 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memc/region.h>
+#include <sys/types.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace memc {
+
+class PagemapScanner;
+
+/**
+ * @brief What one file (or shared memory segment) costs the system, summed
+ * over every scanned mapping of it.
+ *
+ * Fields:
+ * - device, inode: Identify the file.
+ * - pathname: Path of the first mapping seen.
+ * - processes: Processes mapping the file.
+ * - mappings: Mappings of the file, over all processes.
+ * - mapped_kb: File range mapped by at least one process (the union of the
+ *   mappings' offset ranges).
+ * - rss_kb: Sum of the mappings' RSS. This is what adding up per-process
+ *   figures charges: a page shared by N processes counts N times.
+ * - pss_kb: Sum of the mappings' PSS. Every resident page counts once in
+ *   total, split between the processes that map it, so this is the file's
+ *   true resident cost, exact when all of its mappers were scanned.
+ * - shared_kb: The part of pss_kb in pages mapped more than once.
+ * - private_kb: The part of pss_kb in pages mapped only once, including
+ *   copy-on-write copies of the file made by a single process.
+ * - resident_kb: Distinct resident file pages mapped by the scanned
+ *   processes, read from pagemap. Only counted when the table was fed with a
+ *   PagemapScanner (SharedFileTable::pages_counted()).
+ */
+struct SharedFile {
+    DeviceNumber device;
+    uint64_t inode = 0;
+    InternedString pathname;
+    uint32_t processes = 0;
+    uint32_t mappings = 0;
+    uint64_t mapped_kb = 0;
+    uint64_t rss_kb = 0;
+    uint64_t pss_kb = 0;
+    uint64_t shared_kb = 0;
+    uint64_t private_kb = 0;
+    uint64_t resident_kb = 0;
+};
+
+/**
+ * Aggregates file-backed memory across processes, one entry per file.
+ *
+ * Each add() folds the file mappings (inode != 0) of one snapshot into the
+ * entry of their (device, inode), found through a hash index. Entries keep
+ * the merged offset ranges mapped so far, so the table grows with the number
+ * of distinct files, not with the number of processes or regions; snapshots
+ * can be dropped as soon as they are added. The per-process smaps counters
+ * only show sharing from each process's side; summed per file they tell what
+ * a shared library or shm segment costs as a whole.
+ *
+ * PSS needs snapshots taken with smaps. Fed with a PagemapScanner, the table
+ * also marks every resident file page in a per-file bitmap indexed by file
+ * page, which deduplicates the pages themselves: a page of the page cache
+ * is the same physical frame in every process that maps it.
+ *
+ * Usage:
+ *   SharedFileTable table;
+ *   scanner.scan(pids, [&](ProcessEntry& e) {
+ *       if (e.snapshot) table.add(*e.snapshot);
+ *       return true;
+ *   });
+ *   for (const auto& f : table.files()) { ... f.pss_kb ... }
+ */
+class SharedFileTable {
+public:
+    SharedFileTable();
+
+    /**
+     * @brief Adds the file mappings of one process.
+     *
+     * @param snapshot The process snapshot.
+     */
+    void add(const ProcessSnapshot& snapshot);
+
+    /**
+     * @brief Adds the file mappings of one process and marks their
+     * resident pages from its pagemap.
+     *
+     * @param snapshot The process snapshot.
+     * @param pages A scanner for the same process.
+     * @return true on success; false if pagemap could not be read, in which
+     * case the smaps counters are still added.
+     */
+    bool add(const ProcessSnapshot& snapshot, PagemapScanner& pages);
+
+    /**
+     * @brief Returns every file, highest pss_kb first.
+     *
+     * Ties are ordered by rss_kb, then by device and inode.
+     */
+    [[nodiscard]] std::vector<SharedFile> files() const;
+
+    /**
+     * @brief Returns the number of distinct files seen.
+     */
+    [[nodiscard]] size_t size() const {
+        return entries_.size();
+    }
+
+    /**
+     * @brief Returns true if resident_kb was counted from pagemap.
+     */
+    [[nodiscard]] bool pages_counted() const {
+        return pages_counted_;
+    }
+
+    /**
+     * @brief Forgets every file.
+     */
+    void clear();
+
+private:
+    struct Key {
+        uint32_t device = 0;
+        uint64_t inode = 0;
+
+        bool operator==(const Key&) const = default;
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            return static_cast<size_t>((key.inode * 0x9e3779b97f4a7c15ULL) ^ key.device);
+        }
+    };
+
+    struct Entry {
+        SharedFile file;
+        pid_t last_pid = -1;
+        /// Mapped file pages as sorted, disjoint [first, last) ranges.
+        std::vector<std::pair<uint64_t, uint64_t>> ranges;
+        /// Resident pages by file page index (pagemap only).
+        std::vector<uint64_t> resident;
+    };
+
+    Entry& add_region(const MemoryRegion& region, pid_t pid);
+    static void add_range(Entry& entry, uint64_t first, uint64_t last);
+
+    std::unordered_map<Key, uint32_t, KeyHash> index_;
+    std::vector<Entry> entries_;
+    std::vector<uint64_t> bits_;
+    uint64_t page_size_;
+    bool pages_counted_ = false;
+};
+
+} // namespace memc
@@ -1,18 +1,101 @@
 #pragma once
 
+#include <bit>
+#include <cstdint>
 #include <memc/region.h>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace memc {
 
+class ProcHandle;
+
+/**
+ * @brief A set of smaps detail fields, one bit per MemoryRegion counter.
+ *
+ * Selecting fewer fields makes the smaps parser stop tokenizing a region's
+ * detail lines once every selected key has been seen, and makes JsonWriter
+ * leave the other fields out. Unselected fields read as zero. The mapping
+ * columns of the header line (addresses, permissions, path, ...) are always
+ * parsed. A default-constructed set selects every field.
+ *
+ * Field names, as accepted by parse() and used for --fields, are the JSON
+ * keys without their "_kb" suffix: rss, pss, shared_clean, shared_dirty,
+ * private_clean, private_dirty, swap, swap_pss, locked, anon_huge, shmem_pmd,
+ * file_pmd and thp_eligible.
+ */
+class SmapsFields {
+public:
+    static constexpr uint16_t kRss = 1 << 0;
+    static constexpr uint16_t kPss = 1 << 1;
+    static constexpr uint16_t kSharedClean = 1 << 2;
+    static constexpr uint16_t kSharedDirty = 1 << 3;
+    static constexpr uint16_t kPrivateClean = 1 << 4;
+    static constexpr uint16_t kPrivateDirty = 1 << 5;
+    static constexpr uint16_t kSwap = 1 << 6;
+    static constexpr uint16_t kSwapPss = 1 << 7;
+    static constexpr uint16_t kLocked = 1 << 8;
+    static constexpr uint16_t kAnonHuge = 1 << 9;
+    static constexpr uint16_t kShmemPmd = 1 << 10;
+    static constexpr uint16_t kFilePmd = 1 << 11;
+    static constexpr uint16_t kThpEligible = 1 << 12;
+    static constexpr uint16_t kAll = (1 << 13) - 1;
+
+    constexpr SmapsFields() = default;
+    constexpr SmapsFields(uint16_t bits)
+        : bits_(bits & kAll) {}
+
+    /**
+     * @brief Parses a comma-separated list of field names ("rss,pss,swap").
+     *
+     * @param list The names. "all" selects every field.
+     * @return std::optional<SmapsFields> The set, or std::nullopt if the list
+     * is empty or names an unknown field.
+     */
+    static std::optional<SmapsFields> parse(std::string_view list);
+
+    /**
+     * @brief Returns true if every field in @p bits is selected.
+     */
+    [[nodiscard]] constexpr bool has(uint16_t bits) const {
+        return (bits_ & bits) == bits;
+    }
+
+    /**
+     * @brief Returns true if every field is selected.
+     */
+    [[nodiscard]] constexpr bool all() const {
+        return bits_ == kAll;
+    }
+
+    /**
+     * @brief Returns the number of selected fields.
+     */
+    [[nodiscard]] constexpr unsigned count() const {
+        return static_cast<unsigned>(std::popcount(bits_));
+    }
+
+    [[nodiscard]] constexpr uint16_t bits() const {
+        return bits_;
+    }
+
+    friend constexpr bool operator==(SmapsFields a, SmapsFields b) = default;
+
+private:
+    uint16_t bits_ = kAll;
+};
+
 /**
  * Parses /proc/<pid>/smaps to enrich MemoryRegion with detailed memory info.
  *
  * smaps provides per-region details including RSS, PSS, shared/private pages,
  * swap usage, and more. Each region block starts with a header line identical
  * to /proc/<pid>/maps, followed by key-value detail lines.
+ *
+ * Because every smaps header carries the full maps record, a single pass over
+ * smaps yields complete regions; there is no need to read maps as well.
  */
 class SmapsParser {
 public:
@@ -26,6 +109,32 @@ public:
      */
     static std::optional<std::vector<MemoryRegion>> parse(pid_t pid);
 
+    /**
+     * @brief Parses /proc/<pid>/smaps using caller-owned storage.
+     *
+     * The file is read with pread(2) into @p buffer and parsed in one streaming
+     * pass; header and detail lines are scanned in place.
+     *
+     * @param pid The process ID to parse.
+     * @param buffer Scratch buffer receiving the raw file contents.
+     * @param regions Output vector. It is cleared before parsing.
+     * @return true on success, false if the file could not be read.
+     */
+    static bool parse(pid_t pid, std::string& buffer, std::vector<MemoryRegion>& regions);
+
+    /**
+     * @brief Parses the smaps file of an open ProcHandle.
+     *
+     * Same as parse(pid, buffer, regions), but re-reads the descriptor the
+     * handle keeps open instead of opening the file again.
+     *
+     * @param proc The process to read.
+     * @param buffer Scratch buffer receiving the raw file contents.
+     * @param regions Output vector. It is cleared before parsing.
+     * @return true on success, false if the file could not be read.
+     */
+    static bool parse(ProcHandle& proc, std::string& buffer, std::vector<MemoryRegion>& regions);
+
     /**
      * @brief Parses smaps data from a raw string.
      *
@@ -34,6 +143,20 @@ public:
      */
     static std::vector<MemoryRegion> parse_from_string(const std::string& content);
 
+    /**
+     * @brief Parses smaps data from a view over raw smaps content.
+     *
+     * Parsed regions are appended to @p regions; the content is never copied.
+     * Detail lines of fields outside @p fields are stepped over without
+     * being tokenized, and those fields are left at zero.
+     *
+     * @param content The raw smaps content.
+     * @param regions Output vector the parsed regions are appended to.
+     * @param fields The detail fields to parse.
+     */
+    static void parse_from_view(std::string_view content, std::vector<MemoryRegion>& regions,
+                                SmapsFields fields = {});
+
     /**
      * @brief Enriches existing MemoryRegion objects with smaps data.
      *
@@ -46,14 +169,56 @@ public:
      */
     static bool enrich(pid_t pid, std::vector<MemoryRegion>& regions);
 
+    /**
+     * @brief Parses /proc/<pid>/smaps_rollup into per-process totals.
+     *
+     * smaps_rollup requires Linux 4.14 or newer. Callers that need to support
+     * older kernels should fall back to summing a full smaps parse.
+     *
+     * @param pid The process ID to parse.
+     * @param buffer Scratch buffer receiving the raw file contents.
+     * @param summary The summary to fill. Only the memory totals are written.
+     * @return true on success, false if the file could not be read.
+     */
+    static bool parse_rollup(pid_t pid, std::string& buffer, ProcessSummary& summary);
+
+    /**
+     * @brief Parses the smaps_rollup file of an open ProcHandle.
+     *
+     * @param proc The process to read.
+     * @param buffer Scratch buffer receiving the raw file contents.
+     * @param summary The summary to fill. Only the memory totals are written.
+     * @return true on success, false if the file could not be read.
+     */
+    static bool parse_rollup(ProcHandle& proc, std::string& buffer, ProcessSummary& summary);
+
+    /**
+     * @brief Parses smaps_rollup content from a raw view.
+     *
+     * @param content The raw smaps_rollup content.
+     * @param summary The summary to fill. Only the memory totals are written.
+     */
+    static void parse_rollup_from_view(std::string_view content, ProcessSummary& summary);
+
 private:
     /**
      * @brief Parses a single detail line from smaps and updates the MemoryRegion.
      *
      * @param line The detail line (e.g., "Rss: 1024 kB").
      * @param region The MemoryRegion to update.
+     * @param fields The fields to store; other keys are ignored.
+     * @return true if the line held one of the selected fields.
+     */
+    static bool apply_detail_line(std::string_view line, MemoryRegion& region,
+                                  SmapsFields fields);
+
+    /**
+     * @brief Parses a single smaps_rollup line and updates the summary.
+     *
+     * @param line The detail line (e.g., "Pss_Anon: 512 kB").
+     * @param summary The ProcessSummary to update.
      */
-    static void apply_detail_line(const std::string& line, MemoryRegion& region);
+    static void apply_rollup_line(std::string_view line, ProcessSummary& summary);
 };
 
 } // namespace memc
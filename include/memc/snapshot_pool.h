@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <memc/region.h>
+#include <memory>
+
+namespace memc {
+
+/**
+ * Recycles ProcessSnapshot objects, region storage included, between
+ * samples.
+ *
+ * acquire() hands out an empty snapshot behind a shared pointer. When the
+ * last handle to it is released, on whatever thread, the snapshot is not
+ * freed: its regions are cleared with their capacity kept, and it returns
+ * to the pool together with the memory of its shared-pointer control
+ * block. Once the pool holds an idle snapshot, acquire() allocates nothing,
+ * and a sampler that releases one snapshot per sample (the one evicted from
+ * a bounded history) takes every later sample without touching the heap.
+ *
+ * The region hint passed to acquire() pre-sizes the region vector, so even
+ * a fresh snapshot fills it with one allocation instead of one per growth
+ * step. Per-region numa_kb vectors are not recycled.
+ *
+ * Handles may outlive the pool; snapshots released after it is destroyed
+ * are freed. Thread-safe.
+ *
+ * Usage:
+ *   SnapshotPool pool;
+ *   auto snapshot = pool.acquire(previous_region_count);
+ *   collector.collect_into(*snapshot);
+ *   SnapshotHandle handle = std::move(snapshot);
+ */
+class SnapshotPool {
+public:
+    /// Idle snapshots kept by default; more released at once are freed.
+    static constexpr size_t kDefaultMaxIdle = 4;
+
+    /**
+     * @brief Creates an empty pool.
+     *
+     * @param max_idle Most released snapshots kept for reuse.
+     */
+    explicit SnapshotPool(size_t max_idle = kDefaultMaxIdle);
+    ~SnapshotPool();
+
+    SnapshotPool(const SnapshotPool&) = delete;
+    SnapshotPool& operator=(const SnapshotPool&) = delete;
+
+    /**
+     * @brief Returns an empty snapshot, recycled when one is idle.
+     *
+     * @param region_hint Expected region count, usually that of the previous
+     * snapshot; the region vector is reserved for at least this many.
+     * @return std::shared_ptr<ProcessSnapshot> The snapshot, with pid and
+     * timestamp zeroed and no regions. It converts to a SnapshotHandle once
+     * filled.
+     */
+    [[nodiscard]] std::shared_ptr<ProcessSnapshot> acquire(size_t region_hint = 0);
+
+    /**
+     * @brief Returns the number of idle snapshots ready for reuse.
+     */
+    [[nodiscard]] size_t idle() const;
+
+private:
+    struct State;
+    struct Recycler;
+    template <typename T>
+    struct BlockAllocator;
+
+    std::shared_ptr<State> state_;
+};
+
+} // namespace memc
@@ -0,0 +1,224 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <third_party/nlohmann/json.hpp>
+#include <unordered_map>
+#include <vector>
+
+namespace memc {
+
+/**
+ * Process-wide, thread-safe, append-only string interning table.
+ *
+ * Every distinct string is stored once and identified by a small integer
+ * ID; ID 0 is always the empty string. Interning takes a shared lock on the
+ * hit path and an exclusive lock only for strings never seen before.
+ * Resolving an ID back to its text never locks: entries are published into
+ * fixed-size blocks that are never moved or freed.
+ *
+ * Strings live until the process exits: the pool holds every distinct
+ * string interned since startup, not just the ones mapped now. A long-running
+ * sampler or scanner keeps accumulating pathnames that come and go (deleted
+ * files, memfd and temporary file names), so the pool is capped at
+ * kMaxStrings strings and kMaxBytes bytes of text. Once either cap is
+ * reached, new strings intern as the empty string (ID 0) and are counted by
+ * dropped(), which SelfStats reports; strings already in the pool still
+ * resolve.
+ *
+ * Usage:
+ *   uint32_t id = StringPool::global().intern("/usr/lib/libc.so.6");
+ *   std::string_view path = StringPool::global().lookup(id);
+ */
+class StringPool {
+public:
+    StringPool();
+    ~StringPool();
+
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+
+    /**
+     * @brief Returns the pool shared by every InternedString.
+     */
+    static StringPool& global();
+
+    /**
+     * @brief Returns the ID of @p s, adding it to the pool if new.
+     *
+     * @param s The string to intern.
+     * @return uint32_t The string's ID (0 for the empty string).
+     */
+    uint32_t intern(std::string_view s);
+
+    /**
+     * @brief Returns the text of a previously interned string.
+     *
+     * Lock-free. The returned view is NUL-terminated and stays valid for the
+     * lifetime of the pool.
+     *
+     * @param id An ID returned by intern().
+     * @return std::string_view The string.
+     */
+    [[nodiscard]] std::string_view lookup(uint32_t id) const noexcept {
+        const Entry* block = blocks_[id >> kBlockBits].load(std::memory_order_acquire);
+        const Entry& e = block[id & (kBlockSize - 1)];
+        return {e.data, e.size};
+    }
+
+    /**
+     * @brief Returns the number of distinct strings, including the empty one.
+     */
+    [[nodiscard]] size_t size() const noexcept {
+        return count_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Returns the bytes of string data held by the pool.
+     */
+    [[nodiscard]] size_t bytes() const;
+
+    /**
+     * @brief Returns the number of intern() calls that got ID 0 because the
+     * pool was full.
+     *
+     * A string that keeps being interned after the pool filled up counts
+     * once per call.
+     */
+    [[nodiscard]] uint64_t dropped() const noexcept {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+    /// Most strings the pool holds, including the empty one.
+    static constexpr size_t kMaxStrings = size_t{1} << 24;
+    /// Most bytes of string data (with terminators) the pool holds.
+    static constexpr size_t kMaxBytes = size_t{256} << 20;
+
+private:
+    struct Entry {
+        const char* data;
+        uint32_t size;
+    };
+
+    static constexpr uint32_t kBlockBits = 12;
+    static constexpr uint32_t kBlockSize = 1u << kBlockBits;
+    static constexpr uint32_t kMaxBlocks = kMaxStrings / kBlockSize;
+    static constexpr size_t kArenaChunk = 64 * 1024;
+
+    const char* store(std::string_view s);
+
+    std::array<std::atomic<Entry*>, kMaxBlocks> blocks_{};
+    std::atomic<uint32_t> count_{0};
+    std::atomic<uint64_t> dropped_{0};
+
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<std::string_view, uint32_t> ids_;
+    std::vector<std::unique_ptr<char[]>> arena_;
+    char* arena_pos_ = nullptr;
+    size_t arena_left_ = 0;
+    size_t bytes_ = 0;
+};
+
+/**
+ * @brief A string stored once in the global StringPool.
+ *
+ * Four bytes wide and trivially copyable. Equality between two
+ * InternedStrings compares IDs; comparisons with plain strings, views and
+ * the usual read accessors (empty, size, c_str, conversion to
+ * std::string_view) behave as they would on a std::string holding the
+ * same text, so code written against a std::string member keeps compiling.
+ */
+class InternedString {
+public:
+    InternedString() = default;
+    InternedString(std::string_view s)
+        : id_(StringPool::global().intern(s)) {}
+    InternedString(const std::string& s)
+        : InternedString(std::string_view(s)) {}
+    InternedString(const char* s)
+        : InternedString(std::string_view(s)) {}
+
+    InternedString& operator=(std::string_view s) {
+        return assign(s);
+    }
+    InternedString& operator=(const std::string& s) {
+        return assign(s);
+    }
+    InternedString& operator=(const char* s) {
+        return assign(s);
+    }
+
+    /**
+     * @brief Replaces the contents with @p s.
+     */
+    InternedString& assign(std::string_view s) {
+        id_ = StringPool::global().intern(s);
+        return *this;
+    }
+
+    [[nodiscard]] std::string_view view() const noexcept {
+        return StringPool::global().lookup(id_);
+    }
+    operator std::string_view() const noexcept {
+        return view();
+    }
+    [[nodiscard]] std::string str() const {
+        return std::string(view());
+    }
+    [[nodiscard]] const char* c_str() const noexcept {
+        return view().data();
+    }
+    [[nodiscard]] bool empty() const noexcept {
+        return id_ == 0;
+    }
+    [[nodiscard]] size_t size() const noexcept {
+        return view().size();
+    }
+
+    /**
+     * @brief Returns the ID in the global StringPool.
+     */
+    [[nodiscard]] uint32_t id() const noexcept {
+        return id_;
+    }
+
+    /**
+     * @brief Returns the string with ID @p id, which the global StringPool
+     * must already hold.
+     */
+    [[nodiscard]] static InternedString from_id(uint32_t id) noexcept {
+        InternedString s;
+        s.id_ = id;
+        return s;
+    }
+
+    friend bool operator==(InternedString a, InternedString b) noexcept {
+        return a.id_ == b.id_;
+    }
+    friend bool operator==(InternedString a, std::string_view b) noexcept {
+        return a.view() == b;
+    }
+    friend bool operator==(InternedString a, const std::string& b) noexcept {
+        return a.view() == b;
+    }
+    friend bool operator==(InternedString a, const char* b) noexcept {
+        return a.view() == b;
+    }
+
+private:
+    uint32_t id_ = 0;
+};
+
+/**
+ * @brief Serializes an InternedString as a JSON string.
+ */
+inline void to_json(nlohmann::ordered_json& j, const InternedString& s) {
+    j = s.str();
+}
+
+} // namespace memc
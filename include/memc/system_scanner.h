@@ -0,0 +1,273 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memc/batch_reader.h>
+#include <memc/collector.h>
+#include <memc/region.h>
+#include <memc/thread_pool.h>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace memc {
+
+/**
+ * @brief Configuration for the SystemScanner.
+ *
+ * Fields:
+ * - collector: Per-process collection options (smaps, summary mode, ...).
+ * - jobs: Number of worker threads. 0 selects one per hardware thread.
+ * - skip_kernel: If true, kernel threads with no user-space memory are
+ * dropped from the results.
+ * - read_names: If false, /proc/<pid>/comm is not read and
+ * ProcessEntry::name is left empty.
+ * - incremental: If true, the scanner remembers a fingerprint and the
+ * result of every process between scans, and reports processes whose
+ * fingerprint has not changed as unchanged instead of re-parsing them
+ * (see SystemScanner::scan).
+ * - io_uring: If true, each worker reads the /proc files of several
+ * processes at once through a BatchReader before parsing them one by one.
+ * Falls back to plain reads where io_uring is unavailable.
+ * - runtime_shortcut: If true, incremental maps-only scans report a
+ * single-threaded process whose CPU time (/proc/<pid>/schedstat) has not
+ * moved as unchanged without reading its maps. The process cannot have
+ * changed its mappings, but the maps text can still change under it: a
+ * mapped file unlinked by another process gains " (deleted)". Such changes
+ * are missed until the process runs again.
+ */
+struct ScannerConfig {
+    CollectorConfig collector;
+    size_t jobs = 0;
+    bool skip_kernel = false;
+    bool read_names = true;
+    bool incremental = false;
+    bool io_uring = false;
+    bool runtime_shortcut = false;
+};
+
+/**
+ * @brief The result of scanning a single process.
+ *
+ * Fields:
+ * - pid: Process ID.
+ * - name: Process name from /proc/<pid>/comm.
+ * - skipped: True if the process could not be read (permissions, exited).
+ * - unchanged: Incremental scans only. The process looks exactly as it did
+ *   in the previous scan, so it was not parsed: snapshot, summary and name
+ *   are unset (see SystemScanner::cached_snapshot()).
+ * - exited: Incremental scans only. The process was seen by the previous
+ *   scan and is gone now; every other field except pid is unset.
+ * - snapshot: The region snapshot (unset in summary mode or when skipped).
+ * - summary: The rollup totals (set only in summary mode).
+ */
+struct ProcessEntry {
+    pid_t pid = 0;
+    std::string name;
+    bool skipped = false;
+    bool unchanged = false;
+    bool exited = false;
+    std::optional<ProcessSnapshot> snapshot;
+    std::optional<ProcessSummary> summary;
+};
+
+/**
+ * @brief Serializes a reported ProcessEntry to an ordered JSON object.
+ *
+ * Produces the per-process object used by --all output: pid, name, and
+ * either the "snapshot" or the "summary" object.
+ *
+ * @param j The JSON object to populate.
+ * @param e The ProcessEntry to serialize.
+ */
+inline void to_json(nlohmann::ordered_json& j, const ProcessEntry& e) {
+    j = nlohmann::ordered_json{};
+    j["pid"] = e.pid;
+    j["name"] = e.name;
+    if (e.summary) {
+        nlohmann::ordered_json summary_j;
+        to_json(summary_j, *e.summary);
+        j["summary"] = std::move(summary_j);
+    } else if (e.snapshot) {
+        nlohmann::ordered_json snap_j;
+        to_json(snap_j, *e.snapshot);
+        j["snapshot"] = std::move(snap_j);
+    }
+}
+
+/**
+ * Collects snapshots for many processes in parallel.
+ *
+ * PIDs are spread across a work-stealing ThreadPool. Each worker reuses its
+ * own read buffer and parser scratch space for every process it handles, and
+ * results are handed back strictly in the order of the input PID list, so
+ * the output is deterministic regardless of the worker count.
+ *
+ * Usage:
+ *   SystemScanner scanner({.collector = {.use_smaps = true}, .jobs = 8});
+ *   scanner.scan(enumerate_pids(), [](ProcessEntry& e) {
+ *       // ... consume e ...
+ *       return true;
+ *   });
+ */
+class SystemScanner {
+public:
+    /// Sink invoked once per process, in input order. Return false to cancel.
+    using EntryCallback = std::function<bool(ProcessEntry&)>;
+
+    /**
+     * @brief Constructs a scanner and starts its worker threads.
+     *
+     * @param config Scanner configuration.
+     */
+    explicit SystemScanner(ScannerConfig config = {});
+
+    /**
+     * @brief Scans the given PIDs and streams the results to @p sink.
+     *
+     * The sink runs on the calling thread, in the order of @p pids, as soon as
+     * each entry (and every entry before it) has been collected. Entries are
+     * released after the sink returns, so only the in-flight window is ever
+     * held in memory.
+     *
+     * In incremental mode each process is first fingerprinted by its start
+     * time and virtual size (/proc/<pid>/stat) and a hash of the raw file the
+     * scan would parse (plus numa_maps with CollectorConfig::numa); a process
+     * whose fingerprint matches the previous scan is delivered with
+     * ProcessEntry::unchanged set and is not parsed. A reused PID has a new
+     * start time and is reported as changed. With
+     * ScannerConfig::runtime_shortcut, maps-only scans skip reading the maps
+     * of single-threaded processes that have not run, at the cost of
+     * missing changes made from outside (see there). Once every PID has been
+     * delivered, processes from the previous scan that are no
+     * longer present are delivered as ProcessEntry::exited, in PID order, and
+     * forgotten. Incremental scans therefore expect the same PID universe
+     * (normally enumerate_pids()) every time.
+     *
+     * @param pids The processes to scan.
+     * @param sink Consumer for each result.
+     */
+    void scan(const std::vector<pid_t>& pids, const EntryCallback& sink);
+
+    /**
+     * @brief Scans the given PIDs and returns all results in input order.
+     *
+     * @param pids The processes to scan.
+     * @return std::vector<ProcessEntry> One entry per reported process.
+     */
+    [[nodiscard]] std::vector<ProcessEntry> scan(const std::vector<pid_t>& pids);
+
+    /**
+     * @brief Returns the number of worker threads.
+     *
+     * @return size_t The worker count.
+     */
+    [[nodiscard]] size_t jobs() const {
+        return pool_.size();
+    }
+
+    /**
+     * @brief Returns true if the workers read through io_uring (requested
+     * with ScannerConfig::io_uring and supported by the kernel).
+     */
+    [[nodiscard]] bool uses_io_uring() const {
+        return !states_.empty() && states_.front().reader.uses_io_uring();
+    }
+
+    /**
+     * @brief Returns the last snapshot collected for a process in incremental
+     * mode.
+     *
+     * Not thread-safe against a concurrent scan().
+     *
+     * @param pid The process ID.
+     * @return SnapshotHandle The snapshot, or nullptr if none is cached.
+     */
+    [[nodiscard]] SnapshotHandle cached_snapshot(pid_t pid) const;
+
+    /**
+     * @brief Returns the last summary collected for a process in incremental
+     * summary mode.
+     *
+     * @param pid The process ID.
+     * @return std::optional<ProcessSummary> The summary, or std::nullopt.
+     */
+    [[nodiscard]] std::optional<ProcessSummary> cached_summary(pid_t pid) const;
+
+    /**
+     * @brief Returns the number of processes remembered by incremental mode.
+     */
+    [[nodiscard]] size_t cache_size() const {
+        return cache_.size();
+    }
+
+    /**
+     * @brief Forgets every remembered process; the next incremental scan
+     * reports all of them as changed.
+     */
+    void clear_cache() {
+        cache_.clear();
+    }
+
+private:
+    /// Scratch storage owned by a single worker thread.
+    struct WorkerState {
+        std::string buffer;
+        std::string numa_buffer;
+        std::vector<MemoryRegion> scratch;
+
+        // Files of the worker's next few processes, read ahead in one batch.
+        BatchReader reader;
+        std::vector<BatchRead> prefetched;
+        std::vector<std::string> prefetch_buffers;
+
+        void prefetch(std::span<const pid_t> pids, std::span<const char* const> names);
+        bool read(pid_t pid, const char* name, std::string& out);
+    };
+
+    /// Cheap identity and change detector of one process.
+    struct Fingerprint {
+        uint64_t start_time = 0;
+        uint64_t vsize = 0;
+        uint64_t hash = 0;
+        uint64_t runtime_ns = 0; ///< Single-threaded processes only, else 0.
+        bool present = false;
+        bool readable = false;
+
+        /// Same process with the same contents (runtime is not compared).
+        [[nodiscard]] bool matches(const Fingerprint& other) const {
+            return present == other.present && readable == other.readable &&
+                   start_time == other.start_time && vsize == other.vsize && hash == other.hash;
+        }
+    };
+
+    /// What incremental mode remembers about a process between scans.
+    struct CacheEntry {
+        Fingerprint fingerprint;
+        uint64_t generation = 0;
+        SnapshotHandle snapshot;
+        std::optional<ProcessSummary> summary;
+    };
+
+    void collect(pid_t pid, WorkerState& state, ProcessEntry& entry);
+    void collect_incremental(pid_t pid, WorkerState& state, ProcessEntry& entry,
+                             Fingerprint& fingerprint);
+    bool remember(ProcessEntry& entry, const Fingerprint& fingerprint);
+    bool is_kernel_thread(const ProcessEntry& entry) const;
+
+    ScannerConfig config_;
+    ThreadPool pool_;
+    std::vector<WorkerState> states_;
+    std::array<const char*, 4> prefetch_names_{};
+    size_t prefetch_count_ = 0;
+
+    // Incremental state; only touched by the thread calling scan().
+    std::unordered_map<pid_t, CacheEntry> cache_;
+    uint64_t generation_ = 0;
+};
+
+} // namespace memc
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace memc {
+
+/**
+ * Fixed-size work-stealing thread pool.
+ *
+ * Every worker owns a task deque. Submitted tasks are spread across the
+ * deques round-robin; a worker pops from the front of its own deque and,
+ * once that runs dry, steals from the back of the others. Tasks receive the
+ * index of the worker running them, so callers can keep per-worker state
+ * (read buffers, parser scratch space) without any locking.
+ *
+ * Usage:
+ *   ThreadPool pool(4);
+ *   std::vector<std::string> buffers(pool.size());
+ *   pool.submit([&](size_t worker) { use(buffers[worker]); });
+ */
+class ThreadPool {
+public:
+    /// Task type. The argument is the index of the executing worker.
+    using Task = std::function<void(size_t worker)>;
+
+    /**
+     * @brief Starts the worker threads.
+     *
+     * @param threads Number of workers. 0 selects one per hardware thread.
+     */
+    explicit ThreadPool(size_t threads = 0);
+
+    /**
+     * @brief Drains all queued tasks and joins the workers.
+     */
+    ~ThreadPool();
+
+    // Non-copyable, non-movable (owns threads)
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Returns the number of worker threads.
+     *
+     * @return size_t The worker count; worker indices are [0, size()).
+     */
+    [[nodiscard]] size_t size() const {
+        return threads_.size();
+    }
+
+    /**
+     * @brief Queues a task for execution on one of the workers.
+     *
+     * @param task The task to run.
+     */
+    void submit(Task task);
+
+    /**
+     * @brief Runs @p fn for every index in [0, count) and waits for completion.
+     *
+     * Indices are grouped into contiguous blocks so that each task amortises
+     * its dispatch cost; idle workers steal whole blocks from busy ones.
+     *
+     * @param count Number of indices.
+     * @param fn Callback invoked as fn(index, worker).
+     */
+    void parallel_for(size_t count, const std::function<void(size_t index, size_t worker)>& fn);
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void worker_loop(size_t id);
+    bool try_pop(size_t id, Task& out);
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> threads_;
+    std::atomic<size_t> next_queue_{0};
+    std::atomic<size_t> pending_{0};
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+    bool stopping_ = false;
+};
+
+} // namespace memc
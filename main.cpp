@@ -7,26 +7,97 @@
 
 #include <atomic>
 #include <chrono>
+#include <cerrno>
 #include <csignal>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <memc/binary_format.h>
 #include <memc/cli.h>
 #include <memc/collector.h>
+#include <memc/growth_tracker.h>
+#include <memc/interval_timer.h>
+#include <memc/json_stream.h>
+#include <memc/json_writer.h>
+#include <memc/metrics_server.h>
+#include <memc/metrics_writer.h>
+#include <memc/multi_sampler.h>
+#include <memc/pagemap.h>
+#include <memc/process_selector.h>
 #include <memc/process_utils.h>
+#include <memc/self_stats.h>
+#include <memc/shared_files.h>
+#include <memc/system_scanner.h>
 #include <memc/version.h>
-#include <thread>
+#include <map>
+#include <unordered_map>
+#include <utility>
+
+MEMC_COUNT_ALLOCATIONS()
 
 static std::atomic<bool> g_running{true};
+static std::atomic<memc::IntervalTimer*> g_timer{nullptr};
+static std::atomic<memc::MetricsServer*> g_server{nullptr};
 
 /**
  * @brief Signal handler for SIGINT and SIGTERM.
  *
- * Sets the global running flag to false so sampling loops can exit gracefully.
+ * Sets the global running flag to false so sampling loops can exit
+ * gracefully, and wakes the active sampling timer (or metrics server) so
+ * they do so at once.
  *
  * @param sig The signal number (unused).
  */
 static void signal_handler(int /*sig*/) {
     g_running.store(false);
+    if (auto* timer = g_timer.load()) {
+        timer->stop();
+    }
+    if (auto* server = g_server.load()) {
+        server->stop();
+    }
+}
+
+/**
+ * @brief Starts the sampling clock of a periodic mode.
+ *
+ * Publishes @p timer to the signal handler; a signal that arrived before
+ * publication is honored by stopping the timer straight away.
+ *
+ * @param timer The interval timer driving the sampling loop.
+ */
+static void start_sampling_timer(memc::IntervalTimer& timer) {
+    timer.start();
+    g_timer.store(&timer);
+    if (!g_running.load()) {
+        timer.stop();
+    }
+}
+
+/**
+ * @brief Retires the sampling clock and reports its timing statistics.
+ *
+ * @param timer The interval timer that drove the sampling loop.
+ */
+static void finish_sampling_timer(memc::IntervalTimer& timer) {
+    g_timer.store(nullptr);
+
+    memc::TimerStats stats = timer.stats();
+    if (stats.ticks < 2) {
+        return;
+    }
+    std::cerr << "Timing: jitter mean " << static_cast<int64_t>(stats.mean_jitter_ns / 1000)
+              << "us, max " << stats.max_jitter_ns / 1000 << "us; " << stats.missed
+              << " missed deadline(s)\n";
+}
+
+/**
+ * @brief Prints memc's own SelfStats to stderr as one compact JSON line.
+ */
+static void print_self_stats() {
+    nlohmann::ordered_json j;
+    to_json(j["self_stats"], memc::self_stats());
+    std::cerr << j.dump() << "\n";
 }
 
 /**
@@ -54,72 +125,425 @@ static bool write_output(const std::string& json_str, const std::string& output_
     return true;
 }
 
+/**
+ * @brief Runs the all-processes scan mode with binary output.
+ *
+ * Every collected process snapshot is appended to the capture file in PID
+ * order. Process names and the skipped list are not part of the binary
+ * format and are only reported on stderr as counts. With repeated sweeps
+ * (--count other than 1) each later sweep appends only the processes that
+ * changed.
+ *
+ * @param opts The parsed CLI options.
+ * @return int 0 on success, 1 if the output file could not be written.
+ */
+static int run_all_mode_binary(const memc::CLIOptions& opts) {
+    memc::BinaryWriter bin;
+    if (!bin.open(opts.output_file)) {
+        std::cerr << "Error: could not open '" << opts.output_file << "' for writing\n";
+        return 1;
+    }
+
+    const bool sweeping = opts.count != 1;
+    memc::SystemScanner scanner({
+        .collector = opts.collector_config,
+        .jobs = opts.jobs,
+        .skip_kernel = opts.skip_kernel,
+        .read_names = false,
+        .incremental = sweeping,
+        .io_uring = opts.io_uring,
+    });
+
+    // Filters run on cheap /proc files before any maps or smaps parse.
+    // parse_args() has already checked that the name pattern compiles.
+    const auto selector = memc::ProcessSelector::create(opts.selector_config);
+
+    memc::IntervalTimer timer(std::chrono::milliseconds(opts.collector_config.interval_ms));
+    start_sampling_timer(timer);
+
+    int sweeps = 0;
+    while (timer.wait()) {
+        auto pids = selector->select(memc::enumerate_pids());
+        if (sweeps == 0) {
+            std::cerr << "Scanning " << pids.size() << " processes"
+                      << (opts.collector_config.use_smaps ? " (with smaps)" : "")
+                      << (sweeping ? " every " + std::to_string(opts.collector_config.interval_ms) +
+                                         "ms"
+                                   : "")
+                      << "...\n";
+        }
+
+        size_t collected = 0;
+        size_t skipped = 0;
+        size_t unchanged = 0;
+        scanner.scan(pids, [&](memc::ProcessEntry& entry) {
+            if (entry.exited) {
+                // Not representable in the capture.
+            } else if (entry.unchanged) {
+                unchanged++;
+            } else if (entry.skipped) {
+                skipped++;
+            } else {
+                bin.write(*entry.snapshot);
+                collected++;
+            }
+            return g_running.load();
+        });
+        sweeps++;
+
+        std::cerr << "Collected " << collected << " process snapshots (" << skipped
+                  << " skipped due to permissions"
+                  << (sweeping ? ", " + std::to_string(unchanged) + " unchanged" : "") << ").\n";
+        if (opts.count != 0 && sweeps >= opts.count) {
+            break;
+        }
+    }
+    finish_sampling_timer(timer);
+
+    if (!bin.close()) {
+        std::cerr << "Error: failed writing '" << opts.output_file << "'\n";
+        return 1;
+    }
+    std::cerr << "Written to " << opts.output_file << "\n";
+    return 0;
+}
+
 /**
  * @brief Runs the all-processes scan mode.
  *
- * Enumerates every PID on the system, collects a snapshot for each,
- * and writes the combined result as a single JSON object.
+ * Enumerates every PID on the system, collects a snapshot for each on
+ * a SystemScanner worker pool (--jobs), and streams each process entry to
+ * the output as soon as it is collected, in PID order. Process and skip
+ * counts are written at the end of the document.
+ *
+ * With --count other than 1 the scan repeats every --interval on an
+ * incremental scanner, one document per sweep. The first sweep lists
+ * every process; later sweeps list only processes that changed, the rest
+ * being counted in "unchanged_count", and report exits in "exited_pids".
  *
  * @param opts The parsed CLI options.
- * @return int 0 on success.
+ * @return int 0 on success, 1 if the output file could not be opened.
  */
 static int run_all_mode(const memc::CLIOptions& opts) {
-    auto pids = memc::enumerate_pids();
-    std::cerr << "Scanning " << pids.size() << " processes"
-              << (opts.collector_config.use_smaps ? " (with smaps)" : "") << "...\n";
-
-    nlohmann::ordered_json result;
-    auto now = std::chrono::system_clock::now();
-    result["timestamp_ms"] =
-        std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
-    result["process_count"] = 0;
-    result["processes"] = nlohmann::ordered_json::array();
-    result["skipped_count"] = 0;
-    result["skipped_processes"] = nlohmann::ordered_json::array();
-
-    int collected = 0;
-    int skipped = 0;
-
-    for (pid_t p : pids) {
-        if (!g_running.load())
+    if (opts.format == memc::OutputFormat::BINARY) {
+        return run_all_mode_binary(opts);
+    }
+
+    std::ofstream ofs;
+    if (!opts.output_file.empty()) {
+        ofs.open(opts.output_file);
+        if (!ofs.is_open()) {
+            std::cerr << "Error: could not open '" << opts.output_file << "' for writing\n";
+            return 1;
+        }
+    }
+    std::ostream& out = opts.output_file.empty() ? std::cout : ofs;
+
+    const bool sweeping = opts.count != 1;
+    memc::SystemScanner scanner({
+        .collector = opts.collector_config,
+        .jobs = opts.jobs,
+        .skip_kernel = opts.skip_kernel,
+        .incremental = sweeping,
+        .io_uring = opts.io_uring,
+    });
+
+    // Filters run on cheap /proc files before any maps or smaps parse.
+    // parse_args() has already checked that the name pattern compiles.
+    const auto selector = memc::ProcessSelector::create(opts.selector_config);
+
+    memc::IntervalTimer timer(std::chrono::milliseconds(opts.collector_config.interval_ms));
+    start_sampling_timer(timer);
+
+    int sweeps = 0;
+    while (timer.wait()) {
+        auto pids = selector->select(memc::enumerate_pids());
+        if (sweeps == 0) {
+            std::cerr << "Scanning " << pids.size() << " processes"
+                      << (opts.collector_config.summary_only ? " (summary)"
+                          : opts.collector_config.use_smaps  ? " (with smaps)"
+                                                             : "")
+                      << (sweeping ? " every " + std::to_string(opts.collector_config.interval_ms) +
+                                         "ms"
+                                   : "")
+                      << "...\n";
+        }
+
+        memc::SystemJsonWriter writer(out, opts.collector_config.pretty_json, sweeping,
+                                      opts.collector_config.fields);
+        std::optional<memc::SharedFileTable> files;
+        size_t pages_unread = 0;
+        if (opts.shared_files) {
+            files.emplace();
+        }
+        auto now = std::chrono::system_clock::now();
+        writer.begin(
+            std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count());
+
+        scanner.scan(pids, [&](memc::ProcessEntry& entry) {
+            if (entry.exited) {
+                writer.add_exited(entry.pid);
+            } else if (entry.unchanged) {
+                writer.add_unchanged();
+            } else if (entry.skipped) {
+                writer.add_skipped(entry.pid, std::move(entry.name));
+            } else {
+                if (opts.file_pages) {
+                    memc::PagemapScanner pages(entry.pid);
+                    pages_unread += !files->add(*entry.snapshot, pages);
+                } else if (files) {
+                    files->add(*entry.snapshot);
+                }
+                writer.write_process(entry);
+            }
+            return g_running.load();
+        });
+
+        writer.finish(files ? &*files : nullptr);
+        out << std::endl;
+        sweeps++;
+
+        std::cerr << "Collected " << writer.process_count() << " process snapshots ("
+                  << writer.skipped_count() << " skipped due to permissions";
+        if (sweeping) {
+            std::cerr << ", " << writer.unchanged_count() << " unchanged, "
+                      << writer.exited_count() << " exited";
+        }
+        std::cerr << ").\n";
+        if (files) {
+            std::cerr << "Accounted " << files->size() << " mapped files";
+            if (pages_unread != 0) {
+                std::cerr << " (pagemap unreadable for " << pages_unread << " processes)";
+            }
+            std::cerr << ".\n";
+        }
+
+        if (opts.count != 0 && sweeps >= opts.count) {
             break;
+        }
+    }
+    finish_sampling_timer(timer);
 
-        memc::DataCollector collector(p, opts.collector_config);
-        auto snapshot = collector.collect_once();
-        if (!snapshot) {
-            skipped++;
-            nlohmann::ordered_json skipped_entry;
-            skipped_entry["pid"] = p;
-            skipped_entry["name"] = memc::get_process_name(p);
-            result["skipped_processes"].push_back(std::move(skipped_entry));
-            continue;
+    if (!opts.output_file.empty()) {
+        std::cerr << "Written to " << opts.output_file << "\n";
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Runs the single-PID summary mode (one-shot or periodic sampling).
+ *
+ * Same cadence rules as run_single_pid, but each sample is a ProcessSummary
+ * read from smaps_rollup.
+ *
+ * @param opts The parsed CLI options.
+ * @param collector The collector bound to the target PID.
+ * @return int 0 on success, 1 on failure.
+ */
+static int run_single_pid_summary(const memc::CLIOptions& opts, memc::DataCollector& collector) {
+    if (opts.count == 1) {
+        auto summary = collector.collect_summary();
+        if (!summary) {
+            std::cerr << "Error: failed to read /proc/" << opts.pid << "/smaps_rollup\n"
+                      << "Check that the process exists and you have permission.\n";
+            return 1;
+        }
+        write_output(collector.to_json(*summary), opts.output_file);
+        return 0;
+    }
+
+    bool continuous = (opts.count == 0);
+    int samples_taken = 0;
+
+    std::cerr << "Sampling PID " << opts.pid << " totals every "
+              << opts.collector_config.interval_ms << "ms"
+              << (continuous ? " (Ctrl+C to stop)" : "") << "...\n";
+
+    memc::IntervalTimer timer(std::chrono::milliseconds(opts.collector_config.interval_ms));
+    start_sampling_timer(timer);
+
+    while (timer.wait()) {
+        auto summary = collector.collect_summary();
+        if (!summary) {
+            std::cerr << "Warning: failed to read process " << opts.pid
+                      << " — it may have exited.\n";
+            break;
         }
 
-        if (opts.skip_kernel && snapshot->regions.empty()) {
+        std::cout << collector.to_json(*summary) << std::endl;
+        samples_taken++;
+
+        if (!continuous && samples_taken >= opts.count) {
+            break;
+        }
+    }
+
+    finish_sampling_timer(timer);
+    std::cerr << "Collected " << samples_taken << " summary sample(s).\n";
+    return 0;
+}
+
+/**
+ * @brief Runs the single-PID page residency mode (--pagemap / --idle).
+ *
+ * Each sample re-reads the region list and decodes the pagemap entries of
+ * its heap and anonymous regions. With --idle the first scan only marks
+ * the pages idle and is not printed, so even a single report (--count 1)
+ * shows which pages were touched during one --interval.
+ *
+ * @param opts The parsed CLI options.
+ * @param collector The collector bound to the target PID.
+ * @return int 0 on success, 1 on failure.
+ */
+static int run_single_pid_pagemap(const memc::CLIOptions& opts, memc::DataCollector& collector) {
+    bool priming = opts.track_idle;
+    if (priming && !memc::PagemapScanner::idle_tracking_supported()) {
+        std::cerr << "Warning: /sys/kernel/mm/page_idle/bitmap is not available; "
+                     "reporting residency only.\n";
+        priming = false;
+    }
+
+    memc::PagemapScanner pages(opts.pid, {.track_idle = priming});
+    memc::ProcessSnapshot snapshot{};
+    memc::PageReport report;
+    memc::JsonWriter writer(opts.collector_config.pretty_json);
+    bool continuous = (opts.count == 0);
+    int samples_taken = 0;
+
+    if (priming || opts.count != 1) {
+        std::cerr << "Sampling PID " << opts.pid << " pages every "
+                  << opts.collector_config.interval_ms << "ms"
+                  << (continuous ? " (Ctrl+C to stop)" : "") << "...\n";
+    }
+
+    memc::IntervalTimer timer(std::chrono::milliseconds(opts.collector_config.interval_ms));
+    start_sampling_timer(timer);
+
+    int status = 0;
+    while (timer.wait()) {
+        if (!collector.collect_into(snapshot) || !pages.scan(snapshot.regions, report)) {
+            if (samples_taken == 0) {
+                std::cerr << "Error: failed to read /proc/" << opts.pid << "/pagemap\n"
+                          << "Check that the process exists and you have permission.\n";
+                status = 1;
+            } else {
+                std::cerr << "Warning: failed to read process " << opts.pid
+                          << " — it may have exited.\n";
+            }
+            break;
+        }
+        if (priming) {
+            priming = false;
             continue;
         }
 
-        nlohmann::ordered_json proc_entry;
-        proc_entry["pid"] = p;
-        proc_entry["name"] = memc::get_process_name(p);
-        nlohmann::ordered_json snap_j;
-        memc::to_json(snap_j, *snapshot);
-        proc_entry["snapshot"] = std::move(snap_j);
+        writer.clear();
+        writer.write(report);
+        if (opts.count == 1) {
+            write_output(std::string(writer.view()), opts.output_file);
+        } else {
+            std::cout << writer.view() << std::endl;
+        }
+        samples_taken++;
 
-        result["processes"].push_back(std::move(proc_entry));
-        collected++;
+        if (!continuous && samples_taken >= opts.count) {
+            break;
+        }
     }
 
-    result["process_count"] = collected;
-    result["skipped_count"] = skipped;
+    finish_sampling_timer(timer);
+    if (opts.count != 1) {
+        std::cerr << "Collected " << samples_taken << " page report(s).\n";
+    }
+    return status;
+}
 
-    std::cerr << "Collected " << collected << " process snapshots (" << skipped
-              << " skipped due to permissions).\n";
+/**
+ * @brief Writes one growth alert as a JSON object.
+ *
+ * @param writer The writer to append to.
+ * @param alert The alert.
+ * @param rule The rule that raised it.
+ */
+static void write_alert(memc::JsonWriter& writer, const memc::GrowthAlert& alert,
+                        const memc::GrowthRule& rule) {
+    writer.begin_object();
+    writer.key("pid");
+    writer.value(static_cast<int64_t>(alert.pid));
+    writer.key("timestamp_ms");
+    writer.value(alert.timestamp_ms);
+    writer.key("alert");
+    writer.value(std::string_view(rule.name));
+    writer.key("state");
+    writer.value(std::string_view(alert.firing ? "firing" : "resolved"));
+    writer.key("rate_kb_per_min");
+    writer.value(static_cast<int64_t>(alert.rate_kb_per_min));
+    writer.key("value_kb");
+    writer.value(alert.value_kb);
+    writer.end_object();
+}
 
-    std::string json_str = opts.collector_config.pretty_json ? result.dump(2) : result.dump();
-    write_output(json_str, opts.output_file);
+/**
+ * @brief Runs the single-PID growth alert mode (--alert).
+ *
+ * Samples like the periodic snapshot mode, but feeds every snapshot to a
+ * GrowthTracker instead of printing it; only the alerts, raised when a
+ * rule starts or stops holding, reach stdout.
+ *
+ * @param opts The parsed CLI options.
+ * @param collector The collector bound to the target PID.
+ * @return int 0 on success, 1 on failure.
+ */
+static int run_single_pid_alerts(const memc::CLIOptions& opts, memc::DataCollector& collector) {
+    memc::GrowthTracker tracker(opts.growth);
+    memc::ProcessSnapshot snapshot{};
+    std::vector<memc::GrowthAlert> alerts;
+    memc::JsonWriter writer(opts.collector_config.pretty_json);
+    bool continuous = (opts.count == 0);
+    int samples_taken = 0;
+    size_t alerts_raised = 0;
 
-    return 0;
+    std::cerr << "Watching PID " << opts.pid << " every " << opts.collector_config.interval_ms
+              << "ms for " << opts.growth.rules.size() << " alert rule(s)"
+              << (continuous ? " (Ctrl+C to stop)" : "") << "...\n";
+
+    memc::IntervalTimer timer(std::chrono::milliseconds(opts.collector_config.interval_ms));
+    start_sampling_timer(timer);
+
+    int status = 0;
+    while (timer.wait()) {
+        if (!collector.collect_into(snapshot)) {
+            if (samples_taken == 0) {
+                std::cerr << "Error: failed to read /proc/" << opts.pid << "/smaps\n"
+                          << "Check that the process exists and you have permission.\n";
+                status = 1;
+            } else {
+                std::cerr << "Warning: failed to read process " << opts.pid
+                          << " — it may have exited.\n";
+            }
+            break;
+        }
+
+        alerts.clear();
+        tracker.update(snapshot, alerts);
+        for (const auto& alert : alerts) {
+            writer.clear();
+            write_alert(writer, alert, opts.growth.rules[alert.rule]);
+            std::cout << writer.view() << std::endl;
+        }
+        alerts_raised += alerts.size();
+        samples_taken++;
+
+        if (!continuous && samples_taken >= opts.count) {
+            break;
+        }
+    }
+
+    finish_sampling_timer(timer);
+    std::cerr << "Collected " << samples_taken << " snapshot(s), " << alerts_raised
+              << " alert(s).\n";
+    return status;
 }
 
 /**
@@ -134,6 +558,22 @@ static int run_all_mode(const memc::CLIOptions& opts) {
 static int run_single_pid(const memc::CLIOptions& opts) {
     memc::DataCollector collector(opts.pid, opts.collector_config);
 
+    if (opts.collector_config.summary_only) {
+        return run_single_pid_summary(opts, collector);
+    }
+    if (opts.pagemap) {
+        return run_single_pid_pagemap(opts, collector);
+    }
+    if (!opts.growth.rules.empty()) {
+        return run_single_pid_alerts(opts, collector);
+    }
+
+    memc::BinaryWriter bin;
+    if (opts.format == memc::OutputFormat::BINARY && !bin.open(opts.output_file)) {
+        std::cerr << "Error: could not open '" << opts.output_file << "' for writing\n";
+        return 1;
+    }
+
     if (opts.count == 1) {
         auto snapshot = collector.collect_once();
         if (!snapshot) {
@@ -141,7 +581,12 @@ static int run_single_pid(const memc::CLIOptions& opts) {
                       << "Check that the process exists and you have permission.\n";
             return 1;
         }
-        write_output(collector.to_json(*snapshot), opts.output_file);
+        if (bin.is_open()) {
+            bin.write(*snapshot);
+            std::cerr << "Written to " << opts.output_file << "\n";
+        } else {
+            write_output(collector.to_json(*snapshot), opts.output_file);
+        }
     } else {
         bool continuous = (opts.count == 0);
         int samples_taken = 0;
@@ -150,31 +595,203 @@ static int run_single_pid(const memc::CLIOptions& opts) {
                   << "ms" << (opts.collector_config.use_smaps ? " (with smaps)" : "")
                   << (continuous ? " (Ctrl+C to stop)" : "") << "...\n";
 
-        while (g_running.load()) {
-            auto snapshot = collector.collect_once();
-            if (!snapshot) {
-                std::cerr << "Warning: failed to read process " << opts.pid
-                          << " — it may have exited.\n";
-                break;
+        // One snapshot and one output buffer are refilled by every sample, so
+        // steady-state sampling does not allocate for either.
+        memc::ProcessSnapshot snapshot{};
+        memc::JsonWriter writer(opts.collector_config.pretty_json, 0, opts.collector_config.fields);
+        auto emit_snapshot = [&](const memc::ProcessSnapshot& s) {
+            if (bin.is_open()) {
+                bin.write(s);
+            } else {
+                writer.clear();
+                writer.write(s);
+                std::cout << writer.view() << std::endl;
             }
+        };
+
+        memc::IntervalTimer timer(std::chrono::milliseconds(opts.collector_config.interval_ms));
+        start_sampling_timer(timer);
+
+        while (timer.wait()) {
+            if (opts.collector_config.delta) {
+                auto delta = collector.collect_delta();
+                if (!delta) {
+                    std::cerr << "Warning: failed to read process " << opts.pid
+                              << " — it may have exited.\n";
+                    break;
+                }
 
-            std::cout << collector.to_json(*snapshot) << std::endl;
+                // The first sample has no base to diff against; emit it in full.
+                if (samples_taken == 0) {
+                    emit_snapshot(*collector.current_snapshot());
+                } else if (bin.is_open()) {
+                    bin.write(*delta);
+                } else {
+                    std::cout << collector.to_json(*delta) << std::endl;
+                }
+            } else {
+                if (!collector.collect_into(snapshot)) {
+                    std::cerr << "Warning: failed to read process " << opts.pid
+                              << " — it may have exited.\n";
+                    break;
+                }
+                emit_snapshot(snapshot);
+            }
             samples_taken++;
 
             if (!continuous && samples_taken >= opts.count) {
                 break;
             }
+        }
+
+        finish_sampling_timer(timer);
+        std::cerr << "Collected " << samples_taken << " snapshot(s).\n";
+        if (bin.is_open()) {
+            std::cerr << "Written to " << opts.output_file << "\n";
+        }
+    }
+
+    return bin.close() ? 0 : 1;
+}
+
+/**
+ * @brief Runs the convert mode: binary capture back to JSON.
+ *
+ * Every frame in the capture is written as one JSON document followed by
+ * a newline, the same stream a JSON-format sampling run produces. Delta
+ * frames are expanded back into full snapshots unless --delta is given, in
+ * which case they are written as deltas.
+ *
+ * @param opts The parsed CLI options.
+ * @return int 0 on success, 1 on failure.
+ */
+static int run_convert(const memc::CLIOptions& opts) {
+    auto reader = memc::BinaryReader::open(opts.convert_input);
+    if (!reader) {
+        std::cerr << "Error: '" << opts.convert_input << "' is not a readable memc capture\n";
+        return 1;
+    }
+
+    std::ofstream ofs;
+    if (!opts.output_file.empty()) {
+        ofs.open(opts.output_file);
+        if (!ofs.is_open()) {
+            std::cerr << "Error: could not open '" << opts.output_file << "' for writing\n";
+            return 1;
+        }
+    }
+    std::ostream& out = opts.output_file.empty() ? std::cout : ofs;
+
+    memc::JsonWriter writer(opts.collector_config.pretty_json);
+    std::unordered_map<pid_t, memc::ProcessSnapshot> current;
+    for (size_t i = 0; i < reader->size(); ++i) {
+        writer.clear();
+        if (!reader->is_delta(i)) {
+            auto snapshot = reader->snapshot(i).to_snapshot();
+            writer.write(snapshot);
+            if (!opts.collector_config.delta) {
+                current[snapshot.pid] = std::move(snapshot);
+            }
+        } else if (opts.collector_config.delta) {
+            writer.write(reader->delta(i).to_delta());
+        } else {
+            auto delta = reader->delta(i).to_delta();
+            auto it = current.find(delta.pid);
+            if (it == current.end() || !memc::apply_delta(it->second, delta)) {
+                std::cerr << "Error: frame " << i << " does not follow its base snapshot\n";
+                return 1;
+            }
+            writer.write(it->second);
+        }
+        out << writer.view() << '\n';
+    }
+    out.flush();
+
+    std::cerr << "Converted " << reader->size() << " snapshot(s).\n";
+    if (!opts.output_file.empty()) {
+        std::cerr << "Written to " << opts.output_file << "\n";
+    }
+    return out.good() ? 0 : 1;
+}
+
+/**
+ * @brief Runs the serve mode: a Prometheus exporter.
+ *
+ * A MultiSampler collects smaps of the selected processes (or of one PID)
+ * every --interval, parsing only the RSS, PSS and swap lines the report
+ * uses. After each round the whole report is rendered once and
+ * published to the MetricsServer, which answers every scrape from that
+ * buffer on the main thread until SIGINT or SIGTERM. Kernel threads are
+ * always skipped, having no memory to report. Process names are cached by
+ * (pid, start time), read from stat every round, so a reused PID gets its own
+ * name. comm is read when a key first appears and the name is forgotten when
+ * the key leaves the report.
+ *
+ * @param opts The parsed CLI options.
+ * @return int 0 on success, 1 if the address cannot be bound.
+ */
+static int run_serve(const memc::CLIOptions& opts) {
+    memc::MetricsServer server({.listen = opts.listen});
+    if (!server.listen()) {
+        std::cerr << "Error: could not listen on '" << opts.listen << "': " << std::strerror(errno)
+                  << "\n";
+        return 1;
+    }
+
+    // Only touched on the sampler's timer thread, which stops before these go.
+    memc::MetricsWriter writer;
+    std::map<std::pair<pid_t, uint64_t>, std::string> names;
+    std::string buffer;
 
-            auto deadline = std::chrono::steady_clock::now() +
-                            std::chrono::milliseconds(opts.collector_config.interval_ms);
-            while (g_running.load() && std::chrono::steady_clock::now() < deadline) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    memc::ProcessSelector::Config selector = opts.selector_config;
+    selector.skip_kernel = true;
+    memc::MultiSampler sampler({
+        .interval = std::chrono::milliseconds(opts.collector_config.interval_ms),
+        .use_smaps = true,
+        .fields = memc::SmapsFields::kRss | memc::SmapsFields::kPss | memc::SmapsFields::kSwap,
+        .jobs = opts.jobs,
+        .selector = opts.pid != 0 ? std::nullopt : memc::ProcessSelector::create(selector),
+    });
+    if (opts.pid != 0) {
+        sampler.add_pid(opts.pid);
+    }
+
+    sampler.on_round([&](const std::vector<memc::SnapshotHandle>& snapshots) {
+        auto name = names.begin();
+        for (const auto& snapshot : snapshots) {
+            uint64_t start_time = 0;
+            memc::get_process_start_time(snapshot->pid, buffer, start_time);
+            const std::pair key(snapshot->pid, start_time);
+            while (name != names.end() && name->first < key) {
+                name = names.erase(name);
+            }
+            if (name == names.end() || name->first != key) {
+                name = names.emplace_hint(name, key, memc::get_process_name(snapshot->pid, buffer));
             }
+            writer.add(*snapshot, name->second);
+            ++name;
         }
+        names.erase(name, names.end());
 
-        std::cerr << "Collected " << samples_taken << " snapshot(s).\n";
+        server.publish(writer.render());
+        writer.clear();
+    });
+
+    std::cerr << "Serving metrics on port " << server.port() << " at /metrics, collecting every "
+              << opts.collector_config.interval_ms << "ms (Ctrl+C to stop)...\n";
+
+    g_server.store(&server);
+    if (!g_running.load()) {
+        server.stop();
     }
+    sampler.start();
+    server.run();
+    g_server.store(nullptr);
+    sampler.stop();
 
+    memc::MetricsServerStats stats = server.stats();
+    std::cerr << "Served " << stats.scrapes << " scrape(s) over " << stats.connections
+              << " connection(s).\n";
     return 0;
 }
 
@@ -182,7 +799,7 @@ static int run_single_pid(const memc::CLIOptions& opts) {
  * @brief Entry point for the memc CLI.
  *
  * Parses arguments, sets up signal handlers, and dispatches to
- * either all-process scan or single-PID mode.
+ * convert, serve, all-process scan or single-PID mode.
  *
  * @param argc The argument count.
  * @param argv The argument vector.
@@ -213,8 +830,19 @@ int main(int argc, char* argv[]) {
     std::signal(SIGINT, signal_handler);
     std::signal(SIGTERM, signal_handler);
 
-    if (opts.all_mode) {
-        return run_all_mode(opts);
+    int rc = 0;
+    if (!opts.convert_input.empty()) {
+        rc = run_convert(opts);
+    } else if (opts.serve) {
+        rc = run_serve(opts);
+    } else if (opts.all_mode) {
+        rc = run_all_mode(opts);
+    } else {
+        rc = run_single_pid(opts);
+    }
+
+    if (opts.self_stats) {
+        print_self_stats();
     }
-    return run_single_pid(opts);
+    return rc;
 }
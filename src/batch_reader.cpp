@@ -0,0 +1,387 @@
+#include "self_stats_internal.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <memc/batch_reader.h>
+#include <memc/process_utils.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+
+namespace memc {
+
+namespace {
+
+constexpr size_t kInitialBufferSize = 4096;
+
+int io_uring_setup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+int io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return static_cast<int>(
+        ::syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+int io_uring_register(int fd, unsigned opcode, void* arg, unsigned nr_args) {
+    return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+}
+
+/**
+ * @brief Returns true if the ring behind @p fd supports openat, read and
+ * close.
+ */
+bool probe_ops(int fd) {
+    constexpr unsigned kOps = 256;
+    std::vector<unsigned char> storage(sizeof(io_uring_probe) + kOps * sizeof(io_uring_probe_op));
+    auto* probe = reinterpret_cast<io_uring_probe*>(storage.data());
+    if (io_uring_register(fd, IORING_REGISTER_PROBE, probe, kOps) < 0)
+        return false;
+    auto supported = [&](unsigned op) {
+        return op <= probe->last_op && (probe->ops[op].flags & IO_URING_OP_SUPPORTED);
+    };
+    return supported(IORING_OP_OPENAT) && supported(IORING_OP_READ) &&
+           supported(IORING_OP_CLOSE);
+}
+
+} // namespace
+
+/**
+ * @brief The mapped submission and completion rings of one io_uring.
+ *
+ * Only the thread owning the BatchReader touches it. The CQ tail is
+ * written by the kernel and read with acquire loads; the SQ tail and CQ
+ * head are written here and published with release stores.
+ */
+struct BatchReader::Ring {
+    int fd = -1;
+    unsigned entries = 0;
+    void* rings = MAP_FAILED;
+    size_t rings_len = 0;
+    io_uring_sqe* sqes = nullptr;
+    size_t sqes_len = 0;
+
+    unsigned* sq_tail = nullptr;
+    unsigned* sq_mask = nullptr;
+    unsigned* sq_array = nullptr;
+    unsigned* cq_head = nullptr;
+    unsigned* cq_tail = nullptr;
+    unsigned* cq_mask = nullptr;
+    io_uring_cqe* cqes = nullptr;
+    unsigned queued = 0;
+
+    // Per-file state of the chunk in flight.
+    std::vector<std::array<char, 64>> paths;
+    std::vector<int> fds;
+    std::vector<size_t> lens;
+    std::vector<unsigned> pending;
+
+    ~Ring();
+
+    bool setup(unsigned depth);
+    io_uring_sqe& push(uint8_t opcode, uint64_t user_data);
+
+    template <typename OnComplete>
+    bool run(unsigned count, OnComplete&& on_complete);
+};
+
+/**
+ * @brief Unmaps the rings and closes the io_uring descriptor.
+ */
+BatchReader::Ring::~Ring() {
+    if (sqes)
+        ::munmap(sqes, sqes_len);
+    if (rings != MAP_FAILED)
+        ::munmap(rings, rings_len);
+    if (fd >= 0)
+        ::close(fd);
+}
+
+/**
+ * @brief Creates the io_uring and maps its rings.
+ *
+ * Requires IORING_FEAT_SINGLE_MMAP (Linux 5.4) so both rings share one
+ * mapping, and the openat/read/close operations (Linux 5.6).
+ *
+ * @return true on success, false if io_uring is unavailable.
+ */
+bool BatchReader::Ring::setup(unsigned depth) {
+    io_uring_params params{};
+    fd = io_uring_setup(depth, &params);
+    if (fd < 0)
+        return false;
+    if (!(params.features & IORING_FEAT_SINGLE_MMAP) || !probe_ops(fd))
+        return false;
+
+    entries = params.sq_entries;
+    rings_len = std::max(params.sq_off.array + params.sq_entries * sizeof(unsigned),
+                         params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+    rings = ::mmap(nullptr, rings_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                   IORING_OFF_SQ_RING);
+    if (rings == MAP_FAILED)
+        return false;
+    sqes_len = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes_map = ::mmap(nullptr, sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                            fd, IORING_OFF_SQES);
+    if (sqes_map == MAP_FAILED)
+        return false;
+    sqes = static_cast<io_uring_sqe*>(sqes_map);
+
+    auto* base = static_cast<char*>(rings);
+    sq_tail = reinterpret_cast<unsigned*>(base + params.sq_off.tail);
+    sq_mask = reinterpret_cast<unsigned*>(base + params.sq_off.ring_mask);
+    sq_array = reinterpret_cast<unsigned*>(base + params.sq_off.array);
+    cq_head = reinterpret_cast<unsigned*>(base + params.cq_off.head);
+    cq_tail = reinterpret_cast<unsigned*>(base + params.cq_off.tail);
+    cq_mask = reinterpret_cast<unsigned*>(base + params.cq_off.ring_mask);
+    cqes = reinterpret_cast<io_uring_cqe*>(base + params.cq_off.cqes);
+    return true;
+}
+
+/**
+ * @brief Queues one submission and returns it for the caller to fill.
+ *
+ * Callers never queue more than @c entries submissions per run(), so the
+ * ring cannot be full.
+ */
+io_uring_sqe& BatchReader::Ring::push(uint8_t opcode, uint64_t user_data) {
+    unsigned tail = *sq_tail + queued;
+    unsigned index = tail & *sq_mask;
+    io_uring_sqe& sqe = sqes[index];
+    std::memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = opcode;
+    sqe.user_data = user_data;
+    sq_array[index] = index;
+    ++queued;
+    return sqe;
+}
+
+/**
+ * @brief Submits the queued submissions and waits for @p count completions.
+ *
+ * @param count Completions to wait for (the number of queued submissions).
+ * @param on_complete Called as on_complete(user_data, res) per completion.
+ * @return true on success, false if io_uring_enter(2) failed.
+ */
+template <typename OnComplete>
+bool BatchReader::Ring::run(unsigned count, OnComplete&& on_complete) {
+    std::atomic_ref<unsigned>(*sq_tail).store(*sq_tail + queued, std::memory_order_release);
+    unsigned to_submit = queued;
+    queued = 0;
+
+    unsigned completed = 0;
+    uint64_t syscalls = 0;
+    while (completed < count) {
+        unsigned head = *cq_head;
+        unsigned tail = std::atomic_ref<unsigned>(*cq_tail).load(std::memory_order_acquire);
+        if (head == tail || to_submit > 0) {
+            int ret = io_uring_enter(fd, to_submit, count - completed, IORING_ENTER_GETEVENTS);
+            ++syscalls;
+            if (ret < 0) {
+                if (errno == EINTR)
+                    continue;
+                detail::stat_add(detail::StatCounter::SYSCALLS, syscalls);
+                return false;
+            }
+            to_submit -= std::min<unsigned>(to_submit, static_cast<unsigned>(ret));
+            tail = std::atomic_ref<unsigned>(*cq_tail).load(std::memory_order_acquire);
+        }
+        for (; head != tail; ++head, ++completed) {
+            const io_uring_cqe& cqe = cqes[head & *cq_mask];
+            on_complete(cqe.user_data, cqe.res);
+        }
+        std::atomic_ref<unsigned>(*cq_head).store(head, std::memory_order_release);
+    }
+    detail::stat_add(detail::StatCounter::SYSCALLS, syscalls);
+    return true;
+}
+
+BatchReader::BatchReader() = default;
+
+/**
+ * @brief Destructor. Tears down the ring.
+ */
+BatchReader::~BatchReader() = default;
+
+/**
+ * @brief Returns true if this kernel lets the process use io_uring with the
+ * operations BatchReader needs.
+ */
+bool BatchReader::io_uring_supported() {
+    Ring ring;
+    return ring.setup(2);
+}
+
+/**
+ * @brief Sets up the io_uring instance.
+ *
+ * @param depth Ring entries (files in flight per round).
+ * @return true if io_uring is in use, false if read() will fall back to
+ * plain system calls.
+ */
+bool BatchReader::open(unsigned depth) {
+    auto ring = std::make_unique<Ring>();
+    if (!ring->setup(std::max(depth, 1u))) {
+        ring_.reset();
+        return false;
+    }
+    ring_ = std::move(ring);
+    return true;
+}
+
+/**
+ * @brief Tears down the ring; later reads use plain system calls.
+ */
+void BatchReader::close() {
+    ring_.reset();
+}
+
+/**
+ * @brief Reads every file of @p reads and sets its BatchRead::ok.
+ *
+ * Files are processed in chunks of at most one ring's worth. If the ring
+ * fails, it is torn down and the current and remaining chunks are read
+ * with plain system calls.
+ *
+ * @param reads The files to read.
+ */
+void BatchReader::read(std::span<BatchRead> reads) {
+    detail::PhaseTimer timer(StatPhase::READ);
+    while (!reads.empty()) {
+        if (!ring_) {
+            read_sync(reads);
+            return;
+        }
+        auto chunk = reads.first(std::min<size_t>(reads.size(), ring_->entries));
+        if (!read_chunk(chunk)) {
+            ring_.reset();
+            continue;
+        }
+        reads = reads.subspan(chunk.size());
+    }
+}
+
+/**
+ * @brief Reads @p reads one read_proc_file() call at a time.
+ */
+void BatchReader::read_sync(std::span<BatchRead> reads) {
+    for (BatchRead& r : reads) {
+        r.ok = read_proc_file(r.pid, r.name, *r.buffer);
+    }
+}
+
+/**
+ * @brief Reads up to one ring's worth of files through io_uring.
+ *
+ * One round opens every file, then rounds of reads follow until every file
+ * has hit end-of-file or failed, growing a buffer when a read fills it, and
+ * a last round closes them all.
+ *
+ * @return false if the ring failed; files opened so far are closed.
+ */
+bool BatchReader::read_chunk(std::span<BatchRead> reads) {
+    Ring& ring = *ring_;
+    const auto count = static_cast<unsigned>(reads.size());
+    ring.paths.resize(count);
+    ring.fds.assign(count, -1);
+    ring.lens.assign(count, 0);
+
+    for (unsigned i = 0; i < count; ++i) {
+        BatchRead& r = reads[i];
+        r.ok = false;
+        char* path = ring.paths[i].data();
+        char* end = path + ring.paths[i].size();
+        std::memcpy(path, "/proc/", 6);
+        char* p = std::to_chars(path + 6, end, r.pid).ptr;
+        size_t name_len = std::strlen(r.name);
+        if (p + 1 + name_len >= end) {
+            // Too long to be a /proc file; let the open fail.
+            name_len = 0;
+        }
+        *p++ = '/';
+        std::memcpy(p, r.name, name_len);
+        p[name_len] = '\0';
+
+        io_uring_sqe& sqe = ring.push(IORING_OP_OPENAT, i);
+        sqe.fd = AT_FDCWD;
+        sqe.addr = reinterpret_cast<uint64_t>(path);
+        sqe.open_flags = O_RDONLY | O_CLOEXEC;
+    }
+    bool ok = ring.run(count, [&](uint64_t i, int res) { ring.fds[i] = res; });
+
+    uint64_t files = 0;
+    uint64_t bytes = 0;
+    ring.pending.clear();
+    for (unsigned i = 0; i < count; ++i) {
+        if (ring.fds[i] >= 0) {
+            // Reads start over the previous contents; the buffer only grows
+            // when a read fills it, so capacity left over from a large file
+            // is never zero-filled for a small one.
+            std::string& buffer = *reads[i].buffer;
+            if (buffer.size() < kInitialBufferSize) {
+                buffer.resize(kInitialBufferSize);
+            }
+            ring.pending.push_back(i);
+        }
+    }
+
+    while (ok && !ring.pending.empty()) {
+        for (unsigned i : ring.pending) {
+            std::string& buffer = *reads[i].buffer;
+            size_t len = ring.lens[i];
+            if (len == buffer.size()) {
+                buffer.resize(buffer.size() * 2);
+            }
+            io_uring_sqe& sqe = ring.push(IORING_OP_READ, i);
+            sqe.fd = ring.fds[i];
+            sqe.addr = reinterpret_cast<uint64_t>(buffer.data() + len);
+            sqe.len = static_cast<uint32_t>(std::min<size_t>(buffer.size() - len, 1u << 30));
+            sqe.off = len;
+        }
+        const auto round = static_cast<unsigned>(ring.pending.size());
+        ring.pending.clear();
+        ok = ring.run(round, [&](uint64_t i, int res) {
+            if (res > 0) {
+                ring.lens[i] += static_cast<size_t>(res);
+                ring.pending.push_back(static_cast<unsigned>(i));
+            } else if (res == 0) {
+                reads[i].ok = true;
+                ++files;
+                bytes += ring.lens[i];
+            } else if (res == -EINTR || res == -EAGAIN) {
+                ring.pending.push_back(static_cast<unsigned>(i));
+            }
+        });
+    }
+
+    unsigned open_count = 0;
+    for (unsigned i = 0; i < count; ++i) {
+        reads[i].buffer->resize(reads[i].ok ? ring.lens[i] : 0);
+        if (ring.fds[i] >= 0) {
+            if (ok) {
+                io_uring_sqe& sqe = ring.push(IORING_OP_CLOSE, i);
+                sqe.fd = ring.fds[i];
+                ++open_count;
+            } else {
+                ::close(ring.fds[i]);
+                detail::stat_add(detail::StatCounter::SYSCALLS, 1);
+            }
+        }
+    }
+    if (ok && open_count > 0) {
+        ok = ring.run(open_count, [](uint64_t, int) {});
+    }
+
+    detail::stat_add(detail::StatCounter::FILES_READ, files);
+    detail::stat_add(detail::StatCounter::BYTES_READ, bytes);
+    return ok;
+}
+
+} // namespace memc
@@ -0,0 +1,704 @@
+#include "self_stats_internal.h"
+
+#include <cstring>
+#include <fcntl.h>
+#include <memc/binary_format.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+namespace memc {
+
+namespace {
+
+constexpr uint64_t padded(uint64_t n) {
+    return (n + 7) & ~uint64_t{7};
+}
+
+void append_bytes(std::vector<char>& out, const void* data, size_t size) {
+    size_t old = out.size();
+    out.resize(old + size);
+    if (size != 0) {
+        std::memcpy(out.data() + old, data, size);
+    }
+}
+
+template <typename T>
+void append_pod(std::vector<char>& out, const T& value) {
+    append_bytes(out, &value, sizeof(T));
+}
+
+/**
+ * @brief Fills @p r from an on-disk record, resolving its string IDs.
+ *
+ * Fields past the end of a @p stride byte record are left untouched.
+ */
+void from_record(const RegionRecord& rec, size_t stride,
+                 const std::vector<std::string_view>& strings, MemoryRegion& r) {
+    auto string = [&](uint32_t id) {
+        return id < strings.size() ? strings[id] : std::string_view{};
+    };
+    r.start_addr = rec.start_addr;
+    r.end_addr = rec.end_addr;
+    r.offset = rec.offset;
+    r.inode = rec.inode;
+    r.size_kb = rec.size_kb;
+    r.rss_kb = rec.rss_kb;
+    r.pss_kb = rec.pss_kb;
+    r.shared_clean_kb = rec.shared_clean_kb;
+    r.shared_dirty_kb = rec.shared_dirty_kb;
+    r.private_clean_kb = rec.private_clean_kb;
+    r.private_dirty_kb = rec.private_dirty_kb;
+    r.swap_kb = rec.swap_kb;
+    r.permissions.assign(string(rec.permissions_id));
+    r.device.assign(string(rec.device_id));
+    r.pathname.assign(string(rec.pathname_id));
+    r.type = static_cast<RegionType>(rec.type);
+    r.has_smaps_data = (rec.flags & 1) != 0;
+    r.thp_eligible = (rec.flags & 2) != 0;
+    if (stride >= sizeof(RegionRecord)) {
+        r.swap_pss_kb = rec.swap_pss_kb;
+        r.locked_kb = rec.locked_kb;
+        r.anon_huge_kb = rec.anon_huge_kb;
+        r.shmem_pmd_kb = rec.shmem_pmd_kb;
+        r.file_pmd_kb = rec.file_pmd_kb;
+    }
+}
+
+} // namespace
+
+// ── BinaryWriter ─────────────────────────────────────────────────────
+
+/**
+ * @brief Closes the file (writing the index) if still open.
+ */
+BinaryWriter::~BinaryWriter() {
+    close();
+}
+
+/**
+ * @brief Creates (or truncates) the file and writes the header.
+ *
+ * @param path The output path.
+ * @return true on success, false if the file could not be opened.
+ */
+bool BinaryWriter::open(const std::string& path) {
+    close();
+    out_.open(path, std::ios::binary | std::ios::trunc);
+    if (!out_.is_open()) {
+        return false;
+    }
+
+    string_ids_.clear();
+    pool_ids_.clear();
+    permission_ids_.fill(0);
+    device_ids_.clear();
+    pending_strings_.clear();
+    index_.clear();
+    string_chunks_.clear();
+
+    BinaryFileHeader header{};
+    std::memcpy(header.magic, kBinaryMagic, sizeof(header.magic));
+    header.version = kBinaryVersion;
+    header.byte_order_mark = kBinaryByteOrderMark;
+    header.header_size = sizeof(BinaryFileHeader);
+    header.region_record_size = sizeof(RegionRecord);
+    out_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    offset_ = sizeof(header);
+    return out_.good();
+}
+
+/**
+ * @brief Appends a snapshot, preceded by any strings it introduces.
+ *
+ * Region strings are interned first; if any are new, a STRINGS chunk is
+ * flushed ahead of the SNAPSHOT chunk so the file stays self-describing
+ * even if the capture is cut short.
+ *
+ * @param snapshot The snapshot to write.
+ * @return true on success, false on a write error.
+ */
+bool BinaryWriter::write(const ProcessSnapshot& snapshot) {
+    if (!out_.is_open()) {
+        return false;
+    }
+    detail::PhaseTimer timer(StatPhase::SERIALIZE);
+
+    std::vector<RegionRecord> records;
+    records.reserve(snapshot.regions.size());
+    for (const auto& r : snapshot.regions) {
+        records.push_back(make_record(r));
+    }
+    flush_strings();
+
+    BinarySnapshotHeader header{};
+    header.pid = snapshot.pid;
+    header.region_count = static_cast<uint32_t>(records.size());
+    header.timestamp_ms = snapshot.timestamp_ms;
+
+    scratch_.clear();
+    append_pod(scratch_, header);
+    append_bytes(scratch_, records.data(), records.size() * sizeof(RegionRecord));
+
+    index_.push_back({offset_, header.timestamp_ms, header.pid, header.region_count});
+    write_chunk(ChunkType::SNAPSHOT, scratch_.data(), scratch_.size());
+    return out_.good();
+}
+
+/**
+ * @brief Appends a delta frame, preceded by any strings it introduces.
+ *
+ * @param delta The delta to write.
+ * @return true on success, false on a write error.
+ */
+bool BinaryWriter::write(const SnapshotDelta& delta) {
+    if (!out_.is_open()) {
+        return false;
+    }
+    detail::PhaseTimer timer(StatPhase::SERIALIZE);
+
+    std::vector<RegionRecord> records;
+    records.reserve(delta.added.size() + delta.changed.size());
+    for (const auto& r : delta.added) {
+        records.push_back(make_record(r));
+    }
+    for (const auto& r : delta.changed) {
+        records.push_back(make_record(r));
+    }
+    flush_strings();
+
+    BinaryDeltaHeader header{};
+    header.pid = delta.pid;
+    header.added_count = static_cast<uint32_t>(delta.added.size());
+    header.changed_count = static_cast<uint32_t>(delta.changed.size());
+    header.removed_count = static_cast<uint32_t>(delta.removed.size());
+    header.timestamp_ms = delta.timestamp_ms;
+    header.base_timestamp_ms = delta.base_timestamp_ms;
+    header.region_count = delta.region_count;
+    header.total_rss_kb = delta.total_rss_kb;
+    header.total_vsize_kb = delta.total_vsize_kb;
+
+    scratch_.clear();
+    append_pod(scratch_, header);
+    append_bytes(scratch_, records.data(), records.size() * sizeof(RegionRecord));
+    append_bytes(scratch_, delta.removed.data(), delta.removed.size() * sizeof(uint64_t));
+
+    index_.push_back({offset_, header.timestamp_ms, header.pid,
+                      static_cast<uint32_t>(header.region_count)});
+    write_chunk(ChunkType::DELTA, scratch_.data(), scratch_.size());
+    return out_.good();
+}
+
+/**
+ * @brief Writes the index and trailer and closes the file.
+ *
+ * @return true on success, false on a write error.
+ */
+bool BinaryWriter::close() {
+    if (!out_.is_open()) {
+        return true;
+    }
+
+    scratch_.clear();
+    append_pod(scratch_, static_cast<uint64_t>(index_.size()));
+    append_pod(scratch_, static_cast<uint64_t>(string_chunks_.size()));
+    for (const auto& e : index_) {
+        append_pod(scratch_, e);
+    }
+    for (uint64_t off : string_chunks_) {
+        append_pod(scratch_, off);
+    }
+
+    BinaryFileTrailer trailer{};
+    trailer.index_offset = offset_;
+    std::memcpy(trailer.magic, kBinaryTrailerMagic, sizeof(trailer.magic));
+
+    write_chunk(ChunkType::INDEX, scratch_.data(), scratch_.size());
+    out_.write(reinterpret_cast<const char*>(&trailer), sizeof(trailer));
+
+    bool ok = out_.good();
+    out_.close();
+    return ok;
+}
+
+/**
+ * @brief Returns the file-wide ID of @p s, queueing it for output if new.
+ *
+ * @param s The string to intern.
+ * @return uint32_t The string ID (0 for the empty string).
+ */
+uint32_t BinaryWriter::intern(std::string_view s) {
+    if (s.empty()) {
+        return 0;
+    }
+    auto [it, inserted] =
+        string_ids_.try_emplace(std::string(s), static_cast<uint32_t>(string_ids_.size() + 1));
+    if (inserted) {
+        pending_strings_.push_back(it->first);
+    }
+    return it->second;
+}
+
+/**
+ * @brief Maps a StringPool ID to its file-wide ID.
+ *
+ * Pool IDs are dense, so the mapping is a plain vector indexed by pool ID
+ * and the text is only hashed the first time an ID is seen.
+ */
+uint32_t BinaryWriter::intern(InternedString s) {
+    if (s.id() >= pool_ids_.size()) {
+        pool_ids_.resize(s.id() + 1, 0);
+    }
+    uint32_t& id = pool_ids_[s.id()];
+    if (id == 0) {
+        id = intern(s.view());
+    }
+    return id;
+}
+
+/**
+ * @brief Maps a permission set to its file-wide ID via a 16-entry table.
+ */
+uint32_t BinaryWriter::intern(Permissions p) {
+    if (p.empty()) {
+        return 0;
+    }
+    uint32_t& id = permission_ids_[p.bits()];
+    if (id == 0) {
+        id = intern(p.view());
+    }
+    return id;
+}
+
+/**
+ * @brief Maps a device number to the file-wide ID of its "major:minor" text.
+ */
+uint32_t BinaryWriter::intern(DeviceNumber d) {
+    auto [it, inserted] = device_ids_.try_emplace(d.packed(), 0);
+    if (inserted) {
+        char buf[16];
+        it->second = intern(d.format(buf));
+    }
+    return it->second;
+}
+
+/**
+ * @brief Converts a region to its on-disk record, interning its strings.
+ */
+RegionRecord BinaryWriter::make_record(const MemoryRegion& r) {
+    RegionRecord rec{};
+    rec.start_addr = r.start_addr;
+    rec.end_addr = r.end_addr;
+    rec.offset = r.offset;
+    rec.inode = r.inode;
+    rec.size_kb = r.size_kb;
+    rec.rss_kb = r.rss_kb;
+    rec.pss_kb = r.pss_kb;
+    rec.shared_clean_kb = r.shared_clean_kb;
+    rec.shared_dirty_kb = r.shared_dirty_kb;
+    rec.private_clean_kb = r.private_clean_kb;
+    rec.private_dirty_kb = r.private_dirty_kb;
+    rec.swap_kb = r.swap_kb;
+    rec.permissions_id = intern(r.permissions);
+    rec.device_id = intern(r.device);
+    rec.pathname_id = intern(r.pathname);
+    rec.type = static_cast<uint8_t>(r.type);
+    rec.flags = (r.has_smaps_data ? 1 : 0) | (r.thp_eligible ? 2 : 0);
+    rec.swap_pss_kb = r.swap_pss_kb;
+    rec.locked_kb = r.locked_kb;
+    rec.anon_huge_kb = r.anon_huge_kb;
+    rec.shmem_pmd_kb = r.shmem_pmd_kb;
+    rec.file_pmd_kb = r.file_pmd_kb;
+    return rec;
+}
+
+/**
+ * @brief Writes a STRINGS chunk with every string interned since the last
+ * one, if there are any.
+ */
+void BinaryWriter::flush_strings() {
+    if (pending_strings_.empty()) {
+        return;
+    }
+    scratch_.clear();
+    append_pod(scratch_, static_cast<uint32_t>(pending_strings_.size()));
+    for (std::string_view s : pending_strings_) {
+        append_pod(scratch_, static_cast<uint32_t>(s.size()));
+        append_bytes(scratch_, s.data(), s.size());
+    }
+    pending_strings_.clear();
+    string_chunks_.push_back(offset_);
+    write_chunk(ChunkType::STRINGS, scratch_.data(), scratch_.size());
+}
+
+/**
+ * @brief Writes a chunk header, the payload and its alignment padding.
+ */
+void BinaryWriter::write_chunk(ChunkType type, const void* data, size_t size) {
+    ChunkHeader header{};
+    header.type = static_cast<uint32_t>(type);
+    header.size = size;
+
+    static constexpr char kPadding[8] = {};
+    out_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out_.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+    out_.write(kPadding, static_cast<std::streamsize>(padded(size) - size));
+    offset_ += sizeof(header) + padded(size);
+}
+
+// ── BinarySnapshotView ───────────────────────────────────────────────
+
+/**
+ * @brief Materializes the view as an owning ProcessSnapshot.
+ *
+ * @return ProcessSnapshot A deep copy of the snapshot.
+ */
+ProcessSnapshot BinarySnapshotView::to_snapshot() const {
+    ProcessSnapshot snapshot;
+    snapshot.pid = pid();
+    snapshot.timestamp_ms = timestamp_ms();
+    snapshot.regions.resize(region_count());
+
+    for (size_t i = 0; i < region_count(); ++i) {
+        from_record(region(i), stride_, *strings_, snapshot.regions[i]);
+    }
+    return snapshot;
+}
+
+// ── BinaryDeltaView ──────────────────────────────────────────────────
+
+/**
+ * @brief Materializes the view as an owning SnapshotDelta.
+ *
+ * @return SnapshotDelta A deep copy of the delta.
+ */
+SnapshotDelta BinaryDeltaView::to_delta() const {
+    SnapshotDelta delta;
+    delta.pid = pid();
+    delta.timestamp_ms = timestamp_ms();
+    delta.base_timestamp_ms = base_timestamp_ms();
+    delta.region_count = header_->region_count;
+    delta.total_rss_kb = header_->total_rss_kb;
+    delta.total_vsize_kb = header_->total_vsize_kb;
+
+    delta.added.resize(added_count());
+    for (size_t i = 0; i < added_count(); ++i) {
+        from_record(added(i), stride_, *strings_, delta.added[i]);
+    }
+    delta.changed.resize(changed_count());
+    for (size_t i = 0; i < changed_count(); ++i) {
+        from_record(changed(i), stride_, *strings_, delta.changed[i]);
+    }
+    delta.removed.resize(removed_count());
+    for (size_t i = 0; i < removed_count(); ++i) {
+        delta.removed[i] = removed(i);
+    }
+    return delta;
+}
+
+// ── BinaryReader ─────────────────────────────────────────────────────
+
+/**
+ * @brief Maps and validates a capture file.
+ *
+ * @param path The capture file path.
+ * @return std::optional<BinaryReader> The reader, or std::nullopt on failure.
+ */
+std::optional<BinaryReader> BinaryReader::open(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return std::nullopt;
+    }
+
+    struct stat st{};
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(BinaryFileHeader)) {
+        ::close(fd);
+        return std::nullopt;
+    }
+
+    void* map = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        return std::nullopt;
+    }
+
+    BinaryReader reader;
+    reader.data_ = static_cast<const char*>(map);
+    reader.size_ = static_cast<size_t>(st.st_size);
+
+    const auto* header = reinterpret_cast<const BinaryFileHeader*>(reader.data_);
+    if (std::memcmp(header->magic, kBinaryMagic, sizeof(kBinaryMagic)) != 0 ||
+        header->byte_order_mark != kBinaryByteOrderMark || header->version == 0 ||
+        header->version > kBinaryVersion || header->header_size < sizeof(BinaryFileHeader) ||
+        header->region_record_size < kRegionRecordBaseSize) {
+        return std::nullopt;
+    }
+    reader.stride_ = header->region_record_size;
+    reader.strings_.emplace_back();
+
+    bool indexed = false;
+    if (reader.size_ >= header->header_size + sizeof(BinaryFileTrailer)) {
+        const auto* trailer = reinterpret_cast<const BinaryFileTrailer*>(
+            reader.data_ + reader.size_ - sizeof(BinaryFileTrailer));
+        if (std::memcmp(trailer->magic, kBinaryTrailerMagic, sizeof(kBinaryTrailerMagic)) == 0) {
+            indexed = reader.load_index(trailer->index_offset);
+        }
+    }
+
+    if (!indexed) {
+        reader.frames_.clear();
+        reader.strings_.resize(1);
+        if (!reader.walk_chunks()) {
+            return std::nullopt;
+        }
+    }
+
+    return reader;
+}
+
+BinaryReader::BinaryReader(BinaryReader&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr))
+    , size_(std::exchange(other.size_, 0))
+    , stride_(other.stride_)
+    , frames_(std::move(other.frames_))
+    , strings_(std::move(other.strings_)) {}
+
+BinaryReader& BinaryReader::operator=(BinaryReader&& other) noexcept {
+    if (this != &other) {
+        if (data_) {
+            ::munmap(const_cast<char*>(data_), size_);
+        }
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        stride_ = other.stride_;
+        frames_ = std::move(other.frames_);
+        strings_ = std::move(other.strings_);
+    }
+    return *this;
+}
+
+/**
+ * @brief Unmaps the file.
+ */
+BinaryReader::~BinaryReader() {
+    if (data_) {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+}
+
+/**
+ * @brief Returns true if the i-th frame is a delta.
+ *
+ * @param i The frame index, in file order.
+ */
+bool BinaryReader::is_delta(size_t i) const {
+    const auto* chunk = reinterpret_cast<const ChunkHeader*>(data_ + frames_[i]);
+    return chunk->type == static_cast<uint32_t>(ChunkType::DELTA);
+}
+
+/**
+ * @brief Returns a view of the i-th frame, which must be a snapshot.
+ *
+ * @param i The frame index, in file order.
+ * @return BinarySnapshotView A view into the mapping.
+ */
+BinarySnapshotView BinaryReader::snapshot(size_t i) const {
+    const char* payload = data_ + frames_[i] + sizeof(ChunkHeader);
+    const auto* header = reinterpret_cast<const BinarySnapshotHeader*>(payload);
+    return BinarySnapshotView(header, payload + sizeof(BinarySnapshotHeader), stride_, &strings_);
+}
+
+/**
+ * @brief Returns a view of the i-th frame, which must be a delta.
+ *
+ * @param i The frame index, in file order.
+ * @return BinaryDeltaView A view into the mapping.
+ */
+BinaryDeltaView BinaryReader::delta(size_t i) const {
+    const char* payload = data_ + frames_[i] + sizeof(ChunkHeader);
+    const auto* header = reinterpret_cast<const BinaryDeltaHeader*>(payload);
+    return BinaryDeltaView(header, payload + sizeof(BinaryDeltaHeader), stride_, &strings_);
+}
+
+/**
+ * @brief Rebuilds the full snapshot at the i-th frame.
+ *
+ * @param i The frame index, in file order.
+ * @return std::optional<ProcessSnapshot> The snapshot, or std::nullopt if
+ * no earlier snapshot of the process exists or a delta does not apply.
+ */
+std::optional<ProcessSnapshot> BinaryReader::reconstruct(size_t i) const {
+    if (i >= frames_.size()) {
+        return std::nullopt;
+    }
+
+    pid_t pid = is_delta(i) ? delta(i).pid() : snapshot(i).pid();
+    size_t start = i;
+    while (is_delta(start) || snapshot(start).pid() != pid) {
+        if (start == 0) {
+            return std::nullopt;
+        }
+        --start;
+    }
+
+    ProcessSnapshot result = snapshot(start).to_snapshot();
+    for (size_t k = start + 1; k <= i; ++k) {
+        if (is_delta(k) && delta(k).pid() == pid && !apply_delta(result, delta(k).to_delta())) {
+            return std::nullopt;
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Returns true if @p chunk is a SNAPSHOT or DELTA chunk large enough
+ * for its declared record counts.
+ */
+bool BinaryReader::valid_frame(const ChunkHeader* chunk) const {
+    if (chunk->type == static_cast<uint32_t>(ChunkType::SNAPSHOT)) {
+        if (chunk->size < sizeof(BinarySnapshotHeader)) {
+            return false;
+        }
+        const auto* header = reinterpret_cast<const BinarySnapshotHeader*>(chunk + 1);
+        return (chunk->size - sizeof(BinarySnapshotHeader)) / stride_ >= header->region_count;
+    }
+    if (chunk->type == static_cast<uint32_t>(ChunkType::DELTA)) {
+        if (chunk->size < sizeof(BinaryDeltaHeader)) {
+            return false;
+        }
+        const auto* header = reinterpret_cast<const BinaryDeltaHeader*>(chunk + 1);
+        uint64_t needed = (uint64_t{header->added_count} + header->changed_count) * stride_ +
+                          uint64_t{header->removed_count} * sizeof(uint64_t);
+        return chunk->size - sizeof(BinaryDeltaHeader) >= needed;
+    }
+    return false;
+}
+
+/**
+ * @brief Returns the chunk header at @p offset if the whole chunk is in range.
+ */
+const ChunkHeader* BinaryReader::chunk_at(uint64_t offset) const {
+    if (offset % 8 != 0 || offset + sizeof(ChunkHeader) > size_) {
+        return nullptr;
+    }
+    const auto* chunk = reinterpret_cast<const ChunkHeader*>(data_ + offset);
+    if (chunk->size > size_ - offset - sizeof(ChunkHeader)) {
+        return nullptr;
+    }
+    return chunk;
+}
+
+/**
+ * @brief Loads frame and string-table locations from the INDEX chunk.
+ *
+ * @param index_offset File offset of the INDEX chunk header.
+ * @return true if the index is complete and consistent.
+ */
+bool BinaryReader::load_index(uint64_t index_offset) {
+    const ChunkHeader* chunk = chunk_at(index_offset);
+    if (!chunk || chunk->type != static_cast<uint32_t>(ChunkType::INDEX) ||
+        chunk->size < 2 * sizeof(uint64_t)) {
+        return false;
+    }
+
+    const char* p = reinterpret_cast<const char*>(chunk + 1);
+    uint64_t frame_count = 0;
+    uint64_t string_chunk_count = 0;
+    std::memcpy(&frame_count, p, sizeof(uint64_t));
+    std::memcpy(&string_chunk_count, p + sizeof(uint64_t), sizeof(uint64_t));
+    p += 2 * sizeof(uint64_t);
+
+    // Each count is bounded by what the chunk can hold before multiplying, so
+    // a crafted count cannot wrap the size check or reach reserve().
+    uint64_t room = chunk->size - 2 * sizeof(uint64_t);
+    if (frame_count > room / sizeof(BinaryIndexEntry)) {
+        return false;
+    }
+    room -= frame_count * sizeof(BinaryIndexEntry);
+    if (string_chunk_count > room / sizeof(uint64_t)) {
+        return false;
+    }
+
+    const auto* entries = reinterpret_cast<const BinaryIndexEntry*>(p);
+    const auto* string_offsets =
+        reinterpret_cast<const uint64_t*>(p + frame_count * sizeof(BinaryIndexEntry));
+
+    for (uint64_t i = 0; i < string_chunk_count; ++i) {
+        if (!add_strings(string_offsets[i])) {
+            return false;
+        }
+    }
+
+    frames_.reserve(frame_count);
+    for (uint64_t i = 0; i < frame_count; ++i) {
+        const ChunkHeader* frame = chunk_at(entries[i].offset);
+        if (!frame || !valid_frame(frame)) {
+            return false;
+        }
+        frames_.push_back(entries[i].offset);
+    }
+    return true;
+}
+
+/**
+ * @brief Recovers frame and string locations by walking every chunk.
+ *
+ * Stops at the first chunk that runs past the end of the file, so a capture
+ * that was cut short still yields every complete frame before the cut.
+ *
+ * @return true if at least the header was valid.
+ */
+bool BinaryReader::walk_chunks() {
+    const auto* header = reinterpret_cast<const BinaryFileHeader*>(data_);
+    uint64_t offset = padded(header->header_size);
+
+    while (const ChunkHeader* chunk = chunk_at(offset)) {
+        if (chunk->type == static_cast<uint32_t>(ChunkType::STRINGS)) {
+            if (!add_strings(offset)) {
+                break;
+            }
+        } else if (valid_frame(chunk)) {
+            frames_.push_back(offset);
+        }
+        offset += sizeof(ChunkHeader) + padded(chunk->size);
+    }
+    return true;
+}
+
+/**
+ * @brief Appends the strings of one STRINGS chunk to the string table.
+ *
+ * @param chunk_offset File offset of the STRINGS chunk header.
+ * @return true if the chunk was well-formed.
+ */
+bool BinaryReader::add_strings(uint64_t chunk_offset) {
+    const ChunkHeader* chunk = chunk_at(chunk_offset);
+    if (!chunk || chunk->type != static_cast<uint32_t>(ChunkType::STRINGS) ||
+        chunk->size < sizeof(uint32_t)) {
+        return false;
+    }
+
+    const char* p = reinterpret_cast<const char*>(chunk + 1);
+    const char* end = p + chunk->size;
+    uint32_t count = 0;
+    std::memcpy(&count, p, sizeof(count));
+    p += sizeof(count);
+
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t len = 0;
+        if (end - p < static_cast<ptrdiff_t>(sizeof(len))) {
+            return false;
+        }
+        std::memcpy(&len, p, sizeof(len));
+        p += sizeof(len);
+        if (end - p < static_cast<ptrdiff_t>(len)) {
+            return false;
+        }
+        strings_.emplace_back(p, len);
+        p += len;
+    }
+    return true;
+}
+
+} // namespace memc
@@ -1,11 +1,39 @@
+#include <charconv>
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
 #include <memc/cli.h>
 #include <memc/version.h>
+#include <pwd.h>
 
 namespace memc {
 
+namespace {
+
+/**
+ * @brief Resolves a --uid argument, numeric or a user name.
+ *
+ * @param user The argument.
+ * @param uid Receives the user ID.
+ * @return true on success, false if no such user exists.
+ */
+bool parse_user(const char* user, std::optional<uid_t>& uid) {
+    const char* end = user + std::strlen(user);
+    uid_t id = 0;
+    auto [ptr, ec] = std::from_chars(user, end, id);
+    if (ec == std::errc() && ptr == end) {
+        uid = id;
+        return true;
+    }
+    if (const passwd* pw = ::getpwnam(user)) {
+        uid = pw->pw_uid;
+        return true;
+    }
+    return false;
+}
+
+} // namespace
+
 /**
  * @brief Parses command-line arguments into a CLIOptions struct.
  *
@@ -27,12 +55,134 @@ CLIOptions parse_args(int argc, char* argv[]) {
         } else if (std::strcmp(argv[i], "--version") == 0 || std::strcmp(argv[i], "-v") == 0) {
             opts.show_version = true;
             return opts;
+        } else if (i == 1 && std::strcmp(argv[i], "convert") == 0) {
+            if (i + 1 >= argc) {
+                opts.parse_error = true;
+                opts.error_message = "Error: convert requires an input file";
+                return opts;
+            }
+            opts.convert_input = argv[++i];
+        } else if (i == 1 && std::strcmp(argv[i], "serve") == 0) {
+            opts.serve = true;
+        } else if (std::strcmp(argv[i], "--listen") == 0) {
+            if (i + 1 >= argc) {
+                opts.parse_error = true;
+                opts.error_message = "Error: --listen requires an address ([host]:port)";
+                return opts;
+            }
+            opts.listen = argv[++i];
+        } else if (std::strcmp(argv[i], "--format") == 0) {
+            if (i + 1 >= argc) {
+                opts.parse_error = true;
+                opts.error_message = "Error: --format requires a value";
+                return opts;
+            }
+            const char* format = argv[++i];
+            if (std::strcmp(format, "json") == 0) {
+                opts.format = OutputFormat::JSON;
+            } else if (std::strcmp(format, "bin") == 0) {
+                opts.format = OutputFormat::BINARY;
+            } else {
+                opts.parse_error = true;
+                opts.error_message = std::string("Error: unknown format '") + format + "'";
+                return opts;
+            }
         } else if (std::strcmp(argv[i], "--all") == 0) {
             opts.all_mode = true;
         } else if (std::strcmp(argv[i], "--smaps") == 0) {
             opts.collector_config.use_smaps = true;
+        } else if (std::strcmp(argv[i], "--fields") == 0) {
+            if (i + 1 >= argc) {
+                opts.parse_error = true;
+                opts.error_message = "Error: --fields requires a list of smaps fields";
+                return opts;
+            }
+            const char* list = argv[++i];
+            auto fields = SmapsFields::parse(list);
+            if (!fields) {
+                opts.parse_error = true;
+                opts.error_message = std::string("Error: unknown smaps field in '") + list + "'";
+                return opts;
+            }
+            opts.collector_config.fields = *fields;
+            opts.fields = true;
+        } else if (std::strcmp(argv[i], "--alert") == 0) {
+            if (i + 1 >= argc) {
+                opts.parse_error = true;
+                opts.error_message = "Error: --alert requires a rule (e.g. heap_growth>10MB/min)";
+                return opts;
+            }
+            const char* text = argv[++i];
+            auto rule = GrowthRule::parse(text);
+            if (!rule) {
+                opts.parse_error = true;
+                opts.error_message = std::string("Error: invalid alert rule '") + text + "'";
+                return opts;
+            }
+            opts.growth.rules.push_back(std::move(*rule));
+        } else if (std::strcmp(argv[i], "--numa") == 0) {
+            opts.collector_config.numa = true;
+        } else if (std::strcmp(argv[i], "--summary") == 0) {
+            opts.collector_config.summary_only = true;
+        } else if (std::strcmp(argv[i], "--delta") == 0) {
+            opts.collector_config.delta = true;
+        } else if (std::strcmp(argv[i], "--pagemap") == 0) {
+            opts.pagemap = true;
+        } else if (std::strcmp(argv[i], "--idle") == 0) {
+            opts.pagemap = true;
+            opts.track_idle = true;
+        } else if (std::strcmp(argv[i], "--files") == 0) {
+            opts.shared_files = true;
+        } else if (std::strcmp(argv[i], "--file-pages") == 0) {
+            opts.shared_files = true;
+            opts.file_pages = true;
+        } else if (std::strcmp(argv[i], "--self-stats") == 0) {
+            opts.self_stats = true;
+        } else if (std::strcmp(argv[i], "--io-uring") == 0) {
+            opts.io_uring = true;
         } else if (std::strcmp(argv[i], "--skip-kernel") == 0) {
             opts.skip_kernel = true;
+            opts.selector_config.skip_kernel = true;
+        } else if (std::strcmp(argv[i], "--name") == 0) {
+            if (i + 1 >= argc) {
+                opts.parse_error = true;
+                opts.error_message = "Error: --name requires a regex";
+                return opts;
+            }
+            opts.selector_config.name_pattern = argv[++i];
+        } else if (std::strcmp(argv[i], "--cgroup") == 0) {
+            if (i + 1 >= argc) {
+                opts.parse_error = true;
+                opts.error_message = "Error: --cgroup requires a path";
+                return opts;
+            }
+            opts.selector_config.cgroup_prefix = argv[++i];
+        } else if (std::strcmp(argv[i], "--uid") == 0) {
+            if (i + 1 >= argc) {
+                opts.parse_error = true;
+                opts.error_message = "Error: --uid requires a user ID or name";
+                return opts;
+            }
+            const char* user = argv[++i];
+            if (!parse_user(user, opts.selector_config.uid)) {
+                opts.parse_error = true;
+                opts.error_message = std::string("Error: unknown user '") + user + "'";
+                return opts;
+            }
+        } else if (std::strcmp(argv[i], "--min-rss") == 0) {
+            if (i + 1 >= argc) {
+                opts.parse_error = true;
+                opts.error_message = "Error: --min-rss requires a value in KB";
+                return opts;
+            }
+            const char* value = argv[++i];
+            const char* end = value + std::strlen(value);
+            auto [ptr, ec] = std::from_chars(value, end, opts.selector_config.min_rss_kb);
+            if (ec != std::errc() || ptr != end) {
+                opts.parse_error = true;
+                opts.error_message = "Error: --min-rss must be a number of KB";
+                return opts;
+            }
         } else if (std::strcmp(argv[i], "--compact") == 0) {
             opts.collector_config.pretty_json = false;
         } else if (std::strcmp(argv[i], "--output") == 0 || std::strcmp(argv[i], "-o") == 0) {
@@ -61,7 +211,20 @@ CLIOptions parse_args(int argc, char* argv[]) {
                 return opts;
             }
             opts.count = std::atoi(argv[++i]);
-        } else if (opts.pid == 0 && !opts.all_mode) {
+        } else if (std::strcmp(argv[i], "--jobs") == 0 || std::strcmp(argv[i], "-j") == 0) {
+            if (i + 1 >= argc) {
+                opts.parse_error = true;
+                opts.error_message = "Error: --jobs requires a value";
+                return opts;
+            }
+            int jobs = std::atoi(argv[++i]);
+            if (jobs < 0) {
+                opts.parse_error = true;
+                opts.error_message = "Error: jobs must not be negative";
+                return opts;
+            }
+            opts.jobs = static_cast<size_t>(jobs);
+        } else if (opts.pid == 0 && !opts.all_mode && opts.convert_input.empty()) {
             opts.pid = std::atoi(argv[i]);
             if (opts.pid <= 0) {
                 opts.parse_error = true;
@@ -75,9 +238,86 @@ CLIOptions parse_args(int argc, char* argv[]) {
         }
     }
 
-    if (!opts.all_mode && opts.pid == 0) {
+    if (!opts.convert_input.empty()) {
+        return opts;
+    }
+
+    if (opts.serve) {
+        if (opts.listen.empty()) {
+            opts.parse_error = true;
+            opts.error_message = "Error: serve requires --listen [host]:port";
+        } else if (opts.all_mode || opts.count != 1 || !opts.output_file.empty() ||
+                   opts.format == OutputFormat::BINARY || opts.collector_config.summary_only ||
+                   opts.collector_config.delta || opts.pagemap || opts.fields ||
+                   !opts.growth.rules.empty() || opts.shared_files) {
+            opts.parse_error = true;
+            opts.error_message = "Error: serve takes no --all, --count, --output, --format, "
+                                 "--summary, --delta, --pagemap, --fields, --alert or --files";
+        } else if (opts.pid != 0 && (!opts.selector_config.name_pattern.empty() ||
+                                     !opts.selector_config.cgroup_prefix.empty() ||
+                                     opts.selector_config.uid ||
+                                     opts.selector_config.min_rss_kb)) {
+            opts.parse_error = true;
+            opts.error_message = "Error: serve filters only apply without a PID";
+        } else if (!ProcessSelector::create(opts.selector_config)) {
+            opts.parse_error = true;
+            opts.error_message = "Error: invalid --name regex '" +
+                                 opts.selector_config.name_pattern + "'";
+        }
+        return opts;
+    }
+
+    if (!opts.listen.empty()) {
+        opts.parse_error = true;
+        opts.error_message = "Error: --listen only applies to serve";
+    } else if (!opts.all_mode && opts.pid == 0) {
         opts.parse_error = true;
         opts.error_message = "Error: PID is required (or use --all)";
+    } else if (opts.format == OutputFormat::BINARY && opts.output_file.empty()) {
+        opts.parse_error = true;
+        opts.error_message = "Error: --format bin requires --output";
+    } else if (opts.format == OutputFormat::BINARY && opts.collector_config.summary_only) {
+        opts.parse_error = true;
+        opts.error_message = "Error: --format bin does not support --summary";
+    } else if (opts.collector_config.delta &&
+               (opts.all_mode || opts.collector_config.summary_only)) {
+        opts.parse_error = true;
+        opts.error_message = "Error: --delta only applies to sampling a single PID";
+    } else if (opts.collector_config.numa && (opts.collector_config.summary_only ||
+                                              opts.format == OutputFormat::BINARY)) {
+        opts.parse_error = true;
+        opts.error_message = "Error: --numa needs per-region JSON output";
+    } else if (opts.fields && (!opts.collector_config.use_smaps ||
+                               opts.collector_config.summary_only ||
+                               opts.format == OutputFormat::BINARY)) {
+        opts.parse_error = true;
+        opts.error_message = "Error: --fields needs --smaps with per-region JSON output";
+    } else if (!opts.all_mode && (!opts.selector_config.name_pattern.empty() ||
+                                  !opts.selector_config.cgroup_prefix.empty() ||
+                                  opts.selector_config.uid || opts.selector_config.min_rss_kb)) {
+        opts.parse_error = true;
+        opts.error_message = "Error: --name, --uid, --cgroup and --min-rss only apply to --all";
+    } else if (!ProcessSelector::create(opts.selector_config)) {
+        opts.parse_error = true;
+        opts.error_message = "Error: invalid --name regex '" + opts.selector_config.name_pattern +
+                             "'";
+    } else if (opts.pagemap && (opts.all_mode || opts.collector_config.summary_only ||
+                                opts.collector_config.delta ||
+                                opts.format == OutputFormat::BINARY)) {
+        opts.parse_error = true;
+        opts.error_message = "Error: --pagemap only applies to a single PID with JSON output";
+    } else if (!opts.growth.rules.empty() &&
+               (opts.all_mode || opts.count == 1 || !opts.collector_config.use_smaps ||
+                opts.collector_config.summary_only || opts.collector_config.delta ||
+                opts.pagemap || opts.format == OutputFormat::BINARY)) {
+        opts.parse_error = true;
+        opts.error_message = "Error: --alert needs --smaps and --count other than 1 for a "
+                             "single PID, with JSON output";
+    } else if (opts.shared_files &&
+               (!opts.all_mode || !opts.collector_config.use_smaps || opts.count != 1 ||
+                opts.collector_config.summary_only || opts.format == OutputFormat::BINARY)) {
+        opts.parse_error = true;
+        opts.error_message = "Error: --files needs a single --all --smaps sweep with JSON output";
     }
 
     return opts;
@@ -91,6 +331,8 @@ CLIOptions parse_args(int argc, char* argv[]) {
 void print_usage(const char* prog) {
     std::cerr << "Usage: " << prog << " <pid> [options]\n"
               << "       " << prog << " --all [options]\n"
+              << "       " << prog << " convert <capture.bin> [--output <file>] [--compact] [--delta]\n"
+              << "       " << prog << " serve --listen [host]:port [<pid>] [options]\n"
               << "\n"
               << "Memory region data collector for Linux processes.\n"
               << "Reads /proc/<pid>/maps (and optionally smaps) and outputs JSON.\n"
@@ -99,13 +341,31 @@ void print_usage(const char* prog) {
               << "  --all            Snapshot ALL processes on the system\n"
               << "  --smaps          Enable detailed smaps data (RSS, PSS, swap, "
                  "etc.)\n"
+              << "  --fields <list>  With --smaps, only these fields (e.g. rss,pss,swap)\n"
+              << "  --numa           Add per-NUMA-node residency from numa_maps\n"
+              << "  --alert <rule>   Print only growth alerts, e.g. heap_growth>10MB/min\n"
+              << "  --summary        Collect per-process totals only (smaps_rollup)\n"
               << "  --interval <ms>  Sampling interval in milliseconds (default: "
                  "1000)\n"
-              << "  --count <n>      Number of samples to take (default: 1, 0 = "
-                 "continuous)\n"
+              << "  --count <n>      Number of samples (or --all sweeps) to take "
+                 "(default: 1, 0 = continuous)\n"
+              << "  --delta          After the first sample, output only changed regions\n"
               << "  --compact        Output compact JSON (default: pretty-printed)\n"
               << "  --output <file>  Write JSON to a file instead of stdout\n"
+              << "  --format <fmt>   Output format: json (default) or bin (needs --output)\n"
+              << "  --pagemap        Report page residency of heap/anonymous regions\n"
+              << "  --idle           With --pagemap, also report hot/cold pages (root)\n"
               << "  --skip-kernel    Skip kernel threads with no user-space memory\n"
+              << "  --name <regex>   With --all, only processes whose name matches\n"
+              << "  --uid <user>     With --all, only processes of this user (ID or name)\n"
+              << "  --cgroup <path>  With --all, only processes under this cgroup path\n"
+              << "  --min-rss <kb>   With --all, only processes with at least this RSS\n"
+              << "  --files          With --all --smaps, memory per file over all processes\n"
+              << "  --file-pages     Like --files, plus distinct resident pages from pagemap\n"
+              << "  --self-stats     Print memc's own timings and counters to stderr on exit\n"
+              << "  --jobs <n>       Worker threads for --all (default: 0 = one per CPU)\n"
+              << "  --io-uring       With --all, batch /proc reads through io_uring\n"
+              << "  --listen <addr>  With serve, serve Prometheus metrics on [host]:port\n"
               << "  --version        Show version information\n"
               << "  --help           Show this help message\n"
               << "\n"
@@ -113,9 +373,21 @@ void print_usage(const char* prog) {
               << "  " << prog << " 1234                        # Single snapshot of PID 1234\n"
               << "  " << prog << " 1234 --smaps                # With detailed memory info\n"
               << "  " << prog << " --all --smaps               # All processes with smaps\n"
+              << "  " << prog << " --all --summary             # Per-process totals only\n"
+              << "  " << prog << " --all --name '^nginx' --min-rss 10240  # Big nginx processes\n"
+              << "  " << prog << " 1234 --smaps --numa         # THP and NUMA placement\n"
+              << "  " << prog << " --all --smaps --fields rss  # Per-region RSS only\n"
+              << "  " << prog << " --all --smaps --files       # Cost per mapped file\n"
               << "  " << prog << " --all --output system.json   # Save to file\n"
+              << "  " << prog << " --all --count 0 --interval 10000  # Changed processes only\n"
               << "  " << prog << " 1234 --count 0 --interval 500  # Continuous, every 500ms\n"
-              << "  " << prog << " $$                          # Monitor the current shell\n";
+              << "  " << prog << " $$                          # Monitor the current shell\n"
+              << "  " << prog << " 1234 --count 0 --interval 100 --delta  # Diffs only\n"
+              << "  " << prog << " 1234 --count 0 --format bin -o cap.bin  # Binary capture\n"
+              << "  " << prog << " 1234 --idle --interval 5000    # Pages idle for 5s\n"
+              << "  " << prog << " 1234 --smaps --count 0 --alert 'heap_growth>10MB/min'  # Leaks\n"
+              << "  " << prog << " convert cap.bin --output cap.json    # Binary back to JSON\n"
+              << "  " << prog << " serve --listen :9464 --interval 15000  # Prometheus exporter\n";
 }
 
 } // namespace memc
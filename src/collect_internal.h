@@ -0,0 +1,156 @@
+#pragma once
+
+#include "self_stats_internal.h"
+
+#include <memc/maps_parser.h>
+#include <memc/numa_maps_parser.h>
+#include <memc/proc_handle.h>
+#include <memc/region.h>
+#include <memc/smaps_parser.h>
+#include <string>
+#include <string_view>
+#include <sys/types.h>
+#include <vector>
+
+namespace memc::detail {
+
+/**
+ * @brief Returns the current wall-clock time in UNIX epoch milliseconds.
+ */
+uint64_t now_ms();
+
+/**
+ * @brief Reads an open file from offset 0 to end-of-file into @p buffer.
+ *
+ * Uses pread(2), so a descriptor kept open can be re-read any number of
+ * times. Counts its calls and bytes in the self statistics.
+ *
+ * @param fd The open file.
+ * @param buffer The buffer to fill. Its previous contents are discarded.
+ * @return true on success, false on a read error.
+ */
+bool read_whole_file(int fd, std::string& buffer);
+
+/**
+ * @brief Returns the process name held by the raw contents of a comm file,
+ * or "unknown" if it is empty.
+ */
+std::string process_name_from_comm(std::string_view comm);
+
+/**
+ * @brief Adds the smaps counters of @p regions to the totals in @p summary.
+ *
+ * @param regions Regions parsed from smaps.
+ * @param summary The summary to accumulate into.
+ */
+void add_region_totals(const std::vector<MemoryRegion>& regions, ProcessSummary& summary);
+
+/**
+ * @brief Reserves room for the regions of the next snapshot.
+ *
+ * A vector smaller than @p hint grows to @p hint plus an eighth, so a
+ * process that maps a few more regions than last time is still filled
+ * without reallocating.
+ *
+ * @param regions The vector to reserve.
+ * @param hint Expected region count, usually the previous snapshot's.
+ */
+void reserve_regions(std::vector<MemoryRegion>& regions, size_t hint);
+
+/**
+ * @brief Shared body of the read_regions() overloads, over any file source.
+ *
+ * @p read is called as read(name, buffer) for each /proc/<pid>/<name>
+ * file and reports success like read_proc_file().
+ */
+template <typename Reader>
+bool read_regions_with(Reader&& read, bool use_smaps, bool numa, SmapsFields fields,
+                       std::string& buffer, std::vector<MemoryRegion>& regions) {
+    regions.clear();
+    if (use_smaps && read("smaps", buffer)) {
+        SmapsParser::parse_from_view(buffer, regions, fields);
+    } else if (read("maps", buffer)) {
+        MapsParser::parse_from_view(buffer, regions);
+    } else {
+        return false;
+    }
+    if (numa && read("numa_maps", buffer)) {
+        NumaMapsParser::enrich_from_view(buffer, regions);
+    }
+    count_snapshot(regions.size());
+    return true;
+}
+
+/**
+ * @brief Shared body of the read_summary() overloads, over any file source.
+ *
+ * The smaps fallback cannot fill the Pss_* breakdown or the anonymous
+ * total, which are left at zero.
+ */
+template <typename Reader>
+bool read_summary_with(Reader&& read, std::string& buffer, std::vector<MemoryRegion>& scratch,
+                       ProcessSummary& summary) {
+    if (read("smaps_rollup", buffer)) {
+        SmapsParser::parse_rollup_from_view(buffer, summary);
+        count_snapshot(0);
+        return true;
+    }
+    if (!read("smaps", buffer)) {
+        return false;
+    }
+    scratch.clear();
+    SmapsParser::parse_from_view(buffer, scratch);
+    add_region_totals(scratch, summary);
+    count_snapshot(scratch.size());
+    return true;
+}
+
+/**
+ * @brief Reads the region list of a process into caller-owned storage.
+ *
+ * With @p use_smaps, /proc/<pid>/smaps supplies the full region list in a
+ * single pass; /proc/<pid>/maps is only read when smaps is disabled or
+ * unreadable. With @p numa, numa_maps is joined on afterwards; an
+ * unreadable numa_maps leaves the regions without NUMA data.
+ *
+ * @param pid The process ID.
+ * @param use_smaps Whether to collect smaps detail.
+ * @param numa Whether to join numa_maps per-node residency.
+ * @param fields The smaps detail fields to parse.
+ * @param buffer Scratch buffer for the raw file contents.
+ * @param regions Output vector. It is cleared first.
+ * @return true on success, false if the process could not be read.
+ */
+bool read_regions(pid_t pid, bool use_smaps, bool numa, SmapsFields fields, std::string& buffer,
+                  std::vector<MemoryRegion>& regions);
+
+/**
+ * @brief Same as read_regions(pid_t, ...), reading through the descriptors
+ * @p proc keeps open.
+ */
+bool read_regions(ProcHandle& proc, bool use_smaps, bool numa, SmapsFields fields,
+                  std::string& buffer, std::vector<MemoryRegion>& regions);
+
+/**
+ * @brief Reads per-process totals from smaps_rollup into @p summary.
+ *
+ * Falls back to summing a full smaps parse (into @p scratch) when
+ * smaps_rollup is not available.
+ *
+ * @param pid The process ID.
+ * @param buffer Scratch buffer for the raw file contents.
+ * @param scratch Scratch region vector for the fallback path.
+ * @param summary The summary to fill; pid and timestamp are left untouched.
+ * @return true on success, false if the process could not be read.
+ */
+bool read_summary(pid_t pid, std::string& buffer, std::vector<MemoryRegion>& scratch,
+                  ProcessSummary& summary);
+
+/**
+ * @brief Same as read_summary(pid_t, ...), reading through the descriptors
+ * @p proc keeps open.
+ */
+bool read_summary(ProcHandle& proc, std::string& buffer, std::vector<MemoryRegion>& scratch,
+                  ProcessSummary& summary);
+
+} // namespace memc::detail
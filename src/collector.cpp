@@ -1,10 +1,126 @@
+#include "collect_internal.h"
+#include "self_stats_internal.h"
+
 #include <chrono>
 #include <memc/collector.h>
-#include <memc/maps_parser.h>
-#include <memc/smaps_parser.h>
+#include <memc/json_writer.h>
+#include <memc/process_utils.h>
+#include <utility>
 
 namespace memc {
 
+namespace detail {
+
+/**
+ * @brief Returns the current wall-clock time in UNIX epoch milliseconds.
+ */
+uint64_t now_ms() {
+    auto now = std::chrono::system_clock::now();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
+}
+
+/**
+ * @brief Reads the region list of a process into caller-owned storage.
+ *
+ * @param pid The process ID.
+ * @param use_smaps Whether to collect smaps detail.
+ * @param numa Whether to join numa_maps per-node residency.
+ * @param fields The smaps detail fields to parse.
+ * @param buffer Scratch buffer for the raw file contents.
+ * @param regions Output vector. It is cleared first.
+ * @return true on success, false if the process could not be read.
+ */
+bool read_regions(pid_t pid, bool use_smaps, bool numa, SmapsFields fields, std::string& buffer,
+                  std::vector<MemoryRegion>& regions) {
+    auto read = [pid](const char* name, std::string& b) { return read_proc_file(pid, name, b); };
+    return read_regions_with(read, use_smaps, numa, fields, buffer, regions);
+}
+
+/**
+ * @brief Reads the region list of an open ProcHandle into caller-owned
+ * storage.
+ *
+ * @param proc The process to read.
+ * @param use_smaps Whether to collect smaps detail.
+ * @param numa Whether to join numa_maps per-node residency.
+ * @param fields The smaps detail fields to parse.
+ * @param buffer Scratch buffer for the raw file contents.
+ * @param regions Output vector. It is cleared first.
+ * @return true on success, false if the process could not be read.
+ */
+bool read_regions(ProcHandle& proc, bool use_smaps, bool numa, SmapsFields fields,
+                  std::string& buffer, std::vector<MemoryRegion>& regions) {
+    auto read = [&proc](const char* name, std::string& b) { return proc.read(name, b); };
+    return read_regions_with(read, use_smaps, numa, fields, buffer, regions);
+}
+
+/**
+ * @brief Reads per-process totals from smaps_rollup into @p summary.
+ *
+ * @param pid The process ID.
+ * @param buffer Scratch buffer for the raw file contents.
+ * @param scratch Scratch region vector for the fallback path.
+ * @param summary The summary to fill; pid and timestamp are left untouched.
+ * @return true on success, false if the process could not be read.
+ */
+bool read_summary(pid_t pid, std::string& buffer, std::vector<MemoryRegion>& scratch,
+                  ProcessSummary& summary) {
+    auto read = [pid](const char* name, std::string& b) { return read_proc_file(pid, name, b); };
+    return read_summary_with(read, buffer, scratch, summary);
+}
+
+/**
+ * @brief Reads per-process totals of an open ProcHandle into @p summary.
+ *
+ * @param proc The process to read.
+ * @param buffer Scratch buffer for the raw file contents.
+ * @param scratch Scratch region vector for the fallback path.
+ * @param summary The summary to fill; pid and timestamp are left untouched.
+ * @return true on success, false if the process could not be read.
+ */
+bool read_summary(ProcHandle& proc, std::string& buffer, std::vector<MemoryRegion>& scratch,
+                  ProcessSummary& summary) {
+    auto read = [&proc](const char* name, std::string& b) { return proc.read(name, b); };
+    return read_summary_with(read, buffer, scratch, summary);
+}
+
+/**
+ * @brief Reserves room for the regions of the next snapshot.
+ *
+ * @param regions The vector to reserve.
+ * @param hint Expected region count.
+ */
+void reserve_regions(std::vector<MemoryRegion>& regions, size_t hint) {
+    if (regions.capacity() < hint) {
+        regions.reserve(hint + hint / 8);
+    }
+}
+
+/**
+ * @brief Adds the smaps counters of @p regions to the totals in @p summary.
+ *
+ * @param regions Regions parsed from smaps.
+ * @param summary The summary to accumulate into.
+ */
+void add_region_totals(const std::vector<MemoryRegion>& regions, ProcessSummary& summary) {
+    for (const auto& r : regions) {
+        summary.rss_kb += r.rss_kb;
+        summary.pss_kb += r.pss_kb;
+        summary.shared_clean_kb += r.shared_clean_kb;
+        summary.shared_dirty_kb += r.shared_dirty_kb;
+        summary.private_clean_kb += r.private_clean_kb;
+        summary.private_dirty_kb += r.private_dirty_kb;
+        summary.swap_kb += r.swap_kb;
+        summary.swap_pss_kb += r.swap_pss_kb;
+        summary.locked_kb += r.locked_kb;
+        summary.anon_huge_kb += r.anon_huge_kb;
+        summary.shmem_pmd_kb += r.shmem_pmd_kb;
+        summary.file_pmd_kb += r.file_pmd_kb;
+    }
+}
+
+} // namespace detail
+
 /**
  * @brief Constructs a DataCollector for the given process.
  *
@@ -22,53 +138,149 @@ DataCollector::~DataCollector() {
     stop_sampling();
 }
 
+/**
+ * @brief Returns the /proc handle of the process, opening it on first use.
+ *
+ * A failed open is retried on the next call, so a collector created before
+ * its process appears starts reading once it does.
+ */
+ProcHandle& DataCollector::proc() {
+    if (!proc_.is_open()) {
+        proc_.open(pid_);
+    }
+    return proc_;
+}
+
 /**
  * @brief Takes a single snapshot of the process memory.
  *
- * Reads /proc/<pid>/maps and optionally enriches with smaps data.
- * The snapshot is timestamped with the current system time.
+ * With smaps enabled, /proc/<pid>/smaps is parsed in a single pass and
+ * supplies the full region list; /proc/<pid>/maps is only read when smaps
+ * is disabled or unreadable. The snapshot is timestamped with the current
+ * system time.
  *
  * @return std::optional<ProcessSnapshot> A snapshot on success, or
  * std::nullopt if the process could not be accessed.
  */
 std::optional<ProcessSnapshot> DataCollector::collect_once() {
     ProcessSnapshot snapshot;
+    if (!collect_into(snapshot)) {
+        return std::nullopt;
+    }
+    return snapshot;
+}
+
+/**
+ * @brief Takes a snapshot into caller-owned storage.
+ *
+ * The region vector is cleared and refilled, reserved first for the region
+ * count of the previous collection, so a snapshot reused across calls is
+ * filled without allocating once it has grown to the process's size.
+ *
+ * @param snapshot The snapshot to overwrite.
+ * @return true on success, false if the process could not be accessed (the
+ * regions are then left empty).
+ */
+bool DataCollector::collect_into(ProcessSnapshot& snapshot) {
     snapshot.pid = pid_;
+    snapshot.timestamp_ms = detail::now_ms();
+    detail::reserve_regions(snapshot.regions, region_hint_);
 
-    auto now = std::chrono::system_clock::now();
-    snapshot.timestamp_ms =
-        std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
+    if (!detail::read_regions(proc(), config_.use_smaps, config_.numa, config_.fields,
+                              read_buffer_, snapshot.regions)) {
+        return false;
+    }
+    region_hint_ = snapshot.regions.size();
+    return true;
+}
 
-    auto maps_result = MapsParser::parse(pid_);
-    if (!maps_result) {
+/**
+ * @brief Collects per-process memory totals from smaps_rollup.
+ *
+ * Falls back to summing a full smaps parse when smaps_rollup is not
+ * available (Linux < 4.14). The fallback cannot fill the Pss_* breakdown
+ * or the anonymous total, which are left at zero.
+ *
+ * @return std::optional<ProcessSummary> The totals on success, or
+ * std::nullopt if the process could not be accessed.
+ */
+std::optional<ProcessSummary> DataCollector::collect_summary() {
+    ProcessSummary summary;
+    summary.pid = pid_;
+    summary.timestamp_ms = detail::now_ms();
+
+    if (!detail::read_summary(proc(), read_buffer_, scratch_regions_, summary)) {
         return std::nullopt;
     }
 
-    snapshot.regions = std::move(*maps_result);
+    return summary;
+}
 
-    if (config_.use_smaps) {
-        SmapsParser::enrich(pid_, snapshot.regions);
+/**
+ * @brief Takes a snapshot and returns its delta against the previous one.
+ *
+ * @return std::optional<SnapshotDelta> The delta on success, or
+ * std::nullopt if the process could not be accessed.
+ */
+std::optional<SnapshotDelta> DataCollector::collect_delta() {
+    if (!collect_into(next_)) {
+        return std::nullopt;
     }
 
-    return snapshot;
+    SnapshotDelta delta;
+    if (previous_) {
+        delta = compute_delta(*previous_, next_);
+        // The replaced base becomes the storage for the next collection.
+        std::swap(*previous_, next_);
+    } else {
+        ProcessSnapshot empty;
+        empty.pid = pid_;
+        empty.timestamp_ms = 0;
+        delta = compute_delta(empty, next_);
+        previous_ = std::move(next_);
+    }
+    return delta;
 }
 
 /**
  * @brief Serializes a snapshot to a JSON string.
  *
- * Uses ordered JSON to preserve key insertion order. Output format
- * (pretty vs compact) is controlled by the collector's configuration.
+ * Writes the JSON directly with JsonWriter, without building a DOM. The
+ * output is identical to dumping to_json(ordered_json&, ...) of the same
+ * snapshot. Output format (pretty vs compact) and the smaps fields written
+ * are controlled by the collector's configuration.
  *
  * @param snapshot The snapshot to serialize.
  * @return std::string The JSON string representation.
  */
 std::string DataCollector::to_json(const ProcessSnapshot& snapshot) const {
-    nlohmann::ordered_json j;
-    memc::to_json(j, snapshot);
-    if (config_.pretty_json) {
-        return j.dump(2);
-    }
-    return j.dump();
+    JsonWriter writer(config_.pretty_json, 0, config_.fields);
+    writer.write(snapshot);
+    return std::move(writer.buffer());
+}
+
+/**
+ * @brief Serializes a summary to a JSON string.
+ *
+ * @param summary The summary to serialize.
+ * @return std::string The JSON string representation.
+ */
+std::string DataCollector::to_json(const ProcessSummary& summary) const {
+    JsonWriter writer(config_.pretty_json);
+    writer.write(summary);
+    return std::move(writer.buffer());
+}
+
+/**
+ * @brief Serializes a snapshot delta to a JSON string.
+ *
+ * @param delta The delta to serialize.
+ * @return std::string The JSON string representation.
+ */
+std::string DataCollector::to_json(const SnapshotDelta& delta) const {
+    JsonWriter writer(config_.pretty_json, 0, config_.fields);
+    writer.write(delta);
+    return std::move(writer.buffer());
 }
 
 /**
@@ -86,7 +298,11 @@ void DataCollector::start_sampling() {
     sc.pid = pid_;
     sc.interval = std::chrono::milliseconds(config_.interval_ms);
     sc.use_smaps = config_.use_smaps;
+    sc.numa = config_.numa;
+    sc.fields = config_.fields;
     sc.max_snapshots = config_.max_snapshots;
+    sc.delta = config_.delta;
+    sc.dispatch = config_.dispatch;
 
     sampler_ = std::make_unique<Sampler>(sc);
 
@@ -137,6 +353,86 @@ std::optional<ProcessSnapshot> DataCollector::get_latest_snapshot() const {
     return sampler_->get_latest();
 }
 
+/**
+ * @brief Retrieves a shared handle to the most recently collected snapshot.
+ *
+ * @return SnapshotHandle The latest snapshot, or nullptr if no sampler is
+ * active or no snapshots exist.
+ */
+SnapshotHandle DataCollector::get_latest_handle() const {
+    if (!sampler_)
+        return nullptr;
+    return sampler_->get_latest_handle();
+}
+
+/**
+ * @brief Retrieves shared handles to every retained snapshot.
+ *
+ * @return std::vector<SnapshotHandle> The handles, oldest first, or an
+ * empty vector if no sampler is active.
+ */
+std::vector<SnapshotHandle> DataCollector::get_snapshot_handles() const {
+    if (!sampler_)
+        return {};
+    return sampler_->get_snapshot_handles();
+}
+
+/**
+ * @brief Rebuilds a snapshot from the sampling history.
+ *
+ * @param index Position in the history, 0 being the oldest retained.
+ * @return std::optional<ProcessSnapshot> The snapshot, or std::nullopt if
+ * no sampler is active or @p index is out of range.
+ */
+std::optional<ProcessSnapshot> DataCollector::reconstruct(size_t index) const {
+    if (!sampler_)
+        return std::nullopt;
+    return sampler_->reconstruct(index);
+}
+
+/**
+ * @brief Retrieves the stored deltas of a delta-mode sampling session.
+ *
+ * @return std::vector<SnapshotDelta> The deltas, or an empty vector if no
+ * sampler is active or it does not run in delta mode.
+ */
+std::vector<SnapshotDelta> DataCollector::get_all_deltas() const {
+    if (!sampler_)
+        return {};
+    return sampler_->get_deltas();
+}
+
+/**
+ * @brief Retrieves the sampling clock's jitter and missed-deadline counts.
+ *
+ * @return TimerStats The statistics, or all zeros if no sampler exists.
+ */
+TimerStats DataCollector::get_timer_stats() const {
+    if (!sampler_)
+        return {};
+    return sampler_->timer_stats();
+}
+
+/**
+ * @brief Retrieves memc's own per-phase latencies and work counters.
+ *
+ * @return SelfStats The process-wide statistics.
+ */
+SelfStats DataCollector::get_self_stats() {
+    return self_stats();
+}
+
+/**
+ * @brief Retrieves the callback delivery counters of the sampler.
+ *
+ * @return DispatchStats The counters, or all zeros if no sampler exists.
+ */
+DispatchStats DataCollector::get_dispatch_stats() const {
+    if (!sampler_)
+        return {};
+    return sampler_->dispatch_stats();
+}
+
 /**
  * @brief Registers a callback to be invoked on each new snapshot.
  *
@@ -151,4 +447,17 @@ void DataCollector::on_snapshot(SnapshotCallback cb) {
     }
 }
 
+/**
+ * @brief Registers a callback to be invoked on each new delta.
+ *
+ * Forwarded to the internal sampler like on_snapshot().
+ *
+ * @param cb The callback function to register.
+ */
+void DataCollector::on_delta(DeltaCallback cb) {
+    if (sampler_) {
+        sampler_->on_delta(std::move(cb));
+    }
+}
+
 } // namespace memc
@@ -0,0 +1,110 @@
+#include <memc/delta.h>
+
+namespace memc {
+
+/**
+ * @brief Computes the delta that turns @p base into @p next.
+ *
+ * Walks both region lists in start-address order at once, so the cost is
+ * linear in the number of regions and unchanged regions are never copied.
+ *
+ * @param base The older snapshot.
+ * @param next The newer snapshot.
+ * @return SnapshotDelta The difference between the two.
+ */
+SnapshotDelta compute_delta(const ProcessSnapshot& base, const ProcessSnapshot& next) {
+    SnapshotDelta delta;
+    delta.pid = next.pid;
+    delta.timestamp_ms = next.timestamp_ms;
+    delta.base_timestamp_ms = base.timestamp_ms;
+    delta.region_count = next.regions.size();
+    delta.total_rss_kb = next.total_rss_kb();
+    delta.total_vsize_kb = next.total_vsize_kb();
+
+    const auto& old_regions = base.regions;
+    const auto& new_regions = next.regions;
+    size_t i = 0;
+    size_t j = 0;
+    while (i < old_regions.size() && j < new_regions.size()) {
+        const MemoryRegion& a = old_regions[i];
+        const MemoryRegion& b = new_regions[j];
+        if (a.start_addr < b.start_addr) {
+            delta.removed.push_back(a.start_addr);
+            ++i;
+        } else if (b.start_addr < a.start_addr) {
+            delta.added.push_back(b);
+            ++j;
+        } else {
+            if (!(a == b)) {
+                delta.changed.push_back(b);
+            }
+            ++i;
+            ++j;
+        }
+    }
+    for (; i < old_regions.size(); ++i) {
+        delta.removed.push_back(old_regions[i].start_addr);
+    }
+    delta.added.insert(delta.added.end(), new_regions.begin() + j, new_regions.end());
+
+    return delta;
+}
+
+/**
+ * @brief Applies @p delta to @p snapshot in place.
+ *
+ * The base list is first filtered (removed regions dropped, changed ones
+ * replaced), then merged with the added regions, keeping start-address
+ * order. The result is validated against the delta's region count before it
+ * replaces the snapshot's regions.
+ *
+ * @param snapshot The base snapshot; on success it becomes the newer one.
+ * @param delta A delta computed against @p snapshot.
+ * @return true on success, false if the delta does not belong to this
+ * snapshot.
+ */
+bool apply_delta(ProcessSnapshot& snapshot, const SnapshotDelta& delta) {
+    if (snapshot.timestamp_ms != delta.base_timestamp_ms) {
+        return false;
+    }
+
+    std::vector<MemoryRegion> kept;
+    kept.reserve(snapshot.regions.size() + delta.changed.size());
+    size_t r = 0;
+    size_t c = 0;
+    for (const MemoryRegion& region : snapshot.regions) {
+        if (r < delta.removed.size() && delta.removed[r] == region.start_addr) {
+            ++r;
+        } else if (c < delta.changed.size() && delta.changed[c].start_addr == region.start_addr) {
+            kept.push_back(delta.changed[c++]);
+        } else {
+            kept.push_back(region);
+        }
+    }
+    if (r != delta.removed.size() || c != delta.changed.size()) {
+        return false;
+    }
+
+    std::vector<MemoryRegion> merged;
+    merged.reserve(kept.size() + delta.added.size());
+    size_t k = 0;
+    for (const MemoryRegion& region : delta.added) {
+        while (k < kept.size() && kept[k].start_addr < region.start_addr) {
+            merged.push_back(std::move(kept[k++]));
+        }
+        merged.push_back(region);
+    }
+    for (; k < kept.size(); ++k) {
+        merged.push_back(std::move(kept[k]));
+    }
+    if (merged.size() != delta.region_count) {
+        return false;
+    }
+
+    snapshot.pid = delta.pid;
+    snapshot.timestamp_ms = delta.timestamp_ms;
+    snapshot.regions = std::move(merged);
+    return true;
+}
+
+} // namespace memc
@@ -0,0 +1,191 @@
+#include <iostream>
+#include <memc/dispatcher.h>
+#include <unordered_set>
+
+namespace memc {
+
+/**
+ * @brief Creates a stopped dispatcher.
+ *
+ * @param config Thread count, queue size and overflow policy.
+ * @param handler Invoked once per delivered event.
+ */
+SampleDispatcher::SampleDispatcher(DispatchConfig config, Handler handler)
+    : config_(config)
+    , handler_(std::move(handler))
+    , queue_(config_.threads > 0 ? config_.capacity : 2) {}
+
+/**
+ * @brief Destructor. Delivers what is still queued and joins the threads.
+ */
+SampleDispatcher::~SampleDispatcher() {
+    stop();
+}
+
+/**
+ * @brief Starts the dispatcher threads. Does nothing if already running or
+ * synchronous.
+ */
+void SampleDispatcher::start() {
+    if (config_.threads == 0 || running_.load())
+        return;
+    running_.store(true);
+    for (size_t i = 0; i < config_.threads; ++i) {
+        threads_.emplace_back(&SampleDispatcher::run, this);
+    }
+}
+
+/**
+ * @brief Delivers every queued event, then joins the dispatcher threads.
+ *
+ * The running flag is cleared before the wakeup, so a thread either sees
+ * the flag or is woken by the bump; each keeps draining the queue until it
+ * finds it empty with the flag cleared.
+ */
+void SampleDispatcher::stop() {
+    if (!running_.exchange(false))
+        return;
+    pushes_.fetch_add(1, std::memory_order_release);
+    pushes_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+    threads_.clear();
+}
+
+/**
+ * @brief Queues an event for delivery, applying the overflow policy when
+ * the queue is full.
+ *
+ * @param event The event.
+ */
+void SampleDispatcher::post(SampleEvent event) {
+    posted_.fetch_add(1, std::memory_order_relaxed);
+
+    if (!running_.load(std::memory_order_acquire)) {
+        deliver(event);
+        return;
+    }
+
+    bool waited = false;
+    while (!queue_.try_push(event)) {
+        if (config_.policy == OverflowPolicy::BLOCK) {
+            if (!waited) {
+                blocked_.fetch_add(1, std::memory_order_relaxed);
+                waited = true;
+            }
+            uint32_t seen = pops_.load(std::memory_order_acquire);
+            if (queue_.try_push(event))
+                break;
+            pops_.wait(seen, std::memory_order_acquire);
+        } else {
+            discard_oldest();
+        }
+    }
+
+    pushes_.fetch_add(1, std::memory_order_release);
+    pushes_.notify_one();
+}
+
+/**
+ * @brief Returns the delivery counters since construction.
+ */
+DispatchStats SampleDispatcher::stats() const {
+    DispatchStats s;
+    s.posted = posted_.load(std::memory_order_relaxed);
+    s.delivered = delivered_.load(std::memory_order_relaxed);
+    s.dropped = dropped_.load(std::memory_order_relaxed);
+    s.coalesced = coalesced_.load(std::memory_order_relaxed);
+    s.blocked = blocked_.load(std::memory_order_relaxed);
+    return s;
+}
+
+/**
+ * @brief The loop executed by each dispatcher thread.
+ *
+ * Under DROP_OLDEST and BLOCK events are taken one at a time, so queued
+ * events stay in the queue (and count against its capacity) until their
+ * turn. Under COALESCE everything queued is taken as one batch and reduced
+ * to the newest sample per PID.
+ */
+void SampleDispatcher::run() {
+    std::vector<SampleEvent> batch;
+    const bool coalesce = config_.policy == OverflowPolicy::COALESCE;
+
+    for (;;) {
+        uint32_t seen = pushes_.load(std::memory_order_acquire);
+
+        while (auto event = queue_.try_pop()) {
+            pops_.fetch_add(1, std::memory_order_release);
+            pops_.notify_all();
+            if (coalesce) {
+                batch.push_back(std::move(*event));
+                if (batch.size() >= queue_.capacity())
+                    break;
+            } else {
+                deliver(*event);
+            }
+        }
+
+        if (!batch.empty()) {
+            deliver_coalesced(batch);
+            batch.clear();
+            continue;
+        }
+
+        if (!running_.load(std::memory_order_acquire) && queue_.size_approx() == 0)
+            return;
+        pushes_.wait(seen, std::memory_order_acquire);
+    }
+}
+
+/**
+ * @brief Delivers a batch, skipping snapshots superseded by a later event
+ * for the same PID. Exit events and events carrying alerts are always
+ * delivered.
+ *
+ * @param batch The events in queue order.
+ */
+void SampleDispatcher::deliver_coalesced(std::vector<SampleEvent>& batch) {
+    std::unordered_set<pid_t> newer;
+    std::vector<bool> keep(batch.size(), true);
+    for (size_t i = batch.size(); i-- > 0;) {
+        if (!newer.insert(batch[i].pid).second && batch[i].snapshot && !batch[i].alerts) {
+            keep[i] = false;
+        }
+    }
+
+    for (size_t i = 0; i < batch.size(); ++i) {
+        if (keep[i]) {
+            deliver(batch[i]);
+        } else {
+            coalesced_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * @brief Runs the handler for one event; exceptions are logged and
+ * swallowed.
+ */
+void SampleDispatcher::deliver(const SampleEvent& event) {
+    try {
+        handler_(event);
+    } catch (const std::exception& e) {
+        std::cerr << "[memc] Dispatch handler threw: " << e.what() << std::endl;
+    }
+    delivered_.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Discards the oldest queued event to make room for a new one.
+ */
+void SampleDispatcher::discard_oldest() {
+    if (queue_.try_pop()) {
+        pops_.fetch_add(1, std::memory_order_release);
+        pops_.notify_all();
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+} // namespace memc
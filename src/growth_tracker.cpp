@@ -0,0 +1,354 @@
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <memc/growth_tracker.h>
+#include <memc/string_pool.h>
+
+namespace memc {
+
+namespace {
+
+/**
+ * @brief Removes @p suffix from the end of @p s if it is there.
+ */
+bool strip_suffix(std::string_view& s, std::string_view suffix) {
+    if (s.size() < suffix.size() || s.substr(s.size() - suffix.size()) != suffix)
+        return false;
+    s.remove_suffix(suffix.size());
+    return true;
+}
+
+/**
+ * @brief Compares ASCII strings ignoring case.
+ */
+bool equals_nocase(std::string_view a, std::string_view b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+               return std::tolower(static_cast<unsigned char>(x)) ==
+                      std::tolower(static_cast<unsigned char>(y));
+           });
+}
+
+/**
+ * @brief Returns the KB in one unit of a size suffix, or 0 if unknown.
+ */
+double size_unit_kb(std::string_view unit) {
+    if (equals_nocase(unit, "B"))
+        return 1.0 / 1024;
+    if (equals_nocase(unit, "KB") || equals_nocase(unit, "K"))
+        return 1;
+    if (equals_nocase(unit, "MB") || equals_nocase(unit, "M"))
+        return 1024;
+    if (equals_nocase(unit, "GB") || equals_nocase(unit, "G"))
+        return 1024 * 1024;
+    return 0;
+}
+
+/**
+ * @brief Returns how many of a time unit fit in a minute, or 0 if unknown.
+ */
+double per_minute(std::string_view unit) {
+    if (unit == "s")
+        return 60;
+    if (unit == "min")
+        return 1;
+    if (unit == "h")
+        return 1.0 / 60;
+    return 0;
+}
+
+/**
+ * @brief Returns the RegionType printed as @p name, if any.
+ */
+std::optional<RegionType> region_type_from_string(std::string_view name) {
+    for (size_t i = 0; i <= static_cast<size_t>(RegionType::UNKNOWN); ++i) {
+        auto type = static_cast<RegionType>(i);
+        if (name == region_type_to_string(type))
+            return type;
+    }
+    return std::nullopt;
+}
+
+} // namespace
+
+/**
+ * @brief Parses a rule such as "heap_growth>10MB/min".
+ *
+ * @param text The rule.
+ * @return std::optional<GrowthRule> The rule, or std::nullopt if @p text is
+ * malformed.
+ */
+std::optional<GrowthRule> GrowthRule::parse(std::string_view text) {
+    size_t op = text.find_first_of("<>");
+    if (op == std::string_view::npos)
+        return std::nullopt;
+
+    GrowthRule rule;
+    rule.name = std::string(text);
+    rule.above = text[op] == '>';
+
+    std::string_view subject = text.substr(0, op);
+    if (!strip_suffix(subject, "_growth"))
+        return std::nullopt;
+    if (strip_suffix(subject, "_pss"))
+        rule.metric = GrowthMetric::PSS;
+    if (subject.empty())
+        return std::nullopt;
+    rule.subject = std::string(subject);
+
+    std::string_view rest = text.substr(op + 1);
+    size_t slash = rest.rfind('/');
+    if (slash == std::string_view::npos)
+        return std::nullopt;
+    double minutes = per_minute(rest.substr(slash + 1));
+    rest = rest.substr(0, slash);
+
+    double amount = 0;
+    auto [end, ec] = std::from_chars(rest.data(), rest.data() + rest.size(), amount);
+    if (ec != std::errc())
+        return std::nullopt;
+    double unit_kb = size_unit_kb(std::string_view(end, rest.data() + rest.size() - end));
+    if (unit_kb == 0 || minutes == 0)
+        return std::nullopt;
+
+    rule.threshold_kb_per_min = amount * unit_kb * minutes;
+    return rule;
+}
+
+/**
+ * @brief Creates a tracker with no samples.
+ *
+ * A window of fewer than two samples is raised to two, the least a rate
+ * can be computed from. Pathnames named by rules are tracked even without
+ * track_paths.
+ *
+ * @param config The window, warm-up, path tracking and rules.
+ */
+GrowthTracker::GrowthTracker(Config config)
+    : config_(std::move(config)) {
+    config_.window = std::max<size_t>(config_.window, 2);
+    alpha_ = 2.0 / static_cast<double>(config_.window + 1);
+    fixed_.assign(kTypeCount + 1, Series(config_.window));
+
+    for (const GrowthRule& rule : config_.rules) {
+        Binding binding;
+        if (rule.subject == "total") {
+            binding.slot = kTotal;
+        } else if (auto type = region_type_from_string(rule.subject)) {
+            binding.slot = static_cast<size_t>(*type);
+        } else {
+            binding.path = InternedString(rule.subject).id();
+            paths_.try_emplace(binding.path, config_.window).first->second.pinned = true;
+        }
+        bindings_.push_back(binding);
+    }
+    firing_.assign(config_.rules.size(), false);
+}
+
+/**
+ * @brief Adds a sample and evaluates the rules.
+ *
+ * One pass sums the regions into their type and pathname series; runs of
+ * regions with the same pathname (the segments of one library) share a
+ * single map lookup. Every series then gets a point, so a pathname that is
+ * no longer mapped counts as shrinking to zero until it is forgotten.
+ *
+ * @param snapshot The sample.
+ * @param alerts Receives an alert for every rule whose state changed.
+ * @return size_t The number of alerts appended.
+ */
+size_t GrowthTracker::update(const ProcessSnapshot& snapshot, std::vector<GrowthAlert>& alerts) {
+    uint32_t last_path = 0;
+    Series* path = nullptr;
+
+    for (const auto& r : snapshot.regions) {
+        Series& type = fixed_[static_cast<size_t>(r.type)];
+        type.sum[0] += r.rss_kb;
+        type.sum[1] += r.pss_kb;
+
+        uint32_t id = r.pathname.id();
+        if (id == 0)
+            continue;
+        if (id != last_path) {
+            last_path = id;
+            if (config_.track_paths) {
+                path = &paths_.try_emplace(id, config_.window).first->second;
+            } else {
+                auto it = paths_.find(id);
+                path = it != paths_.end() ? &it->second : nullptr;
+            }
+        }
+        if (path) {
+            path->sum[0] += r.rss_kb;
+            path->sum[1] += r.pss_kb;
+        }
+    }
+
+    Series& total = fixed_[kTotal];
+    for (size_t i = 0; i < kTypeCount; ++i) {
+        total.sum[0] += fixed_[i].sum[0];
+        total.sum[1] += fixed_[i].sum[1];
+    }
+    for (Series& series : fixed_) {
+        push(series, snapshot.timestamp_ms);
+    }
+    for (auto it = paths_.begin(); it != paths_.end();) {
+        Series& series = it->second;
+        series.idle = series.sum[0] == 0 && series.sum[1] == 0 ? series.idle + 1 : 0;
+        push(series, snapshot.timestamp_ms);
+        if (series.idle >= config_.window && !series.pinned) {
+            it = paths_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    const size_t warm_up = std::max<size_t>(config_.min_samples, 2);
+    size_t raised = 0;
+    for (size_t i = 0; i < config_.rules.size(); ++i) {
+        const GrowthRule& rule = config_.rules[i];
+        const size_t m = static_cast<size_t>(rule.metric);
+        const Series* series = find(bindings_[i]);
+
+        bool holds = false;
+        double rate = 0;
+        uint64_t value = 0;
+        if (series && series->samples >= warm_up) {
+            rate = series->rate[m];
+            value = series->points.back().kb[m];
+            holds = rule.above ? rate > rule.threshold_kb_per_min
+                               : rate < rule.threshold_kb_per_min;
+        }
+        if (holds != firing_[i]) {
+            firing_[i] = holds;
+            alerts.push_back({snapshot.pid, snapshot.timestamp_ms, i, holds, rate, value});
+            ++raised;
+        }
+    }
+    return raised;
+}
+
+/**
+ * @brief Appends the accumulated sums as a new point and updates the
+ * moving averages.
+ *
+ * The newest rate is (value - previous value) / elapsed minutes; a sample
+ * with the same timestamp as the previous one updates the window but not
+ * the averages. The first rate seeds the average.
+ */
+void GrowthTracker::push(Series& series, uint64_t timestamp_ms) {
+    Point point;
+    point.timestamp_ms = timestamp_ms;
+    point.kb[0] = series.sum[0];
+    point.kb[1] = series.sum[1];
+    series.sum[0] = 0;
+    series.sum[1] = 0;
+
+    if (series.points.size() != 0 && timestamp_ms > series.points.back().timestamp_ms) {
+        const Point& last = series.points.back();
+        double minutes = static_cast<double>(timestamp_ms - last.timestamp_ms) / 60000.0;
+        for (size_t m = 0; m < 2; ++m) {
+            double rate =
+                (static_cast<double>(point.kb[m]) - static_cast<double>(last.kb[m])) / minutes;
+            series.rate[m] = series.samples == 1 ? rate
+                                                 : alpha_ * rate + (1 - alpha_) * series.rate[m];
+        }
+    }
+    series.points.push_back(point);
+    series.samples++;
+}
+
+/**
+ * @brief Returns the series a rule is bound to, or nullptr if its pathname
+ * is not tracked.
+ */
+const GrowthTracker::Series* GrowthTracker::find(const Binding& binding) const {
+    if (binding.path == 0)
+        return &fixed_[binding.slot];
+    auto it = paths_.find(binding.path);
+    return it != paths_.end() ? &it->second : nullptr;
+}
+
+/**
+ * @brief Returns the statistics of one series.
+ *
+ * @param subject "total", a region type name or a pathname.
+ * @param metric The counter.
+ * @return std::optional<GrowthRate> The statistics, or std::nullopt if no
+ * such series is tracked or it has no sample yet.
+ */
+std::optional<GrowthRate> GrowthTracker::rate(std::string_view subject,
+                                              GrowthMetric metric) const {
+    const Series* series = nullptr;
+    if (subject == "total") {
+        series = &fixed_[kTotal];
+    } else if (auto type = region_type_from_string(subject)) {
+        series = &fixed_[static_cast<size_t>(*type)];
+    } else {
+        // Looked up by text so that queries never add to the string pool.
+        for (const auto& [id, s] : paths_) {
+            if (StringPool::global().lookup(id) == subject) {
+                series = &s;
+                break;
+            }
+        }
+    }
+    if (!series || series->samples == 0)
+        return std::nullopt;
+    return describe(subject, *series, metric);
+}
+
+/**
+ * @brief Returns the statistics of every series that has a sample.
+ *
+ * Region types the process has never mapped (at zero and not moving) are
+ * left out.
+ */
+std::vector<GrowthRate> GrowthTracker::rates() const {
+    std::vector<GrowthRate> out;
+    if (fixed_[kTotal].samples == 0)
+        return out;
+
+    auto add = [&](std::string_view subject, const Series& series) {
+        out.push_back(describe(subject, series, GrowthMetric::RSS));
+        out.push_back(describe(subject, series, GrowthMetric::PSS));
+    };
+    add("total", fixed_[kTotal]);
+    for (size_t i = 0; i < kTypeCount; ++i) {
+        const Series& series = fixed_[i];
+        const Point& last = series.points.back();
+        if (last.kb[0] != 0 || last.kb[1] != 0 || series.rate[0] != 0 || series.rate[1] != 0) {
+            add(region_type_to_string(static_cast<RegionType>(i)), series);
+        }
+    }
+    for (const auto& [id, series] : paths_) {
+        if (series.samples != 0) {
+            add(StringPool::global().lookup(id), series);
+        }
+    }
+    return out;
+}
+
+/**
+ * @brief Builds the public statistics of a series with at least one sample.
+ */
+GrowthRate GrowthTracker::describe(std::string_view subject, const Series& series,
+                                   GrowthMetric metric) const {
+    const size_t m = static_cast<size_t>(metric);
+    const Point& first = series.points.front();
+    const Point& last = series.points.back();
+
+    GrowthRate rate;
+    rate.subject = std::string(subject);
+    rate.metric = metric;
+    rate.value_kb = last.kb[m];
+    rate.rate_kb_per_min = series.samples > 1 ? series.rate[m] : 0;
+    if (last.timestamp_ms > first.timestamp_ms) {
+        double minutes = static_cast<double>(last.timestamp_ms - first.timestamp_ms) / 60000.0;
+        rate.window_kb_per_min =
+            (static_cast<double>(last.kb[m]) - static_cast<double>(first.kb[m])) / minutes;
+    }
+    rate.samples = series.samples;
+    return rate;
+}
+
+} // namespace memc
@@ -0,0 +1,217 @@
+#include <cerrno>
+#include <ctime>
+#include <memc/interval_timer.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+namespace memc {
+
+namespace {
+
+constexpr int64_t kNanosPerSecond = 1'000'000'000;
+
+/// Longest single sleep of the fallback path, bounding its stop latency.
+constexpr int64_t kFallbackSliceNs = 50'000'000;
+
+/**
+ * @brief Returns the current CLOCK_MONOTONIC time in nanoseconds.
+ */
+int64_t monotonic_ns() {
+    timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * kNanosPerSecond + ts.tv_nsec;
+}
+
+timespec to_timespec(int64_t ns) {
+    return {static_cast<time_t>(ns / kNanosPerSecond), static_cast<long>(ns % kNanosPerSecond)};
+}
+
+} // namespace
+
+/**
+ * @brief Creates a stopped timer and its timerfd/eventfd pair.
+ *
+ * @param interval Time between deadlines.
+ */
+IntervalTimer::IntervalTimer(std::chrono::nanoseconds interval)
+    : interval_ns_(interval.count() > 0 ? interval.count() : 0) {
+    timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+    stop_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (timer_fd_ < 0 || stop_fd_ < 0) {
+        if (timer_fd_ >= 0)
+            close(timer_fd_);
+        if (stop_fd_ >= 0)
+            close(stop_fd_);
+        timer_fd_ = stop_fd_ = -1;
+    }
+}
+
+/**
+ * @brief Closes the descriptors.
+ */
+IntervalTimer::~IntervalTimer() {
+    if (timer_fd_ >= 0)
+        close(timer_fd_);
+    if (stop_fd_ >= 0)
+        close(stop_fd_);
+}
+
+/**
+ * @brief Resets the schedule and statistics; the first deadline is now.
+ *
+ * A stop notification left over from a previous run is drained.
+ */
+void IntervalTimer::start() {
+    if (stop_fd_ >= 0) {
+        uint64_t value;
+        while (read(stop_fd_, &value, sizeof(value)) == static_cast<ssize_t>(sizeof(value))) {
+        }
+    }
+
+    ticks_.store(0, std::memory_order_relaxed);
+    missed_.store(0, std::memory_order_relaxed);
+    last_jitter_ns_.store(0, std::memory_order_relaxed);
+    max_jitter_ns_.store(0, std::memory_order_relaxed);
+    total_jitter_ns_.store(0, std::memory_order_relaxed);
+
+    next_ns_ = monotonic_ns();
+    stopped_.store(false, std::memory_order_release);
+}
+
+/**
+ * @brief Blocks until the next deadline.
+ *
+ * If the caller is late, the most recent passed deadline fires at once and
+ * any earlier ones are counted as missed, so the schedule stays on its
+ * grid. The wakeup's lateness against its deadline is recorded as jitter.
+ *
+ * @return true on a deadline, false once stop() has been called.
+ */
+bool IntervalTimer::wait() {
+    if (stopped())
+        return false;
+
+    if (interval_ns_ > 0) {
+        int64_t now = monotonic_ns();
+        if (now > next_ns_) {
+            // The caller overran: fire at once for the latest passed deadline
+            // and count the ones before it as missed.
+            int64_t skipped = (now - next_ns_) / interval_ns_;
+            next_ns_ += skipped * interval_ns_;
+            missed_.fetch_add(static_cast<uint64_t>(skipped), std::memory_order_relaxed);
+        }
+    } else {
+        next_ns_ = monotonic_ns();
+    }
+
+    if (!sleep_until(next_ns_))
+        return false;
+
+    record(monotonic_ns() - next_ns_);
+    next_ns_ += interval_ns_;
+    return true;
+}
+
+/**
+ * @brief Wakes any waiter and makes every later wait() return false.
+ *
+ * Only an atomic store and a write(2), both async-signal-safe.
+ */
+void IntervalTimer::stop() noexcept {
+    stopped_.store(true, std::memory_order_release);
+    if (stop_fd_ >= 0) {
+        uint64_t one = 1;
+        ssize_t ignored = write(stop_fd_, &one, sizeof(one));
+        (void)ignored;
+    }
+}
+
+/**
+ * @brief Returns the statistics gathered since the last start().
+ */
+TimerStats IntervalTimer::stats() const noexcept {
+    TimerStats s;
+    s.ticks = ticks_.load(std::memory_order_relaxed);
+    s.missed = missed_.load(std::memory_order_relaxed);
+    s.last_jitter_ns = last_jitter_ns_.load(std::memory_order_relaxed);
+    s.max_jitter_ns = max_jitter_ns_.load(std::memory_order_relaxed);
+    if (s.ticks > 0) {
+        s.mean_jitter_ns = static_cast<double>(total_jitter_ns_.load(std::memory_order_relaxed)) /
+                           static_cast<double>(s.ticks);
+    }
+    return s;
+}
+
+/**
+ * @brief Sleeps until @p deadline_ns on CLOCK_MONOTONIC or until stopped.
+ *
+ * @return true if the deadline was reached, false if stopped.
+ */
+bool IntervalTimer::sleep_until(int64_t deadline_ns) {
+    if (timer_fd_ < 0)
+        return sleep_sliced(deadline_ns);
+
+    if (deadline_ns <= monotonic_ns())
+        return !stopped();
+
+    itimerspec spec{};
+    spec.it_value = to_timespec(deadline_ns);
+    if (timerfd_settime(timer_fd_, TFD_TIMER_ABSTIME, &spec, nullptr) != 0)
+        return sleep_sliced(deadline_ns);
+
+    pollfd fds[2] = {{timer_fd_, POLLIN, 0}, {stop_fd_, POLLIN, 0}};
+    while (!stopped()) {
+        int ready = poll(fds, 2, -1);
+        if (ready < 0) {
+            if (errno == EINTR)
+                continue;
+            return sleep_sliced(deadline_ns);
+        }
+        if (fds[1].revents & POLLIN)
+            return false;
+        if (fds[0].revents & POLLIN) {
+            uint64_t expirations;
+            ssize_t ignored = read(timer_fd_, &expirations, sizeof(expirations));
+            (void)ignored;
+            return !stopped();
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Fallback sleep when timerfd/eventfd are unavailable.
+ *
+ * Sleeps with clock_nanosleep(TIMER_ABSTIME) in slices of at most
+ * kFallbackSliceNs, checking the stop flag between slices.
+ *
+ * @return true if the deadline was reached, false if stopped.
+ */
+bool IntervalTimer::sleep_sliced(int64_t deadline_ns) {
+    while (!stopped()) {
+        int64_t now = monotonic_ns();
+        if (now >= deadline_ns)
+            return true;
+        int64_t target = deadline_ns - now > kFallbackSliceNs ? now + kFallbackSliceNs : deadline_ns;
+        timespec ts = to_timespec(target);
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr);
+    }
+    return false;
+}
+
+/**
+ * @brief Accounts one honored deadline woken @p jitter_ns late.
+ */
+void IntervalTimer::record(int64_t jitter_ns) {
+    if (jitter_ns < 0)
+        jitter_ns = 0;
+    last_jitter_ns_.store(jitter_ns, std::memory_order_relaxed);
+    if (jitter_ns > max_jitter_ns_.load(std::memory_order_relaxed))
+        max_jitter_ns_.store(jitter_ns, std::memory_order_relaxed);
+    total_jitter_ns_.fetch_add(jitter_ns, std::memory_order_relaxed);
+    ticks_.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace memc
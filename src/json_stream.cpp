@@ -0,0 +1,135 @@
+#include <memc/json_stream.h>
+
+namespace memc {
+
+/**
+ * @brief Constructs a writer over an output stream.
+ *
+ * @param out The stream to write to. It must outlive the writer.
+ * @param pretty If true, indent with two spaces like dump(2).
+ * @param incremental If true, write the unchanged and exited fields.
+ * @param fields The smaps fields to write for each region.
+ */
+SystemJsonWriter::SystemJsonWriter(std::ostream& out, bool pretty, bool incremental,
+                                   SmapsFields fields)
+    : out_(out)
+    , pretty_(pretty)
+    , incremental_(incremental)
+    , entry_writer_(pretty, 2, fields) {}
+
+/**
+ * @brief Writes the document header and opens the "processes" array.
+ *
+ * @param timestamp_ms The scan timestamp in UNIX epoch milliseconds.
+ */
+void SystemJsonWriter::begin(uint64_t timestamp_ms) {
+    if (pretty_) {
+        out_ << "{\n  \"timestamp_ms\": " << timestamp_ms << ",\n  \"processes\": [";
+    } else {
+        out_ << "{\"timestamp_ms\":" << timestamp_ms << ",\"processes\":[";
+    }
+}
+
+/**
+ * @brief Serializes one process entry into the "processes" array.
+ *
+ * The entry is written into a reused buffer and flushed to the stream
+ * immediately, so nothing but the buffer outlives this call.
+ *
+ * @param entry The collected process.
+ */
+void SystemJsonWriter::write_process(const ProcessEntry& entry) {
+    if (pretty_) {
+        out_ << (process_count_ == 0 ? "\n    " : ",\n    ");
+    } else if (process_count_ != 0) {
+        out_ << ',';
+    }
+
+    JsonWriter& w = entry_writer_;
+    w.clear();
+    w.begin_object();
+    w.key("pid");
+    w.value(static_cast<int64_t>(entry.pid));
+    w.key("name");
+    w.value(std::string_view(entry.name));
+    if (entry.summary) {
+        w.key("summary");
+        w.write(*entry.summary);
+    } else if (entry.snapshot) {
+        w.key("snapshot");
+        w.write(*entry.snapshot);
+    }
+    w.end_object();
+
+    out_ << w.view();
+    process_count_++;
+}
+
+/**
+ * @brief Records a process that could not be read.
+ *
+ * @param pid The process ID.
+ * @param name The process name.
+ */
+void SystemJsonWriter::add_skipped(pid_t pid, std::string name) {
+    skipped_.emplace_back(pid, std::move(name));
+    skipped_total_ = skipped_.size();
+}
+
+/**
+ * @brief Closes the "processes" array and writes the trailing fields.
+ *
+ * Empty arrays are written as "[]", matching nlohmann's dump().
+ *
+ * @param files If not null, written as the "shared_files" array.
+ */
+void SystemJsonWriter::finish(const SharedFileTable* files) {
+    JsonWriter w(pretty_, 1);
+    w.begin_array();
+    for (const auto& [pid, name] : skipped_) {
+        w.begin_object();
+        w.key("pid");
+        w.value(static_cast<int64_t>(pid));
+        w.key("name");
+        w.value(std::string_view(name));
+        w.end_object();
+    }
+    w.end_array();
+    skipped_total_ = skipped_.size();
+    skipped_.clear();
+
+    if (pretty_) {
+        out_ << (process_count_ == 0 ? "]" : "\n  ]") << ",\n  \"process_count\": "
+             << process_count_ << ",\n  \"skipped_count\": " << skipped_total_
+             << ",\n  \"skipped_processes\": " << w.view();
+    } else {
+        out_ << "],\"process_count\":" << process_count_ << ",\"skipped_count\":" << skipped_total_
+             << ",\"skipped_processes\":" << w.view();
+    }
+
+    if (incremental_) {
+        w.clear();
+        w.begin_array();
+        for (pid_t pid : exited_) {
+            w.value(static_cast<int64_t>(pid));
+        }
+        w.end_array();
+
+        if (pretty_) {
+            out_ << ",\n  \"unchanged_count\": " << unchanged_count_
+                 << ",\n  \"exited_pids\": " << w.view();
+        } else {
+            out_ << ",\"unchanged_count\":" << unchanged_count_ << ",\"exited_pids\":" << w.view();
+        }
+    }
+
+    if (files) {
+        w.clear();
+        w.write(*files);
+        out_ << (pretty_ ? ",\n  \"shared_files\": " : ",\"shared_files\":") << w.view();
+    }
+
+    out_ << (pretty_ ? "\n}" : "}");
+}
+
+} // namespace memc
@@ -0,0 +1,592 @@
+#include "self_stats_internal.h"
+
+#include <charconv>
+#include <memc/json_writer.h>
+
+namespace memc {
+
+namespace {
+
+/// Two lowercase hex digits for every byte value.
+constexpr std::array<char, 512> kHexPairs = [] {
+    constexpr char digits[] = "0123456789abcdef";
+    std::array<char, 512> table{};
+    for (int i = 0; i < 256; ++i) {
+        table[i * 2] = digits[i >> 4];
+        table[i * 2 + 1] = digits[i & 0xF];
+    }
+    return table;
+}();
+
+/**
+ * @brief Returns the length of the valid UTF-8 sequence at @p p, or 0.
+ *
+ * Rejects overlong encodings, surrogates and code points above U+10FFFF,
+ * the same inputs nlohmann's decoder refuses.
+ */
+size_t utf8_sequence_length(const unsigned char* p, const unsigned char* end) {
+    auto cont = [&](size_t i, unsigned char lo = 0x80, unsigned char hi = 0xBF) {
+        return p + i < end && p[i] >= lo && p[i] <= hi;
+    };
+
+    unsigned char c = p[0];
+    if (c >= 0xC2 && c <= 0xDF)
+        return cont(1) ? 2 : 0;
+    if (c == 0xE0)
+        return cont(1, 0xA0) && cont(2) ? 3 : 0;
+    if ((c >= 0xE1 && c <= 0xEC) || c == 0xEE || c == 0xEF)
+        return cont(1) && cont(2) ? 3 : 0;
+    if (c == 0xED)
+        return cont(1, 0x80, 0x9F) && cont(2) ? 3 : 0;
+    if (c == 0xF0)
+        return cont(1, 0x90) && cont(2) && cont(3) ? 4 : 0;
+    if (c >= 0xF1 && c <= 0xF3)
+        return cont(1) && cont(2) && cont(3) ? 4 : 0;
+    if (c == 0xF4)
+        return cont(1, 0x80, 0x8F) && cont(2) && cont(3) ? 4 : 0;
+    return 0;
+}
+
+/// One smaps counter of MemoryRegion, with its JSON key and SmapsFields bit.
+struct SmapsCounter {
+    std::string_view key;
+    uint16_t bit;
+    uint64_t MemoryRegion::*member;
+};
+
+constexpr SmapsCounter kSmapsCounters[] = {
+    {"rss_kb", SmapsFields::kRss, &MemoryRegion::rss_kb},
+    {"pss_kb", SmapsFields::kPss, &MemoryRegion::pss_kb},
+    {"shared_clean_kb", SmapsFields::kSharedClean, &MemoryRegion::shared_clean_kb},
+    {"shared_dirty_kb", SmapsFields::kSharedDirty, &MemoryRegion::shared_dirty_kb},
+    {"private_clean_kb", SmapsFields::kPrivateClean, &MemoryRegion::private_clean_kb},
+    {"private_dirty_kb", SmapsFields::kPrivateDirty, &MemoryRegion::private_dirty_kb},
+    {"swap_kb", SmapsFields::kSwap, &MemoryRegion::swap_kb},
+    {"swap_pss_kb", SmapsFields::kSwapPss, &MemoryRegion::swap_pss_kb},
+    {"locked_kb", SmapsFields::kLocked, &MemoryRegion::locked_kb},
+    {"anon_huge_kb", SmapsFields::kAnonHuge, &MemoryRegion::anon_huge_kb},
+    {"shmem_pmd_kb", SmapsFields::kShmemPmd, &MemoryRegion::shmem_pmd_kb},
+    {"file_pmd_kb", SmapsFields::kFilePmd, &MemoryRegion::file_pmd_kb},
+};
+
+constexpr uint16_t kThpFields = SmapsFields::kAnonHuge | SmapsFields::kShmemPmd |
+                                SmapsFields::kFilePmd;
+
+} // namespace
+
+/**
+ * @brief Constructs a writer.
+ *
+ * @param pretty If true, indent with two spaces like dump(2).
+ * @param base_depth Nesting depth the output will be embedded at.
+ * @param fields The smaps fields to write for each region.
+ */
+JsonWriter::JsonWriter(bool pretty, unsigned base_depth, SmapsFields fields)
+    : pretty_(pretty)
+    , base_depth_(base_depth)
+    , fields_(fields) {}
+
+/**
+ * @brief Serializes a memory region as a JSON object.
+ *
+ * Field order and presence match to_json(ordered_json&, const MemoryRegion&)
+ * when every smaps field is selected; otherwise only the selected counters
+ * are written.
+ *
+ * @param r The region to write.
+ */
+void JsonWriter::write(const MemoryRegion& r) {
+    begin_object();
+    key("start");
+    value_hex(r.start_addr);
+    key("end");
+    value_hex(r.end_addr);
+    key("type");
+    value(std::string_view(region_type_to_string(r.type)));
+    key("perm");
+    value(std::string_view(r.permissions));
+    key("size_kb");
+    value(r.size_bytes() / 1024);
+
+    if (!r.pathname.empty()) {
+        key("pathname");
+        value(std::string_view(r.pathname));
+    }
+
+    if (r.has_smaps_data) {
+        for (const SmapsCounter& counter : kSmapsCounters) {
+            if (fields_.has(counter.bit)) {
+                key(counter.key);
+                value(r.*counter.member);
+            }
+        }
+        if (fields_.has(SmapsFields::kThpEligible)) {
+            key("thp_eligible");
+            value(uint64_t{r.thp_eligible});
+        }
+    }
+
+    if (!r.numa_kb.empty()) {
+        key("numa_kb");
+        begin_array();
+        for (uint64_t kb : r.numa_kb) {
+            value(kb);
+        }
+        end_array();
+    }
+    end_object();
+}
+
+/**
+ * @brief Serializes a process snapshot, including all its regions.
+ *
+ * Field order matches to_json(ordered_json&, const ProcessSnapshot&).
+ *
+ * @param s The snapshot to write.
+ */
+void JsonWriter::write(const ProcessSnapshot& s) {
+    detail::PhaseTimer timer(StatPhase::SERIALIZE);
+    begin_object();
+    key("pid");
+    value(static_cast<int64_t>(s.pid));
+    key("timestamp_ms");
+    value(s.timestamp_ms);
+    key("total_rss_kb");
+    value(s.total_rss_kb());
+    key("total_vsize_kb");
+    value(s.total_vsize_kb());
+    if (s.has_smaps_data()) {
+        if (fields_.has(kThpFields)) {
+            key("total_thp_kb");
+            value(s.total_thp_kb());
+        }
+        if (fields_.has(SmapsFields::kLocked)) {
+            key("total_locked_kb");
+            value(s.total_locked_kb());
+        }
+    }
+    if (s.has_numa_data()) {
+        key("numa_node_kb");
+        begin_array();
+        for (uint64_t kb : s.numa_node_kb()) {
+            value(kb);
+        }
+        end_array();
+        key("numa_remote_kb");
+        value(s.numa_remote_kb());
+    }
+    key("region_count");
+    value(static_cast<uint64_t>(s.regions.size()));
+
+    key("regions");
+    begin_array();
+    for (const auto& r : s.regions) {
+        write(r);
+    }
+    end_array();
+    end_object();
+}
+
+/**
+ * @brief Serializes a process summary as a JSON object.
+ *
+ * Field order matches to_json(ordered_json&, const ProcessSummary&).
+ *
+ * @param s The summary to write.
+ */
+void JsonWriter::write(const ProcessSummary& s) {
+    detail::PhaseTimer timer(StatPhase::SERIALIZE);
+    begin_object();
+    key("pid");
+    value(static_cast<int64_t>(s.pid));
+    key("timestamp_ms");
+    value(s.timestamp_ms);
+    key("rss_kb");
+    value(s.rss_kb);
+    key("pss_kb");
+    value(s.pss_kb);
+    key("pss_anon_kb");
+    value(s.pss_anon_kb);
+    key("pss_file_kb");
+    value(s.pss_file_kb);
+    key("pss_shmem_kb");
+    value(s.pss_shmem_kb);
+    key("shared_clean_kb");
+    value(s.shared_clean_kb);
+    key("shared_dirty_kb");
+    value(s.shared_dirty_kb);
+    key("private_clean_kb");
+    value(s.private_clean_kb);
+    key("private_dirty_kb");
+    value(s.private_dirty_kb);
+    key("anonymous_kb");
+    value(s.anonymous_kb);
+    key("swap_kb");
+    value(s.swap_kb);
+    key("swap_pss_kb");
+    value(s.swap_pss_kb);
+    key("locked_kb");
+    value(s.locked_kb);
+    key("anon_huge_kb");
+    value(s.anon_huge_kb);
+    key("shmem_pmd_kb");
+    value(s.shmem_pmd_kb);
+    key("file_pmd_kb");
+    value(s.file_pmd_kb);
+    end_object();
+}
+
+/**
+ * @brief Serializes a snapshot delta, including its changed regions.
+ *
+ * Field order matches to_json(ordered_json&, const SnapshotDelta&).
+ *
+ * @param d The delta to write.
+ */
+void JsonWriter::write(const SnapshotDelta& d) {
+    detail::PhaseTimer timer(StatPhase::SERIALIZE);
+    begin_object();
+    key("pid");
+    value(static_cast<int64_t>(d.pid));
+    key("timestamp_ms");
+    value(d.timestamp_ms);
+    key("base_timestamp_ms");
+    value(d.base_timestamp_ms);
+    key("total_rss_kb");
+    value(d.total_rss_kb);
+    key("total_vsize_kb");
+    value(d.total_vsize_kb);
+    key("region_count");
+    value(d.region_count);
+
+    key("added");
+    begin_array();
+    for (const auto& r : d.added) {
+        write(r);
+    }
+    end_array();
+    key("changed");
+    begin_array();
+    for (const auto& r : d.changed) {
+        write(r);
+    }
+    end_array();
+    key("removed");
+    begin_array();
+    for (uint64_t start : d.removed) {
+        value_hex(start);
+    }
+    end_array();
+    end_object();
+}
+
+/**
+ * @brief Serializes a page report, one object per scanned region.
+ *
+ * The hot/cold fields are only written when the report holds idle
+ * tracking data.
+ *
+ * @param p The report to write.
+ */
+void JsonWriter::write(const PageReport& p) {
+    detail::PhaseTimer timer(StatPhase::SERIALIZE);
+    static constexpr std::string_view kColdKeys[kIdleAgeBuckets] = {
+        "cold_1", "cold_2_3", "cold_4_7", "cold_8_plus"};
+
+    begin_object();
+    key("pid");
+    value(static_cast<int64_t>(p.pid));
+    key("timestamp_ms");
+    value(p.timestamp_ms);
+    key("page_size");
+    value(p.page_size);
+    key("region_count");
+    value(static_cast<uint64_t>(p.regions.size()));
+
+    key("regions");
+    begin_array();
+    for (const auto& r : p.regions) {
+        begin_object();
+        key("start");
+        value_hex(r.start_addr);
+        key("end");
+        value_hex(r.end_addr);
+        key("type");
+        value(std::string_view(region_type_to_string(r.type)));
+        if (!r.pathname.empty()) {
+            key("pathname");
+            value(std::string_view(r.pathname));
+        }
+        key("pages");
+        value(r.pages);
+        key("present");
+        value(r.present);
+        key("swapped");
+        value(r.swapped);
+        key("exclusive");
+        value(r.exclusive);
+        key("shared");
+        value(r.shared);
+        key("file_backed");
+        value(r.file_backed);
+        key("soft_dirty");
+        value(r.soft_dirty);
+        if (p.idle_tracked) {
+            key("hot");
+            value(r.hot);
+            for (size_t i = 0; i < kIdleAgeBuckets; ++i) {
+                key(kColdKeys[i]);
+                value(r.cold[i]);
+            }
+        }
+        end_object();
+    }
+    end_array();
+    end_object();
+}
+
+/**
+ * @brief Serializes a shared file table, one object per file.
+ *
+ * resident_kb is only written when the table was fed from pagemap.
+ *
+ * @param t The table to write.
+ */
+void JsonWriter::write(const SharedFileTable& t) {
+    detail::PhaseTimer timer(StatPhase::SERIALIZE);
+    char device[16];
+
+    begin_array();
+    for (const auto& f : t.files()) {
+        begin_object();
+        key("device");
+        value(f.device.format(device));
+        key("inode");
+        value(f.inode);
+        if (!f.pathname.empty()) {
+            key("pathname");
+            value(std::string_view(f.pathname));
+        }
+        key("processes");
+        value(static_cast<uint64_t>(f.processes));
+        key("mappings");
+        value(static_cast<uint64_t>(f.mappings));
+        key("mapped_kb");
+        value(f.mapped_kb);
+        key("rss_kb");
+        value(f.rss_kb);
+        key("pss_kb");
+        value(f.pss_kb);
+        key("shared_kb");
+        value(f.shared_kb);
+        key("private_kb");
+        value(f.private_kb);
+        if (t.pages_counted()) {
+            key("resident_kb");
+            value(f.resident_kb);
+        }
+        end_object();
+    }
+    end_array();
+}
+
+void JsonWriter::begin_object() {
+    before_value();
+    buf_.push_back('{');
+    first_[++depth_] = true;
+}
+
+/**
+ * @brief Closes the current object; an empty object is written as "{}".
+ */
+void JsonWriter::end_object() {
+    if (!first_[depth_] && pretty_) {
+        newline_indent(base_depth_ + depth_ - 1);
+    }
+    buf_.push_back('}');
+    --depth_;
+}
+
+void JsonWriter::begin_array() {
+    before_value();
+    buf_.push_back('[');
+    first_[++depth_] = true;
+}
+
+/**
+ * @brief Closes the current array; an empty array is written as "[]".
+ */
+void JsonWriter::end_array() {
+    if (!first_[depth_] && pretty_) {
+        newline_indent(base_depth_ + depth_ - 1);
+    }
+    buf_.push_back(']');
+    --depth_;
+}
+
+/**
+ * @brief Writes an object key, preceded by the member separator if needed.
+ *
+ * @param k The key. It is escaped like any other string.
+ */
+void JsonWriter::key(std::string_view k) {
+    before_value();
+    buf_.push_back('"');
+    write_escaped(k);
+    buf_.append(pretty_ ? "\": " : "\":");
+    after_key_ = true;
+}
+
+void JsonWriter::value(uint64_t v) {
+    before_value();
+    char tmp[24];
+    auto res = std::to_chars(tmp, tmp + sizeof(tmp), v);
+    buf_.append(tmp, res.ptr);
+}
+
+void JsonWriter::value(int64_t v) {
+    before_value();
+    char tmp[24];
+    auto res = std::to_chars(tmp, tmp + sizeof(tmp), v);
+    buf_.append(tmp, res.ptr);
+}
+
+void JsonWriter::value(std::string_view v) {
+    before_value();
+    buf_.push_back('"');
+    write_escaped(v);
+    buf_.push_back('"');
+}
+
+/**
+ * @brief Writes @p v as a quoted "0x..." string without leading zeros.
+ *
+ * Equivalent to printf("0x%lx"), but formats two digits per table lookup.
+ *
+ * @param v The value to format.
+ */
+void JsonWriter::value_hex(uint64_t v) {
+    before_value();
+    char tmp[20];
+    char* end = tmp + sizeof(tmp);
+    char* p = end;
+
+    do {
+        p -= 2;
+        const char* pair = &kHexPairs[(v & 0xFF) * 2];
+        p[0] = pair[0];
+        p[1] = pair[1];
+        v >>= 8;
+    } while (v != 0);
+    if (*p == '0' && p + 1 < end) {
+        ++p;
+    }
+
+    buf_.append("\"0x");
+    buf_.append(p, end);
+    buf_.push_back('"');
+}
+
+void JsonWriter::clear() {
+    buf_.clear();
+    depth_ = 0;
+    after_key_ = false;
+}
+
+/**
+ * @brief Emits the separator that precedes a value or key.
+ *
+ * A value directly after a key needs nothing; otherwise every element but
+ * the first in a container is preceded by ',', and in pretty mode each
+ * element starts on its own indented line.
+ */
+void JsonWriter::before_value() {
+    if (after_key_) {
+        after_key_ = false;
+        return;
+    }
+    if (depth_ == 0) {
+        return;
+    }
+    if (first_[depth_]) {
+        first_[depth_] = false;
+    } else {
+        buf_.push_back(',');
+    }
+    if (pretty_) {
+        newline_indent(base_depth_ + depth_);
+    }
+}
+
+void JsonWriter::newline_indent(unsigned depth) {
+    buf_.push_back('\n');
+    buf_.append(depth * 2, ' ');
+}
+
+/**
+ * @brief Appends @p s with JSON escaping, matching nlohmann's dump().
+ *
+ * Runs of plain characters are copied in bulk. '"', '\\' and control
+ * characters are escaped (short forms where JSON has them, otherwise
+ * \\u00xx). Invalid UTF-8, which nlohmann would reject with an exception,
+ * is replaced by U+FFFD.
+ *
+ * @param s The raw string.
+ */
+void JsonWriter::write_escaped(std::string_view s) {
+    const auto* p = reinterpret_cast<const unsigned char*>(s.data());
+    const auto* end = p + s.size();
+
+    while (p < end) {
+        const auto* run = p;
+        while (p < end && *p >= 0x20 && *p < 0x80 && *p != '"' && *p != '\\')
+            ++p;
+        buf_.append(reinterpret_cast<const char*>(run), p - run);
+        if (p == end)
+            break;
+
+        unsigned char c = *p;
+        if (c >= 0x80) {
+            size_t len = utf8_sequence_length(p, end);
+            if (len == 0) {
+                buf_.append("\xEF\xBF\xBD");
+                ++p;
+            } else {
+                buf_.append(reinterpret_cast<const char*>(p), len);
+                p += len;
+            }
+            continue;
+        }
+
+        switch (c) {
+        case '"':
+            buf_.append("\\\"");
+            break;
+        case '\\':
+            buf_.append("\\\\");
+            break;
+        case '\b':
+            buf_.append("\\b");
+            break;
+        case '\f':
+            buf_.append("\\f");
+            break;
+        case '\n':
+            buf_.append("\\n");
+            break;
+        case '\r':
+            buf_.append("\\r");
+            break;
+        case '\t':
+            buf_.append("\\t");
+            break;
+        default:
+            buf_.append("\\u00");
+            buf_.append(&kHexPairs[c * 2], 2);
+            break;
+        }
+        ++p;
+    }
+}
+
+} // namespace memc
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace memc::detail {
+
+/// Lookup table mapping an ASCII byte to its hex digit value, or -1.
+inline constexpr std::array<int8_t, 256> kHexDigits = [] {
+    std::array<int8_t, 256> table{};
+    for (auto& v : table)
+        v = -1;
+    for (int c = '0'; c <= '9'; ++c)
+        table[c] = static_cast<int8_t>(c - '0');
+    for (int c = 'a'; c <= 'f'; ++c)
+        table[c] = static_cast<int8_t>(c - 'a' + 10);
+    for (int c = 'A'; c <= 'F'; ++c)
+        table[c] = static_cast<int8_t>(c - 'A' + 10);
+    return table;
+}();
+
+inline bool is_blank(char c) {
+    return c == ' ' || c == '\t';
+}
+
+/**
+ * @brief Forward-only cursor over a single /proc line.
+ *
+ * Every scanner consumes characters from the front of the view and reports
+ * failure instead of throwing, so a malformed line costs nothing more than
+ * the bytes inspected before the error.
+ */
+struct LineCursor {
+    std::string_view rest;
+
+    void skip_blanks() {
+        size_t i = 0;
+        while (i < rest.size() && is_blank(rest[i]))
+            ++i;
+        rest.remove_prefix(i);
+    }
+
+    bool scan_hex(uint64_t& out) {
+        size_t i = 0;
+        uint64_t value = 0;
+        while (i < rest.size()) {
+            int8_t d = kHexDigits[static_cast<unsigned char>(rest[i])];
+            if (d < 0)
+                break;
+            value = (value << 4) | static_cast<uint64_t>(d);
+            ++i;
+        }
+        if (i == 0)
+            return false;
+        rest.remove_prefix(i);
+        out = value;
+        return true;
+    }
+
+    bool scan_decimal(uint64_t& out) {
+        size_t i = 0;
+        uint64_t value = 0;
+        while (i < rest.size() && rest[i] >= '0' && rest[i] <= '9') {
+            value = value * 10 + static_cast<uint64_t>(rest[i] - '0');
+            ++i;
+        }
+        if (i == 0)
+            return false;
+        rest.remove_prefix(i);
+        out = value;
+        return true;
+    }
+
+    std::string_view scan_token() {
+        size_t i = 0;
+        while (i < rest.size() && !is_blank(rest[i]))
+            ++i;
+        std::string_view token = rest.substr(0, i);
+        rest.remove_prefix(i);
+        return token;
+    }
+
+    bool consume(char c) {
+        if (rest.empty() || rest.front() != c)
+            return false;
+        rest.remove_prefix(1);
+        return true;
+    }
+
+    /// A field must be followed by a separator (or the end of the line).
+    bool at_field_end() const {
+        return rest.empty() || is_blank(rest.front());
+    }
+};
+
+/**
+ * @brief Calls @p fn with every line of @p content, without the newline.
+ *
+ * Lines are located with memchr; the final line need not be terminated.
+ */
+template <typename Fn>
+inline void for_each_line(std::string_view content, Fn&& fn) {
+    const char* p = content.data();
+    const char* end = p + content.size();
+
+    while (p < end) {
+        const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        const char* line_end = nl ? nl : end;
+        fn(std::string_view(p, line_end - p));
+        p = nl ? nl + 1 : end;
+    }
+}
+
+} // namespace memc::detail
@@ -1,158 +1,164 @@
-#include <cstddef>
-#include <cstdio>
-#include <fstream>
+#include "line_cursor.h"
+#include "self_stats_internal.h"
+
+#include <cctype>
 #include <memc/maps_parser.h>
-#include <sstream>
+#include <memc/proc_handle.h>
+#include <memc/process_utils.h>
+#include <memc/region_classifier.h>
 #include <string>
 
 namespace memc {
 
+static_assert(DefaultRegionClassifier::classify("[heap]", "rw-p") == RegionType::HEAP);
+static_assert(DefaultRegionClassifier::classify("[stack:42]", "rw-p") == RegionType::STACK);
+static_assert(DefaultRegionClassifier::classify("/lib/libc.so.6", "r-xp") ==
+              RegionType::SHARED_LIB);
+static_assert(DefaultRegionClassifier::classify("/usr/bin/cat", "r-xp") == RegionType::CODE);
+static_assert(DefaultRegionClassifier::classify("", "rw-p") == RegionType::ANONYMOUS);
+
 /**
  * @brief Parses /proc/<pid>/maps for the given PID.
  *
- * Opens and reads the entire maps file, then delegates to
- * parse_from_string for line-by-line parsing.
+ * Convenience wrapper around the buffer-reusing overload that owns its
+ * own scratch storage.
  *
  * @param pid The process ID to parse.
  * @return std::optional<std::vector<MemoryRegion>> A vector of MemoryRegion
  * objects, or std::nullopt if the file could not be opened.
  */
 std::optional<std::vector<MemoryRegion>> MapsParser::parse(pid_t pid) {
-    std::string path = "/proc/" + std::to_string(pid) + "/maps";
-    std::ifstream ifs(path);
-    if (!ifs.is_open()) {
+    std::string buffer;
+    std::vector<MemoryRegion> regions;
+    if (!parse(pid, buffer, regions)) {
         return std::nullopt;
     }
+    return regions;
+}
 
-    std::string content((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
-    return parse_from_string(content);
+/**
+ * @brief Parses /proc/<pid>/maps using caller-owned storage.
+ *
+ * Reads the whole file with pread(2) into @p buffer, then scans it in place.
+ *
+ * @param pid The process ID to parse.
+ * @param buffer Scratch buffer receiving the raw file contents.
+ * @param regions Output vector. It is cleared before parsing.
+ * @return true on success, false if the file could not be read.
+ */
+bool MapsParser::parse(pid_t pid, std::string& buffer, std::vector<MemoryRegion>& regions) {
+    regions.clear();
+    if (!read_proc_file(pid, "maps", buffer)) {
+        return false;
+    }
+    parse_from_view(buffer, regions);
+    return true;
 }
 
 /**
- * @brief Parses memory regions from a raw maps-format string.
+ * @brief Parses the maps file of an open ProcHandle.
  *
- * Iterates over each line of the input, parsing it into a MemoryRegion.
- * Empty lines are skipped; malformed lines are silently ignored.
+ * @param proc The process to read.
+ * @param buffer Scratch buffer receiving the raw file contents.
+ * @param regions Output vector. It is cleared before parsing.
+ * @return true on success, false if the file could not be read.
+ */
+bool MapsParser::parse(ProcHandle& proc, std::string& buffer, std::vector<MemoryRegion>& regions) {
+    regions.clear();
+    if (!proc.read("maps", buffer)) {
+        return false;
+    }
+    parse_from_view(buffer, regions);
+    return true;
+}
+
+/**
+ * @brief Parses memory regions from a raw maps-format string.
  *
  * @param content The raw content of a maps file.
  * @return std::vector<MemoryRegion> A vector of successfully parsed regions.
  */
 std::vector<MemoryRegion> MapsParser::parse_from_string(const std::string& content) {
     std::vector<MemoryRegion> regions;
-    std::istringstream stream(content);
-    std::string line;
-
-    while (std::getline(stream, line)) {
-        if (line.empty())
-            continue;
-        auto region = parse_line(line);
-        if (region) {
-            regions.push_back(std::move(*region));
-        }
-    }
-
+    parse_from_view(content, regions);
     return regions;
 }
 
 /**
- * @brief Parses a single line from a maps file into a MemoryRegion.
+ * @brief Parses memory regions from a view over raw maps content.
  *
- * Extracts the address range, permissions, offset, device, inode, and
- * optional pathname using sscanf, then classifies the region type.
+ * Splits the input on newlines with memchr and parses each line in place.
+ * Empty lines are skipped; malformed lines are silently ignored.
  *
- * @param line The line to parse (e.g., "7f2c5c000000-7f2c5c021000 rw-p ...").
- * @return std::optional<MemoryRegion> The parsed region, or std::nullopt
- * if fewer than 6 fields could be read.
+ * @param content The raw content of a maps file.
+ * @param regions Output vector the parsed regions are appended to.
  */
-std::optional<MemoryRegion> MapsParser::parse_line(const std::string& line) {
-    MemoryRegion region;
-    std::istringstream lineStream(line);
-    std::string addr_range;
-    std::string permissions;
-    uint64_t offset = 0;
-    std::string device;
-    uint64_t inode;
-
-    if (!(lineStream >> addr_range >> permissions >> std::hex >> offset >> device >> inode)) {
-        return std::nullopt;
-    }
-    char dash = addr_range.find('-');
-    if (dash == std::string::npos) {
-        return std::nullopt;
-    }
+void MapsParser::parse_from_view(std::string_view content, std::vector<MemoryRegion>& regions) {
+    detail::PhaseTimer timer(StatPhase::MAPS_PARSE);
+    detail::for_each_line(content, [&](std::string_view line) {
+        if (line.empty())
+            return;
 
-    region.start_addr = std::stoull(addr_range.substr(0, dash), nullptr, 16);
-    region.end_addr = std::stoull(addr_range.substr(dash + 1), nullptr, 16);
-    region.permissions = permissions;
-    region.offset = offset;
-    region.device = device;
-    region.inode = inode;
-    std::string rest;
-    std::getline(lineStream, rest);
-
-    if (!rest.empty()) {
-        size_t pos = rest.find_first_not_of(" \t");
-        if (pos != std::string::npos) {
-            region.pathname = rest.substr(pos);
-            while (!region.pathname.empty() &&
-                   std::isspace(static_cast<unsigned char>(region.pathname.back()))) {
-                region.pathname.pop_back();
-            }
+        MemoryRegion& region = regions.emplace_back();
+        if (!parse_line(line, region)) {
+            regions.pop_back();
         }
-    }
-
-    region.type = classify_region(region.pathname, region.permissions);
-    region.size_kb = (region.end_addr - region.start_addr) / 1024;
-    return region;
+    });
 }
 
 /**
- * @brief Classifies a memory region based on its pathname and permissions.
+ * @brief Parses a single line from a maps file into a MemoryRegion.
  *
- * Uses pattern matching on the pathname (e.g., "[heap]", "[stack]", ".so")
- * and permission flags to determine the RegionType.
+ * Walks the line once with hand-written hex/decimal scanners to extract the
+ * address range, permissions, offset, device, inode, and optional pathname,
+ * then classifies the region type. No temporaries are created; only the
+ * region's own string members are assigned.
  *
- * @param pathname The pathname associated with the region.
- * @param permissions The permissions string (e.g., "rw-p").
- * @return RegionType The classified region type.
+ * @param line The line to parse (e.g., "7f2c5c000000-7f2c5c021000 rw-p ...").
+ * @param region The MemoryRegion to populate.
+ * @return true on success, false if any of the six leading fields is
+ * missing or malformed.
  */
-RegionType MapsParser::classify_region(const std::string& pathname,
-                                       const std::string& permissions) {
-    if (pathname == "[heap]") {
-        return RegionType::HEAP;
-    }
-    if (pathname.find("[stack") != std::string::npos) {
-        return RegionType::STACK;
-    }
-    if (pathname == "[vdso]") {
-        return RegionType::VDSO;
-    }
-    if (pathname == "[vvar]") {
-        return RegionType::VVAR;
-    }
-    if (pathname == "[vsyscall]") {
-        return RegionType::VSYSCALL;
+bool MapsParser::parse_line(std::string_view line, MemoryRegion& region) {
+    detail::LineCursor cur{line};
+
+    cur.skip_blanks();
+    if (!cur.scan_hex(region.start_addr) || !cur.consume('-') || !cur.scan_hex(region.end_addr) ||
+        !cur.at_field_end()) {
+        return false;
     }
 
-    if (!pathname.empty() && pathname[0] == '/') {
-        if (pathname.find(".so") != std::string::npos) {
-            return RegionType::SHARED_LIB;
-        }
+    cur.skip_blanks();
+    std::string_view permissions = cur.scan_token();
+    if (permissions.empty())
+        return false;
 
-        if (permissions.size() >= 3 && permissions[2] == 'x') {
-            return RegionType::CODE;
-        }
-        return RegionType::MAPPED_FILE;
-    }
+    cur.skip_blanks();
+    if (!cur.scan_hex(region.offset) || !cur.at_field_end())
+        return false;
 
-    if (pathname.empty()) {
-        if (permissions.size() >= 3 && permissions[2] == 'x') {
-            return RegionType::CODE;
-        }
-        return RegionType::ANONYMOUS;
+    cur.skip_blanks();
+    std::string_view device = cur.scan_token();
+    if (device.empty())
+        return false;
+
+    cur.skip_blanks();
+    if (!cur.scan_decimal(region.inode) || !cur.at_field_end())
+        return false;
+
+    cur.skip_blanks();
+    std::string_view pathname = cur.rest;
+    while (!pathname.empty() && std::isspace(static_cast<unsigned char>(pathname.back()))) {
+        pathname.remove_suffix(1);
     }
 
-    return RegionType::UNKNOWN;
+    region.permissions.assign(permissions);
+    region.device.assign(device);
+    region.pathname.assign(pathname);
+
+    region.type = DefaultRegionClassifier::classify(pathname, region.permissions);
+    region.size_kb = (region.end_addr - region.start_addr) / 1024;
+    return true;
 }
 
 } // namespace memc
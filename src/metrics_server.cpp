@@ -0,0 +1,423 @@
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cctype>
+#include <cerrno>
+#include <memc/metrics_server.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+namespace memc {
+
+/**
+ * @brief A complete HTTP response: status line, headers and body.
+ *
+ * header_size is the length of everything before the body, which is all a
+ * HEAD request receives.
+ */
+struct MetricsServer::Response {
+    std::string data;
+    size_t header_size = 0;
+};
+
+/**
+ * @brief One open connection.
+ *
+ * Fields:
+ * - fd: The connected socket.
+ * - request: Bytes received and not yet answered (pipelined requests queue
+ *   up here).
+ * - response, sent, length: The response being written, the bytes already
+ *   written and the bytes to write in total.
+ * - close_after: Close the connection once the response is written.
+ * - last_active: Time of the last byte read or written.
+ */
+struct MetricsServer::Client {
+    int fd = -1;
+    std::string request;
+    std::shared_ptr<const Response> response;
+    size_t sent = 0;
+    size_t length = 0;
+    bool close_after = false;
+    std::chrono::steady_clock::time_point last_active;
+};
+
+namespace {
+
+/// Largest request head accepted; scrapers send a few hundred bytes.
+constexpr size_t kMaxRequestBytes = 8192;
+
+/// Longest a poll(2) waits, so idle connections are expired on time.
+constexpr int kPollTimeoutMs = 1000;
+
+constexpr std::string_view kMetricsContentType = "text/plain; version=0.0.4; charset=utf-8";
+
+/**
+ * @brief Renders a response with the given status and body.
+ *
+ * @param status Status code and reason, e.g. "200 OK".
+ * @param body The body.
+ * @param close If true, a Connection: close header is added.
+ * @param header_size Receives the length of the status line and headers.
+ */
+std::string render_response(std::string_view status, std::string_view body, bool close,
+                            size_t& header_size) {
+    std::string data;
+    data.reserve(body.size() + 160);
+    data += "HTTP/1.1 ";
+    data += status;
+    data += "\r\nContent-Type: ";
+    data += status.starts_with("200") ? kMetricsContentType : "text/plain; charset=utf-8";
+    data += "\r\nContent-Length: ";
+    data += std::to_string(body.size());
+    if (close) {
+        data += "\r\nConnection: close";
+    }
+    data += "\r\n\r\n";
+    header_size = data.size();
+    data += body;
+    return data;
+}
+
+/**
+ * @brief Returns true if @p text contains @p needle, ignoring ASCII case.
+ *
+ * @p needle must be lowercase.
+ */
+bool contains_nocase(std::string_view text, std::string_view needle) {
+    auto it = std::search(text.begin(), text.end(), needle.begin(), needle.end(),
+                          [](char a, char b) {
+                              return std::tolower(static_cast<unsigned char>(a)) == b;
+                          });
+    return it != text.end();
+}
+
+} // namespace
+
+/**
+ * @brief Creates a server that is not yet listening.
+ *
+ * @param config The server configuration.
+ */
+MetricsServer::MetricsServer(Config config)
+    : config_(std::move(config)) {
+    stop_fd_ = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+}
+
+/**
+ * @brief Closes the listening socket and the stop descriptor.
+ */
+MetricsServer::~MetricsServer() {
+    if (listen_fd_ >= 0)
+        ::close(listen_fd_);
+    if (stop_fd_ >= 0)
+        ::close(stop_fd_);
+}
+
+/**
+ * @brief Binds and listens on the configured address.
+ *
+ * The host part is resolved with getaddrinfo(3); the first address that
+ * can be bound is used.
+ *
+ * @return true on success, false with errno set otherwise.
+ */
+bool MetricsServer::listen() {
+    std::string_view address = config_.listen;
+    size_t colon = address.rfind(':');
+    if (colon == std::string_view::npos || colon + 1 == address.size()) {
+        errno = EINVAL;
+        return false;
+    }
+    std::string host(address.substr(0, colon));
+    std::string service(address.substr(colon + 1));
+    if (host.size() >= 2 && host.front() == '[' && host.back() == ']') {
+        host = host.substr(1, host.size() - 2);
+    }
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE | AI_NUMERICSERV;
+    addrinfo* result = nullptr;
+    int rc = ::getaddrinfo(host.empty() ? nullptr : host.c_str(), service.c_str(), &hints, &result);
+    if (rc != 0) {
+        if (rc != EAI_SYSTEM) {
+            errno = EINVAL;
+        }
+        return false;
+    }
+
+    int fd = -1;
+    int saved_errno = EADDRNOTAVAIL;
+    for (addrinfo* ai = result; ai; ai = ai->ai_next) {
+        fd = ::socket(ai->ai_family, ai->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                      ai->ai_protocol);
+        if (fd < 0) {
+            saved_errno = errno;
+            continue;
+        }
+        int one = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (::bind(fd, ai->ai_addr, ai->ai_addrlen) == 0 && ::listen(fd, SOMAXCONN) == 0) {
+            break;
+        }
+        saved_errno = errno;
+        ::close(fd);
+        fd = -1;
+    }
+    ::freeaddrinfo(result);
+    if (fd < 0) {
+        errno = saved_errno;
+        return false;
+    }
+
+    sockaddr_storage bound{};
+    socklen_t length = sizeof(bound);
+    if (::getsockname(fd, reinterpret_cast<sockaddr*>(&bound), &length) == 0) {
+        if (bound.ss_family == AF_INET) {
+            port_ = ntohs(reinterpret_cast<sockaddr_in*>(&bound)->sin_port);
+        } else if (bound.ss_family == AF_INET6) {
+            port_ = ntohs(reinterpret_cast<sockaddr_in6*>(&bound)->sin6_port);
+        }
+    }
+    if (listen_fd_ >= 0) {
+        ::close(listen_fd_);
+    }
+    listen_fd_ = fd;
+    return true;
+}
+
+/**
+ * @brief Replaces the report served at /metrics.
+ *
+ * The full response is rendered first and then swapped in atomically. The
+ * previous report is freed once the last response still writing it
+ * completes.
+ *
+ * @param body Exposition text.
+ */
+void MetricsServer::publish(std::string_view body) {
+    auto response = std::make_shared<Response>();
+    response->data = render_response("200 OK", body, false, response->header_size);
+    report_.store(std::move(response), std::memory_order_release);
+}
+
+/**
+ * @brief Serves connections on the calling thread until stop().
+ *
+ * Each iteration polls the stop descriptor, the listening socket and every
+ * connection: readable connections have their requests parsed and answered,
+ * and connections with a response in progress wait for room to write the
+ * rest. Connections idle longer than client_timeout are closed.
+ */
+void MetricsServer::run() {
+    if (listen_fd_ < 0)
+        return;
+
+    std::vector<Client> clients;
+    std::vector<pollfd> fds;
+    while (!stopped_.load(std::memory_order_acquire)) {
+        fds.clear();
+        fds.push_back({stop_fd_, POLLIN, 0});
+        fds.push_back({listen_fd_, POLLIN, 0});
+        for (const Client& client : clients) {
+            fds.push_back({client.fd, static_cast<short>(client.response ? POLLOUT : POLLIN), 0});
+        }
+
+        if (::poll(fds.data(), fds.size(), kPollTimeoutMs) < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        if (fds[0].revents != 0) {
+            break;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < clients.size(); ++i) {
+            Client& client = clients[i];
+            short events = fds[i + 2].revents;
+            bool keep = true;
+            if (events & (POLLERR | POLLNVAL)) {
+                keep = false;
+            } else if (events & POLLOUT) {
+                keep = flush(client) && (client.response || handle_request(client));
+            } else if (events & (POLLIN | POLLHUP)) {
+                char chunk[2048];
+                ssize_t n = ::recv(client.fd, chunk, sizeof(chunk), 0);
+                if (n > 0) {
+                    client.last_active = now;
+                    client.request.append(chunk, static_cast<size_t>(n));
+                    keep = handle_request(client);
+                } else {
+                    keep = n < 0 && (errno == EAGAIN || errno == EINTR);
+                }
+            } else if (now - client.last_active > config_.client_timeout) {
+                keep = false;
+            }
+            if (!keep) {
+                ::close(client.fd);
+                client.fd = -1;
+            }
+        }
+        std::erase_if(clients, [](const Client& client) { return client.fd < 0; });
+
+        if (fds[1].revents & POLLIN) {
+            while (true) {
+                int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+                if (fd < 0) {
+                    break;
+                }
+                connections_.fetch_add(1, std::memory_order_relaxed);
+                if (clients.size() >= config_.max_clients) {
+                    ::close(fd);
+                    continue;
+                }
+                Client& client = clients.emplace_back();
+                client.fd = fd;
+                client.last_active = now;
+            }
+        }
+    }
+
+    for (const Client& client : clients) {
+        ::close(client.fd);
+    }
+}
+
+/**
+ * @brief Makes run() return.
+ *
+ * Async-signal-safe.
+ */
+void MetricsServer::stop() noexcept {
+    stopped_.store(true, std::memory_order_release);
+    if (stop_fd_ >= 0) {
+        uint64_t one = 1;
+        ssize_t ignored = ::write(stop_fd_, &one, sizeof(one));
+        (void)ignored;
+    }
+}
+
+/**
+ * @brief Returns the request counters since construction.
+ */
+MetricsServerStats MetricsServer::stats() const {
+    MetricsServerStats s;
+    s.connections = connections_.load(std::memory_order_relaxed);
+    s.scrapes = scrapes_.load(std::memory_order_relaxed);
+    s.errors = errors_.load(std::memory_order_relaxed);
+    s.bytes_sent = bytes_sent_.load(std::memory_order_relaxed);
+    return s;
+}
+
+/**
+ * @brief Answers the complete requests buffered for a client.
+ *
+ * Picks the response for the first complete request head and writes it;
+ * when that finishes at once, the next buffered request is answered too.
+ * Request bodies are not read: anything but GET and HEAD is refused and
+ * the connection closed.
+ *
+ * @param client The connection.
+ * @return false if the connection should be closed now.
+ */
+bool MetricsServer::handle_request(Client& client) {
+    static const auto make_error = [](std::string_view status, bool close) {
+        auto response = std::make_shared<Response>();
+        response->data = render_response(status, std::string(status) + "\n", close,
+                                          response->header_size);
+        return std::shared_ptr<const Response>(std::move(response));
+    };
+    static const auto kBadRequest = make_error("400 Bad Request", true);
+    static const auto kNotFound = make_error("404 Not Found", false);
+    static const auto kBadMethod = make_error("405 Method Not Allowed", true);
+    static const auto kNotReady = make_error("503 Service Unavailable", false);
+
+    while (!client.response) {
+        size_t end = client.request.find("\r\n\r\n");
+        if (end == std::string::npos && client.request.size() <= kMaxRequestBytes) {
+            return true;
+        }
+
+        std::shared_ptr<const Response> response;
+        bool head_only = false;
+        std::string_view head = std::string_view(client.request).substr(0, end);
+        std::string_view line = head.substr(0, head.find("\r\n"));
+        size_t first = line.find(' ');
+        size_t second = first == std::string_view::npos ? first : line.find(' ', first + 1);
+
+        if (end == std::string::npos || second == std::string_view::npos) {
+            response = kBadRequest;
+            client.close_after = true;
+        } else {
+            std::string_view method = line.substr(0, first);
+            std::string_view target = line.substr(first + 1, second - first - 1);
+            std::string_view version = line.substr(second + 1);
+            std::string_view path = target.substr(0, target.find('?'));
+            head_only = method == "HEAD";
+            client.close_after = version == "HTTP/1.0" ? !contains_nocase(head, "keep-alive")
+                                                       : contains_nocase(head, "connection: close");
+
+            if (method != "GET" && !head_only) {
+                response = kBadMethod;
+                client.close_after = true;
+            } else if (path != "/metrics") {
+                response = kNotFound;
+            } else {
+                response = report_.load(std::memory_order_acquire);
+                if (!response) {
+                    response = kNotReady;
+                }
+            }
+        }
+        bool scrape = response != kBadRequest && response != kBadMethod &&
+                      response != kNotFound && response != kNotReady;
+        (scrape ? scrapes_ : errors_).fetch_add(1, std::memory_order_relaxed);
+
+        client.request.erase(0, end == std::string::npos ? end : end + 4);
+        client.length = head_only ? response->header_size : response->data.size();
+        client.sent = 0;
+        client.response = std::move(response);
+        if (!flush(client)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Writes as much of the pending response as the socket takes.
+ *
+ * A complete response is released; the caller then answers any request
+ * that arrived behind it.
+ *
+ * @param client The connection.
+ * @return false if the connection should be closed now: a write error, or
+ * a complete response after which the connection closes.
+ */
+bool MetricsServer::flush(Client& client) {
+    while (client.sent < client.length) {
+        ssize_t n = ::send(client.fd, client.response->data.data() + client.sent,
+                           client.length - client.sent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        client.sent += static_cast<size_t>(n);
+        bytes_sent_.fetch_add(static_cast<uint64_t>(n), std::memory_order_relaxed);
+        client.last_active = std::chrono::steady_clock::now();
+    }
+
+    client.response.reset();
+    return !client.close_after;
+}
+
+} // namespace memc
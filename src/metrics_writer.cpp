@@ -0,0 +1,176 @@
+#include "self_stats_internal.h"
+
+#include <charconv>
+#include <memc/metrics_writer.h>
+
+namespace memc {
+
+/**
+ * @brief Adds one process to the report.
+ *
+ * Sizes are summed per region type and overall, in bytes; the snapshot is
+ * not referenced afterwards.
+ *
+ * @param snapshot The process's snapshot.
+ * @param comm The process name for the comm label.
+ */
+void MetricsWriter::add(const ProcessSnapshot& snapshot, std::string_view comm) {
+    if (count_ == processes_.size()) {
+        processes_.emplace_back();
+    }
+    Process& process = processes_[count_++];
+    process.pid = snapshot.pid;
+    process.comm.assign(comm);
+    process.regions = snapshot.regions.size();
+    process.total = {};
+    process.by_type.fill({});
+
+    for (const auto& r : snapshot.regions) {
+        Totals& t = process.by_type[static_cast<size_t>(r.type)];
+        t.rss += r.rss_kb * 1024;
+        t.pss += r.pss_kb * 1024;
+        t.swap += r.swap_kb * 1024;
+        t.vsize += r.size_bytes();
+    }
+    for (const Totals& t : process.by_type) {
+        process.total.rss += t.rss;
+        process.total.pss += t.pss;
+        process.total.swap += t.swap;
+        process.total.vsize += t.vsize;
+    }
+}
+
+/**
+ * @brief Writes every metric family for the processes added so far.
+ *
+ * Families are written one after the other, each with its HELP and TYPE
+ * lines followed by one sample per process (or per process and region
+ * type), in the order the processes were added.
+ *
+ * @return std::string_view The exposition text.
+ */
+std::string_view MetricsWriter::render() {
+    detail::PhaseTimer timer(StatPhase::SERIALIZE);
+    buffer_.clear();
+
+    struct Field {
+        std::string_view process_name;
+        std::string_view region_name;
+        std::string_view what;
+        uint64_t Totals::*member;
+    };
+    static constexpr Field kFields[] = {
+        {"memc_process_rss_bytes", "memc_region_rss_bytes", "Resident set size", &Totals::rss},
+        {"memc_process_pss_bytes", "memc_region_pss_bytes", "Proportional set size",
+         &Totals::pss},
+        {"memc_process_swap_bytes", "memc_region_swap_bytes", "Swapped-out anonymous memory",
+         &Totals::swap},
+        {"memc_process_vsize_bytes", "memc_region_vsize_bytes", "Mapped virtual address space",
+         &Totals::vsize},
+    };
+
+    family("memc_processes", "Processes in this report", "");
+    buffer_ += "memc_processes ";
+    value(count_);
+
+    for (const Field& field : kFields) {
+        family(field.process_name, field.what, " of the process, in bytes");
+        for (size_t i = 0; i < count_; ++i) {
+            buffer_ += field.process_name;
+            buffer_ += '{';
+            labels(processes_[i]);
+            buffer_ += "} ";
+            value(processes_[i].total.*field.member);
+        }
+    }
+
+    for (const Field& field : kFields) {
+        family(field.region_name, field.what, " of the process by region type, in bytes");
+        for (size_t i = 0; i < count_; ++i) {
+            const Process& process = processes_[i];
+            for (size_t type = 0; type < kTypeCount; ++type) {
+                if (process.by_type[type].vsize == 0) {
+                    continue;
+                }
+                buffer_ += field.region_name;
+                buffer_ += '{';
+                labels(process);
+                buffer_ += ",type=\"";
+                buffer_ += region_type_to_string(static_cast<RegionType>(type));
+                buffer_ += "\"} ";
+                value(process.by_type[type].*field.member);
+            }
+        }
+    }
+
+    family("memc_process_regions", "Mapped regions of the process", "");
+    for (size_t i = 0; i < count_; ++i) {
+        buffer_ += "memc_process_regions{";
+        labels(processes_[i]);
+        buffer_ += "} ";
+        value(processes_[i].regions);
+    }
+
+    return buffer_;
+}
+
+/**
+ * @brief Forgets the processes and the rendered text, keeping the buffers'
+ * capacity.
+ */
+void MetricsWriter::clear() {
+    count_ = 0;
+    buffer_.clear();
+}
+
+/**
+ * @brief Writes the HELP and TYPE lines that open a gauge family.
+ *
+ * The help text is @p help followed by @p detail and a full stop.
+ */
+void MetricsWriter::family(std::string_view name, std::string_view help,
+                           std::string_view detail) {
+    buffer_ += "# HELP ";
+    buffer_ += name;
+    buffer_ += ' ';
+    buffer_ += help;
+    buffer_ += detail;
+    buffer_ += ".\n# TYPE ";
+    buffer_ += name;
+    buffer_ += " gauge\n";
+}
+
+/**
+ * @brief Writes the pid and comm labels, escaping the name as the format
+ * requires (backslash, double quote and line feed).
+ */
+void MetricsWriter::labels(const Process& process) {
+    buffer_ += "pid=\"";
+    char digits[24];
+    auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), process.pid);
+    buffer_.append(digits, end);
+    buffer_ += "\",comm=\"";
+    for (char c : process.comm) {
+        if (c == '\\' || c == '"') {
+            buffer_ += '\\';
+            buffer_ += c;
+        } else if (c == '\n') {
+            buffer_ += "\\n";
+        } else {
+            buffer_ += c;
+        }
+    }
+    buffer_ += '"';
+}
+
+/**
+ * @brief Writes a sample value and ends the line.
+ */
+void MetricsWriter::value(uint64_t v) {
+    char digits[24];
+    auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), v);
+    buffer_.append(digits, end);
+    buffer_ += '\n';
+}
+
+} // namespace memc
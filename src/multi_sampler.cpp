@@ -0,0 +1,340 @@
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <memc/multi_sampler.h>
+#include <memc/process_utils.h>
+
+namespace memc {
+
+namespace {
+
+/**
+ * @brief Builds the scanner configuration for a MultiSampler.
+ *
+ * Names are not read: snapshots carry no name, and the selector reads comm
+ * itself when it needs one.
+ */
+ScannerConfig scanner_config(const MultiSamplerConfig& config) {
+    ScannerConfig scanner;
+    scanner.collector.use_smaps = config.use_smaps;
+    scanner.collector.numa = config.numa;
+    scanner.collector.fields = config.fields;
+    scanner.jobs = config.jobs;
+    scanner.read_names = false;
+    return scanner;
+}
+
+} // namespace
+
+/**
+ * @brief Constructs a MultiSampler and starts its worker pool.
+ *
+ * The timer thread is not started until start() is called.
+ *
+ * @param config The sampler configuration.
+ */
+MultiSampler::MultiSampler(MultiSamplerConfig config)
+    : config_(std::move(config))
+    , scanner_(scanner_config(config_))
+    , timer_(config_.interval)
+    , dispatcher_(config_.dispatch, [this](const SampleEvent& event) { deliver(event); }) {}
+
+/**
+ * @brief Destructor. Ensures the timer thread is stopped and joined.
+ */
+MultiSampler::~MultiSampler() {
+    stop();
+}
+
+/**
+ * @brief Adds a process to the monitored set.
+ *
+ * @param pid The process ID.
+ */
+void MultiSampler::add_pid(pid_t pid) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pids_.insert(pid);
+}
+
+/**
+ * @brief Removes a process from the monitored set and drops its snapshot.
+ *
+ * @param pid The process ID.
+ */
+void MultiSampler::remove_pid(pid_t pid) {
+    SnapshotHandle released;
+    std::lock_guard<std::mutex> lock(mutex_);
+    pids_.erase(pid);
+    auto it = latest_.find(pid);
+    if (it != latest_.end()) {
+        released = std::move(it->second);
+        latest_.erase(it);
+    }
+}
+
+/**
+ * @brief Returns the explicitly added PIDs, in ascending order.
+ *
+ * @return std::vector<pid_t> The PIDs.
+ */
+std::vector<pid_t> MultiSampler::pids() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return {pids_.begin(), pids_.end()};
+}
+
+/**
+ * @brief Starts the timer thread.
+ *
+ * If the sampler is already running, this method does nothing.
+ */
+void MultiSampler::start() {
+    if (running_.load())
+        return;
+    running_.store(true);
+    dispatcher_.start();
+    timer_.start();
+    thread_ = std::thread(&MultiSampler::sample_loop, this);
+}
+
+/**
+ * @brief Stops the timer thread.
+ *
+ * Clears the running flag, wakes the timer thread out of its wait, and
+ * blocks until the thread has joined. Callbacks still queued are
+ * delivered before returning.
+ */
+void MultiSampler::stop() {
+    running_.store(false);
+    timer_.stop();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    dispatcher_.stop();
+}
+
+/**
+ * @brief Checks if the sampler is currently running.
+ *
+ * @return true if the timer thread is active, false otherwise.
+ */
+bool MultiSampler::is_running() const {
+    return running_.load();
+}
+
+/**
+ * @brief Registers a callback to be invoked with each new snapshot.
+ *
+ * Thread-safe: acquires the callback mutex before modifying the list.
+ *
+ * @param cb The callback function to register.
+ */
+void MultiSampler::on_snapshot(SnapshotCallback cb) {
+    std::unique_lock lock(callbacks_mutex_);
+    callbacks_.push_back(std::move(cb));
+}
+
+/**
+ * @brief Registers a callback to be invoked when a monitored process
+ * disappears.
+ *
+ * Thread-safe: acquires the callback mutex before modifying the list.
+ *
+ * @param cb The callback function to register.
+ */
+void MultiSampler::on_exit(ExitCallback cb) {
+    std::unique_lock lock(callbacks_mutex_);
+    exit_callbacks_.push_back(std::move(cb));
+}
+
+/**
+ * @brief Registers a callback to be invoked after each complete round.
+ *
+ * Thread-safe: acquires the callback mutex before modifying the list.
+ *
+ * @param cb The callback function to register.
+ */
+void MultiSampler::on_round(RoundCallback cb) {
+    std::unique_lock lock(callbacks_mutex_);
+    round_callbacks_.push_back(std::move(cb));
+}
+
+/**
+ * @brief Returns the latest snapshot of a process.
+ *
+ * @param pid The process ID.
+ * @return SnapshotHandle The snapshot, or nullptr if none is held.
+ */
+SnapshotHandle MultiSampler::get_latest(pid_t pid) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = latest_.find(pid);
+    return it == latest_.end() ? nullptr : it->second;
+}
+
+/**
+ * @brief The timer loop executed on the background thread.
+ *
+ * Runs one round per IntervalTimer deadline. Deadlines are absolute, so
+ * the time spent sampling does not accumulate as drift, and a round that
+ * overruns its interval skips the deadlines it missed rather than running
+ * back to back.
+ */
+void MultiSampler::sample_loop() {
+    while (timer_.wait()) {
+        sample_round();
+    }
+}
+
+/**
+ * @brief Samples every monitored process once.
+ *
+ * Snapshots are published and handed to the callbacks as the scanner
+ * delivers them. Explicit PIDs that could not be read, and processes whose
+ * snapshot was not refreshed (a selector match that exited), are reported
+ * to the exit callbacks afterwards. Selector matches that were never
+ * readable, such as another user's processes, are silently ignored.
+ */
+void MultiSampler::sample_round() {
+    std::vector<pid_t> selected;
+    const std::vector<pid_t> pids = targets(selected);
+
+    std::vector<pid_t> skipped;
+    std::vector<pid_t> seen;
+    seen.reserve(pids.size());
+
+    scanner_.scan(pids, [&](ProcessEntry& entry) {
+        if (entry.skipped || !entry.snapshot) {
+            skipped.push_back(entry.pid);
+            return running_.load();
+        }
+
+        auto snapshot = std::make_shared<const ProcessSnapshot>(std::move(*entry.snapshot));
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!pids_.count(entry.pid) &&
+                !std::binary_search(selected.begin(), selected.end(), entry.pid)) {
+                return running_.load(); // removed while the round was running
+            }
+            latest_[entry.pid] = snapshot;
+        }
+        seen.push_back(entry.pid);
+
+        dispatcher_.post({entry.pid, std::move(snapshot), nullptr, nullptr});
+        return running_.load();
+    });
+
+    // A round cut short by stop() did not visit every process.
+    if (!running_.load())
+        return;
+
+    std::vector<pid_t> gone;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (pid_t pid : skipped) {
+            if (pids_.erase(pid)) {
+                gone.push_back(pid);
+            }
+        }
+        for (auto it = latest_.begin(); it != latest_.end();) {
+            if (!std::binary_search(seen.begin(), seen.end(), it->first)) {
+                gone.push_back(it->first);
+                it = latest_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    std::sort(gone.begin(), gone.end());
+    gone.erase(std::unique(gone.begin(), gone.end()), gone.end());
+    for (pid_t pid : gone) {
+        dispatcher_.post({pid, nullptr, nullptr, nullptr});
+    }
+
+    finish_round();
+}
+
+/**
+ * @brief Hands the latest snapshot of every monitored process to the round
+ * callbacks.
+ *
+ * Runs on the timer thread. The handles are copied under the lock and the
+ * callbacks run after it is released; exceptions are logged and swallowed.
+ */
+void MultiSampler::finish_round() {
+    std::shared_lock callbacks_lock(callbacks_mutex_);
+    if (round_callbacks_.empty())
+        return;
+
+    std::vector<SnapshotHandle> snapshots;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        snapshots.reserve(latest_.size());
+        for (const auto& [pid, snapshot] : latest_) {
+            snapshots.push_back(snapshot);
+        }
+    }
+
+    for (const auto& cb : round_callbacks_) {
+        try {
+            cb(snapshots);
+        } catch (const std::exception& e) {
+            std::cerr << "[memc] Round callback threw: " << e.what() << std::endl;
+        }
+    }
+}
+
+/**
+ * @brief Returns this round's PIDs: the explicit set merged with the
+ * current selector matches, in ascending order without duplicates.
+ *
+ * @param selected Receives the sorted selector matches alone.
+ */
+std::vector<pid_t> MultiSampler::targets(std::vector<pid_t>& selected) const {
+    std::vector<pid_t> explicit_pids = pids();
+    if (!config_.selector) {
+        return explicit_pids;
+    }
+
+    selected = config_.selector->select(enumerate_pids());
+    std::sort(selected.begin(), selected.end());
+
+    std::vector<pid_t> merged;
+    merged.reserve(explicit_pids.size() + selected.size());
+    std::set_union(explicit_pids.begin(), explicit_pids.end(), selected.begin(), selected.end(),
+                   std::back_inserter(merged));
+    return merged;
+}
+
+/**
+ * @brief Invokes the registered callbacks for one event.
+ *
+ * Runs on a dispatcher thread (or the timer thread when dispatch is
+ * synchronous) under a shared lock on the callback lists; exceptions are
+ * logged and swallowed.
+ *
+ * @param event A new snapshot, or an exit notification if it has none.
+ */
+void MultiSampler::deliver(const SampleEvent& event) {
+    std::shared_lock lock(callbacks_mutex_);
+
+    if (!event.snapshot) {
+        for (const auto& cb : exit_callbacks_) {
+            try {
+                cb(event.pid);
+            } catch (const std::exception& e) {
+                std::cerr << "[memc] Exit callback threw: " << e.what() << std::endl;
+            }
+        }
+        return;
+    }
+
+    for (const auto& cb : callbacks_) {
+        try {
+            cb(*event.snapshot);
+        } catch (const std::exception& e) {
+            std::cerr << "[memc] Snapshot callback threw: " << e.what() << std::endl;
+        }
+    }
+}
+
+} // namespace memc
@@ -0,0 +1,116 @@
+#include "line_cursor.h"
+#include "self_stats_internal.h"
+
+#include <memc/numa_maps_parser.h>
+#include <memc/proc_handle.h>
+#include <memc/process_utils.h>
+
+namespace memc {
+
+namespace {
+
+/// Upper bound on node IDs accepted from numa_maps (the kernel's MAX_NUMNODES).
+constexpr uint64_t kMaxNodes = 1024;
+
+/**
+ * @brief Parses the tokens after the address and policy into @p numa_kb.
+ *
+ * @param cur Cursor positioned after the start address.
+ * @param numa_kb Output, indexed by node ID. It is cleared first.
+ */
+void parse_node_pages(detail::LineCursor cur, std::vector<uint64_t>& numa_kb) {
+    numa_kb.clear();
+    uint64_t page_kb = 4;
+
+    for (;;) {
+        cur.skip_blanks();
+        if (cur.rest.empty())
+            break;
+        std::string_view token = cur.scan_token();
+
+        if (token.size() > 2 && token[0] == 'N' && token[1] >= '0' && token[1] <= '9') {
+            detail::LineCursor field{token.substr(1)};
+            uint64_t node = 0;
+            uint64_t pages = 0;
+            if (field.scan_decimal(node) && field.consume('=') && field.scan_decimal(pages) &&
+                node < kMaxNodes) {
+                if (node >= numa_kb.size())
+                    numa_kb.resize(node + 1);
+                numa_kb[node] = pages;
+            }
+        } else if (token.starts_with("kernelpagesize_kB=")) {
+            detail::LineCursor field{token.substr(sizeof("kernelpagesize_kB=") - 1)};
+            field.scan_decimal(page_kb);
+        }
+    }
+
+    for (uint64_t& kb : numa_kb)
+        kb *= page_kb;
+}
+
+} // namespace
+
+/**
+ * @brief Reads /proc/<pid>/numa_maps and joins it onto @p regions.
+ *
+ * @param pid The process ID to read.
+ * @param buffer Scratch buffer receiving the raw file contents.
+ * @param regions The regions to enrich, ascending by start address.
+ * @return true on success, false if the file could not be read.
+ */
+bool NumaMapsParser::enrich(pid_t pid, std::string& buffer, std::vector<MemoryRegion>& regions) {
+    if (!read_proc_file(pid, "numa_maps", buffer)) {
+        return false;
+    }
+    enrich_from_view(buffer, regions);
+    return true;
+}
+
+/**
+ * @brief Reads the numa_maps file of an open ProcHandle and joins it onto
+ * @p regions.
+ *
+ * @param proc The process to read.
+ * @param buffer Scratch buffer receiving the raw file contents.
+ * @param regions The regions to enrich, ascending by start address.
+ * @return true on success, false if the file could not be read.
+ */
+bool NumaMapsParser::enrich(ProcHandle& proc, std::string& buffer,
+                            std::vector<MemoryRegion>& regions) {
+    if (!proc.read("numa_maps", buffer)) {
+        return false;
+    }
+    enrich_from_view(buffer, regions);
+    return true;
+}
+
+/**
+ * @brief Joins raw numa_maps content onto @p regions by start address.
+ *
+ * Lines whose address matches no region (the mappings changed between the
+ * two reads) are skipped.
+ *
+ * @param content The raw numa_maps content.
+ * @param regions The regions to enrich, ascending by start address.
+ */
+void NumaMapsParser::enrich_from_view(std::string_view content,
+                                      std::vector<MemoryRegion>& regions) {
+    detail::PhaseTimer timer(StatPhase::ENRICH);
+    size_t next = 0;
+    detail::for_each_line(content, [&](std::string_view line) {
+        detail::LineCursor cur{line};
+        uint64_t start = 0;
+        if (!cur.scan_hex(start) || !cur.at_field_end())
+            return;
+
+        while (next < regions.size() && regions[next].start_addr < start)
+            ++next;
+        if (next == regions.size() || regions[next].start_addr != start)
+            return;
+
+        parse_node_pages(cur, regions[next].numa_kb);
+        ++next;
+    });
+}
+
+} // namespace memc
@@ -0,0 +1,411 @@
+#include "collect_internal.h"
+#include "self_stats_internal.h"
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <fcntl.h>
+#include <memc/pagemap.h>
+#include <unistd.h>
+
+namespace memc {
+
+namespace {
+
+constexpr const char* kIdleBitmap = "/sys/kernel/mm/page_idle/bitmap";
+
+/// Pagemap entry bits (Documentation/admin-guide/mm/pagemap.rst).
+constexpr unsigned kPresentBit = 63;
+constexpr unsigned kSwappedBit = 62;
+constexpr unsigned kFileBit = 61;
+constexpr unsigned kExclusiveBit = 56;
+constexpr unsigned kSoftDirtyBit = 55;
+constexpr uint64_t kFrameMask = (uint64_t{1} << 55) - 1;
+
+/// Bitmap words between two wanted ones that are cheaper to read than skip.
+constexpr uint64_t kMaxWordGap = 8;
+
+/**
+ * @brief pread(2) until @p len bytes are read or the file ends.
+ *
+ * Timed as StatPhase::READ, with its calls and bytes counted.
+ *
+ * @return ssize_t Bytes read, or -1 on error.
+ */
+ssize_t pread_full(int fd, void* buf, size_t len, off_t offset) {
+    detail::PhaseTimer timer(StatPhase::READ);
+    auto* p = static_cast<char*>(buf);
+    size_t done = 0;
+    uint64_t calls = 0;
+    bool failed = false;
+    while (done < len) {
+        ++calls;
+        ssize_t n = ::pread(fd, p + done, len - done, offset + static_cast<off_t>(done));
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            failed = true;
+            break;
+        }
+        if (n == 0)
+            break;
+        done += static_cast<size_t>(n);
+    }
+    detail::stat_add(detail::StatCounter::SYSCALLS, calls);
+    detail::stat_add(detail::StatCounter::BYTES_READ, done);
+    return failed ? -1 : static_cast<ssize_t>(done);
+}
+
+/**
+ * @brief Accumulates the residency counters of @p n pagemap entries.
+ *
+ * Every counter is a plain sum of shifted bits with no data-dependent
+ * branch, so the loop vectorizes.
+ */
+void decode_entries(const uint64_t* entries, size_t n, PageStats& stats) {
+    uint64_t present = 0;
+    uint64_t swapped = 0;
+    uint64_t file = 0;
+    uint64_t exclusive = 0;
+    uint64_t soft_dirty = 0;
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t e = entries[i];
+        uint64_t p = e >> kPresentBit;
+        present += p;
+        swapped += (e >> kSwappedBit) & 1;
+        file += (e >> kFileBit) & p;
+        exclusive += (e >> kExclusiveBit) & p;
+        soft_dirty += (e >> kSoftDirtyBit) & 1;
+    }
+    stats.present += present;
+    stats.swapped += swapped;
+    stats.file_backed += file;
+    stats.exclusive += exclusive;
+    stats.soft_dirty += soft_dirty;
+}
+
+/**
+ * @brief Returns the cold histogram bucket of a page idle for @p age scans.
+ */
+size_t age_bucket(uint8_t age) {
+    return std::min<size_t>(std::bit_width(age) - 1, kIdleAgeBuckets - 1);
+}
+
+} // namespace
+
+/**
+ * @brief Creates a scanner; files are opened on the first scan.
+ *
+ * @param pid The process ID.
+ * @param config Which regions to scan and whether to track idle pages.
+ */
+PagemapScanner::PagemapScanner(pid_t pid, PagemapConfig config)
+    : pid_(pid)
+    , config_(config)
+    , page_size_(static_cast<uint64_t>(::sysconf(_SC_PAGESIZE))) {
+    config_.batch_pages = std::max<size_t>(config_.batch_pages, 1);
+}
+
+/**
+ * @brief Closes the pagemap and idle bitmap descriptors.
+ */
+PagemapScanner::~PagemapScanner() {
+    if (pagemap_fd_ >= 0)
+        ::close(pagemap_fd_);
+    if (bitmap_fd_ >= 0)
+        ::close(bitmap_fd_);
+}
+
+/**
+ * @brief Returns true if this kernel exposes the page idle bitmap.
+ *
+ * The bitmap only exists with CONFIG_IDLE_PAGE_TRACKING; using it also
+ * needs root.
+ */
+bool PagemapScanner::idle_tracking_supported() {
+    return ::access(kIdleBitmap, F_OK) == 0;
+}
+
+/**
+ * @brief Opens /proc/<pid>/pagemap and, for idle tracking, the bitmap.
+ *
+ * The bitmap is tried once, together with pagemap; without it the scanner
+ * silently reports residency only.
+ *
+ * @return true if pagemap is open.
+ */
+bool PagemapScanner::open_files() {
+    if (pagemap_fd_ >= 0)
+        return true;
+
+    char path[64] = "/proc/";
+    char* p = std::to_chars(path + 6, path + 32, pid_).ptr;
+    std::memcpy(p, "/pagemap", sizeof("/pagemap"));
+
+    pagemap_fd_ = ::open(path, O_RDONLY | O_CLOEXEC);
+    detail::stat_add(detail::StatCounter::SYSCALLS, 1);
+    if (pagemap_fd_ < 0)
+        return false;
+    detail::stat_add(detail::StatCounter::FILES_READ, 1);
+    if (config_.track_idle) {
+        bitmap_fd_ = ::open(kIdleBitmap, O_RDWR | O_CLOEXEC);
+        detail::stat_add(detail::StatCounter::SYSCALLS, 1);
+        if (bitmap_fd_ >= 0)
+            detail::stat_add(detail::StatCounter::FILES_READ, 1);
+    }
+    return true;
+}
+
+/**
+ * @brief Decodes the pagemap entries of @p regions into @p report.
+ *
+ * With idle tracking, ages of regions that no longer exist are dropped, and
+ * tracking is switched off for good if pagemap hides physical frame numbers
+ * (no CAP_SYS_ADMIN).
+ *
+ * @param regions The process's regions, ascending by start address.
+ * @param report Output report. Its region list is cleared first.
+ * @return true on success, false if pagemap could not be opened or read.
+ */
+bool PagemapScanner::scan(const std::vector<MemoryRegion>& regions, PageReport& report) {
+    report.pid = pid_;
+    report.page_size = page_size_;
+    report.idle_tracked = false;
+    report.regions.clear();
+    if (!open_files())
+        return false;
+    report.timestamp_ms = detail::now_ms();
+
+    const bool tracking = bitmap_fd_ >= 0;
+    const bool report_idle = tracking && idle_primed_;
+    ++generation_;
+
+    for (const auto& r : regions) {
+        if (!config_.all_regions && r.type != RegionType::HEAP &&
+            r.type != RegionType::ANONYMOUS) {
+            continue;
+        }
+
+        PageStats& stats = report.regions.emplace_back();
+        stats.start_addr = r.start_addr;
+        stats.end_addr = r.end_addr;
+        stats.pathname = r.pathname;
+        stats.type = r.type;
+
+        RegionAges* ages = nullptr;
+        if (tracking && !frames_hidden_) {
+            ages = &ages_[r.start_addr];
+            size_t pages = r.size_bytes() / page_size_;
+            if (ages->age.size() != pages) {
+                ages->age.assign(pages, 0);
+            }
+            ages->generation = generation_;
+        }
+        if (!scan_region(r, stats, ages, report_idle)) {
+            return false;
+        }
+    }
+
+    if (tracking && frames_hidden_) {
+        ::close(bitmap_fd_);
+        bitmap_fd_ = -1;
+        ages_.clear();
+        return true;
+    }
+    if (tracking) {
+        std::erase_if(ages_, [&](const auto& kv) { return kv.second.generation != generation_; });
+        idle_primed_ = true;
+        report.idle_tracked = report_idle;
+    }
+    return true;
+}
+
+/**
+ * @brief Reads which pages of one region are resident file pages.
+ *
+ * The entries are read batch by batch and folded into the bitmap without
+ * branching on their contents.
+ *
+ * @param region The region, one of the process's mappings.
+ * @param bits Receives one bit per page of the region; cleared first.
+ * @return true on success, false if pagemap could not be opened or read.
+ */
+bool PagemapScanner::file_pages(const MemoryRegion& region, std::vector<uint64_t>& bits) {
+    const uint64_t first = region.start_addr / page_size_;
+    const uint64_t count = region.size_bytes() / page_size_;
+    bits.assign(static_cast<size_t>((count + 63) / 64), 0);
+    if (!open_files())
+        return false;
+    entries_.resize(config_.batch_pages);
+
+    for (uint64_t done = 0; done < count;) {
+        size_t want = static_cast<size_t>(std::min<uint64_t>(config_.batch_pages, count - done));
+        ssize_t got = pread_full(pagemap_fd_, entries_.data(), want * sizeof(uint64_t),
+                                 static_cast<off_t>((first + done) * sizeof(uint64_t)));
+        if (got < 0)
+            return false;
+        size_t n = static_cast<size_t>(got) / sizeof(uint64_t);
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t e = entries_[i];
+            uint64_t page = done + i;
+            bits[page / 64] |= ((e >> kPresentBit) & (e >> kFileBit) & 1) << (page % 64);
+        }
+        if (n < want)
+            break;
+        done += n;
+    }
+    return true;
+}
+
+/**
+ * @brief Reads and decodes the pagemap slice of one region, batch by batch.
+ *
+ * With @p ages, every present page's idle bit is read, its age updated and,
+ * if @p report_idle, counted as hot or into a cold bucket; the pages are
+ * then marked idle again for the next scan.
+ *
+ * @param region The region to scan.
+ * @param stats The region's stats to fill.
+ * @param ages Page ages of the region, or nullptr without idle tracking.
+ * @param report_idle Whether the previous scan marked pages idle.
+ * @return true on success, false if pagemap could not be read.
+ */
+bool PagemapScanner::scan_region(const MemoryRegion& region, PageStats& stats, RegionAges* ages,
+                                 bool report_idle) {
+    const uint64_t first = region.start_addr / page_size_;
+    const uint64_t count = region.size_bytes() / page_size_;
+    stats.pages = count;
+    entries_.resize(config_.batch_pages);
+
+    for (uint64_t done = 0; done < count;) {
+        size_t want = static_cast<size_t>(std::min<uint64_t>(config_.batch_pages, count - done));
+        ssize_t got = pread_full(pagemap_fd_, entries_.data(), want * sizeof(uint64_t),
+                                 static_cast<off_t>((first + done) * sizeof(uint64_t)));
+        if (got < 0)
+            return false;
+        size_t n = static_cast<size_t>(got) / sizeof(uint64_t);
+        decode_entries(entries_.data(), n, stats);
+
+        if (ages && !frames_hidden_) {
+            frames_.clear();
+            frame_pages_.clear();
+            for (size_t i = 0; i < n; ++i) {
+                uint64_t e = entries_[i];
+                if (!(e >> kPresentBit)) {
+                    ages->age[done + i] = 0;
+                    continue;
+                }
+                uint64_t frame = e & kFrameMask;
+                if (frame == 0) {
+                    frames_hidden_ = true;
+                    break;
+                }
+                frames_.push_back(frame);
+                frame_pages_.push_back(static_cast<uint32_t>(i));
+            }
+        }
+
+        if (ages && !frames_hidden_ && !frames_.empty()) {
+            words_.clear();
+            for (uint64_t frame : frames_)
+                words_.push_back(frame >> 6);
+            std::sort(words_.begin(), words_.end());
+            words_.erase(std::unique(words_.begin(), words_.end()), words_.end());
+
+            if (!read_idle_words()) {
+                std::fill(word_bits_.begin(), word_bits_.end(), 0);
+            }
+            for (size_t k = 0; k < frames_.size(); ++k) {
+                uint64_t frame = frames_[k];
+                size_t w = std::lower_bound(words_.begin(), words_.end(), frame >> 6) -
+                           words_.begin();
+                bool idle = (word_bits_[w] >> (frame & 63)) & 1;
+
+                uint8_t& age = ages->age[done + frame_pages_[k]];
+                if (!idle || !report_idle) {
+                    age = 0;
+                } else if (age < UINT8_MAX) {
+                    ++age;
+                }
+                if (report_idle) {
+                    if (age == 0)
+                        ++stats.hot;
+                    else
+                        ++stats.cold[age_bucket(age)];
+                }
+            }
+
+            std::fill(word_bits_.begin(), word_bits_.end(), 0);
+            for (uint64_t frame : frames_) {
+                size_t w = std::lower_bound(words_.begin(), words_.end(), frame >> 6) -
+                           words_.begin();
+                word_bits_[w] |= uint64_t{1} << (frame & 63);
+            }
+            mark_idle_words();
+        }
+
+        if (n < want)
+            break; // Past the end of the user address space.
+        done += n;
+    }
+
+    stats.shared = stats.present - stats.exclusive;
+    return true;
+}
+
+/**
+ * @brief Reads the idle bitmap words listed in words_ into word_bits_.
+ *
+ * Nearby words are fetched by a single pread covering the gap between them.
+ *
+ * @return true on success, false if the bitmap could not be read.
+ */
+bool PagemapScanner::read_idle_words() {
+    word_bits_.assign(words_.size(), 0);
+    for (size_t i = 0; i < words_.size();) {
+        size_t j = i;
+        while (j + 1 < words_.size() && words_[j + 1] - words_[j] <= kMaxWordGap)
+            ++j;
+        uint64_t base = words_[i];
+        size_t len = static_cast<size_t>(words_[j] - base + 1);
+        io_.resize(len);
+        ssize_t got = pread_full(bitmap_fd_, io_.data(), len * sizeof(uint64_t),
+                                 static_cast<off_t>(base * sizeof(uint64_t)));
+        if (got != static_cast<ssize_t>(len * sizeof(uint64_t)))
+            return false;
+        for (size_t k = i; k <= j; ++k)
+            word_bits_[k] = io_[words_[k] - base];
+        i = j + 1;
+    }
+    return true;
+}
+
+/**
+ * @brief Marks the frames whose bits are set in word_bits_ idle.
+ *
+ * Writes to the bitmap only act on set bits, so the gap words written
+ * between two wanted ones are zero and leave other pages alone. Errors are
+ * ignored: an unmarked page simply reads as hot on the next scan.
+ */
+void PagemapScanner::mark_idle_words() {
+    for (size_t i = 0; i < words_.size();) {
+        size_t j = i;
+        while (j + 1 < words_.size() && words_[j + 1] - words_[j] <= kMaxWordGap)
+            ++j;
+        uint64_t base = words_[i];
+        size_t len = static_cast<size_t>(words_[j] - base + 1);
+        io_.assign(len, 0);
+        for (size_t k = i; k <= j; ++k)
+            io_[words_[k] - base] = word_bits_[k];
+        ssize_t n;
+        do {
+            n = ::pwrite(bitmap_fd_, io_.data(), len * sizeof(uint64_t),
+                         static_cast<off_t>(base * sizeof(uint64_t)));
+        } while (n < 0 && errno == EINTR);
+        i = j + 1;
+    }
+}
+
+} // namespace memc
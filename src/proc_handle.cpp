@@ -0,0 +1,179 @@
+#include "collect_internal.h"
+#include "self_stats_internal.h"
+
+#include <charconv>
+#include <cstring>
+#include <fcntl.h>
+#include <memc/proc_handle.h>
+#include <unistd.h>
+#include <utility>
+
+namespace memc {
+
+/**
+ * @brief Opens /proc/<pid>; check is_open() for the result.
+ *
+ * @param pid The process ID.
+ */
+ProcHandle::ProcHandle(pid_t pid) {
+    open(pid);
+}
+
+/**
+ * @brief Destructor. Closes the directory and every cached file.
+ */
+ProcHandle::~ProcHandle() {
+    close();
+}
+
+/**
+ * @brief Takes over the descriptors of @p other, leaving it closed.
+ */
+ProcHandle::ProcHandle(ProcHandle&& other) noexcept
+    : pid_(std::exchange(other.pid_, 0))
+    , dir_fd_(std::exchange(other.dir_fd_, -1))
+    , files_(std::exchange(other.files_, {})) {}
+
+/**
+ * @brief Closes this handle and takes over the descriptors of @p other.
+ */
+ProcHandle& ProcHandle::operator=(ProcHandle&& other) noexcept {
+    if (this != &other) {
+        close();
+        pid_ = std::exchange(other.pid_, 0);
+        dir_fd_ = std::exchange(other.dir_fd_, -1);
+        files_ = std::exchange(other.files_, {});
+    }
+    return *this;
+}
+
+/**
+ * @brief Opens /proc/<pid>, closing any previously open process first.
+ *
+ * @param pid The process ID.
+ * @return true on success, false if the process does not exist or its
+ * /proc directory cannot be opened.
+ */
+bool ProcHandle::open(pid_t pid) {
+    close();
+
+    char path[32] = "/proc/";
+    *std::to_chars(path + 6, path + sizeof(path) - 1, pid).ptr = '\0';
+    dir_fd_ = ::open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    detail::stat_add(detail::StatCounter::SYSCALLS, 1);
+    if (dir_fd_ < 0)
+        return false;
+    pid_ = pid;
+    return true;
+}
+
+/**
+ * @brief Closes the directory and every cached file.
+ */
+void ProcHandle::close() {
+    close_files();
+    if (dir_fd_ >= 0) {
+        ::close(dir_fd_);
+        detail::stat_add(detail::StatCounter::SYSCALLS, 1);
+        dir_fd_ = -1;
+    }
+    pid_ = 0;
+}
+
+/**
+ * @brief Reads an entire /proc/<pid>/<name> file into a caller-owned buffer.
+ *
+ * A cached descriptor that fails or reads back empty may belong to an
+ * address space the process has since replaced by exec(2); it is dropped
+ * and the file is reopened and read once more. The call is timed as
+ * StatPhase::READ.
+ *
+ * @param name The file name below /proc/<pid>/ (e.g., "smaps").
+ * @param buffer The buffer to fill. Its previous contents are discarded.
+ * @return true on success, false if the handle is closed or the file could
+ * not be opened or read.
+ */
+bool ProcHandle::read(const char* name, std::string& buffer) {
+    if (dir_fd_ < 0)
+        return false;
+
+    detail::PhaseTimer timer(StatPhase::READ);
+    File* file = find_slot(name);
+    if (!file) {
+        // Cache full: fall back to one open per read.
+        int fd = open_file(name);
+        if (fd < 0)
+            return false;
+        bool ok = detail::read_whole_file(fd, buffer);
+        ::close(fd);
+        detail::stat_add(detail::StatCounter::SYSCALLS, 1);
+        return ok;
+    }
+    if (file->fd < 0) {
+        file->fd = open_file(name);
+        if (file->fd < 0) {
+            file->name = nullptr;
+            return false;
+        }
+        return detail::read_whole_file(file->fd, buffer);
+    }
+
+    if (detail::read_whole_file(file->fd, buffer) && !buffer.empty())
+        return true;
+
+    ::close(file->fd);
+    file->fd = open_file(name);
+    detail::stat_add(detail::StatCounter::SYSCALLS, 1);
+    if (file->fd < 0) {
+        file->name = nullptr;
+        return false;
+    }
+    return detail::read_whole_file(file->fd, buffer);
+}
+
+/**
+ * @brief Returns the cache slot of @p name, claiming a free one (with a
+ * closed fd) for a name not seen before.
+ *
+ * @return File* The slot, or nullptr if every slot holds another name.
+ */
+ProcHandle::File* ProcHandle::find_slot(const char* name) {
+    File* free_slot = nullptr;
+    for (File& f : files_) {
+        if (f.name && (f.name == name || std::strcmp(f.name, name) == 0))
+            return &f;
+        if (!f.name && !free_slot)
+            free_slot = &f;
+    }
+    if (free_slot) {
+        free_slot->name = name;
+        free_slot->fd = -1;
+    }
+    return free_slot;
+}
+
+/**
+ * @brief Opens @p name relative to the /proc/<pid> directory.
+ *
+ * @return int The descriptor, or -1 on failure.
+ */
+int ProcHandle::open_file(const char* name) {
+    int fd = ::openat(dir_fd_, name, O_RDONLY | O_CLOEXEC);
+    detail::stat_add(detail::StatCounter::SYSCALLS, 1);
+    return fd;
+}
+
+/**
+ * @brief Closes every cached file and forgets its name.
+ */
+void ProcHandle::close_files() {
+    for (File& f : files_) {
+        if (f.fd >= 0) {
+            ::close(f.fd);
+            detail::stat_add(detail::StatCounter::SYSCALLS, 1);
+        }
+        f = File{};
+    }
+}
+
+} // namespace memc
@@ -0,0 +1,226 @@
+#include "line_cursor.h"
+
+#include <memc/process_selector.h>
+#include <memc/process_utils.h>
+#include <unistd.h>
+
+namespace memc {
+
+namespace {
+
+/// Task flag of kernel threads (include/linux/sched.h).
+constexpr uint64_t kPfKthread = 0x00200000;
+
+/**
+ * @brief Reads the effective UID from the contents of /proc/<pid>/status.
+ *
+ * The line is "Uid:\t<real>\t<effective>\t<saved>\t<filesystem>".
+ *
+ * @return true on success, false if the line is missing or malformed.
+ */
+bool parse_effective_uid(std::string_view status, uint64_t& uid) {
+    bool found = false;
+    detail::for_each_line(status, [&](std::string_view line) {
+        if (found || !line.starts_with("Uid:")) {
+            return;
+        }
+        detail::LineCursor cursor{line.substr(4)};
+        uint64_t real;
+        cursor.skip_blanks();
+        if (!cursor.scan_decimal(real)) {
+            return;
+        }
+        cursor.skip_blanks();
+        found = cursor.scan_decimal(uid);
+    });
+    return found;
+}
+
+} // namespace
+
+/**
+ * @brief Builds a selector, compiling the name pattern once.
+ *
+ * @param name_pattern Regex for the process name, or empty for any name.
+ * @param cgroup_prefix Cgroup path prefix, or empty for any cgroup.
+ * @return std::optional<ProcessSelector> The selector, or std::nullopt if
+ * the pattern does not compile.
+ */
+std::optional<ProcessSelector> ProcessSelector::create(const std::string& name_pattern,
+                                                       const std::string& cgroup_prefix) {
+    return create(Config{.name_pattern = name_pattern,
+                         .cgroup_prefix = cgroup_prefix,
+                         .uid = std::nullopt,
+                         .min_rss_kb = 0,
+                         .skip_kernel = false});
+}
+
+/**
+ * @brief Builds a selector from a full set of criteria.
+ *
+ * @param config The criteria.
+ * @return std::optional<ProcessSelector> The selector, or std::nullopt if
+ * the name pattern does not compile.
+ */
+std::optional<ProcessSelector> ProcessSelector::create(const Config& config) {
+    ProcessSelector selector;
+    if (!config.name_pattern.empty()) {
+        try {
+            selector.name_regex_.emplace(config.name_pattern,
+                                         std::regex::ECMAScript | std::regex::optimize);
+        } catch (const std::regex_error&) {
+            return std::nullopt;
+        }
+    }
+    selector.cgroup_prefix_ = config.cgroup_prefix;
+    selector.uid_ = config.uid;
+    selector.min_rss_kb_ = config.min_rss_kb;
+    selector.skip_kernel_ = config.skip_kernel;
+    long page_size = ::sysconf(_SC_PAGESIZE);
+    selector.page_kb_ = page_size > 0 ? static_cast<uint64_t>(page_size) / 1024 : 4;
+    return selector;
+}
+
+/**
+ * @brief Checks one process against every criterion.
+ *
+ * Name and kind come from one read of /proc/<pid>/stat; status, statm and
+ * cgroup are only read when their criterion is set and every earlier one
+ * passed.
+ *
+ * @param pid The process ID.
+ * @param buffer Scratch buffer for reading /proc files.
+ * @return true if the process matches.
+ */
+bool ProcessSelector::matches(pid_t pid, std::string& buffer) const {
+    if (name_regex_ || skip_kernel_) {
+        if (!read_proc_file(pid, "stat", buffer) || !stat_matches(buffer)) {
+            return false;
+        }
+    }
+
+    if (uid_) {
+        uint64_t uid = 0;
+        if (!read_proc_file(pid, "status", buffer) || !parse_effective_uid(buffer, uid) ||
+            uid != *uid_) {
+            return false;
+        }
+    }
+
+    if (min_rss_kb_ > 0) {
+        // statm: size resident shared text lib data dt, in pages.
+        if (!read_proc_file(pid, "statm", buffer)) {
+            return false;
+        }
+        detail::LineCursor cursor{buffer};
+        uint64_t size;
+        uint64_t resident;
+        if (!cursor.scan_decimal(size)) {
+            return false;
+        }
+        cursor.skip_blanks();
+        if (!cursor.scan_decimal(resident) || resident * page_kb_ < min_rss_kb_) {
+            return false;
+        }
+    }
+
+    if (!cgroup_prefix_.empty()) {
+        if (!read_proc_file(pid, "cgroup", buffer)) {
+            return false;
+        }
+        return cgroup_matches(buffer);
+    }
+    return true;
+}
+
+/**
+ * @brief Filters a PID list, keeping its order.
+ *
+ * @param pids Candidate processes.
+ * @return std::vector<pid_t> The matching subset.
+ */
+std::vector<pid_t> ProcessSelector::select(const std::vector<pid_t>& pids) const {
+    if (empty()) {
+        return pids;
+    }
+
+    std::vector<pid_t> selected;
+    std::string buffer;
+    for (pid_t pid : pids) {
+        if (matches(pid, buffer)) {
+            selected.push_back(pid);
+        }
+    }
+    return selected;
+}
+
+/**
+ * @brief Applies the name and kernel-thread criteria to the contents of
+ * /proc/<pid>/stat.
+ *
+ * The name is field 2, between the first '(' and the last ')' (it may
+ * itself contain parentheses); it is the same string /proc/<pid>/comm
+ * holds. The task flags are field 9.
+ *
+ * @param content Contents of /proc/<pid>/stat.
+ */
+bool ProcessSelector::stat_matches(std::string_view content) const {
+    size_t open = content.find('(');
+    size_t close = content.rfind(')');
+    if (open == std::string_view::npos || close == std::string_view::npos || close < open) {
+        return false;
+    }
+
+    if (skip_kernel_) {
+        detail::LineCursor cursor{content.substr(close + 1)};
+        for (int field = 3; field < 9; ++field) {
+            cursor.skip_blanks();
+            cursor.scan_token();
+        }
+        uint64_t flags;
+        cursor.skip_blanks();
+        if (!cursor.scan_decimal(flags) || (flags & kPfKthread)) {
+            return false;
+        }
+    }
+
+    if (name_regex_) {
+        std::string_view name = content.substr(open + 1, close - open - 1);
+        return std::regex_search(name.begin(), name.end(), *name_regex_);
+    }
+    return true;
+}
+
+/**
+ * @brief Returns true if any hierarchy path in @p content is the configured
+ * prefix or lies below it.
+ *
+ * Lines have the form "hierarchy-id:controllers:path"; the path is
+ * everything after the second colon. The prefix matches whole path
+ * components, so "/system.slice/foo" selects "/system.slice/foo" and
+ * "/system.slice/foo/bar" but not "/system.slice/foobar". A trailing '/' on
+ * the prefix is ignored.
+ *
+ * @param content Contents of /proc/<pid>/cgroup.
+ */
+bool ProcessSelector::cgroup_matches(std::string_view content) const {
+    std::string_view prefix = cgroup_prefix_;
+    if (prefix.size() > 1 && prefix.ends_with('/')) {
+        prefix.remove_suffix(1);
+    }
+    bool found = false;
+    detail::for_each_line(content, [&](std::string_view line) {
+        size_t first = line.find(':');
+        size_t second = first == std::string_view::npos ? first : line.find(':', first + 1);
+        if (second == std::string_view::npos)
+            return;
+        std::string_view path = line.substr(second + 1);
+        if (path.starts_with(prefix) &&
+            (path.size() == prefix.size() || prefix.ends_with('/') || path[prefix.size()] == '/')) {
+            found = true;
+        }
+    });
+    return found;
+}
+
+} // namespace memc
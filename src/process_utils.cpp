@@ -1,44 +1,68 @@
+#include "collect_internal.h"
+#include "line_cursor.h"
+#include "self_stats_internal.h"
+
 #include <algorithm>
-#include <cctype>
-#include <cstdlib>
-#include <dirent.h>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <fcntl.h>
 #include <fstream>
+#include <memc/proc_handle.h>
 #include <memc/process_utils.h>
-#include <memory>
 #include <string>
+#include <string_view>
+#include <sys/syscall.h>
+#include <unistd.h>
 
 namespace memc {
 
 /**
  * @brief Enumerates all numeric PIDs from /proc.
  *
- * Scans the /proc directory for entries whose names are purely numeric,
- * interpreting each as a process ID.
+ * Reads the /proc directory with getdents64(2) into a 32 KiB stack buffer,
+ * several hundred entries per call, and converts the numeric names with
+ * std::from_chars. procfs lists processes in ascending PID order, so the
+ * final sort normally finds the list already sorted.
  *
  * @return std::vector<pid_t> A sorted list of discovered PIDs.
  */
 std::vector<pid_t> enumerate_pids() {
     std::vector<pid_t> pids;
-    auto dir = std::unique_ptr<DIR, int (*)(DIR*)>(opendir("/proc"), closedir);
-    if (!dir)
+    int fd = ::open("/proc", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0)
         return pids;
 
-    struct dirent* entry;
-    while ((entry = readdir(dir.get())) != nullptr) {
-        const char* name = entry->d_name;
-        bool is_pid = true;
-        for (const char* p = name; *p; ++p) {
-            if (!std::isdigit(static_cast<unsigned char>(*p))) {
-                is_pid = false;
-                break;
+    alignas(8) char buf[32 * 1024];
+    for (;;) {
+        long n = ::syscall(SYS_getdents64, fd, buf, sizeof(buf));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            break;
+        for (long off = 0; off < n;) {
+            // struct linux_dirent64: d_ino, d_off, d_reclen, d_type, d_name.
+            const char* entry = buf + off;
+            unsigned short reclen;
+            std::memcpy(&reclen, entry + 16, sizeof(reclen));
+            const char* name = entry + 19;
+            off += reclen;
+
+            if (name[0] < '1' || name[0] > '9')
+                continue;
+            const char* end = name + std::strlen(name);
+            pid_t pid = 0;
+            auto [ptr, ec] = std::from_chars(name, end, pid);
+            if (ec == std::errc() && ptr == end) {
+                pids.push_back(pid);
             }
         }
-        if (is_pid && name[0] != '\0') {
-            pids.push_back(static_cast<pid_t>(std::atoi(name)));
-        }
     }
+    ::close(fd);
 
-    std::sort(pids.begin(), pids.end());
+    if (!std::is_sorted(pids.begin(), pids.end())) {
+        std::sort(pids.begin(), pids.end());
+    }
     return pids;
 }
 
@@ -61,4 +85,167 @@ std::string get_process_name(pid_t pid) {
     return "unknown";
 }
 
+/**
+ * @brief Reads /proc/<pid>/comm through a caller-owned read buffer.
+ *
+ * @param pid The process ID.
+ * @param buffer Scratch buffer for the raw file contents.
+ * @return std::string The process name, or "unknown" if not found.
+ */
+std::string get_process_name(pid_t pid, std::string& buffer) {
+    if (!read_proc_file(pid, "comm", buffer)) {
+        return "unknown";
+    }
+    return detail::process_name_from_comm(buffer);
+}
+
+/**
+ * @brief Reads the process name through an open ProcHandle.
+ *
+ * @param proc An open handle for the process.
+ * @param buffer Scratch buffer for the raw file contents.
+ * @return std::string The process name, or "unknown" if not found.
+ */
+std::string get_process_name(ProcHandle& proc, std::string& buffer) {
+    if (!proc.read("comm", buffer)) {
+        return "unknown";
+    }
+    return detail::process_name_from_comm(buffer);
+}
+
+/**
+ * @brief Reads the start time of a process from /proc/<pid>/stat.
+ *
+ * The command name (field 2) may contain spaces and parentheses, so fields
+ * are counted from the last ')'; starttime is field 22.
+ *
+ * @param pid The process ID.
+ * @param buffer Scratch buffer for the raw file contents.
+ * @param start_time Receives the starttime field, in clock ticks since boot.
+ * @return true on success, false if the process is gone or stat is
+ * malformed.
+ */
+bool get_process_start_time(pid_t pid, std::string& buffer, uint64_t& start_time) {
+    if (!read_proc_file(pid, "stat", buffer)) {
+        return false;
+    }
+    std::string_view stat = buffer;
+    size_t close = stat.rfind(')');
+    if (close == std::string_view::npos) {
+        return false;
+    }
+
+    detail::LineCursor cursor{stat.substr(close + 1)};
+    for (int field = 3; field < 22; ++field) {
+        cursor.skip_blanks();
+        cursor.scan_token();
+    }
+    cursor.skip_blanks();
+    return cursor.scan_decimal(start_time);
+}
+
+/**
+ * @brief Reads an entire /proc/<pid>/<name> file into a caller-owned buffer.
+ *
+ * The path is built on the stack to keep the call allocation-free once the
+ * buffer has reached its working size. The call is timed as
+ * StatPhase::READ and its bytes and system calls are counted in the self
+ * statistics.
+ *
+ * @param pid The process ID.
+ * @param name The file name below /proc/<pid>/ (e.g., "maps").
+ * @param buffer The buffer to fill. Its previous contents are discarded.
+ * @return true on success, false if the file could not be opened or read.
+ */
+bool read_proc_file(pid_t pid, const char* name, std::string& buffer) {
+    char path[64] = "/proc/";
+    char* p = path + 6;
+    p = std::to_chars(p, path + 32, pid).ptr;
+    *p++ = '/';
+    size_t name_len = std::strlen(name);
+    if (name_len >= static_cast<size_t>(path + sizeof(path) - p))
+        return false;
+    std::memcpy(p, name, name_len + 1);
+
+    detail::PhaseTimer timer(StatPhase::READ);
+    int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    detail::stat_add(detail::StatCounter::SYSCALLS, 1);
+    if (fd < 0)
+        return false;
+
+    bool ok = detail::read_whole_file(fd, buffer);
+    ::close(fd);
+    detail::stat_add(detail::StatCounter::SYSCALLS, 1);
+    return ok;
+}
+
+namespace detail {
+
+/**
+ * @brief Returns the process name held by the raw contents of a comm file.
+ *
+ * @param comm The raw /proc/<pid>/comm contents.
+ * @return std::string The first line, or "unknown" if it is empty.
+ */
+std::string process_name_from_comm(std::string_view comm) {
+    if (comm.empty()) {
+        return "unknown";
+    }
+    std::string_view name = comm.substr(0, comm.find('\n'));
+    while (!name.empty() && name.back() == '\r') {
+        name.remove_suffix(1);
+    }
+    return std::string(name);
+}
+
+/**
+ * @brief Reads an open file from offset 0 to end-of-file into @p buffer.
+ *
+ * /proc files report a size of zero, so the buffer is grown geometrically
+ * until pread(2) signals end-of-file. It only grows when a read has filled
+ * it: reading starts over the previous contents, and resizing within the
+ * capacity zero-fills just the bytes added, so a small file read after a
+ * large one costs no more than the small file. Reading at explicit offsets
+ * makes a re-read of a descriptor kept open start over from the beginning,
+ * which for seq_file-backed /proc files regenerates the contents.
+ *
+ * @param fd The open file.
+ * @param buffer The buffer to fill. Its previous contents are discarded.
+ * @return true on success, false on a read error (@p buffer is cleared).
+ */
+bool read_whole_file(int fd, std::string& buffer) {
+    constexpr size_t kInitialSize = 4096;
+    size_t len = 0;
+    uint64_t syscalls = 0;
+    if (buffer.size() < kInitialSize) {
+        buffer.resize(kInitialSize);
+    }
+
+    for (;;) {
+        if (len == buffer.size()) {
+            buffer.resize(buffer.size() * 2);
+        }
+        ssize_t n = ::pread(fd, buffer.data() + len, buffer.size() - len, static_cast<off_t>(len));
+        ++syscalls;
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            stat_add(StatCounter::SYSCALLS, syscalls);
+            buffer.clear();
+            return false;
+        }
+        if (n == 0)
+            break;
+        len += static_cast<size_t>(n);
+    }
+
+    buffer.resize(len);
+    stat_add(StatCounter::SYSCALLS, syscalls);
+    stat_add(StatCounter::FILES_READ, 1);
+    stat_add(StatCounter::BYTES_READ, len);
+    return true;
+}
+
+} // namespace detail
+
 } // namespace memc
@@ -0,0 +1,118 @@
+#include <memc/region_index.h>
+
+namespace memc {
+
+namespace {
+
+/**
+ * @brief Returns how many elements of the ascending array @p base are <= @p key.
+ *
+ * Branchless: each step halves the range with a conditional move, so the
+ * loop runs log2(n) iterations regardless of the data.
+ */
+size_t count_not_greater(const uint64_t* base, size_t n, uint64_t key) {
+    if (n == 0)
+        return 0;
+    const uint64_t* first = base;
+    while (n > 1) {
+        size_t half = n / 2;
+        first = first[half] <= key ? first + half : first;
+        n -= half;
+    }
+    return static_cast<size_t>(first - base) + (*first <= key);
+}
+
+} // namespace
+
+/**
+ * @brief Builds an index over the regions of @p snapshot.
+ */
+RegionIndex::RegionIndex(const ProcessSnapshot& snapshot)
+    : RegionIndex(std::span<const MemoryRegion>(snapshot.regions)) {}
+
+/**
+ * @brief Builds an index over @p regions.
+ */
+RegionIndex::RegionIndex(std::span<const MemoryRegion> regions) {
+    assign(regions);
+}
+
+/**
+ * @brief Rebuilds the index over @p regions, keeping the capacity.
+ *
+ * @param regions The regions, ascending by start address and disjoint.
+ */
+void RegionIndex::assign(std::span<const MemoryRegion> regions) {
+    regions_ = regions;
+    starts_.resize(regions.size());
+    ends_.resize(regions.size());
+    for (size_t i = 0; i < regions.size(); ++i) {
+        starts_[i] = regions[i].start_addr;
+        ends_[i] = regions[i].end_addr;
+    }
+}
+
+/**
+ * @brief Returns the region containing @p addr.
+ *
+ * The last region starting at or below @p addr is the only candidate,
+ * since regions are disjoint.
+ *
+ * @param addr A virtual address.
+ * @return const MemoryRegion* The region, or nullptr if unmapped.
+ */
+const MemoryRegion* RegionIndex::find_region(uint64_t addr) const {
+    size_t n = count_not_greater(starts_.data(), starts_.size(), addr);
+    if (n == 0 || addr >= ends_[n - 1])
+        return nullptr;
+    return &regions_[n - 1];
+}
+
+/**
+ * @brief Returns the regions overlapping the range [lo, hi).
+ *
+ * Disjoint sorted regions also have ascending end addresses, so the
+ * overlapping ones are the contiguous run from the first region ending
+ * after @p lo to the last one starting before @p hi.
+ *
+ * @param lo First address of the range.
+ * @param hi One past the last address of the range.
+ * @return std::span<const MemoryRegion> The overlapping regions.
+ */
+std::span<const MemoryRegion> RegionIndex::overlapping(uint64_t lo, uint64_t hi) const {
+    if (lo >= hi)
+        return {};
+    size_t first = count_not_greater(ends_.data(), ends_.size(), lo);
+    size_t last = count_not_greater(starts_.data(), starts_.size(), hi - 1);
+    if (first >= last)
+        return {};
+    return regions_.subspan(first, last - first);
+}
+
+/**
+ * @brief Looks up every address of @p addrs in one merge pass.
+ *
+ * Addresses and regions are both walked forward once, so the cost is
+ * O(addresses + regions) with sequential reads of the address arrays.
+ *
+ * @param addrs Addresses to look up, in ascending order.
+ * @param out One entry per address: the region, or nullptr if unmapped.
+ * @return size_t Number of addresses found in a region.
+ */
+size_t RegionIndex::find_regions(std::span<const uint64_t> addrs,
+                                 std::span<const MemoryRegion*> out) const {
+    const size_t n = starts_.size();
+    size_t i = 0;
+    size_t found = 0;
+    for (size_t k = 0; k < addrs.size(); ++k) {
+        uint64_t addr = addrs[k];
+        while (i < n && ends_[i] <= addr)
+            ++i;
+        bool hit = i < n && starts_[i] <= addr;
+        out[k] = hit ? &regions_[i] : nullptr;
+        found += hit;
+    }
+    return found;
+}
+
+} // namespace memc
@@ -0,0 +1,209 @@
+#include <algorithm>
+#include <memc/region_table.h>
+
+namespace memc {
+
+namespace {
+
+/**
+ * @brief Sums rows [begin, end) of a column; vectorizes.
+ */
+uint64_t column_sum(const std::vector<uint64_t>& column, size_t begin, size_t end) {
+    uint64_t total = 0;
+    for (size_t i = begin; i < end; ++i)
+        total += column[i];
+    return total;
+}
+
+} // namespace
+
+/**
+ * @brief Builds a table holding the regions of @p snapshot.
+ */
+RegionTable::RegionTable(const ProcessSnapshot& snapshot) {
+    append(snapshot);
+}
+
+/**
+ * @brief Appends the regions of @p snapshot as one more snapshot.
+ *
+ * Each column grows by one push per region; call reserve() first when the
+ * final size is known.
+ */
+void RegionTable::append(const ProcessSnapshot& snapshot) {
+    offsets_.push_back(size());
+    for (const auto& r : snapshot.regions) {
+        start_.push_back(r.start_addr);
+        end_.push_back(r.end_addr);
+        rss_.push_back(r.rss_kb);
+        pss_.push_back(r.pss_kb);
+        swap_.push_back(r.swap_kb);
+        shared_.push_back(r.shared_clean_kb + r.shared_dirty_kb);
+        private_.push_back(r.private_clean_kb + r.private_dirty_kb);
+        thp_.push_back(r.thp_kb());
+        pathname_.push_back(r.pathname.id());
+        type_.push_back(static_cast<uint8_t>(r.type));
+        perms_.push_back(r.permissions.bits());
+    }
+}
+
+/**
+ * @brief Replaces the contents with @p snapshot, keeping the capacity.
+ */
+void RegionTable::assign(const ProcessSnapshot& snapshot) {
+    clear();
+    append(snapshot);
+}
+
+/**
+ * @brief Reserves room for @p regions rows in every column.
+ */
+void RegionTable::reserve(size_t regions) {
+    start_.reserve(regions);
+    end_.reserve(regions);
+    rss_.reserve(regions);
+    pss_.reserve(regions);
+    swap_.reserve(regions);
+    shared_.reserve(regions);
+    private_.reserve(regions);
+    thp_.reserve(regions);
+    pathname_.reserve(regions);
+    type_.reserve(regions);
+    perms_.reserve(regions);
+}
+
+/**
+ * @brief Removes every row, keeping the allocated columns.
+ */
+void RegionTable::clear() {
+    start_.clear();
+    end_.clear();
+    rss_.clear();
+    pss_.clear();
+    swap_.clear();
+    shared_.clear();
+    private_.clear();
+    thp_.clear();
+    pathname_.clear();
+    type_.clear();
+    perms_.clear();
+    offsets_.clear();
+}
+
+/**
+ * @brief Returns the totals of every row.
+ */
+RegionTotals RegionTable::totals() const {
+    return totals(0, size());
+}
+
+/**
+ * @brief Returns the totals of the @p i-th appended snapshot.
+ */
+RegionTotals RegionTable::snapshot_totals(size_t i) const {
+    size_t end = i + 1 < offsets_.size() ? offsets_[i + 1] : size();
+    return totals(offsets_[i], end);
+}
+
+/**
+ * @brief Sums rows [begin, end), one column at a time.
+ *
+ * The size is summed in bytes and converted once, like
+ * ProcessSnapshot::total_vsize_kb().
+ */
+RegionTotals RegionTable::totals(size_t begin, size_t end) const {
+    RegionTotals t;
+    t.regions = end - begin;
+
+    uint64_t bytes = 0;
+    for (size_t i = begin; i < end; ++i)
+        bytes += end_[i] - start_[i];
+    t.size_kb = bytes / 1024;
+
+    t.rss_kb = column_sum(rss_, begin, end);
+    t.pss_kb = column_sum(pss_, begin, end);
+    t.swap_kb = column_sum(swap_, begin, end);
+    t.shared_kb = column_sum(shared_, begin, end);
+    t.private_kb = column_sum(private_, begin, end);
+    t.thp_kb = column_sum(thp_, begin, end);
+    return t;
+}
+
+/**
+ * @brief Adds every row into groups[keys[i]], one column per pass.
+ *
+ * @p groups must have room for every key value and start zeroed. While the
+ * passes run, size_kb accumulates bytes; it is converted to KB at the end
+ * for the first @p group_count groups.
+ *
+ * @param keys Group key of every row.
+ * @param groups Accumulators indexed by key.
+ * @param group_count Number of accumulators.
+ */
+template <typename Key>
+void RegionTable::group_totals(std::span<const Key> keys, RegionTotals* groups,
+                               size_t group_count) const {
+    const size_t n = keys.size();
+    for (size_t i = 0; i < n; ++i) {
+        RegionTotals& g = groups[keys[i]];
+        g.regions += 1;
+        g.size_kb += end_[i] - start_[i];
+    }
+
+    auto add = [&](const std::vector<uint64_t>& column, uint64_t RegionTotals::*field) {
+        for (size_t i = 0; i < n; ++i)
+            groups[keys[i]].*field += column[i];
+    };
+    add(rss_, &RegionTotals::rss_kb);
+    add(pss_, &RegionTotals::pss_kb);
+    add(swap_, &RegionTotals::swap_kb);
+    add(shared_, &RegionTotals::shared_kb);
+    add(private_, &RegionTotals::private_kb);
+    add(thp_, &RegionTotals::thp_kb);
+
+    for (size_t g = 0; g < group_count; ++g)
+        groups[g].size_kb /= 1024;
+}
+
+/**
+ * @brief Returns the totals of every row grouped by RegionType.
+ */
+std::array<RegionTotals, kRegionTypeCount> RegionTable::totals_by_type() const {
+    std::array<RegionTotals, kRegionTypeCount> groups{};
+    group_totals(type(), groups.data(), groups.size());
+    return groups;
+}
+
+/**
+ * @brief Returns the totals of every row grouped by permission class.
+ */
+std::array<RegionTotals, kPermissionClassCount> RegionTable::totals_by_permissions() const {
+    std::array<RegionTotals, kPermissionClassCount> groups{};
+    group_totals(permissions(), groups.data(), groups.size());
+    return groups;
+}
+
+/**
+ * @brief Returns the totals of every row grouped by pathname.
+ *
+ * StringPool IDs are dense, so the accumulators are a flat array indexed
+ * by ID, sized to the largest ID in the table.
+ */
+std::vector<PathnameTotals> RegionTable::totals_by_pathname() const {
+    uint32_t max_id = 0;
+    for (uint32_t id : pathname_)
+        max_id = std::max(max_id, id);
+
+    std::vector<RegionTotals> groups(empty() ? 0 : size_t{max_id} + 1);
+    group_totals(pathname_id(), groups.data(), groups.size());
+
+    std::vector<PathnameTotals> result;
+    for (uint32_t id = 0; id < groups.size(); ++id) {
+        if (groups[id].regions > 0) {
+            result.push_back({InternedString::from_id(id), groups[id]});
+        }
+    }
+    return result;
+}
+
+} // namespace memc
@@ -1,18 +1,28 @@
-#include <chrono>
+#include "collect_internal.h"
+
 #include <iostream>
-#include <memc/maps_parser.h>
 #include <memc/sampler.h>
-#include <memc/smaps_parser.h>
 
 namespace memc {
 
 /**
  * @brief Constructs a Sampler with the given configuration.
  *
+ * A bounded history of N entries keeps up to N snapshot handles, or in
+ * delta mode the base snapshot plus up to N - 1 deltas.
+ *
  * @param config The sampler configuration (PID, interval, smaps, etc.).
  */
 Sampler::Sampler(SamplerConfig config)
-    : config_(std::move(config)) {}
+    : config_(std::move(config))
+    , timer_(config_.interval)
+    , snapshots_(config_.delta ? 1 : config_.max_snapshots)
+    , deltas_(config_.max_snapshots > 1 ? config_.max_snapshots - 1 : 0)
+    , dispatcher_(config_.dispatch, [this](const SampleEvent& event) { deliver(event); }) {
+    if (config_.growth) {
+        growth_.emplace(*config_.growth);
+    }
+}
 
 /**
  * @brief Destructor. Ensures the sampling thread is stopped and joined.
@@ -31,33 +41,64 @@ void Sampler::start() {
     if (running_.load())
         return;
     running_.store(true);
+    dispatcher_.start();
+    timer_.start();
     thread_ = std::thread(&Sampler::sample_loop, this);
 }
 
 /**
  * @brief Stops the background sampling thread.
  *
- * Sets the running flag to false and blocks until the thread has joined.
+ * Clears the running flag, wakes the sampling thread out of its timer
+ * wait, and blocks until the thread has joined. Callbacks still queued
+ * are delivered before returning.
  */
 void Sampler::stop() {
     running_.store(false);
+    timer_.stop();
     if (thread_.joinable()) {
         thread_.join();
     }
+    dispatcher_.stop();
 }
 
 /**
  * @brief Registers a callback to be invoked after each snapshot.
  *
- * Thread-safe: acquires the internal mutex before modifying the callback list.
+ * Thread-safe: acquires the callback mutex before modifying the list.
  *
  * @param cb The callback function to register.
  */
 void Sampler::on_snapshot(SnapshotCallback cb) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::unique_lock lock(callbacks_mutex_);
     callbacks_.push_back(std::move(cb));
 }
 
+/**
+ * @brief Registers a callback to be invoked with each new delta.
+ *
+ * Thread-safe: acquires the callback mutex before modifying the list.
+ *
+ * @param cb The callback function to register.
+ */
+void Sampler::on_delta(DeltaCallback cb) {
+    std::unique_lock lock(callbacks_mutex_);
+    delta_callbacks_.push_back(std::move(cb));
+}
+
+/**
+ * @brief Registers a callback to be invoked when a growth rule changes
+ * state.
+ *
+ * Thread-safe: acquires the callback mutex before modifying the list.
+ *
+ * @param cb The callback function to register.
+ */
+void Sampler::on_alert(AlertCallback cb) {
+    std::unique_lock lock(callbacks_mutex_);
+    alert_callbacks_.push_back(std::move(cb));
+}
+
 /**
  * @brief Checks if the sampler is currently running.
  *
@@ -76,68 +117,305 @@ bool Sampler::is_running() const {
  */
 size_t Sampler::snapshot_count() const {
     std::lock_guard<std::mutex> lock(mutex_);
+    if (config_.delta) {
+        return base_ ? deltas_.size() + 1 : 0;
+    }
     return snapshots_.size();
 }
 
 /**
  * @brief Returns a copy of all collected snapshots.
  *
- * Thread-safe: acquires the internal mutex and returns a copy.
+ * Handles are gathered under the lock; the deep copies are made after it
+ * is released.
  *
  * @return std::vector<ProcessSnapshot> Copy of all snapshots.
  */
 std::vector<ProcessSnapshot> Sampler::get_snapshots() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return snapshots_;
+    std::vector<ProcessSnapshot> all;
+    for (const auto& handle : get_snapshot_handles()) {
+        all.push_back(*handle);
+    }
+    return all;
 }
 
 /**
- * @brief Returns the most recent snapshot.
- *
- * Thread-safe: acquires the internal mutex.
+ * @brief Returns a copy of the most recent snapshot.
  *
  * @return std::optional<ProcessSnapshot> The latest snapshot, or
  * std::nullopt if no snapshots have been collected.
  */
 std::optional<ProcessSnapshot> Sampler::get_latest() const {
+    auto handle = get_latest_handle();
+    if (!handle)
+        return std::nullopt;
+    return *handle;
+}
+
+/**
+ * @brief Returns handles to every retained snapshot, oldest first.
+ *
+ * In delta mode the base snapshot and the deltas are copied under the
+ * lock, and the intermediate snapshots are rebuilt after releasing it.
+ *
+ * @return std::vector<SnapshotHandle> The snapshot handles.
+ */
+std::vector<SnapshotHandle> Sampler::get_snapshot_handles() const {
+    std::vector<SnapshotHandle> handles;
+
+    if (!config_.delta) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        handles.reserve(snapshots_.size());
+        for (size_t i = 0; i < snapshots_.size(); ++i) {
+            handles.push_back(snapshots_[i]);
+        }
+        return handles;
+    }
+
+    std::optional<ProcessSnapshot> base;
+    std::vector<SnapshotDelta> deltas;
+    SnapshotHandle latest;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!base_)
+            return handles;
+        base = base_;
+        deltas.reserve(deltas_.size());
+        for (size_t i = 0; i < deltas_.size(); ++i) {
+            deltas.push_back(deltas_[i]);
+        }
+        latest = latest_.load(std::memory_order_acquire);
+    }
+
+    handles.reserve(deltas.size() + 1);
+    if (deltas.empty()) {
+        handles.push_back(std::move(latest));
+        return handles;
+    }
+    handles.push_back(std::make_shared<const ProcessSnapshot>(*base));
+    for (size_t i = 0; i + 1 < deltas.size(); ++i) {
+        apply_delta(*base, deltas[i]);
+        handles.push_back(std::make_shared<const ProcessSnapshot>(*base));
+    }
+    handles.push_back(std::move(latest));
+    return handles;
+}
+
+/**
+ * @brief Returns a handle to the most recent snapshot.
+ *
+ * Loads the published pointer without taking mutex_, so it never waits for
+ * the sampling thread's history updates.
+ *
+ * @return SnapshotHandle The latest snapshot, or nullptr if none exist.
+ */
+SnapshotHandle Sampler::get_latest_handle() const {
+    return latest_.load(std::memory_order_acquire);
+}
+
+/**
+ * @brief Rebuilds the snapshot at a position in the history.
+ *
+ * Thread-safe: acquires the internal mutex.
+ *
+ * @param index Position in the history, 0 being the oldest retained.
+ * @return std::optional<ProcessSnapshot> The snapshot, or std::nullopt if
+ * @p index is out of range.
+ */
+std::optional<ProcessSnapshot> Sampler::reconstruct(size_t index) const {
     std::lock_guard<std::mutex> lock(mutex_);
-    if (snapshots_.empty())
+    if (!config_.delta) {
+        if (index >= snapshots_.size())
+            return std::nullopt;
+        return *snapshots_[index];
+    }
+
+    if (!base_ || index > deltas_.size())
         return std::nullopt;
-    return snapshots_.back();
+    if (index == deltas_.size())
+        return *latest_.load(std::memory_order_acquire);
+
+    ProcessSnapshot snapshot = *base_;
+    for (size_t i = 0; i < index; ++i) {
+        apply_delta(snapshot, deltas_[i]);
+    }
+    return snapshot;
+}
+
+/**
+ * @brief Returns the stored deltas, oldest first.
+ *
+ * Thread-safe: acquires the internal mutex and returns a copy.
+ *
+ * @return std::vector<SnapshotDelta> Copy of the stored deltas.
+ */
+std::vector<SnapshotDelta> Sampler::get_deltas() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<SnapshotDelta> deltas;
+    deltas.reserve(deltas_.size());
+    for (size_t i = 0; i < deltas_.size(); ++i) {
+        deltas.push_back(deltas_[i]);
+    }
+    return deltas;
+}
+
+/**
+ * @brief Returns the growth statistics of every tracked series.
+ *
+ * Thread-safe: acquires the growth mutex.
+ *
+ * @return std::vector<GrowthRate> The statistics, empty without a tracker.
+ */
+std::vector<GrowthRate> Sampler::growth_rates() const {
+    std::lock_guard<std::mutex> lock(growth_mutex_);
+    if (!growth_)
+        return {};
+    return growth_->rates();
 }
 
 /**
  * @brief The main sampling loop executed on the background thread.
  *
- * Takes a snapshot, stores it in the ring buffer (evicting the oldest
- * entry if max_snapshots is reached), invokes all registered callbacks,
- * and then sleeps until the next interval.
+ * Waits for each deadline of the interval timer, takes a snapshot, stores
+ * it in the ring buffer (evicting the oldest entry if max_snapshots is
+ * reached) and invokes all registered callbacks. Deadlines are absolute,
+ * so the time spent collecting does not push later samples back. With a
+ * growth tracker, the sample is folded into it first.
  */
 void Sampler::sample_loop() {
-    while (running_.load()) {
-        auto snapshot = take_snapshot();
+    while (timer_.wait()) {
+        SnapshotHandle snapshot = take_snapshot();
 
-        {
-            std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<GrowthAlert> alerts;
+        if (growth_) {
+            std::lock_guard<std::mutex> lock(growth_mutex_);
+            growth_->update(*snapshot, alerts);
+        }
 
-            if (config_.max_snapshots > 0 && snapshots_.size() >= config_.max_snapshots) {
-                snapshots_.erase(snapshots_.begin());
-            }
+        if (config_.delta) {
+            store_delta(std::move(snapshot), std::move(alerts));
+        } else {
+            store_snapshot(std::move(snapshot), std::move(alerts));
+        }
+    }
+}
 
-            snapshots_.push_back(snapshot);
+/**
+ * @brief Records a new sample in full-snapshot mode.
+ *
+ * The lock is held only to push the handle; an evicted snapshot is
+ * released after the lock is dropped, so its destruction never delays
+ * readers. The new snapshot is published to latest_ with a single atomic
+ * store.
+ *
+ * @param snapshot The newly taken snapshot.
+ * @param alerts The growth alerts it raised.
+ */
+void Sampler::store_snapshot(SnapshotHandle snapshot, std::vector<GrowthAlert> alerts) {
+    std::optional<SnapshotHandle> evicted;
+    SnapshotHandle previous;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        evicted = snapshots_.push_back(snapshot);
+        previous = latest_.exchange(snapshot, std::memory_order_acq_rel);
+    }
+    notify(std::move(snapshot), std::nullopt, std::move(alerts));
+}
 
-            for (const auto& cb : callbacks_) {
+/**
+ * @brief Records a new sample in delta mode.
+ *
+ * The first sample becomes the full base snapshot. Each later sample is
+ * diffed against the previous one (outside the lock) and only the delta is
+ * kept; when the history is full, the evicted oldest delta is folded into
+ * the base.
+ *
+ * @param snapshot The newly taken snapshot.
+ * @param alerts The growth alerts it raised.
+ */
+void Sampler::store_delta(SnapshotHandle snapshot, std::vector<GrowthAlert> alerts) {
+    // Only this thread writes latest_, so the relaxed load sees its own store.
+    SnapshotHandle previous = latest_.load(std::memory_order_relaxed);
+    std::optional<SnapshotDelta> delta;
+    if (previous) {
+        delta = compute_delta(*previous, *snapshot);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!delta || config_.max_snapshots == 1) {
+            base_ = *snapshot;
+        } else if (auto evicted = deltas_.push_back(*delta)) {
+            apply_delta(*base_, *evicted);
+        }
+        latest_.store(snapshot, std::memory_order_release);
+    }
+    notify(std::move(snapshot), std::move(delta), std::move(alerts));
+}
+
+/**
+ * @brief Hands a new sample to the dispatcher.
+ *
+ * @param snapshot The new snapshot.
+ * @param delta Its delta against the previous sample, if any.
+ * @param alerts The growth alerts it raised.
+ */
+void Sampler::notify(SnapshotHandle snapshot, std::optional<SnapshotDelta> delta,
+                     std::vector<GrowthAlert> alerts) {
+    SampleEvent event;
+    event.pid = config_.pid;
+    event.snapshot = std::move(snapshot);
+    if (delta) {
+        event.delta = std::make_shared<const SnapshotDelta>(std::move(*delta));
+    }
+    if (!alerts.empty()) {
+        event.alerts = std::make_shared<const std::vector<GrowthAlert>>(std::move(alerts));
+    }
+    dispatcher_.post(std::move(event));
+}
+
+/**
+ * @brief Invokes the registered callbacks for one sample.
+ *
+ * Runs on a dispatcher thread (or the sampling thread when dispatch is
+ * synchronous). Alert callbacks run first, then delta callbacks, then
+ * snapshot callbacks. The callback lists are held under a shared lock, so
+ * several dispatcher threads can deliver at once; exceptions are logged
+ * and swallowed.
+ *
+ * @param event The sample to deliver.
+ */
+void Sampler::deliver(const SampleEvent& event) {
+    std::shared_lock lock(callbacks_mutex_);
+
+    if (event.alerts) {
+        const auto& rules = config_.growth->rules;
+        for (const auto& alert : *event.alerts) {
+            for (const auto& cb : alert_callbacks_) {
                 try {
-                    cb(snapshot);
+                    cb(alert, rules[alert.rule]);
                 } catch (const std::exception& e) {
-                    std::cerr << "[memc] Snapshot callback threw: " << e.what() << std::endl;
+                    std::cerr << "[memc] Alert callback threw: " << e.what() << std::endl;
                 }
             }
         }
+    }
+
+    if (event.delta) {
+        for (const auto& cb : delta_callbacks_) {
+            try {
+                cb(*event.delta);
+            } catch (const std::exception& e) {
+                std::cerr << "[memc] Delta callback threw: " << e.what() << std::endl;
+            }
+        }
+    }
 
-        auto deadline = std::chrono::steady_clock::now() + config_.interval;
-        while (running_.load() && std::chrono::steady_clock::now() < deadline) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    for (const auto& cb : callbacks_) {
+        try {
+            cb(*event.snapshot);
+        } catch (const std::exception& e) {
+            std::cerr << "[memc] Snapshot callback threw: " << e.what() << std::endl;
         }
     }
 }
@@ -145,23 +423,29 @@ void Sampler::sample_loop() {
 /**
  * @brief Takes a single process memory snapshot.
  *
- * Reads /proc/<pid>/maps and optionally enriches with smaps data.
- * The snapshot is timestamped with the current system time.
+ * Reads /proc/<pid>/smaps in a single pass when smaps is enabled, and
+ * /proc/<pid>/maps otherwise (or when smaps is unreadable). The files stay
+ * open in proc_ between samples; a failed open of the process is retried
+ * on the next sample. The snapshot is timestamped with the current system
+ * time.
  *
- * @return ProcessSnapshot The captured snapshot.
+ * The snapshot comes from pool_, reserved for the previous sample's region
+ * count. Once a bounded history is full, every sample reuses the snapshot
+ * (and region storage) that the previous push evicted.
+ *
+ * @return std::shared_ptr<ProcessSnapshot> The captured snapshot.
  */
-ProcessSnapshot Sampler::take_snapshot() {
-    ProcessSnapshot snapshot;
-    snapshot.pid = config_.pid;
-
-    auto now = std::chrono::system_clock::now();
-    snapshot.timestamp_ms =
-        std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
+std::shared_ptr<ProcessSnapshot> Sampler::take_snapshot() {
+    SnapshotHandle previous = latest_.load(std::memory_order_relaxed);
+    auto snapshot = pool_.acquire(previous ? previous->regions.size() : 0);
+    snapshot->pid = config_.pid;
+    snapshot->timestamp_ms = detail::now_ms();
 
-    if (config_.use_smaps) {
-        SmapsParser::enrich(config_.pid, snapshot.regions);
+    if (!proc_.is_open()) {
+        proc_.open(config_.pid);
     }
-
+    detail::read_regions(proc_, config_.use_smaps, config_.numa, config_.fields, read_buffer_,
+                         snapshot->regions);
     return snapshot;
 }
 
@@ -0,0 +1,261 @@
+#include "self_stats_internal.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memc/string_pool.h>
+#include <mutex>
+
+namespace memc {
+
+namespace {
+
+constexpr size_t kBuckets = LatencyHistogram::kBuckets;
+
+/**
+ * @brief Plain copy of the counters of one or more threads.
+ */
+struct Totals {
+    uint64_t counters[detail::kStatCounterCount] = {};
+    uint64_t phase_ns[kStatPhaseCount] = {};
+    uint64_t buckets[kStatPhaseCount][kBuckets] = {};
+};
+
+/**
+ * @brief The counters of one thread, linked into the live-thread list.
+ *
+ * Only the owning thread writes them, with relaxed load + store pairs that
+ * compile to plain adds; readers on other threads load them relaxed. The
+ * list itself only changes when a thread records for the first time and
+ * when it exits.
+ */
+struct ThreadStats {
+    std::atomic<uint64_t> counters[detail::kStatCounterCount] = {};
+    std::atomic<uint64_t> phase_ns[kStatPhaseCount] = {};
+    std::atomic<uint64_t> buckets[kStatPhaseCount][kBuckets] = {};
+    ThreadStats* prev = nullptr;
+    ThreadStats* next = nullptr;
+
+    ThreadStats();
+    ~ThreadStats();
+
+    void add_to(Totals& t) const;
+};
+
+// Constant-initialized so that allocations counted before main(), or while
+// other statics are being set up, find them ready.
+constinit std::mutex g_mutex;
+constinit ThreadStats* g_threads = nullptr;
+constinit Totals g_retired{};
+constinit Totals g_baseline{};
+constinit std::atomic<bool> g_allocations_tracked{false};
+
+thread_local bool t_retired = false;
+thread_local ThreadStats t_stats;
+
+/**
+ * @brief Adds @p n to a counter only the calling thread writes.
+ */
+void bump(std::atomic<uint64_t>& counter, uint64_t n) noexcept {
+    counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Returns the calling thread's counters, or nullptr once the thread
+ * is exiting and they have been folded into g_retired.
+ */
+ThreadStats* local_stats() noexcept {
+    if (t_retired)
+        return nullptr;
+    return &t_stats;
+}
+
+/**
+ * @brief Links the calling thread's counters into the live list.
+ */
+ThreadStats::ThreadStats() {
+    std::lock_guard lock(g_mutex);
+    next = g_threads;
+    if (g_threads)
+        g_threads->prev = this;
+    g_threads = this;
+}
+
+/**
+ * @brief Folds the exiting thread's counters into g_retired and unlinks them.
+ */
+ThreadStats::~ThreadStats() {
+    std::lock_guard lock(g_mutex);
+    add_to(g_retired);
+    if (prev)
+        prev->next = next;
+    else
+        g_threads = next;
+    if (next)
+        next->prev = prev;
+    t_retired = true;
+}
+
+/**
+ * @brief Adds this thread's counters to @p t.
+ */
+void ThreadStats::add_to(Totals& t) const {
+    for (size_t i = 0; i < detail::kStatCounterCount; ++i)
+        t.counters[i] += counters[i].load(std::memory_order_relaxed);
+    for (size_t p = 0; p < kStatPhaseCount; ++p) {
+        t.phase_ns[p] += phase_ns[p].load(std::memory_order_relaxed);
+        for (size_t b = 0; b < kBuckets; ++b)
+            t.buckets[p][b] += buckets[p][b].load(std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Sums the counters of every exited and live thread.
+ *
+ * The caller must hold g_mutex.
+ */
+Totals collect_totals() {
+    Totals t = g_retired;
+    for (const ThreadStats* s = g_threads; s; s = s->next)
+        s->add_to(t);
+    return t;
+}
+
+} // namespace
+
+/**
+ * @brief Returns the upper bound of the bucket holding the @p p-th
+ * percentile.
+ *
+ * @param p Percentile, 0 < p <= 100.
+ * @return uint64_t 2^b for bucket b, or 0 without samples.
+ */
+uint64_t LatencyHistogram::percentile_ns(double p) const {
+    if (count == 0)
+        return 0;
+    auto rank = static_cast<uint64_t>(std::ceil(static_cast<double>(count) * p / 100.0));
+    rank = std::clamp<uint64_t>(rank, 1, count);
+    uint64_t seen = 0;
+    for (size_t b = 0; b < kBuckets; ++b) {
+        seen += buckets[b];
+        if (seen >= rank)
+            return b == 0 ? 0 : uint64_t{1} << b;
+    }
+    return uint64_t{1} << (kBuckets - 1);
+}
+
+/**
+ * @brief Returns the process-wide self statistics.
+ */
+SelfStats self_stats() {
+    Totals t;
+    {
+        std::lock_guard lock(g_mutex);
+        t = collect_totals();
+        for (size_t i = 0; i < detail::kStatCounterCount; ++i)
+            t.counters[i] -= g_baseline.counters[i];
+        for (size_t p = 0; p < kStatPhaseCount; ++p) {
+            t.phase_ns[p] -= g_baseline.phase_ns[p];
+            for (size_t b = 0; b < kBuckets; ++b)
+                t.buckets[p][b] -= g_baseline.buckets[p][b];
+        }
+    }
+
+    auto counter = [&](detail::StatCounter c) { return t.counters[static_cast<size_t>(c)]; };
+    SelfStats s;
+    s.snapshots = counter(detail::StatCounter::SNAPSHOTS);
+    s.regions = counter(detail::StatCounter::REGIONS);
+    s.files_read = counter(detail::StatCounter::FILES_READ);
+    s.bytes_read = counter(detail::StatCounter::BYTES_READ);
+    s.syscalls = counter(detail::StatCounter::SYSCALLS);
+    s.allocations = counter(detail::StatCounter::ALLOCATIONS);
+    s.allocations_tracked = g_allocations_tracked.load(std::memory_order_relaxed);
+    const StringPool& pool = StringPool::global();
+    s.interned_strings = pool.size();
+    s.interned_bytes = pool.bytes();
+    s.interned_dropped = pool.dropped();
+    for (size_t p = 0; p < kStatPhaseCount; ++p) {
+        LatencyHistogram& h = s.phases[p];
+        h.total_ns = t.phase_ns[p];
+        for (size_t b = 0; b < kBuckets; ++b) {
+            h.buckets[b] = t.buckets[p][b];
+            h.count += t.buckets[p][b];
+        }
+    }
+    return s;
+}
+
+/**
+ * @brief Makes later self_stats() calls count from now.
+ *
+ * Threads keep recording into their own counters; the current totals are
+ * remembered as a baseline and subtracted from later reads.
+ */
+void reset_self_stats() {
+    std::lock_guard lock(g_mutex);
+    g_baseline = collect_totals();
+}
+
+namespace detail {
+
+/**
+ * @brief Adds @p n to a counter of the calling thread.
+ */
+void stat_add(StatCounter counter, uint64_t n) noexcept {
+    if (ThreadStats* s = local_stats())
+        bump(s->counters[static_cast<size_t>(counter)], n);
+}
+
+/**
+ * @brief Records one call of @p phase lasting @p ns on the calling thread.
+ */
+void stat_record(StatPhase phase, uint64_t ns) noexcept {
+    ThreadStats* s = local_stats();
+    if (!s)
+        return;
+    auto p = static_cast<size_t>(phase);
+    bump(s->phase_ns[p], ns);
+    bump(s->buckets[p][std::min<size_t>(std::bit_width(ns), kBuckets - 1)], 1);
+}
+
+/**
+ * @brief Counts one allocation on the calling thread.
+ */
+void count_allocation() noexcept {
+    if (!g_allocations_tracked.load(std::memory_order_relaxed))
+        g_allocations_tracked.store(true, std::memory_order_relaxed);
+    stat_add(StatCounter::ALLOCATIONS, 1);
+}
+
+/**
+ * @brief Counts one allocation and allocates @p size bytes aligned to
+ * @p alignment (0 for the default alignment).
+ *
+ * Over-aligned requests go to aligned_alloc, with the size rounded up to a
+ * multiple of the alignment as it requires; both are released by free.
+ */
+void* allocate_counted(std::size_t size, std::size_t alignment) noexcept {
+    count_allocation();
+    if (size == 0)
+        size = 1;
+    if (alignment <= alignof(std::max_align_t))
+        return std::malloc(size);
+    if (size > SIZE_MAX - alignment)
+        return nullptr;
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+/**
+ * @brief Frees memory returned by allocate_counted().
+ */
+void deallocate_counted(void* p) noexcept {
+    std::free(p);
+}
+
+} // namespace detail
+
+} // namespace memc
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memc/self_stats.h>
+
+namespace memc::detail {
+
+/**
+ * @brief The work counters behind SelfStats.
+ */
+enum class StatCounter : uint8_t { SNAPSHOTS, REGIONS, FILES_READ, BYTES_READ, SYSCALLS, ALLOCATIONS };
+
+/// Number of StatCounter values.
+inline constexpr size_t kStatCounterCount = static_cast<size_t>(StatCounter::ALLOCATIONS) + 1;
+
+/**
+ * @brief Adds @p n to a counter of the calling thread.
+ */
+void stat_add(StatCounter counter, uint64_t n) noexcept;
+
+/**
+ * @brief Records one call of @p phase lasting @p ns on the calling thread.
+ */
+void stat_record(StatPhase phase, uint64_t ns) noexcept;
+
+/**
+ * @brief Counts one collected snapshot (or summary) of @p regions regions.
+ */
+inline void count_snapshot(size_t regions) noexcept {
+    stat_add(StatCounter::SNAPSHOTS, 1);
+    stat_add(StatCounter::REGIONS, regions);
+}
+
+/**
+ * @brief Records the lifetime of the enclosing scope as one @p phase call.
+ *
+ * Usage:
+ *   PhaseTimer timer(StatPhase::MAPS_PARSE);
+ *   // ... parse ...
+ */
+class PhaseTimer {
+public:
+    explicit PhaseTimer(StatPhase phase) noexcept
+        : phase_(phase)
+        , start_(std::chrono::steady_clock::now()) {}
+
+    ~PhaseTimer() {
+        auto elapsed = std::chrono::steady_clock::now() - start_;
+        stat_record(phase_,
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+private:
+    StatPhase phase_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace memc::detail
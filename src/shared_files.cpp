@@ -0,0 +1,171 @@
+#include <algorithm>
+#include <bit>
+#include <memc/pagemap.h>
+#include <memc/shared_files.h>
+#include <tuple>
+#include <unistd.h>
+
+namespace memc {
+
+/**
+ * @brief Creates an empty table.
+ */
+SharedFileTable::SharedFileTable()
+    : page_size_(static_cast<uint64_t>(::sysconf(_SC_PAGESIZE))) {}
+
+/**
+ * @brief Adds the file mappings of one process.
+ *
+ * @param snapshot The process snapshot.
+ */
+void SharedFileTable::add(const ProcessSnapshot& snapshot) {
+    for (const auto& r : snapshot.regions) {
+        if (r.inode != 0) {
+            add_region(r, snapshot.pid);
+        }
+    }
+}
+
+/**
+ * @brief Adds the file mappings of one process and marks their resident
+ * pages from its pagemap.
+ *
+ * The resident pages of each mapping are shifted by the mapping's file
+ * offset into the file's bitmap, so a page mapped by several processes (or
+ * twice by one) is set once.
+ *
+ * @param snapshot The process snapshot.
+ * @param pages A scanner for the same process.
+ * @return true on success; false if pagemap could not be read.
+ */
+bool SharedFileTable::add(const ProcessSnapshot& snapshot, PagemapScanner& pages) {
+    pages_counted_ = true;
+    bool ok = true;
+    for (const auto& r : snapshot.regions) {
+        if (r.inode == 0)
+            continue;
+        Entry& entry = add_region(r, snapshot.pid);
+        if (!ok || !pages.file_pages(r, bits_)) {
+            ok = false;
+            continue;
+        }
+
+        const uint64_t first = r.offset / page_size_;
+        const uint64_t count = r.size_bytes() / page_size_;
+        const size_t words = static_cast<size_t>((first + count + 63) / 64);
+        if (entry.resident.size() < words) {
+            entry.resident.resize(words, 0);
+        }
+        for (size_t w = 0; w < bits_.size(); ++w) {
+            for (uint64_t word = bits_[w]; word != 0; word &= word - 1) {
+                uint64_t page = first + w * 64 + static_cast<uint64_t>(std::countr_zero(word));
+                entry.resident[page / 64] |= uint64_t{1} << (page % 64);
+            }
+        }
+    }
+    return ok;
+}
+
+/**
+ * @brief Returns every file, highest pss_kb first.
+ *
+ * mapped_kb and resident_kb are computed here from the ranges and bitmaps.
+ */
+std::vector<SharedFile> SharedFileTable::files() const {
+    std::vector<SharedFile> out;
+    out.reserve(entries_.size());
+    for (const Entry& entry : entries_) {
+        SharedFile& file = out.emplace_back(entry.file);
+        uint64_t mapped = 0;
+        for (const auto& [first, last] : entry.ranges) {
+            mapped += last - first;
+        }
+        uint64_t resident = 0;
+        for (uint64_t word : entry.resident) {
+            resident += static_cast<uint64_t>(std::popcount(word));
+        }
+        file.mapped_kb = mapped * page_size_ / 1024;
+        file.resident_kb = resident * page_size_ / 1024;
+    }
+
+    std::sort(out.begin(), out.end(), [](const SharedFile& a, const SharedFile& b) {
+        return std::tuple(b.pss_kb, b.rss_kb, a.device.packed(), a.inode) <
+               std::tuple(a.pss_kb, a.rss_kb, b.device.packed(), b.inode);
+    });
+    return out;
+}
+
+/**
+ * @brief Forgets every file.
+ */
+void SharedFileTable::clear() {
+    index_.clear();
+    entries_.clear();
+    pages_counted_ = false;
+}
+
+/**
+ * @brief Folds one file mapping into the entry of its file, creating the
+ * entry on first sight.
+ *
+ * @param region The mapping.
+ * @param pid The process it belongs to.
+ * @return Entry& The file's entry.
+ */
+SharedFileTable::Entry& SharedFileTable::add_region(const MemoryRegion& region, pid_t pid) {
+    Key key{region.device.packed(), region.inode};
+    auto [it, inserted] = index_.try_emplace(key, static_cast<uint32_t>(entries_.size()));
+    if (inserted) {
+        Entry& entry = entries_.emplace_back();
+        entry.file.device = region.device;
+        entry.file.inode = region.inode;
+        entry.file.pathname = region.pathname;
+    }
+
+    Entry& entry = entries_[it->second];
+    SharedFile& file = entry.file;
+    if (entry.last_pid != pid) {
+        entry.last_pid = pid;
+        file.processes++;
+    }
+    file.mappings++;
+    file.rss_kb += region.rss_kb;
+    file.pss_kb += region.pss_kb;
+    uint64_t private_kb = std::min(region.private_clean_kb + region.private_dirty_kb,
+                                   region.pss_kb);
+    file.private_kb += private_kb;
+    file.shared_kb += region.pss_kb - private_kb;
+
+    const uint64_t first = region.offset / page_size_;
+    add_range(entry, first, first + region.size_bytes() / page_size_);
+    return entry;
+}
+
+/**
+ * @brief Merges [first, last) into the entry's sorted, disjoint ranges.
+ *
+ * Overlapping and adjacent ranges are joined, so a file keeps one range per
+ * separately mapped part of it.
+ */
+void SharedFileTable::add_range(Entry& entry, uint64_t first, uint64_t last) {
+    if (first >= last)
+        return;
+    auto& ranges = entry.ranges;
+    // First range that ends at or after first: the only candidates to join.
+    auto begin = std::lower_bound(ranges.begin(), ranges.end(), first,
+                                  [](const auto& range, uint64_t v) { return range.second < v; });
+    auto end = begin;
+    while (end != ranges.end() && end->first <= last) {
+        first = std::min(first, end->first);
+        last = std::max(last, end->second);
+        ++end;
+    }
+    if (begin == end) {
+        ranges.insert(begin, {first, last});
+    } else {
+        *begin = {first, last};
+        ranges.erase(begin + 1, end);
+    }
+}
+
+} // namespace memc
@@ -1,40 +1,166 @@
+#include "line_cursor.h"
+#include "self_stats_internal.h"
 
-#include <cstdio>
-#include <fstream>
+#include <algorithm>
+#include <cstring>
 #include <memc/maps_parser.h>
+#include <memc/proc_handle.h>
+#include <memc/process_utils.h>
 #include <memc/smaps_parser.h>
-#include <sstream>
 #include <string>
-#include <unordered_map>
 
 namespace memc {
 
+namespace {
+
+/**
+ * @brief Returns true if @p line is a VMA header ("<hex>-<hex> ...").
+ *
+ * Detail keys such as "AnonHugePages" or "FilePmdMapped" also start with a
+ * hex digit, so the range separator is what tells the two apart.
+ */
+inline bool is_header_line(std::string_view line) {
+    size_t i = 0;
+    while (i < line.size() && detail::kHexDigits[static_cast<unsigned char>(line[i])] >= 0)
+        ++i;
+    return i > 0 && i < line.size() && line[i] == '-';
+}
+
+/**
+ * @brief Scans the "<n> kB" value that follows the key of a detail line.
+ */
+inline uint64_t scan_detail_value(std::string_view line, size_t key_len) {
+    detail::LineCursor cur{line.substr(key_len + 1)};
+    cur.skip_blanks();
+    uint64_t value = 0;
+    cur.scan_decimal(value);
+    return value;
+}
+
+/**
+ * @brief Returns the start of the line after the next "VmFlags:" line, or
+ * nullptr if there is none before @p end.
+ *
+ * VmFlags is the last line of every smaps block, and the only key starting
+ * with 'V' (values are numbers, and headers start with a hex digit), so one
+ * memchr per candidate finds the end of the block.
+ *
+ * @param begin Start of the content, for the line-start check.
+ * @param p Start of a line inside the block.
+ * @param end End of the content.
+ */
+const char* skip_block(const char* begin, const char* p, const char* end) {
+    constexpr std::string_view kKey = "VmFlags:";
+    while ((p = static_cast<const char*>(std::memchr(p, 'V', end - p)))) {
+        if ((p == begin || p[-1] == '\n') && static_cast<size_t>(end - p) >= kKey.size() &&
+            std::memcmp(p, kKey.data(), kKey.size()) == 0) {
+            const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+            return nl ? nl + 1 : end;
+        }
+        ++p;
+    }
+    return nullptr;
+}
+
+/// Names accepted by SmapsFields::parse(), in bit order.
+constexpr std::string_view kFieldNames[] = {
+    "rss",  "pss",      "shared_clean", "shared_dirty", "private_clean", "private_dirty",
+    "swap", "swap_pss", "locked",       "anon_huge",    "shmem_pmd",     "file_pmd",
+    "thp_eligible",
+};
+
+} // namespace
+
+/**
+ * @brief Parses a comma-separated list of field names ("rss,pss,swap").
+ *
+ * Names may repeat; "all" selects every field.
+ *
+ * @param list The names.
+ * @return std::optional<SmapsFields> The set, or std::nullopt if the list is
+ * empty or names an unknown field.
+ */
+std::optional<SmapsFields> SmapsFields::parse(std::string_view list) {
+    uint16_t bits = 0;
+    while (true) {
+        size_t comma = list.find(',');
+        std::string_view name = list.substr(0, comma);
+        if (name == "all") {
+            bits = kAll;
+        } else {
+            auto it = std::find(std::begin(kFieldNames), std::end(kFieldNames), name);
+            if (it == std::end(kFieldNames)) {
+                return std::nullopt;
+            }
+            bits |= static_cast<uint16_t>(1u << (it - std::begin(kFieldNames)));
+        }
+        if (comma == std::string_view::npos) {
+            break;
+        }
+        list.remove_prefix(comma + 1);
+    }
+    return SmapsFields(bits);
+}
+
 /**
  * @brief Parses /proc/<pid>/smaps for the given PID.
  *
- * Opens and reads the entire smaps file, then delegates to
- * parse_from_string for structured parsing.
+ * Convenience wrapper around the buffer-reusing overload that owns its
+ * own scratch storage.
  *
  * @param pid The process ID to parse.
  * @return std::optional<std::vector<MemoryRegion>> A vector of enriched
  * MemoryRegion objects, or std::nullopt if the file could not be opened.
  */
 std::optional<std::vector<MemoryRegion>> SmapsParser::parse(pid_t pid) {
-    std::string path = "/proc/" + std::to_string(pid) + "/smaps";
-    std::ifstream ifs(path);
-    if (!ifs.is_open()) {
+    std::string buffer;
+    std::vector<MemoryRegion> regions;
+    if (!parse(pid, buffer, regions)) {
         return std::nullopt;
     }
+    return regions;
+}
 
-    std::string content((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
-    return parse_from_string(content);
+/**
+ * @brief Parses /proc/<pid>/smaps using caller-owned storage.
+ *
+ * Reads the whole file with pread(2) into @p buffer, then parses it in a
+ * single streaming pass.
+ *
+ * @param pid The process ID to parse.
+ * @param buffer Scratch buffer receiving the raw file contents.
+ * @param regions Output vector. It is cleared before parsing.
+ * @return true on success, false if the file could not be read.
+ */
+bool SmapsParser::parse(pid_t pid, std::string& buffer, std::vector<MemoryRegion>& regions) {
+    regions.clear();
+    if (!read_proc_file(pid, "smaps", buffer)) {
+        return false;
+    }
+    parse_from_view(buffer, regions);
+    return true;
 }
 
 /**
- * @brief Parses smaps data from a raw string.
+ * @brief Parses the smaps file of an open ProcHandle.
  *
- * Iterates over lines: header lines (starting with a hex digit) begin
- * a new region, and subsequent detail lines update that region's fields.
+ * @param proc The process to read.
+ * @param buffer Scratch buffer receiving the raw file contents.
+ * @param regions Output vector. It is cleared before parsing.
+ * @return true on success, false if the file could not be read.
+ */
+bool SmapsParser::parse(ProcHandle& proc, std::string& buffer,
+                        std::vector<MemoryRegion>& regions) {
+    regions.clear();
+    if (!proc.read("smaps", buffer)) {
+        return false;
+    }
+    parse_from_view(buffer, regions);
+    return true;
+}
+
+/**
+ * @brief Parses smaps data from a raw string.
  *
  * @param content The raw smaps content.
  * @return std::vector<MemoryRegion> A vector of parsed MemoryRegion objects
@@ -42,36 +168,78 @@ std::optional<std::vector<MemoryRegion>> SmapsParser::parse(pid_t pid) {
  */
 std::vector<MemoryRegion> SmapsParser::parse_from_string(const std::string& content) {
     std::vector<MemoryRegion> regions;
-    std::istringstream stream(content);
-    std::string line;
+    parse_from_view(content, regions);
+    return regions;
+}
 
-    std::optional<size_t> current_idx;
+/**
+ * @brief Parses smaps data from a view over raw smaps content.
+ *
+ * Iterates over lines: header lines begin a new region and are parsed in
+ * place by the maps line scanner, and subsequent detail lines update that
+ * region's fields. Detail lines before the first valid header are ignored.
+ *
+ * With a partial field set, the selected keys still pending for the current
+ * region are counted down. Once they have all been seen, the rest of the
+ * block is jumped over to just past its VmFlags line, without splitting,
+ * dispatching or scanning the lines in between. Kernels too old to print
+ * VmFlags (before 3.8) have their remaining lines stepped over one memchr
+ * at a time instead.
+ *
+ * @param content The raw smaps content.
+ * @param regions Output vector the parsed regions are appended to.
+ * @param fields The detail fields to parse.
+ */
+void SmapsParser::parse_from_view(std::string_view content, std::vector<MemoryRegion>& regions,
+                                  SmapsFields fields) {
+    detail::PhaseTimer timer(StatPhase::SMAPS_PARSE);
+    MemoryRegion* current = nullptr;
+    const unsigned wanted = fields.all() ? ~0u : fields.count();
+    unsigned pending = 0;
+    bool has_vm_flags = true;
+
+    const char* begin = content.data();
+    const char* end = begin + content.size();
+    const char* p = begin;
+    while (p < end) {
+        if (current && pending == 0 && has_vm_flags) {
+            current = nullptr;
+            if (const char* next = skip_block(begin, p, end)) {
+                p = next;
+                continue;
+            }
+            has_vm_flags = false;
+        }
 
-    while (std::getline(stream, line)) {
+        const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        std::string_view line(p, (nl ? nl : end) - p);
+        p = nl ? nl + 1 : end;
         if (line.empty())
             continue;
 
-        if (!line.empty() && std::isxdigit(line[0])) {
-            auto parsed = MapsParser::parse_from_string(line + "\n");
-            if (!parsed.empty()) {
-                regions.push_back(std::move(parsed[0]));
-                current_idx = regions.size() - 1;
-                regions[*current_idx].has_smaps_data = true;
+        if (is_header_line(line)) {
+            MemoryRegion& region = regions.emplace_back();
+            if (MapsParser::parse_line(line, region)) {
+                region.has_smaps_data = true;
+                current = &region;
+                pending = wanted;
+            } else {
+                regions.pop_back();
+                current = nullptr;
             }
-        } else if (current_idx) {
-            apply_detail_line(line, regions[*current_idx]);
+        } else if (current && pending != 0 && apply_detail_line(line, *current, fields)) {
+            --pending;
         }
     }
-
-    return regions;
 }
 
 /**
  * @brief Enriches existing MemoryRegion objects with smaps data.
  *
- * Parses /proc/<pid>/smaps, builds a lookup table by start address,
- * and copies smaps fields (RSS, PSS, swap, etc.) into matching regions.
- * Regions not found in smaps are left unchanged.
+ * Parses /proc/<pid>/smaps once and copies smaps fields (RSS, PSS, swap,
+ * etc.) into regions with a matching start address. smaps is emitted in
+ * address order, so matches are found by binary search. Regions not found
+ * in smaps are left unchanged.
  *
  * @param pid The process ID to read smaps from.
  * @param regions The vector of MemoryRegion objects to enrich.
@@ -83,22 +251,26 @@ bool SmapsParser::enrich(pid_t pid, std::vector<MemoryRegion>& regions) {
         return false;
     }
 
-    std::unordered_map<uint64_t, size_t> smaps_lookup;
-    for (size_t i = 0; i < smaps_result->size(); ++i) {
-        smaps_lookup[(*smaps_result)[i].start_addr] = i;
-    }
-
+    detail::PhaseTimer timer(StatPhase::ENRICH);
+    const auto& smaps = *smaps_result;
     for (auto& region : regions) {
-        auto it = smaps_lookup.find(region.start_addr);
-        if (it != smaps_lookup.end()) {
-            const auto& sr = (*smaps_result)[it->second];
-            region.rss_kb = sr.rss_kb;
-            region.pss_kb = sr.pss_kb;
-            region.shared_clean_kb = sr.shared_clean_kb;
-            region.shared_dirty_kb = sr.shared_dirty_kb;
-            region.private_clean_kb = sr.private_clean_kb;
-            region.private_dirty_kb = sr.private_dirty_kb;
-            region.swap_kb = sr.swap_kb;
+        auto it = std::lower_bound(
+            smaps.begin(), smaps.end(), region.start_addr,
+            [](const MemoryRegion& r, uint64_t addr) { return r.start_addr < addr; });
+        if (it != smaps.end() && it->start_addr == region.start_addr) {
+            region.rss_kb = it->rss_kb;
+            region.pss_kb = it->pss_kb;
+            region.shared_clean_kb = it->shared_clean_kb;
+            region.shared_dirty_kb = it->shared_dirty_kb;
+            region.private_clean_kb = it->private_clean_kb;
+            region.private_dirty_kb = it->private_dirty_kb;
+            region.swap_kb = it->swap_kb;
+            region.swap_pss_kb = it->swap_pss_kb;
+            region.locked_kb = it->locked_kb;
+            region.anon_huge_kb = it->anon_huge_kb;
+            region.shmem_pmd_kb = it->shmem_pmd_kb;
+            region.file_pmd_kb = it->file_pmd_kb;
+            region.thp_eligible = it->thp_eligible;
             region.has_smaps_data = true;
         }
     }
@@ -109,40 +281,232 @@ bool SmapsParser::enrich(pid_t pid, std::vector<MemoryRegion>& regions) {
 /**
  * @brief Parses a single detail line from smaps and updates the MemoryRegion.
  *
- * Splits the line on ':', extracts the numeric value, and updates the
- * corresponding field (Size, Rss, Pss, Shared_Clean, etc.) on the region.
+ * Locates the ':' separator and dispatches on the key length first, so each
+ * line costs at most one short memcmp before the value is scanned. Unknown
+ * and unselected keys are skipped without reading their value. Size is not
+ * a selectable field: the header already gives it, and the line is only
+ * stored when every field is selected.
  *
  * @param line The detail line (e.g., "Rss:           1024 kB").
  * @param region The MemoryRegion to update.
+ * @param fields The fields to store.
+ * @return true if the line held one of the selected fields.
+ */
+bool SmapsParser::apply_detail_line(std::string_view line, MemoryRegion& region,
+                                    SmapsFields fields) {
+    const void* colon = std::memchr(line.data(), ':', line.size());
+    if (!colon)
+        return false;
+
+    size_t key_len = static_cast<const char*>(colon) - line.data();
+    const char* key = line.data();
+    uint64_t* field = nullptr;
+    uint16_t bit = 0;
+
+    switch (key_len) {
+    case 3:
+        if (std::memcmp(key, "Rss", 3) == 0) {
+            field = &region.rss_kb;
+            bit = SmapsFields::kRss;
+        } else if (std::memcmp(key, "Pss", 3) == 0) {
+            field = &region.pss_kb;
+            bit = SmapsFields::kPss;
+        }
+        break;
+    case 4:
+        if (std::memcmp(key, "Size", 4) == 0) {
+            field = &region.size_kb;
+        } else if (std::memcmp(key, "Swap", 4) == 0) {
+            field = &region.swap_kb;
+            bit = SmapsFields::kSwap;
+        }
+        break;
+    case 6:
+        if (std::memcmp(key, "Locked", 6) == 0) {
+            field = &region.locked_kb;
+            bit = SmapsFields::kLocked;
+        }
+        break;
+    case 7:
+        if (std::memcmp(key, "SwapPss", 7) == 0) {
+            field = &region.swap_pss_kb;
+            bit = SmapsFields::kSwapPss;
+        }
+        break;
+    case 11:
+        if (std::memcmp(key, "THPeligible", 11) == 0) {
+            if (!fields.has(SmapsFields::kThpEligible))
+                return false;
+            region.thp_eligible = scan_detail_value(line, key_len) != 0;
+            return true;
+        }
+        break;
+    case 12:
+        if (std::memcmp(key, "Shared_Clean", 12) == 0) {
+            field = &region.shared_clean_kb;
+            bit = SmapsFields::kSharedClean;
+        } else if (std::memcmp(key, "Shared_Dirty", 12) == 0) {
+            field = &region.shared_dirty_kb;
+            bit = SmapsFields::kSharedDirty;
+        }
+        break;
+    case 13:
+        if (std::memcmp(key, "Private_Clean", 13) == 0) {
+            field = &region.private_clean_kb;
+            bit = SmapsFields::kPrivateClean;
+        } else if (std::memcmp(key, "Private_Dirty", 13) == 0) {
+            field = &region.private_dirty_kb;
+            bit = SmapsFields::kPrivateDirty;
+        } else if (std::memcmp(key, "AnonHugePages", 13) == 0) {
+            field = &region.anon_huge_kb;
+            bit = SmapsFields::kAnonHuge;
+        } else if (std::memcmp(key, "FilePmdMapped", 13) == 0) {
+            field = &region.file_pmd_kb;
+            bit = SmapsFields::kFilePmd;
+        }
+        break;
+    case 14:
+        if (std::memcmp(key, "ShmemPmdMapped", 14) == 0) {
+            field = &region.shmem_pmd_kb;
+            bit = SmapsFields::kShmemPmd;
+        }
+        break;
+    default:
+        break;
+    }
+
+    if (!field || (bit != 0 ? !fields.has(bit) : !fields.all()))
+        return false;
+
+    *field = scan_detail_value(line, key_len);
+    return bit != 0;
+}
+
+/**
+ * @brief Parses /proc/<pid>/smaps_rollup into per-process totals.
+ *
+ * @param pid The process ID to parse.
+ * @param buffer Scratch buffer receiving the raw file contents.
+ * @param summary The summary to fill. Only the memory totals are written.
+ * @return true on success, false if the file could not be read.
  */
-void SmapsParser::apply_detail_line(const std::string& line, MemoryRegion& region) {
-    auto colon_pos = line.find(':');
-    if (colon_pos == std::string::npos)
+bool SmapsParser::parse_rollup(pid_t pid, std::string& buffer, ProcessSummary& summary) {
+    if (!read_proc_file(pid, "smaps_rollup", buffer)) {
+        return false;
+    }
+    parse_rollup_from_view(buffer, summary);
+    return true;
+}
+
+/**
+ * @brief Parses the smaps_rollup file of an open ProcHandle.
+ *
+ * @param proc The process to read.
+ * @param buffer Scratch buffer receiving the raw file contents.
+ * @param summary The summary to fill. Only the memory totals are written.
+ * @return true on success, false if the file could not be read.
+ */
+bool SmapsParser::parse_rollup(ProcHandle& proc, std::string& buffer, ProcessSummary& summary) {
+    if (!proc.read("smaps_rollup", buffer)) {
+        return false;
+    }
+    parse_rollup_from_view(buffer, summary);
+    return true;
+}
+
+/**
+ * @brief Parses smaps_rollup content from a raw view.
+ *
+ * The leading "[rollup]" header line carries no totals and is skipped.
+ *
+ * @param content The raw smaps_rollup content.
+ * @param summary The summary to fill. Only the memory totals are written.
+ */
+void SmapsParser::parse_rollup_from_view(std::string_view content, ProcessSummary& summary) {
+    detail::PhaseTimer timer(StatPhase::SMAPS_PARSE);
+    detail::for_each_line(content, [&](std::string_view line) {
+        if (!line.empty() && !is_header_line(line)) {
+            apply_rollup_line(line, summary);
+        }
+    });
+}
+
+/**
+ * @brief Parses a single smaps_rollup line and updates the summary.
+ *
+ * Uses the same length-first key dispatch as apply_detail_line.
+ *
+ * @param line The detail line (e.g., "Pss_Anon: 512 kB").
+ * @param summary The ProcessSummary to update.
+ */
+void SmapsParser::apply_rollup_line(std::string_view line, ProcessSummary& summary) {
+    const void* colon = std::memchr(line.data(), ':', line.size());
+    if (!colon)
         return;
 
-    std::string key = line.substr(0, colon_pos);
-    std::string value_part = line.substr(colon_pos + 1);
+    size_t key_len = static_cast<const char*>(colon) - line.data();
+    const char* key = line.data();
+    uint64_t* field = nullptr;
 
-    uint64_t value = 0;
-    std::sscanf(value_part.c_str(), " %lu", &value);
-
-    if (key == "Size") {
-        region.size_kb = value;
-    } else if (key == "Rss") {
-        region.rss_kb = value;
-    } else if (key == "Pss") {
-        region.pss_kb = value;
-    } else if (key == "Shared_Clean") {
-        region.shared_clean_kb = value;
-    } else if (key == "Shared_Dirty") {
-        region.shared_dirty_kb = value;
-    } else if (key == "Private_Clean") {
-        region.private_clean_kb = value;
-    } else if (key == "Private_Dirty") {
-        region.private_dirty_kb = value;
-    } else if (key == "Swap") {
-        region.swap_kb = value;
+    switch (key_len) {
+    case 3:
+        if (std::memcmp(key, "Rss", 3) == 0)
+            field = &summary.rss_kb;
+        else if (std::memcmp(key, "Pss", 3) == 0)
+            field = &summary.pss_kb;
+        break;
+    case 4:
+        if (std::memcmp(key, "Swap", 4) == 0)
+            field = &summary.swap_kb;
+        break;
+    case 6:
+        if (std::memcmp(key, "Locked", 6) == 0)
+            field = &summary.locked_kb;
+        break;
+    case 7:
+        if (std::memcmp(key, "SwapPss", 7) == 0)
+            field = &summary.swap_pss_kb;
+        break;
+    case 8:
+        if (std::memcmp(key, "Pss_Anon", 8) == 0)
+            field = &summary.pss_anon_kb;
+        else if (std::memcmp(key, "Pss_File", 8) == 0)
+            field = &summary.pss_file_kb;
+        break;
+    case 9:
+        if (std::memcmp(key, "Pss_Shmem", 9) == 0)
+            field = &summary.pss_shmem_kb;
+        else if (std::memcmp(key, "Anonymous", 9) == 0)
+            field = &summary.anonymous_kb;
+        break;
+    case 12:
+        if (std::memcmp(key, "Shared_Clean", 12) == 0)
+            field = &summary.shared_clean_kb;
+        else if (std::memcmp(key, "Shared_Dirty", 12) == 0)
+            field = &summary.shared_dirty_kb;
+        break;
+    case 13:
+        if (std::memcmp(key, "Private_Clean", 13) == 0)
+            field = &summary.private_clean_kb;
+        else if (std::memcmp(key, "Private_Dirty", 13) == 0)
+            field = &summary.private_dirty_kb;
+        else if (std::memcmp(key, "AnonHugePages", 13) == 0)
+            field = &summary.anon_huge_kb;
+        else if (std::memcmp(key, "FilePmdMapped", 13) == 0)
+            field = &summary.file_pmd_kb;
+        break;
+    case 14:
+        if (std::memcmp(key, "ShmemPmdMapped", 14) == 0)
+            field = &summary.shmem_pmd_kb;
+        break;
+    default:
+        break;
     }
+
+    if (!field)
+        return;
+
+    *field = scan_detail_value(line, key_len);
 }
 
 } // namespace memc
@@ -0,0 +1,185 @@
+#include "collect_internal.h"
+
+#include <memc/snapshot_pool.h>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace memc {
+
+/**
+ * @brief Free lists shared by the pool and every snapshot it handed out.
+ *
+ * Both lists are reserved up front, so returning an entry never allocates.
+ * Control blocks all have the same type and hence the same size, which is
+ * recorded on the first allocation; a request of any other size bypasses
+ * the list.
+ */
+struct SnapshotPool::State {
+    explicit State(size_t max_idle)
+        : max_idle(max_idle) {
+        snapshots.reserve(max_idle);
+        blocks.reserve(max_idle);
+    }
+
+    ~State() {
+        for (ProcessSnapshot* snapshot : snapshots) {
+            delete snapshot;
+        }
+        for (void* block : blocks) {
+            ::operator delete(block, block_size);
+        }
+    }
+
+    State(const State&) = delete;
+    State& operator=(const State&) = delete;
+
+    /**
+     * @brief Takes an idle snapshot, or returns nullptr if there is none.
+     */
+    ProcessSnapshot* pop_snapshot() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (snapshots.empty()) {
+            return nullptr;
+        }
+        ProcessSnapshot* snapshot = snapshots.back();
+        snapshots.pop_back();
+        return snapshot;
+    }
+
+    /**
+     * @brief Empties a released snapshot and keeps it, or frees it if the
+     * pool is full.
+     */
+    void push_snapshot(ProcessSnapshot* snapshot) {
+        snapshot->pid = 0;
+        snapshot->timestamp_ms = 0;
+        snapshot->regions.clear();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (snapshots.size() < max_idle) {
+                snapshots.push_back(snapshot);
+                return;
+            }
+        }
+        delete snapshot;
+    }
+
+    void* allocate(size_t bytes) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (block_size == 0) {
+                block_size = bytes;
+            }
+            if (bytes == block_size && !blocks.empty()) {
+                void* block = blocks.back();
+                blocks.pop_back();
+                return block;
+            }
+        }
+        return ::operator new(bytes);
+    }
+
+    void deallocate(void* block, size_t bytes) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (bytes == block_size && blocks.size() < max_idle) {
+                blocks.push_back(block);
+                return;
+            }
+        }
+        ::operator delete(block, bytes);
+    }
+
+    std::mutex mutex;
+    size_t max_idle;
+    size_t block_size = 0;
+    std::vector<ProcessSnapshot*> snapshots;
+    std::vector<void*> blocks;
+};
+
+/**
+ * @brief Shared-pointer deleter that hands a snapshot back to its pool.
+ */
+struct SnapshotPool::Recycler {
+    std::shared_ptr<State> state;
+
+    void operator()(ProcessSnapshot* snapshot) const {
+        state->push_snapshot(snapshot);
+    }
+};
+
+/**
+ * @brief Allocator for shared-pointer control blocks, backed by the pool's
+ * block list.
+ *
+ * Each copy keeps the pool state alive, so a control block can be returned
+ * after the pool itself is gone.
+ */
+template <typename T>
+struct SnapshotPool::BlockAllocator {
+    using value_type = T;
+
+    explicit BlockAllocator(std::shared_ptr<State> state)
+        : state(std::move(state)) {}
+
+    template <typename U>
+    BlockAllocator(const BlockAllocator<U>& other)
+        : state(other.state) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(state->allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* block, size_t n) {
+        state->deallocate(block, n * sizeof(T));
+    }
+
+    template <typename U>
+    bool operator==(const BlockAllocator<U>& other) const {
+        return state == other.state;
+    }
+
+    std::shared_ptr<State> state;
+};
+
+/**
+ * @brief Creates an empty pool.
+ *
+ * @param max_idle Most released snapshots kept for reuse.
+ */
+SnapshotPool::SnapshotPool(size_t max_idle)
+    : state_(std::make_shared<State>(max_idle)) {}
+
+/**
+ * @brief Destroys the pool. Snapshots still in use are freed when their
+ * last handle is released.
+ */
+SnapshotPool::~SnapshotPool() = default;
+
+/**
+ * @brief Returns an empty snapshot, recycled when one is idle.
+ *
+ * @param region_hint Expected region count; the region vector is reserved
+ * for at least this many.
+ * @return std::shared_ptr<ProcessSnapshot> The snapshot.
+ */
+std::shared_ptr<ProcessSnapshot> SnapshotPool::acquire(size_t region_hint) {
+    ProcessSnapshot* snapshot = state_->pop_snapshot();
+    if (!snapshot) {
+        snapshot = new ProcessSnapshot{};
+    }
+    detail::reserve_regions(snapshot->regions, region_hint);
+    return std::shared_ptr<ProcessSnapshot>(snapshot, Recycler{state_},
+                                            BlockAllocator<ProcessSnapshot>(state_));
+}
+
+/**
+ * @brief Returns the number of idle snapshots ready for reuse.
+ */
+size_t SnapshotPool::idle() const {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    return state_->snapshots.size();
+}
+
+} // namespace memc
@@ -0,0 +1,145 @@
+#include <cstring>
+#include <memc/string_pool.h>
+#include <mutex>
+
+namespace memc {
+
+namespace {
+
+/// Most recent hit per thread; pathnames repeat across consecutive regions.
+struct LastHit {
+    const StringPool* pool = nullptr;
+    uint32_t id = 0;
+};
+
+thread_local LastHit t_last_hit;
+
+} // namespace
+
+/**
+ * @brief Creates a pool holding only the empty string (ID 0).
+ */
+StringPool::StringPool() {
+    auto* block = new Entry[kBlockSize];
+    block[0] = {"", 0};
+    blocks_[0].store(block, std::memory_order_release);
+    count_.store(1, std::memory_order_release);
+}
+
+/**
+ * @brief Frees every block and arena chunk.
+ */
+StringPool::~StringPool() {
+    for (auto& block : blocks_) {
+        delete[] block.load(std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Returns the pool shared by every InternedString.
+ *
+ * Deliberately never destroyed, so interned strings stay valid during
+ * static destruction.
+ */
+StringPool& StringPool::global() {
+    static StringPool* pool = new StringPool();
+    return *pool;
+}
+
+/**
+ * @brief Returns the ID of @p s, adding it to the pool if new.
+ *
+ * A per-thread cache of the last hit short-circuits runs of the same
+ * string, which is the common case when parsing maps (every segment of a
+ * shared library shares its pathname). Once the pool holds kMaxStrings
+ * strings or kMaxBytes bytes, new strings intern as the empty string and
+ * are counted in dropped().
+ *
+ * @param s The string to intern.
+ * @return uint32_t The string's ID (0 for the empty string).
+ */
+uint32_t StringPool::intern(std::string_view s) {
+    if (s.empty()) {
+        return 0;
+    }
+    if (t_last_hit.pool == this && lookup(t_last_hit.id) == s) {
+        return t_last_hit.id;
+    }
+
+    {
+        std::shared_lock lock(mutex_);
+        auto it = ids_.find(s);
+        if (it != ids_.end()) {
+            t_last_hit = {this, it->second};
+            return it->second;
+        }
+    }
+
+    std::unique_lock lock(mutex_);
+    auto it = ids_.find(s);
+    if (it != ids_.end()) {
+        t_last_hit = {this, it->second};
+        return it->second;
+    }
+
+    uint32_t id = count_.load(std::memory_order_relaxed);
+    if (id >= kMaxStrings || bytes_ + s.size() + 1 > kMaxBytes) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return 0;
+    }
+
+    Entry* block = blocks_[id >> kBlockBits].load(std::memory_order_relaxed);
+    if (!block) {
+        block = new Entry[kBlockSize];
+        blocks_[id >> kBlockBits].store(block, std::memory_order_release);
+    }
+
+    const char* data = store(s);
+    block[id & (kBlockSize - 1)] = {data, static_cast<uint32_t>(s.size())};
+    ids_.emplace(std::string_view(data, s.size()), id);
+    count_.store(id + 1, std::memory_order_release);
+
+    t_last_hit = {this, id};
+    return id;
+}
+
+/**
+ * @brief Returns the bytes of string data held by the pool.
+ */
+size_t StringPool::bytes() const {
+    std::shared_lock lock(mutex_);
+    return bytes_;
+}
+
+/**
+ * @brief Copies @p s, NUL-terminated, into the arena.
+ *
+ * Small strings are packed into shared 64 KiB chunks; anything larger than
+ * a quarter chunk gets its own allocation. Called with the exclusive lock
+ * held.
+ *
+ * @return const char* The stable copy.
+ */
+const char* StringPool::store(std::string_view s) {
+    size_t needed = s.size() + 1;
+    char* dst;
+    if (needed > kArenaChunk / 4) {
+        arena_.push_back(std::make_unique<char[]>(needed));
+        dst = arena_.back().get();
+    } else {
+        if (needed > arena_left_) {
+            arena_.push_back(std::make_unique<char[]>(kArenaChunk));
+            arena_pos_ = arena_.back().get();
+            arena_left_ = kArenaChunk;
+        }
+        dst = arena_pos_;
+        arena_pos_ += needed;
+        arena_left_ -= needed;
+    }
+    std::memcpy(dst, s.data(), s.size());
+    dst[s.size()] = '\0';
+    bytes_ += needed;
+    return dst;
+}
+
+} // namespace memc
@@ -0,0 +1,573 @@
+#include "collect_internal.h"
+#include "line_cursor.h"
+#include "self_stats_internal.h"
+
+#include <algorithm>
+#include <bit>
+#include <condition_variable>
+#include <cstring>
+#include <memc/maps_parser.h>
+#include <memc/numa_maps_parser.h>
+#include <memc/process_utils.h>
+#include <memc/smaps_parser.h>
+#include <memc/system_scanner.h>
+#include <mutex>
+#include <string_view>
+
+namespace memc {
+
+namespace {
+
+/// Which /proc file an incremental scan read for a process.
+enum class Source : uint64_t { MAPS = 1, SMAPS = 2, ROLLUP = 3 };
+
+/**
+ * @brief Returns true if a collected snapshot or summary looks like a kernel
+ * thread.
+ *
+ * Kernel threads have no user-space mm, so their maps are empty and their
+ * rollup totals are zero.
+ */
+bool looks_like_kernel_thread(const ProcessSnapshot* snapshot, const ProcessSummary* summary) {
+    if (snapshot) {
+        return snapshot->regions.empty();
+    }
+    if (summary) {
+        return summary->rss_kb == 0;
+    }
+    return false;
+}
+
+/**
+ * @brief Hashes raw file contents for change detection.
+ *
+ * Eight bytes per multiply-xorshift step; not cryptographic, only meant to
+ * make an accidental match between two different maps files negligible.
+ */
+uint64_t hash_bytes(std::string_view bytes) {
+    uint64_t h = 0x9e3779b97f4a7c15ULL ^ bytes.size();
+    const char* p = bytes.data();
+    size_t n = bytes.size();
+    for (; n >= 8; p += 8, n -= 8) {
+        uint64_t word;
+        std::memcpy(&word, p, 8);
+        h = (h ^ word) * 0xff51afd7ed558ccdULL;
+        h ^= h >> 29;
+    }
+    uint64_t tail = 0;
+    std::memcpy(&tail, p, n);
+    h = (h ^ tail) * 0xc4ceb9fe1a85ec53ULL;
+    return h ^ (h >> 32);
+}
+
+/**
+ * @brief Parses the thread count, start time and virtual size of a process
+ * from the contents of /proc/<pid>/stat.
+ *
+ * The command name (field 2) may contain spaces and parentheses, so fields
+ * are counted from the last ')'. num_threads, starttime and vsize are
+ * fields 20, 22 and 23.
+ *
+ * @return true on success, false if the contents are malformed.
+ */
+bool parse_identity(std::string_view stat, uint64_t& threads, uint64_t& start_time,
+                    uint64_t& vsize) {
+    size_t close = stat.rfind(')');
+    if (close == std::string_view::npos) {
+        return false;
+    }
+
+    detail::LineCursor cursor{stat.substr(close + 1)};
+    uint64_t itrealvalue;
+    for (int field = 3; field < 20; ++field) {
+        cursor.skip_blanks();
+        cursor.scan_token();
+    }
+    cursor.skip_blanks();
+    if (!cursor.scan_decimal(threads)) {
+        return false;
+    }
+    cursor.skip_blanks();
+    if (!cursor.scan_decimal(itrealvalue)) {
+        return false;
+    }
+    cursor.skip_blanks();
+    if (!cursor.scan_decimal(start_time)) {
+        return false;
+    }
+    cursor.skip_blanks();
+    return cursor.scan_decimal(vsize);
+}
+
+/**
+ * @brief Parses the time a task has spent on the CPU, in nanoseconds, from
+ * the first field of /proc/<pid>/schedstat.
+ *
+ * @return true on success, false if the contents are malformed.
+ */
+bool parse_runtime(std::string_view schedstat, uint64_t& runtime_ns) {
+    detail::LineCursor cursor{schedstat};
+    return cursor.scan_decimal(runtime_ns);
+}
+
+/// Processes whose files a worker reads ahead per BatchReader batch.
+constexpr size_t kPrefetchPids = 16;
+
+} // namespace
+
+/**
+ * @brief Constructs a scanner and starts its worker threads.
+ *
+ * One WorkerState is allocated per pool worker up front; workers only ever
+ * touch their own state, so no locking is needed around the buffers.
+ *
+ * With ScannerConfig::io_uring, every worker also sets up its own ring, and
+ * the files each process will certainly need are listed for prefetching:
+ * the file to parse (plus numa_maps and comm) in full scans, and stat plus
+ * either schedstat (maps-only with runtime_shortcut, where most processes
+ * stop there) or the file to fingerprint in incremental scans. Fallback reads (e.g. maps after an
+ * unreadable smaps) are made one at a time.
+ *
+ * @param config Scanner configuration.
+ */
+SystemScanner::SystemScanner(ScannerConfig config)
+    : config_(std::move(config))
+    , pool_(config_.jobs)
+    , states_(pool_.size()) {
+    if (!config_.io_uring) {
+        return;
+    }
+    for (WorkerState& state : states_) {
+        if (!state.reader.open()) {
+            return;
+        }
+    }
+
+    const CollectorConfig& c = config_.collector;
+    const char* primary = c.summary_only ? "smaps_rollup" : c.use_smaps ? "smaps" : "maps";
+    const bool numa = c.numa && !c.summary_only;
+    auto add = [this](const char* name) { prefetch_names_[prefetch_count_++] = name; };
+    if (config_.incremental) {
+        add("stat");
+        if (config_.runtime_shortcut && !c.summary_only && !c.use_smaps && !numa) {
+            add("schedstat");
+        } else {
+            add(primary);
+            if (numa)
+                add("numa_maps");
+        }
+    } else {
+        add(primary);
+        if (numa)
+            add("numa_maps");
+        if (config_.read_names)
+            add("comm");
+    }
+}
+
+/**
+ * @brief Scans the given PIDs and streams the results to @p sink.
+ *
+ * PIDs are submitted to the pool in contiguous blocks. Workers mark each
+ * slot complete as they go, and the calling thread emits the completed
+ * prefix in order. When the sink cancels, outstanding blocks skip their
+ * remaining work and the call returns once they have drained.
+ *
+ * @param pids The processes to scan.
+ * @param sink Consumer for each result.
+ */
+void SystemScanner::scan(const std::vector<pid_t>& pids, const EntryCallback& sink) {
+    const size_t count = pids.size();
+    if (count == 0)
+        return;
+
+    std::vector<ProcessEntry> slots(count);
+    std::vector<uint8_t> done(count, 0);
+
+    // Workers swap the previous fingerprint for the new one in place.
+    std::vector<Fingerprint> fingerprints;
+    if (config_.incremental) {
+        ++generation_;
+        fingerprints.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            auto it = cache_.find(pids[i]);
+            if (it != cache_.end()) {
+                fingerprints[i] = it->second.fingerprint;
+            }
+        }
+    }
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::atomic<bool> cancelled{false};
+
+    const size_t grain = std::max<size_t>(1, count / (pool_.size() * 8));
+    size_t blocks_remaining = (count + grain - 1) / grain;
+
+    for (size_t begin = 0; begin < count; begin += grain) {
+        size_t end = std::min(count, begin + grain);
+        pool_.submit([&, begin, end](size_t worker) {
+            WorkerState& state = states_[worker];
+            const std::span<const char* const> names(prefetch_names_.data(), prefetch_count_);
+            for (size_t i = begin; i < end; ++i) {
+                if (!names.empty() && (i - begin) % kPrefetchPids == 0 &&
+                    !cancelled.load(std::memory_order_relaxed)) {
+                    size_t n = std::min(kPrefetchPids, end - i);
+                    state.prefetch(std::span(pids).subspan(i, n), names);
+                }
+                if (cancelled.load(std::memory_order_relaxed)) {
+                    // Leave the slot empty; it is never delivered.
+                } else if (config_.incremental) {
+                    collect_incremental(pids[i], state, slots[i], fingerprints[i]);
+                } else {
+                    collect(pids[i], state, slots[i]);
+                }
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    done[i] = 1;
+                }
+                cv.notify_all();
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            --blocks_remaining;
+            cv.notify_all();
+        });
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [&] { return done[i] != 0; });
+        }
+
+        ProcessEntry& entry = slots[i];
+        bool report = !config_.incremental || remember(entry, fingerprints[i]);
+        report = report && !(config_.skip_kernel && !entry.skipped && is_kernel_thread(entry));
+        if (report && !sink(entry)) {
+            cancelled.store(true, std::memory_order_relaxed);
+            break;
+        }
+        entry = ProcessEntry{};
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&] { return blocks_remaining == 0; });
+    }
+
+    if (!config_.incremental || cancelled.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    // Whatever the previous scan saw and this one did not is gone.
+    std::vector<pid_t> exited;
+    for (auto it = cache_.begin(); it != cache_.end();) {
+        if (it->second.generation != generation_) {
+            exited.push_back(it->first);
+            it = cache_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    std::sort(exited.begin(), exited.end());
+    for (pid_t pid : exited) {
+        ProcessEntry entry;
+        entry.pid = pid;
+        entry.exited = true;
+        if (!sink(entry)) {
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Scans the given PIDs and returns all results in input order.
+ *
+ * @param pids The processes to scan.
+ * @return std::vector<ProcessEntry> One entry per reported process.
+ */
+std::vector<ProcessEntry> SystemScanner::scan(const std::vector<pid_t>& pids) {
+    std::vector<ProcessEntry> results;
+    results.reserve(pids.size());
+    scan(pids, [&](ProcessEntry& entry) {
+        results.push_back(std::move(entry));
+        return true;
+    });
+    return results;
+}
+
+/**
+ * @brief Reads the files @p names of every process in @p pids in one
+ * BatchReader batch, for read() to hand out.
+ *
+ * @param pids The processes the worker collects next.
+ * @param names The /proc/<pid>/ files to read for each of them.
+ */
+void SystemScanner::WorkerState::prefetch(std::span<const pid_t> pids,
+                                          std::span<const char* const> names) {
+    const size_t count = pids.size() * names.size();
+    if (prefetch_buffers.size() < count) {
+        prefetch_buffers.resize(count);
+    }
+    prefetched.clear();
+    for (pid_t pid : pids) {
+        for (const char* name : names) {
+            prefetched.push_back({pid, name, &prefetch_buffers[prefetched.size()]});
+        }
+    }
+    reader.read(prefetched);
+}
+
+/**
+ * @brief Reads /proc/<pid>/<name> into @p out, taking the prefetched
+ * contents if there are any.
+ *
+ * A prefetched file is handed out once, by swapping buffers; a file that
+ * was not prefetched is read with read_proc_file().
+ *
+ * @return true on success, false if the file could not be read.
+ */
+bool SystemScanner::WorkerState::read(pid_t pid, const char* name, std::string& out) {
+    for (BatchRead& r : prefetched) {
+        if (r.pid == pid && r.name && std::strcmp(r.name, name) == 0) {
+            r.name = nullptr;
+            if (r.ok) {
+                out.swap(*r.buffer);
+            }
+            return r.ok;
+        }
+    }
+    return read_proc_file(pid, name, out);
+}
+
+/**
+ * @brief Collects one process into @p entry using the worker's scratch state.
+ *
+ * @param pid The process ID.
+ * @param state The executing worker's buffers.
+ * @param entry The slot to fill.
+ */
+void SystemScanner::collect(pid_t pid, WorkerState& state, ProcessEntry& entry) {
+    entry.pid = pid;
+
+    auto read = [&](const char* name, std::string& buffer) {
+        return state.read(pid, name, buffer);
+    };
+    if (config_.collector.summary_only) {
+        ProcessSummary summary;
+        summary.pid = pid;
+        summary.timestamp_ms = detail::now_ms();
+        if (detail::read_summary_with(read, state.buffer, state.scratch, summary)) {
+            entry.summary = summary;
+        } else {
+            entry.skipped = true;
+        }
+    } else {
+        ProcessSnapshot snapshot;
+        snapshot.pid = pid;
+        snapshot.timestamp_ms = detail::now_ms();
+        if (detail::read_regions_with(read, config_.collector.use_smaps, config_.collector.numa,
+                                      config_.collector.fields, state.buffer, snapshot.regions)) {
+            entry.snapshot = std::move(snapshot);
+        } else {
+            entry.skipped = true;
+        }
+    }
+
+    if (config_.read_names) {
+        entry.name = state.read(pid, "comm", state.buffer)
+                         ? detail::process_name_from_comm(state.buffer)
+                         : "unknown";
+    }
+}
+
+/**
+ * @brief Collects one process in incremental mode.
+ *
+ * Reads the identity from /proc/<pid>/stat and the raw file the scan
+ * parses (smaps_rollup, smaps or maps, with the usual fallbacks), and only
+ * parses it when the resulting fingerprint differs from @p fingerprint.
+ * An unreadable process is unchanged if its identity and vsize are.
+ *
+ * @param pid The process ID.
+ * @param state The executing worker's buffers.
+ * @param entry The slot to fill.
+ * @param fingerprint In: the previous scan's fingerprint (default if none).
+ * Out: this scan's fingerprint; not present if the process is gone.
+ */
+void SystemScanner::collect_incremental(pid_t pid, WorkerState& state, ProcessEntry& entry,
+                                        Fingerprint& fingerprint) {
+    const Fingerprint previous = fingerprint;
+    fingerprint = Fingerprint{};
+    entry.pid = pid;
+
+    uint64_t threads = 0;
+    if (!state.read(pid, "stat", state.buffer) ||
+        !parse_identity(state.buffer, threads, fingerprint.start_time, fingerprint.vsize)) {
+        entry.skipped = true;
+        return;
+    }
+    fingerprint.present = true;
+
+    const uint64_t timestamp_ms = detail::now_ms();
+    const bool summary = config_.collector.summary_only;
+    Source source = summary ? Source::ROLLUP : config_.collector.use_smaps ? Source::SMAPS
+                                                                           : Source::MAPS;
+
+    // Opt-in: mappings only change through the process's own system calls,
+    // which cost CPU time, but the maps text does not (a mapped file deleted
+    // by another process gains " (deleted)"). smaps counters and NUMA
+    // placement move even more freely, so the shortcut is maps-only.
+    if (config_.runtime_shortcut && source == Source::MAPS && !config_.collector.numa &&
+        threads == 1 && state.read(pid, "schedstat", state.buffer) &&
+        parse_runtime(state.buffer, fingerprint.runtime_ns) && previous.readable &&
+        previous.runtime_ns == fingerprint.runtime_ns &&
+        previous.start_time == fingerprint.start_time && previous.vsize == fingerprint.vsize) {
+        fingerprint = previous;
+        entry.unchanged = true;
+        return;
+    }
+    bool readable = false;
+    if (source == Source::ROLLUP) {
+        readable = state.read(pid, "smaps_rollup", state.buffer);
+        if (!readable) {
+            source = Source::SMAPS;
+            readable = state.read(pid, "smaps", state.buffer);
+        }
+    } else if (source == Source::SMAPS) {
+        readable = state.read(pid, "smaps", state.buffer);
+        if (!readable) {
+            source = Source::MAPS;
+            readable = state.read(pid, "maps", state.buffer);
+        }
+    } else {
+        readable = state.read(pid, "maps", state.buffer);
+    }
+
+    if (readable) {
+        fingerprint.readable = true;
+        fingerprint.hash = hash_bytes(state.buffer) ^ static_cast<uint64_t>(source);
+    }
+    // Page placement moves without the mappings changing, so numa_maps is
+    // part of the fingerprint too.
+    const bool numa = readable && !summary && config_.collector.numa &&
+                      state.read(pid, "numa_maps", state.numa_buffer);
+    if (numa) {
+        fingerprint.hash = std::rotl(fingerprint.hash, 1) ^ hash_bytes(state.numa_buffer);
+    }
+    if (fingerprint.matches(previous)) {
+        entry.unchanged = true;
+        entry.skipped = !readable;
+        return;
+    }
+
+    if (!readable) {
+        entry.skipped = true;
+    } else if (summary) {
+        ProcessSummary totals;
+        totals.pid = pid;
+        totals.timestamp_ms = timestamp_ms;
+        if (source == Source::ROLLUP) {
+            SmapsParser::parse_rollup_from_view(state.buffer, totals);
+            detail::count_snapshot(0);
+        } else {
+            state.scratch.clear();
+            SmapsParser::parse_from_view(state.buffer, state.scratch);
+            detail::add_region_totals(state.scratch, totals);
+            detail::count_snapshot(state.scratch.size());
+        }
+        entry.summary = totals;
+    } else {
+        ProcessSnapshot snapshot;
+        snapshot.pid = pid;
+        snapshot.timestamp_ms = timestamp_ms;
+        if (source == Source::SMAPS) {
+            SmapsParser::parse_from_view(state.buffer, snapshot.regions, config_.collector.fields);
+        } else {
+            MapsParser::parse_from_view(state.buffer, snapshot.regions);
+        }
+        if (numa) {
+            NumaMapsParser::enrich_from_view(state.numa_buffer, snapshot.regions);
+        }
+        detail::count_snapshot(snapshot.regions.size());
+        entry.snapshot = std::move(snapshot);
+    }
+
+    if (config_.read_names) {
+        entry.name = state.read(pid, "comm", state.buffer)
+                         ? detail::process_name_from_comm(state.buffer)
+                         : "unknown";
+    }
+}
+
+/**
+ * @brief Records an incremental result in the cache.
+ *
+ * Called on the scanning thread, in PID order, before the entry reaches the
+ * sink. Changed processes have their new snapshot or summary copied into
+ * the cache.
+ *
+ * @param entry The collected entry.
+ * @param fingerprint Its fingerprint from this scan.
+ * @return true if the entry should be delivered; false for a cached process
+ * that vanished during the scan, which is reported as exited instead.
+ */
+bool SystemScanner::remember(ProcessEntry& entry, const Fingerprint& fingerprint) {
+    auto it = cache_.find(entry.pid);
+    if (!fingerprint.present) {
+        return it == cache_.end();
+    }
+
+    CacheEntry& cached = it != cache_.end() ? it->second : cache_[entry.pid];
+    cached.fingerprint = fingerprint;
+    cached.generation = generation_;
+    if (!entry.unchanged) {
+        cached.snapshot =
+            entry.snapshot ? std::make_shared<const ProcessSnapshot>(*entry.snapshot) : nullptr;
+        cached.summary = entry.summary;
+    }
+    return true;
+}
+
+/**
+ * @brief Returns true if the entry looks like a kernel thread.
+ *
+ * Unchanged entries carry no data, so the cached result is consulted.
+ */
+bool SystemScanner::is_kernel_thread(const ProcessEntry& entry) const {
+    if (entry.unchanged) {
+        auto it = cache_.find(entry.pid);
+        if (it == cache_.end()) {
+            return false;
+        }
+        const auto& summary = it->second.summary;
+        return looks_like_kernel_thread(it->second.snapshot.get(), summary ? &*summary : nullptr);
+    }
+    return looks_like_kernel_thread(entry.snapshot ? &*entry.snapshot : nullptr,
+                                    entry.summary ? &*entry.summary : nullptr);
+}
+
+/**
+ * @brief Returns the last snapshot collected for a process in incremental
+ * mode.
+ *
+ * @param pid The process ID.
+ * @return SnapshotHandle The snapshot, or nullptr if none is cached.
+ */
+SnapshotHandle SystemScanner::cached_snapshot(pid_t pid) const {
+    auto it = cache_.find(pid);
+    return it == cache_.end() ? nullptr : it->second.snapshot;
+}
+
+/**
+ * @brief Returns the last summary collected for a process in incremental
+ * summary mode.
+ *
+ * @param pid The process ID.
+ * @return std::optional<ProcessSummary> The summary, or std::nullopt.
+ */
+std::optional<ProcessSummary> SystemScanner::cached_summary(pid_t pid) const {
+    auto it = cache_.find(pid);
+    return it == cache_.end() ? std::nullopt : it->second.summary;
+}
+
+} // namespace memc
@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <memc/thread_pool.h>
+
+namespace memc {
+
+/**
+ * @brief Starts the worker threads.
+ *
+ * @param threads Number of workers. 0 selects one per hardware thread.
+ */
+ThreadPool::ThreadPool(size_t threads) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    queues_.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        queues_.push_back(std::make_unique<Queue>());
+    }
+
+    threads_.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        threads_.emplace_back(&ThreadPool::worker_loop, this, i);
+    }
+}
+
+/**
+ * @brief Drains all queued tasks and joins the workers.
+ */
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        stopping_ = true;
+    }
+    wake_cv_.notify_all();
+    for (auto& t : threads_) {
+        if (t.joinable()) {
+            t.join();
+        }
+    }
+}
+
+/**
+ * @brief Queues a task on the next worker deque in round-robin order.
+ *
+ * The pending counter is bumped under the wake mutex so a worker that is
+ * about to sleep cannot miss the notification.
+ *
+ * @param task The task to run.
+ */
+void ThreadPool::submit(Task task) {
+    size_t q = next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+    {
+        std::lock_guard<std::mutex> lock(queues_[q]->mutex);
+        queues_[q]->tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        pending_.fetch_add(1, std::memory_order_relaxed);
+    }
+    wake_cv_.notify_one();
+}
+
+/**
+ * @brief Runs @p fn for every index in [0, count) and waits for completion.
+ *
+ * @param count Number of indices.
+ * @param fn Callback invoked as fn(index, worker).
+ */
+void ThreadPool::parallel_for(size_t count,
+                              const std::function<void(size_t index, size_t worker)>& fn) {
+    if (count == 0)
+        return;
+
+    size_t grain = std::max<size_t>(1, count / (size() * 8));
+    size_t blocks = (count + grain - 1) / grain;
+
+    std::mutex done_mutex;
+    std::condition_variable done_cv;
+    size_t remaining = blocks;
+
+    for (size_t b = 0; b < blocks; ++b) {
+        size_t begin = b * grain;
+        size_t end = std::min(count, begin + grain);
+        submit([&, begin, end](size_t worker) {
+            for (size_t i = begin; i < end; ++i) {
+                fn(i, worker);
+            }
+            std::lock_guard<std::mutex> lock(done_mutex);
+            if (--remaining == 0) {
+                done_cv.notify_all();
+            }
+        });
+    }
+
+    std::unique_lock<std::mutex> lock(done_mutex);
+    done_cv.wait(lock, [&] { return remaining == 0; });
+}
+
+/**
+ * @brief Pops the next task for worker @p id.
+ *
+ * Takes from the front of the worker's own deque first, then steals from
+ * the back of the other deques, starting with its right-hand neighbour.
+ *
+ * @param id The worker index.
+ * @param out Receives the task.
+ * @return true if a task was found, false if every deque was empty.
+ */
+bool ThreadPool::try_pop(size_t id, Task& out) {
+    {
+        auto& own = *queues_[id];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            out = std::move(own.tasks.front());
+            own.tasks.pop_front();
+            return true;
+        }
+    }
+
+    for (size_t k = 1; k < queues_.size(); ++k) {
+        auto& victim = *queues_[(id + k) % queues_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            out = std::move(victim.tasks.back());
+            victim.tasks.pop_back();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Worker thread body: run tasks until the pool is stopped and drained.
+ *
+ * @param id The worker index.
+ */
+void ThreadPool::worker_loop(size_t id) {
+    for (;;) {
+        Task task;
+        if (try_pop(id, task)) {
+            pending_.fetch_sub(1, std::memory_order_relaxed);
+            task(id);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(wake_mutex_);
+        wake_cv_.wait(lock, [&] { return stopping_ || pending_.load() > 0; });
+        if (stopping_ && pending_.load() == 0) {
+            return;
+        }
+    }
+}
+
+} // namespace memc